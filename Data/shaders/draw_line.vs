@@ -4,8 +4,13 @@ layout (location = 0) in vec3 position;
 
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-view data, shared by programs
+layout (std140) uniform ViewBlock
+{
+    mat4 view;
+    mat4 projection;
+};
 
 
 void main()
@@ -0,0 +1,9 @@
+// point light of the lighting passes, included by the fragment shaders
+struct Light {
+	vec3 Position;
+	vec3 Color;
+
+	float Linear;
+	float Quadratic;
+	float Radius;
+};
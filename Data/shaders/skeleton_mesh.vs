@@ -9,8 +9,13 @@ layout (location = 5) in ivec4 BoneIDs;
 layout (location = 6) in vec4 Weights;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-view data, shared by programs
+layout (std140) uniform ViewBlock
+{
+    mat4 view;
+    mat4 projection;
+};
 
 uniform mat4 gBones[75];
 
@@ -7,17 +7,16 @@ uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 
-struct Light {
-	vec3 Position;
-	vec3 Color;
+#include "light.glsl"
 
-	float Linear;
-	float Quadratic;
-	float Radius;
-}; 
-
-const int NR_LIGHTS = 32;
-uniform Light lights[NR_LIGHTS];
+#ifndef NR_LIGHTS
+#define NR_LIGHTS 32
+#endif
+// light data, uploaded once and shared by programs
+layout (std140) uniform LightsBlock
+{
+    Light lights[NR_LIGHTS];
+};
 uniform vec3 viewPos;
 
 uniform int draw_mode;
@@ -10,8 +10,13 @@ out vec3 Normal;
 out vec2 Texcoord0;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-view data, shared by programs
+layout (std140) uniform ViewBlock
+{
+    mat4 view;
+    mat4 projection;
+};
 
 
 void main()
@@ -7,8 +7,13 @@ layout (location = 3) in vec3 tangent;
 layout (location = 4) in vec3 bitangent;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-view data, shared by programs
+layout (std140) uniform ViewBlock
+{
+    mat4 view;
+    mat4 projection;
+};
 
 // varying outputs
 out vec2   Texcoord0;
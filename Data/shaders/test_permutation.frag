@@ -0,0 +1,29 @@
+#version 330 core
+
+// switches of TShaderPermutation, defined as 0 or 1
+// SHOW_NORMAL: the color is the world normal
+// GRAYSCALE: the luminance of the color
+
+in vec2 Texcoord0;
+in vec3 Normal;
+
+out vec4 color;
+
+uniform sampler2D diffuseTex;
+uniform sampler2D specularTex;
+uniform sampler2D normalTex;
+
+
+void main()
+{
+#if SHOW_NORMAL
+    color = vec4(normalize(Normal) * 0.5f + 0.5f, 1.0f);
+#else
+    color = texture(diffuseTex, Texcoord0);
+#endif
+
+#if GRAYSCALE
+    float luminance = dot(color.rgb, vec3(0.2126f, 0.7152f, 0.0722f));
+    color = vec4(vec3(luminance), color.a);
+#endif
+}
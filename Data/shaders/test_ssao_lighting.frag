@@ -7,14 +7,7 @@ uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 uniform sampler2D ssao;
 
-struct Light {
-	vec3 Position;
-	vec3 Color;
-
-	float Linear;
-	float Quadratic;
-	float Radius;
-};
+#include "light.glsl"
 
 uniform Light light;
 uniform int draw_mode;
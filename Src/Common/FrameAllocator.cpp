@@ -0,0 +1,113 @@
+// \brief
+//		implementation of frame allocator
+//
+
+#include <cassert>
+#include <cstring>
+#include "FrameAllocator.h"
+
+
+static inline size_t AlignOffset(const unsigned char *InBase, size_t InOffset, size_t InAlign)
+{
+	size_t Address = (size_t)(InBase + InOffset);
+	return InOffset + ((InAlign - (Address & (InAlign - 1))) & (InAlign - 1));
+}
+
+FFrameAllocator& FFrameAllocator::SharedInstance()
+{
+	static FFrameAllocator Allocator;
+
+	return Allocator;
+}
+
+FFrameAllocator::FFrameAllocator(size_t InBlockSize)
+	: BlockSize(InBlockSize)
+	, CurrentBlock(0)
+	, CurrentOffset(0)
+{
+	memset(&Stats, 0, sizeof(Stats));
+}
+
+FFrameAllocator::~FFrameAllocator()
+{
+	for (size_t k = 0; k < Blocks.size(); k++)
+	{
+		::operator delete(Blocks[k].Data);
+	} // end for k
+	Blocks.clear();
+}
+
+void* FFrameAllocator::Alloc(size_t InSize, size_t InAlign)
+{
+	assert(InAlign > 0 && (InAlign & (InAlign - 1)) == 0);
+
+	size_t Offset = 0;
+	if (CurrentBlock < Blocks.size())
+	{
+		Offset = AlignOffset(Blocks[CurrentBlock].Data, CurrentOffset, InAlign);
+	}
+
+	if (CurrentBlock >= Blocks.size() || Offset + InSize > Blocks[CurrentBlock].Size)
+	{
+		NextBlock(InSize, InAlign);
+		Offset = AlignOffset(Blocks[CurrentBlock].Data, CurrentOffset, InAlign);
+	}
+
+	CurrentOffset = Offset + InSize;
+	Stats.FrameAllocs++;
+	Stats.FrameBytes += InSize;
+	if (Stats.FrameBytes > Stats.PeakBytes)
+	{
+		Stats.PeakBytes = Stats.FrameBytes;
+	}
+
+	return Blocks[CurrentBlock].Data + Offset;
+}
+
+void FFrameAllocator::NextBlock(size_t InSize, size_t InAlign)
+{
+	const size_t Required = InSize + InAlign;
+
+	// reuse the blocks kept from previous frames
+	size_t Index = Blocks.empty() ? 0 : CurrentBlock + 1;
+	for (; Index < Blocks.size(); Index++)
+	{
+		if (Blocks[Index].Size >= Required)
+		{
+			CurrentBlock = Index;
+			CurrentOffset = 0;
+			return;
+		}
+	} // end for Index
+
+	FBlock Block;
+	Block.Size = BlockSize > Required ? BlockSize : Required;
+	Block.Data = (unsigned char*)::operator new(Block.Size);
+	Stats.HeapAllocs++;
+
+	// insert after current block, the skipped small blocks are still reused next frame
+	CurrentBlock = Blocks.empty() ? 0 : CurrentBlock + 1;
+	Blocks.insert(Blocks.begin() + CurrentBlock, Block);
+	CurrentOffset = 0;
+}
+
+const char* FFrameAllocator::CopyString(const char *InString)
+{
+	size_t Length = strlen(InString) + 1;
+	char *String = (char*)Alloc(Length, 1);
+	memcpy(String, InString, Length);
+
+	return String;
+}
+
+void FFrameAllocator::Reset()
+{
+	CurrentBlock = 0;
+	CurrentOffset = 0;
+
+	Stats.LastFrameAllocs = Stats.FrameAllocs;
+	Stats.LastFrameBytes = Stats.FrameBytes;
+	Stats.FrameAllocs = 0;
+	Stats.FrameBytes = 0;
+	Stats.Frames++;
+}
@@ -0,0 +1,83 @@
+// \brief
+//		linear allocator for the transient objects of a frame
+//
+
+#ifndef __JETX_FRAME_ALLOCATOR_H__
+#define __JETX_FRAME_ALLOCATOR_H__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+
+// statistics of frame allocator
+struct FFrameAllocatorStats
+{
+	unsigned int	FrameAllocs;	// allocations in current frame
+	size_t			FrameBytes;		// bytes used in current frame
+	unsigned int	LastFrameAllocs;	// allocations in last finished frame
+	size_t			LastFrameBytes;		// bytes used in last finished frame
+	size_t			PeakBytes;		// max bytes used by a frame
+	unsigned int	HeapAllocs;		// total heap allocations made by allocator (memory blocks)
+	unsigned int	Frames;			// total frames reset
+};
+
+// \brief
+//	the memory is allocated linearly from chained blocks, no free for single allocation.
+//	Reset() at the end of frame rewinds it in O(1), the blocks are kept for next frame,
+//	so a steady-state frame does no heap allocation.
+//	the destructors of objects are never called, only use it for trivially destructible data.
+class FFrameAllocator
+{
+public:
+	explicit FFrameAllocator(size_t InBlockSize = 64 * 1024);
+	~FFrameAllocator();
+
+	static FFrameAllocator& SharedInstance();
+
+	// allocate memory, valid until Reset()
+	void* Alloc(size_t InSize, size_t InAlign = 16);
+
+	// allocate an array of trivially destructible type
+	template<typename T>
+	T* NewArray(size_t InCount)
+	{
+		T *Array = (T*)Alloc(sizeof(T) * InCount, alignof(T));
+		for (size_t k = 0; k < InCount; k++)
+		{
+			new (Array + k) T();
+		} // end for k
+
+		return Array;
+	}
+
+	// copy a null-terminated string
+	const char* CopyString(const char *InString);
+
+	// rewind to the first block
+	void Reset();
+
+	const FFrameAllocatorStats& GetStats() const { return Stats; }
+
+private:
+	FFrameAllocator(const FFrameAllocator&) = delete;
+	FFrameAllocator& operator=(const FFrameAllocator&) = delete;
+
+	struct FBlock
+	{
+		unsigned char	*Data;
+		size_t			Size;
+	};
+
+	// move to a block which can hold InSize bytes, allocate one if none
+	void NextBlock(size_t InSize, size_t InAlign);
+
+	std::vector<FBlock>		Blocks;
+	size_t					BlockSize;
+	size_t					CurrentBlock;
+	size_t					CurrentOffset;
+
+	FFrameAllocatorStats	Stats;
+};
+
+#endif // __JETX_FRAME_ALLOCATOR_H__
@@ -0,0 +1,345 @@
+// \brief
+//		implementation of job system
+//
+
+#include <cassert>
+#include "JobSystem.h"
+
+
+// a queued job
+struct FJob
+{
+	FJobFunction	Function;
+	FJobCounter		*Counter;
+	bool			bGLThread;
+};
+
+// index of worker for the worker threads, -1 for the others
+static thread_local int GWorkerIndex = -1;
+
+FJobSystem& FJobSystem::SharedInstance()
+{
+	static FJobSystem JobSystem;
+
+	return JobSystem;
+}
+
+unsigned int FJobSystem::GetDefaultNumWorkers()
+{
+	const unsigned int kThreads = std::thread::hardware_concurrency();
+
+	return kThreads > 1 ? kThreads - 1 : 0;
+}
+
+FJobSystem::FJobSystem()
+	: bQuit(false)
+	, GLThreadId(std::this_thread::get_id())
+	, PendingJobs(0)
+	, SleepingWorkers(0)
+	, JobsExecuted(0)
+	, JobsStolen(0)
+	, GLJobsExecuted(0)
+{
+}
+
+FJobSystem::~FJobSystem()
+{
+	Shutdown();
+}
+
+void FJobSystem::Initialize(unsigned int InNumWorkers)
+{
+	assert(Workers.empty());
+
+	bQuit = false;
+	Workers.resize(InNumWorkers);
+	for (unsigned int Index = 0; Index < InNumWorkers; Index++)
+	{
+		Workers[Index].Thread = std::thread(&FJobSystem::WorkerMain, this, (int)Index);
+	} // end for
+}
+
+void FJobSystem::Shutdown()
+{
+	if (Workers.empty())
+	{
+		return;
+	}
+
+	bQuit = true;
+	{
+		std::lock_guard<std::mutex> Lock(SleepMutex);
+		WakeCondition.notify_all();
+	}
+	for (size_t Index = 0; Index < Workers.size(); Index++)
+	{
+		Workers[Index].Thread.join();
+	} // end for
+	Workers.clear();
+}
+
+void FJobSystem::SetGLThread()
+{
+	GLThreadId = std::this_thread::get_id();
+}
+
+bool FJobSystem::IsGLThread() const
+{
+	return GLThreadId == std::this_thread::get_id();
+}
+
+void FJobSystem::Run(const FJobFunction &InFunction, FJobCounter *InCounter, FJobCounter *InPrerequisite)
+{
+	Submit(NewJob(InFunction, InCounter, false), InPrerequisite);
+}
+
+void FJobSystem::RunOnGLThread(const FJobFunction &InFunction, FJobCounter *InCounter, FJobCounter *InPrerequisite)
+{
+	Submit(NewJob(InFunction, InCounter, true), InPrerequisite);
+}
+
+void FJobSystem::Wait(FJobCounter &InCounter)
+{
+	while (!InCounter.IsDone())
+	{
+		FJob *Job = FindJob();
+		if (Job)
+		{
+			Execute(Job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	} // end while
+
+	// the last job may still hold the lock after the count reaches zero
+	std::lock_guard<std::mutex> Lock(InCounter.Mutex);
+}
+
+void FJobSystem::PumpGLThread()
+{
+	assert(IsGLThread());
+
+	std::deque<FJob*> Jobs;
+	{
+		std::lock_guard<std::mutex> Lock(GLMutex);
+		Jobs.swap(GLJobs);
+	}
+	for (size_t Index = 0; Index < Jobs.size(); Index++)
+	{
+		Execute(Jobs[Index]);
+	} // end for
+}
+
+void FJobSystem::ParallelFor(size_t InBegin, size_t InEnd, size_t InGrain, const std::function<void(size_t, size_t)> &InFunction)
+{
+	if (InEnd <= InBegin)
+	{
+		return;
+	}
+
+	const size_t kGrain = InGrain > 0 ? InGrain : 1;
+	FJobCounter Counter;
+	size_t Begin = InBegin;
+	for (; Begin + kGrain < InEnd; Begin += kGrain)
+	{
+		const size_t End = Begin + kGrain;
+		Run([&InFunction, Begin, End]() { InFunction(Begin, End); }, &Counter);
+	} // end for
+
+	// the last chunk on the calling thread
+	InFunction(Begin, InEnd);
+	Wait(Counter);
+}
+
+FJobSystemStats FJobSystem::GetStats() const
+{
+	FJobSystemStats Stats;
+	Stats.JobsExecuted = JobsExecuted.load();
+	Stats.JobsStolen = JobsStolen.load();
+	Stats.GLJobsExecuted = GLJobsExecuted.load();
+
+	return Stats;
+}
+
+void FJobSystem::WorkerMain(int InWorkerIndex)
+{
+	GWorkerIndex = InWorkerIndex;
+
+	for (;;)
+	{
+		FJob *Job = FindJob();
+		if (Job)
+		{
+			Execute(Job);
+			continue;
+		}
+
+		if (PendingJobs.load() > 0)
+		{
+			// lost a race for the job, try again
+			std::this_thread::yield();
+			continue;
+		}
+		if (bQuit)
+		{
+			break;
+		}
+
+		std::unique_lock<std::mutex> Lock(SleepMutex);
+		SleepingWorkers++;
+		WakeCondition.wait(Lock, [this]() { return bQuit || PendingJobs.load() > 0; });
+		SleepingWorkers--;
+	} // end for
+
+	GWorkerIndex = -1;
+}
+
+FJob* FJobSystem::NewJob(const FJobFunction &InFunction, FJobCounter *InCounter, bool bInGLThread)
+{
+	assert(InFunction);
+
+	FJob *Job = new FJob();
+	Job->Function = InFunction;
+	Job->Counter = InCounter;
+	Job->bGLThread = bInGLThread;
+	if (InCounter)
+	{
+		InCounter->Value.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return Job;
+}
+
+void FJobSystem::Submit(FJob *InJob, FJobCounter *InPrerequisite)
+{
+	if (InPrerequisite)
+	{
+		std::lock_guard<std::mutex> Lock(InPrerequisite->Mutex);
+		if (InPrerequisite->Value.load(std::memory_order_acquire) != 0)
+		{
+			InPrerequisite->Continuations.push_back(InJob);
+			return;
+		}
+	}
+
+	Enqueue(InJob);
+}
+
+void FJobSystem::Enqueue(FJob *InJob)
+{
+	if (InJob->bGLThread)
+	{
+		std::lock_guard<std::mutex> Lock(GLMutex);
+		GLJobs.push_back(InJob);
+		return;
+	}
+
+	PendingJobs++;
+	if (GWorkerIndex < 0 || !Workers[GWorkerIndex].Queue->Push(InJob))
+	{
+		std::lock_guard<std::mutex> Lock(SharedMutex);
+		SharedJobs.push_back(InJob);
+	}
+	WakeWorkers(1);
+}
+
+FJob* FJobSystem::FindJob()
+{
+	FJob *Job = nullptr;
+
+	// own deque first, the latest job is hot in cache
+	if (GWorkerIndex >= 0 && Workers[GWorkerIndex].Queue->Pop(Job))
+	{
+		PendingJobs--;
+		return Job;
+	}
+
+	if (IsGLThread())
+	{
+		std::lock_guard<std::mutex> Lock(GLMutex);
+		if (!GLJobs.empty())
+		{
+			Job = GLJobs.front();
+			GLJobs.pop_front();
+			return Job;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(SharedMutex);
+		if (!SharedJobs.empty())
+		{
+			Job = SharedJobs.front();
+			SharedJobs.pop_front();
+			PendingJobs--;
+			return Job;
+		}
+	}
+
+	// steal from the others, starting next to self
+	const int kNumWorkers = (int)Workers.size();
+	for (int k = 1; k <= kNumWorkers; k++)
+	{
+		const int Victim = (GWorkerIndex + k + kNumWorkers) % kNumWorkers;
+		if (Victim != GWorkerIndex && Workers[Victim].Queue->Steal(Job))
+		{
+			PendingJobs--;
+			JobsStolen++;
+			return Job;
+		}
+	} // end for k
+
+	return nullptr;
+}
+
+void FJobSystem::Execute(FJob *InJob)
+{
+	InJob->Function();
+	if (InJob->bGLThread)
+	{
+		GLJobsExecuted++;
+	}
+	else
+	{
+		JobsExecuted++;
+	}
+
+	FJobCounter *Counter = InJob->Counter;
+	delete InJob;
+
+	if (Counter)
+	{
+		std::vector<FJob*> ReadyJobs;
+		{
+			std::lock_guard<std::mutex> Lock(Counter->Mutex);
+			if (Counter->Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				ReadyJobs.swap(Counter->Continuations);
+			}
+		}
+		// the counter may be destroyed from here
+
+		for (size_t Index = 0; Index < ReadyJobs.size(); Index++)
+		{
+			Enqueue(ReadyJobs[Index]);
+		} // end for
+	}
+}
+
+void FJobSystem::WakeWorkers(unsigned int InCount)
+{
+	if (SleepingWorkers.load() > 0)
+	{
+		std::lock_guard<std::mutex> Lock(SleepMutex);
+		if (InCount > 1)
+		{
+			WakeCondition.notify_all();
+		}
+		else
+		{
+			WakeCondition.notify_one();
+		}
+	}
+}
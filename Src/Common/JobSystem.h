@@ -0,0 +1,146 @@
+// \brief
+//		job system, fixed worker threads with work stealing
+//
+
+#ifndef __JETX_JOB_SYSTEM_H__
+#define __JETX_JOB_SYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingQueue.h"
+
+
+typedef std::function<void()>	FJobFunction;
+struct FJob;
+
+// \brief
+//	counts the unfinished jobs of a group, the jobs waiting for it start when it reaches zero.
+//	it must outlive the jobs which reference it, FJobSystem::Wait() makes it safe to destroy.
+class FJobCounter
+{
+public:
+	FJobCounter()
+		: Value(0)
+	{}
+
+	bool IsDone() const { return Value.load(std::memory_order_acquire) == 0; }
+
+private:
+	FJobCounter(const FJobCounter&) = delete;
+	FJobCounter& operator=(const FJobCounter&) = delete;
+
+	friend class FJobSystem;
+
+	std::atomic<int>	Value;
+	std::mutex			Mutex;
+	std::vector<FJob*>	Continuations;	// jobs waiting for zero
+};
+
+// statistics of job system
+struct FJobSystemStats
+{
+	unsigned int	JobsExecuted;
+	unsigned int	JobsStolen;
+	unsigned int	GLJobsExecuted;
+};
+
+// \brief
+//	each worker owns a Chase-Lev deque, pops its own jobs and steals from others when empty.
+//	the jobs queued by a non-worker thread go to a shared queue.
+//	Wait() executes jobs on the calling thread until the counter is done, so nested waits don't deadlock.
+//	the jobs queued by RunOnGLThread() are executed only by the gl thread, in PumpGLThread() or Wait().
+class FJobSystem
+{
+public:
+	static FJobSystem& SharedInstance();
+
+	// one less than the hardware threads, the calling thread also executes jobs in Wait()
+	static unsigned int GetDefaultNumWorkers();
+
+	// 0 worker is valid, then all jobs are executed by Wait()
+	void Initialize(unsigned int InNumWorkers);
+	// finish the queued jobs and join the workers
+	void Shutdown();
+
+	unsigned int GetNumWorkers() const { return (unsigned int)Workers.size(); }
+
+	// the calling thread owns the gl context
+	void SetGLThread();
+	bool IsGLThread() const;
+
+	// queue a job, InCounter is incremented now and decremented when the job finishes.
+	// the job starts after InPrerequisite reaches zero, both are optional
+	void Run(const FJobFunction &InFunction, FJobCounter *InCounter = nullptr, FJobCounter *InPrerequisite = nullptr);
+	// same as Run(), but the job is executed by gl thread
+	void RunOnGLThread(const FJobFunction &InFunction, FJobCounter *InCounter = nullptr, FJobCounter *InPrerequisite = nullptr);
+
+	// execute jobs until the counter is done
+	void Wait(FJobCounter &InCounter);
+
+	// gl thread: execute the queued gl jobs, e.g. once per frame
+	void PumpGLThread();
+
+	// call InFunction(Begin, End) on chunks of [InBegin, InEnd), a chunk has InGrain items at least.
+	// returns when all chunks are done
+	void ParallelFor(size_t InBegin, size_t InEnd, size_t InGrain, const std::function<void(size_t, size_t)> &InFunction);
+
+	FJobSystemStats GetStats() const;
+
+private:
+	FJobSystem();
+	~FJobSystem();
+	FJobSystem(const FJobSystem&) = delete;
+	FJobSystem& operator=(const FJobSystem&) = delete;
+
+	typedef TWorkStealingQueue<FJob*>	FJobQueue;
+
+	struct FWorker
+	{
+		FWorker()
+			: Queue(new FJobQueue())
+		{}
+
+		std::unique_ptr<FJobQueue>	Queue;
+		std::thread					Thread;
+	};
+
+	void WorkerMain(int InWorkerIndex);
+
+	FJob* NewJob(const FJobFunction &InFunction, FJobCounter *InCounter, bool bInGLThread);
+	// queue the job now or as continuation of prerequisite
+	void Submit(FJob *InJob, FJobCounter *InPrerequisite);
+	// queue a job which is ready to run
+	void Enqueue(FJob *InJob);
+	// find a job for the calling thread, null if none
+	FJob* FindJob();
+	void Execute(FJob *InJob);
+	void WakeWorkers(unsigned int InCount);
+
+	std::vector<FWorker>	Workers;
+	std::atomic<bool>		bQuit;
+
+	std::mutex				SharedMutex;
+	std::deque<FJob*>		SharedJobs;		// from non-worker threads, or a full deque
+	std::mutex				GLMutex;
+	std::deque<FJob*>		GLJobs;
+	std::thread::id			GLThreadId;
+
+	// the workers sleep when no job is pending
+	std::atomic<int>		PendingJobs;
+	std::atomic<int>		SleepingWorkers;
+	std::mutex				SleepMutex;
+	std::condition_variable	WakeCondition;
+
+	std::atomic<unsigned int>	JobsExecuted;
+	std::atomic<unsigned int>	JobsStolen;
+	std::atomic<unsigned int>	GLJobsExecuted;
+};
+
+#endif // __JETX_JOB_SYSTEM_H__
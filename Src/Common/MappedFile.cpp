@@ -0,0 +1,114 @@
+// \brief
+//		implementation of memory mapped file
+//
+
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+
+FMappedFile::FMappedFile()
+	: Data(nullptr)
+	, Size(0)
+#ifdef _WIN32
+	, FileHandle(INVALID_HANDLE_VALUE)
+	, MappingHandle(nullptr)
+#endif
+{
+}
+
+FMappedFile::~FMappedFile()
+{
+#ifdef _WIN32
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+	}
+	if (MappingHandle)
+	{
+		CloseHandle(MappingHandle);
+	}
+	if (FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(FileHandle);
+	}
+#else
+	if (Data)
+	{
+		munmap((void*)Data, Size);
+	}
+#endif
+}
+
+FMappedFileRef FMappedFile::Open(const std::string &InFilename)
+{
+	FMappedFileRef File = new FMappedFile();
+	File->Filename = InFilename;
+
+#ifdef _WIN32
+	File->FileHandle = CreateFileA(InFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File->FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File->FileHandle, &FileSize) || FileSize.QuadPart == 0)
+	{
+		return nullptr;
+	}
+
+	File->MappingHandle = CreateFileMappingA(File->FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!File->MappingHandle)
+	{
+		std::cout << "Error: CreateFileMapping Failed: " << InFilename << std::endl;
+		return nullptr;
+	}
+
+	File->Data = (const unsigned char*)MapViewOfFile(File->MappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!File->Data)
+	{
+		std::cout << "Error: MapViewOfFile Failed: " << InFilename << std::endl;
+		return nullptr;
+	}
+	File->Size = (size_t)FileSize.QuadPart;
+#else
+	int Fd = open(InFilename.c_str(), O_RDONLY);
+	if (Fd < 0)
+	{
+		return nullptr;
+	}
+
+	struct stat FileStat;
+	if (fstat(Fd, &FileStat) != 0 || FileStat.st_size == 0)
+	{
+		close(Fd);
+		return nullptr;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void *Address = mmap(nullptr, (size_t)FileStat.st_size, PROT_READ, MAP_PRIVATE, Fd, 0);
+	close(Fd);
+	if (Address == MAP_FAILED)
+	{
+		std::cout << "Error: mmap Failed: " << InFilename << std::endl;
+		return nullptr;
+	}
+	File->Data = (const unsigned char*)Address;
+	File->Size = (size_t)FileStat.st_size;
+#endif
+
+	return File;
+}
@@ -0,0 +1,45 @@
+// \brief
+//		read-only memory mapped file
+//
+
+#ifndef __JETX_MAPPED_FILE_H__
+#define __JETX_MAPPED_FILE_H__
+
+#include <string>
+
+#include "RefCounting.h"
+
+
+class FMappedFile;
+typedef TRefCountPtr<FMappedFile>	FMappedFileRef;
+
+// \brief
+//	the whole file is mapped on open and unmapped on the last release,
+//	the pages are read by the os on first access, so the data may be handed to gl without a copy.
+class FMappedFile : public FRefCountedObject
+{
+public:
+	// null if the file doesn't exist or is empty
+	static FMappedFileRef Open(const std::string &InFilename);
+
+	virtual ~FMappedFile();
+
+	const unsigned char* GetData() const { return Data; }
+	size_t GetSize() const { return Size; }
+	const std::string& GetFilename() const { return Filename; }
+
+private:
+	FMappedFile();
+	FMappedFile(const FMappedFile&) = delete;
+	FMappedFile& operator=(const FMappedFile&) = delete;
+
+	std::string		Filename;
+	const unsigned char	*Data;
+	size_t			Size;
+#ifdef _WIN32
+	void			*FileHandle;
+	void			*MappingHandle;
+#endif
+};
+
+#endif // __JETX_MAPPED_FILE_H__
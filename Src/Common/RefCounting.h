@@ -5,9 +5,11 @@
 #ifndef __JETX_REFCOUNTING_H__
 #define __JETX_REFCOUNTING_H__
 
+#include <atomic>
 #include <cassert>
 
 
+// the count is atomic, the references can be copied on worker threads (e.g. recording command lists)
 class FRefCountedObject
 {
 public:
@@ -16,6 +18,17 @@ public:
 	{
 	}
 
+	// a copy is a new object without references
+	FRefCountedObject(const FRefCountedObject&) :
+		nRefCount(0)
+	{
+	}
+
+	FRefCountedObject& operator=(const FRefCountedObject&)
+	{
+		return *this;
+	}
+
 	virtual ~FRefCountedObject()
 	{
 		assert(nRefCount == 0);
@@ -38,13 +51,28 @@ public:
 		return NewRef;
 	}
 
+	// retain only if still alive, for the weak references which may race with the last Release()
+	bool TryRetain()
+	{
+		int Count = nRefCount.load();
+		while (Count > 0)
+		{
+			if (nRefCount.compare_exchange_weak(Count, Count + 1))
+			{
+				return true;
+			}
+		} // end while
+
+		return false;
+	}
+
 	int RetainCount()
 	{
 		return nRefCount;
 	}
 
 protected:
-	int		nRefCount;
+	std::atomic<int>	nRefCount;
 };
 
 // smart pointer base on ref-counting
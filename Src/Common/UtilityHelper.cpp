@@ -1,6 +1,8 @@
 // \brief
 //		implementation for Helper
 
+#include <sys/stat.h>
+
 #include "UtilityHelper.h"
 
 
@@ -25,3 +27,29 @@ std::string FUtilityHelper::ReadTextFile(const char* InFileName)
 
 	return TextString;
 }
+
+unsigned int FUtilityHelper::StringHash(const char *InString)
+{
+	unsigned int Hash = 2166136261u;
+
+	for (const unsigned char *Ptr = (const unsigned char*)InString; *Ptr; Ptr++)
+	{
+		Hash ^= *Ptr;
+		Hash *= 16777619u;
+	}
+
+	return Hash;
+}
+
+bool FUtilityHelper::GetFileStamp(const char *InFileName, unsigned long long &OutSize, long long &OutTime)
+{
+	struct stat FileStat;
+	if (stat(InFileName, &FileStat) != 0)
+	{
+		return false;
+	}
+
+	OutSize = (unsigned long long)FileStat.st_size;
+	OutTime = (long long)FileStat.st_mtime;
+	return true;
+}
@@ -24,6 +24,12 @@ public:
 	
 	// read a text file
 	static std::string ReadTextFile(const char *InFileName);
+
+	// FNV-1a hash of a null-terminated string
+	static unsigned int StringHash(const char *InString);
+
+	// size and modification time of a file, false if it doesn't exist
+	static bool GetFileStamp(const char *InFileName, unsigned long long &OutSize, long long &OutTime);
 };
 
 
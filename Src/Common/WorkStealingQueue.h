@@ -0,0 +1,117 @@
+// \brief
+//		lock-free work stealing deque (Chase-Lev)
+//
+
+#ifndef __JETX_WORK_STEALING_QUEUE_H__
+#define __JETX_WORK_STEALING_QUEUE_H__
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+
+// \brief
+//	the owner thread pushes and pops at the bottom, LIFO for cache locality,
+//	the other threads steal from the top. fixed capacity, Push() fails when full.
+//	memory orders follow "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+template<typename T>
+class TWorkStealingQueue
+{
+public:
+	explicit TWorkStealingQueue(size_t InCapacity = 4096)
+		: Top(0)
+		, Bottom(0)
+		, Mask((int64_t)InCapacity - 1)
+		, Items(new std::atomic<T>[InCapacity])
+	{
+		assert(InCapacity > 0 && (InCapacity & (InCapacity - 1)) == 0);
+	}
+
+	// owner only
+	bool Push(T InItem)
+	{
+		const int64_t B = Bottom.load(std::memory_order_relaxed);
+		const int64_t T0 = Top.load(std::memory_order_acquire);
+		if (B - T0 > Mask)
+		{
+			return false;
+		}
+
+		Items[B & Mask].store(InItem, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Bottom.store(B + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	// owner only
+	bool Pop(T &OutItem)
+	{
+		const int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+		Bottom.store(B, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t T0 = Top.load(std::memory_order_relaxed);
+
+		if (T0 > B)
+		{
+			// empty
+			Bottom.store(B + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		OutItem = Items[B & Mask].load(std::memory_order_relaxed);
+		if (T0 == B)
+		{
+			// the last item, race against the thieves
+			const bool bWon = Top.compare_exchange_strong(T0, T0 + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			Bottom.store(B + 1, std::memory_order_relaxed);
+			return bWon;
+		}
+
+		return true;
+	}
+
+	// any thread
+	bool Steal(T &OutItem)
+	{
+		int64_t T0 = Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t B = Bottom.load(std::memory_order_acquire);
+
+		if (T0 >= B)
+		{
+			return false;
+		}
+
+		T Item = Items[T0 & Mask].load(std::memory_order_relaxed);
+		if (!Top.compare_exchange_strong(T0, T0 + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return false;
+		}
+		OutItem = Item;
+
+		return true;
+	}
+
+	// approximate, for heuristics only
+	bool IsEmpty() const
+	{
+		return Bottom.load(std::memory_order_relaxed) <= Top.load(std::memory_order_relaxed);
+	}
+
+private:
+	TWorkStealingQueue(const TWorkStealingQueue&) = delete;
+	TWorkStealingQueue& operator=(const TWorkStealingQueue&) = delete;
+
+	// top and bottom on separate cache lines, they are written by different threads
+	std::atomic<int64_t>	Top;
+	char					Padding0[64 - sizeof(std::atomic<int64_t>)];
+	std::atomic<int64_t>	Bottom;
+	char					Padding1[64 - sizeof(std::atomic<int64_t>)];
+
+	const int64_t			Mask;
+	std::unique_ptr<std::atomic<T>[]>	Items;
+};
+
+#endif // __JETX_WORK_STEALING_QUEUE_H__
@@ -3,27 +3,42 @@
 //
 
 #include <cassert>
+#include <iostream>
 #include "OpenGLDrv.h"
 #include "GLBuffer.h"
 
 
-FOpenGLBuffer::FOpenGLBuffer(FOpenGLDrv& InOwner, GLenum InType, GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage)
+FOpenGLBuffer::FOpenGLBuffer(FOpenGLDrv& InOwner, GLenum InType, GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage, GLbitfield InStorageFlags)
 	: Owner(InOwner)
 	, Name(0)
 	, Type(InType)
 	, SizeBytes(InSize)
 	, Usage(InUsage)
+	, StorageFlags(InStorageFlags)
+	, LockFlags(0)
 	, bIsLocked(false)
 {
 	glGenBuffers(1, &Name);
 	Bind();
-	glBufferData(Type, SizeBytes, InData, Usage);
+	if (StorageFlags != 0)
+	{
+#ifdef GL_ARB_buffer_storage
+		glBufferStorage(Type, SizeBytes, InData, StorageFlags);
+#else
+		std::cout << "Error: glBufferStorage is not in this glew" << std::endl;
+		assert(false);
+#endif
+	}
+	else
+	{
+		glBufferData(Type, SizeBytes, InData, Usage);
+	}
 	Owner.CheckError(__FILE__, __LINE__);
 }
 
 FOpenGLBuffer::~FOpenGLBuffer()
 {
-	if (Name != 0)
+	if (Name != 0 && !Owner.DeferDeletion(GLOT_Buffer, Name, Type))
 	{
 		Owner.OnDeleteBuffer(Type, Name);
 		glDeleteBuffers(1, &Name);
@@ -37,28 +52,78 @@ bool FOpenGLBuffer::IsValid() const
 
 void FOpenGLBuffer::Bind()
 {
+	if (Type == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		// do not change the element array buffer of cached vertex arrays
+		Owner.CachedBindSharedVertexArrayObject();
+	}
 	Owner.CachedBindBuffer(Type, Name);
 }
 
 // Lock Buffer
-// bDiscard:  discard the mapping data-content for write-only
-void* FOpenGLBuffer::Lock(GLintptr InOffset, GLsizeiptr InLength, bool bReadOnly, bool bDiscard)
+// InLockFlags: combination of EBufferLockFlags
+void* FOpenGLBuffer::Lock(GLintptr InOffset, GLsizeiptr InLength, GLbitfield InLockFlags)
 {
-	GLbitfield Access;
+	GLbitfield Access = 0;
 	void* Data = nullptr;
 
 	assert(!bIsLocked);
+	assert(InOffset >= 0 && InOffset + InLength <= SizeBytes);
+	assert((InLockFlags & BLF_ReadWrite) != 0);
+	// the discard flags are only for write-only lock
+	assert((InLockFlags & BLF_Read) == 0 || (InLockFlags & (BLF_DiscardRange | BLF_DiscardBuffer)) == 0);
+
+	if (InLockFlags & BLF_Read)
+	{
+		Access |= GL_MAP_READ_BIT;
+	}
+	if (InLockFlags & BLF_Write)
+	{
+		Access |= GL_MAP_WRITE_BIT;
+	}
+	if (InLockFlags & BLF_DiscardBuffer)
+	{
+		Access |= GL_MAP_INVALIDATE_BUFFER_BIT;
+	}
+	else if (InLockFlags & BLF_DiscardRange)
+	{
+		Access |= GL_MAP_INVALIDATE_RANGE_BIT;
+	}
+	if (InLockFlags & BLF_Unsynchronized)
+	{
+		Access |= GL_MAP_UNSYNCHRONIZED_BIT;
+	}
+	if (InLockFlags & BLF_FlushExplicit)
+	{
+		assert(InLockFlags & BLF_Write);
+		Access |= GL_MAP_FLUSH_EXPLICIT_BIT;
+	}
+#ifdef GL_ARB_buffer_storage
+	if (InLockFlags & BLF_Persistent)
+	{
+		assert(StorageFlags & GL_MAP_PERSISTENT_BIT);
+		Access |= GL_MAP_PERSISTENT_BIT | (StorageFlags & GL_MAP_COHERENT_BIT);
+	}
+#else
+	assert((InLockFlags & BLF_Persistent) == 0);
+#endif
 
 	bIsLocked = true;
+	LockFlags = InLockFlags;
 	Bind();
-	Access = bReadOnly ? GL_MAP_READ_BIT :
-		(bDiscard ? GL_MAP_WRITE_BIT : GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
-
 	Data = glMapBufferRange(Type, InOffset, InLength, Access);
 	Owner.CheckError(__FILE__, __LINE__);
 	return Data;
 }
 
+void FOpenGLBuffer::FlushRange(GLintptr InOffset, GLsizeiptr InLength)
+{
+	assert(bIsLocked && (LockFlags & BLF_FlushExplicit));
+	Bind();
+	glFlushMappedBufferRange(Type, InOffset, InLength);
+	Owner.CheckError(__FILE__, __LINE__);
+}
+
 void FOpenGLBuffer::UnLock()
 {
 	assert(bIsLocked);
@@ -68,3 +133,18 @@ void FOpenGLBuffer::UnLock()
 	Owner.CheckError(__FILE__, __LINE__);
 }
 
+
+void FOpenGLBuffer::UpdateData(GLintptr InOffset, GLsizeiptr InSize, const GLvoid *InData)
+{
+	assert(!bIsLocked);
+	assert(InOffset >= 0 && InOffset + InSize <= SizeBytes);
+
+	Bind();
+	if (InOffset == 0 && InSize == SizeBytes && StorageFlags == 0)
+	{
+		// orphan, avoid waiting for the draws still using the old content
+		glBufferData(Type, SizeBytes, nullptr, Usage);
+	}
+	glBufferSubData(Type, InOffset, InSize, InData);
+	Owner.CheckError(__FILE__, __LINE__);
+}
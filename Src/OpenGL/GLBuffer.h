@@ -5,16 +5,33 @@
 #ifndef __JETX_GL_BUFFER_H__
 #define __JETX_GL_BUFFER_H__
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
 #include <GL/glew.h>
 #include <Common/RefCounting.h>
 
 class FOpenGLDrv;
 
+// flags of buffer lock
+enum EBufferLockFlags
+{
+	BLF_Read			= 0x01,
+	BLF_Write			= 0x02,
+	BLF_ReadWrite		= BLF_Read | BLF_Write,
+	BLF_DiscardRange	= 0x04,	// write-only, the old content of locked range is dropped, no wait for the gpu using it
+	BLF_DiscardBuffer	= 0x08,	// write-only, the old content of whole buffer is dropped (orphan)
+	BLF_Unsynchronized	= 0x10,	// no synchronization, the caller guarantees the range is not used by gpu
+	BLF_FlushExplicit	= 0x20,	// the written ranges are flushed by FlushRange() before UnLock()
+	BLF_Persistent		= 0x40,	// the mapping stays valid while drawing, the storage must be created with GL_MAP_PERSISTENT_BIT
+};
+
 // glbuffer class
 class FOpenGLBuffer : public FRefCountedObject
 {
 public:
-	FOpenGLBuffer(FOpenGLDrv& InOwner, GLenum InType, GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage);
+	// InStorageFlags: non-zero creates immutable storage by glBufferStorage (ARB_buffer_storage), InUsage is ignored
+	FOpenGLBuffer(FOpenGLDrv& InOwner, GLenum InType, GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage, GLbitfield InStorageFlags = 0);
 
 	virtual ~FOpenGLBuffer();
 
@@ -23,12 +40,21 @@ public:
 	void Bind();
 
 	// Lock Buffer
-	// bDiscard:  discard the mapping data-content for write-only
-	void* Lock(GLintptr InOffset, GLsizeiptr InLength, bool bReadOnly, bool bDiscard);
+	// InLockFlags: combination of EBufferLockFlags
+	void* Lock(GLintptr InOffset, GLsizeiptr InLength, GLbitfield InLockFlags);
+
+	// flush the written range of BLF_FlushExplicit lock, the offset is relative to the locked range
+	void FlushRange(GLintptr InOffset, GLsizeiptr InLength);
 
 	void UnLock();
 
+	// update the content, the whole buffer update orphans the old storage
+	void UpdateData(GLintptr InOffset, GLsizeiptr InSize, const GLvoid *InData);
+
 	GLuint GetGLResource() const { return Name; }
+	GLenum GetType() const { return Type; }
+	GLsizeiptr GetSize() const { return SizeBytes; }
+	bool IsImmutable() const { return StorageFlags != 0; }
 
 protected:
 	FOpenGLDrv		&Owner;
@@ -36,6 +62,8 @@ protected:
 	GLenum			Type;
 	GLsizeiptr		SizeBytes;
 	GLenum			Usage;
+	GLbitfield		StorageFlags;
+	GLbitfield		LockFlags;
 	bool			bIsLocked;
 };
 
@@ -44,8 +72,8 @@ protected:
 class FOpenGLVertexBuffer : public FOpenGLBuffer
 {
 public:
-	FOpenGLVertexBuffer(FOpenGLDrv &InOwner, GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage = GL_STATIC_DRAW)
-		: FOpenGLBuffer(InOwner, GL_ARRAY_BUFFER, InSize, InData, InUsage)
+	FOpenGLVertexBuffer(FOpenGLDrv &InOwner, GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage = GL_STATIC_DRAW, GLbitfield InStorageFlags = 0)
+		: FOpenGLBuffer(InOwner, GL_ARRAY_BUFFER, InSize, InData, InUsage, InStorageFlags)
 	{
 	}
 };
@@ -54,8 +82,8 @@ public:
 class FOpenGLIndexBuffer : public FOpenGLBuffer
 {
 public:
-	FOpenGLIndexBuffer(FOpenGLDrv &InOwner, GLsizeiptr InSize, const GLvoid *InData, GLuint InStride, GLenum InUsage = GL_STATIC_DRAW)
-		: FOpenGLBuffer(InOwner, GL_ELEMENT_ARRAY_BUFFER, InSize, InData, InUsage)
+	FOpenGLIndexBuffer(FOpenGLDrv &InOwner, GLsizeiptr InSize, const GLvoid *InData, GLuint InStride, GLenum InUsage = GL_STATIC_DRAW, GLbitfield InStorageFlags = 0)
+		: FOpenGLBuffer(InOwner, GL_ELEMENT_ARRAY_BUFFER, InSize, InData, InUsage, InStorageFlags)
 		, Stride(InStride)
 	{
 	}
@@ -67,7 +95,59 @@ protected:
 	GLuint	Stride;
 };
 
+// Uniform Buffer, the content is std140 layout
+class FOpenGLUniformBuffer : public FOpenGLBuffer
+{
+public:
+	FOpenGLUniformBuffer(FOpenGLDrv &InOwner, GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage = GL_DYNAMIC_DRAW, GLbitfield InStorageFlags = 0)
+		: FOpenGLBuffer(InOwner, GL_UNIFORM_BUFFER, InSize, InData, InUsage, InStorageFlags)
+	{
+	}
+};
+
+// command of indexed indirect draw, the layout is defined by glDrawElementsIndirect
+struct FDrawElementsIndirectCommand
+{
+	GLuint		Count;
+	GLuint		InstanceCount;
+	GLuint		FirstIndex;
+	GLint		BaseVertex;
+	GLuint		BaseInstance;	// must be 0 without ARB_base_instance
+};
+
+// Indirect Buffer, an array of FDrawElementsIndirectCommand.
+// a copy of the commands is kept for the emulated draws, the gl buffer is only storage if ARB_draw_indirect is missing
+class FOpenGLIndirectBuffer : public FOpenGLBuffer
+{
+public:
+	FOpenGLIndirectBuffer(FOpenGLDrv &InOwner, GLsizei InCommandCount, const FDrawElementsIndirectCommand *InCommands, GLenum InUsage = GL_DYNAMIC_DRAW)
+		: FOpenGLBuffer(InOwner, GLEW_ARB_draw_indirect ? GL_DRAW_INDIRECT_BUFFER : GL_COPY_WRITE_BUFFER, InCommandCount * sizeof(FDrawElementsIndirectCommand), InCommands, InUsage)
+		, Commands(InCommandCount)
+	{
+		if (InCommands)
+		{
+			Commands.assign(InCommands, InCommands + InCommandCount);
+		}
+	}
+
+	// overwrite the first InCommandCount commands
+	void UpdateCommands(GLsizei InCommandCount, const FDrawElementsIndirectCommand *InCommands)
+	{
+		assert(InCommandCount <= GetCommandCount());
+		std::copy(InCommands, InCommands + InCommandCount, Commands.begin());
+		UpdateData(0, InCommandCount * sizeof(FDrawElementsIndirectCommand), InCommands);
+	}
+
+	GLsizei GetCommandCount() const { return (GLsizei)Commands.size(); }
+	const FDrawElementsIndirectCommand* GetCommands() const { return Commands.data(); }
+
+protected:
+	std::vector<FDrawElementsIndirectCommand>	Commands;
+};
+
 typedef TRefCountPtr<FOpenGLVertexBuffer>	FOpenGLVertexBufferRef;
 typedef TRefCountPtr<FOpenGLIndexBuffer>	FOpenGLIndexBufferRef;
+typedef TRefCountPtr<FOpenGLUniformBuffer>	FOpenGLUniformBufferRef;
+typedef TRefCountPtr<FOpenGLIndirectBuffer>	FOpenGLIndirectBufferRef;
 
 #endif // __JETX_GL_BUFFER_H__
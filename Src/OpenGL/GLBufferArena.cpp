@@ -0,0 +1,244 @@
+// \brief
+//		implementation of buffer arena
+//
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include "OpenGLDrv.h"
+#include "GLBufferArena.h"
+
+
+FOpenGLBufferAllocation::~FOpenGLBufferAllocation()
+{
+	Arena->Free(this);
+}
+
+FOpenGLBuffer* FOpenGLBufferAllocation::GetBuffer() const
+{
+	return Arena->Pages[Page].Buffer;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FOpenGLBufferArena::FOpenGLBufferArena(FOpenGLDrv &InOwner, GLenum InType, GLuint InStride, GLuint InPageElements)
+	: Owner(InOwner)
+	, Type(InType)
+	, Stride(InStride)
+	, PageElements(InPageElements)
+	, bFragmented(false)
+{
+	assert(Type == GL_ARRAY_BUFFER || Type == GL_ELEMENT_ARRAY_BUFFER);
+	assert(Stride > 0 && PageElements > 0);
+}
+
+FOpenGLBufferArena::~FOpenGLBufferArena()
+{
+	// the allocations keep the arena alive
+	for (size_t Index = 0; Index < Pages.size(); Index++)
+	{
+		assert(Pages[Index].Allocations.empty());
+	} // end for
+}
+
+FOpenGLBufferAllocationRef FOpenGLBufferArena::Allocate(GLuint InCount, const GLvoid *InData)
+{
+	assert(InCount > 0);
+
+	// first fit
+	GLuint PageIndex = (GLuint)Pages.size();
+	size_t RangeIndex = 0;
+	for (GLuint Index = 0; Index < Pages.size() && PageIndex == Pages.size(); Index++)
+	{
+		const std::vector<FFreeRange> &FreeRanges = Pages[Index].FreeRanges;
+		for (size_t k = 0; k < FreeRanges.size(); k++)
+		{
+			if (FreeRanges[k].Count >= InCount)
+			{
+				PageIndex = Index;
+				RangeIndex = k;
+				break;
+			}
+		} // end for k
+	} // end for
+
+	if (PageIndex == Pages.size())
+	{
+		PageIndex = NewPage(InCount);
+		RangeIndex = 0;
+	}
+
+	FPage &Page = Pages[PageIndex];
+	FFreeRange &Range = Page.FreeRanges[RangeIndex];
+	const GLuint kOffset = Range.Offset;
+	Range.Offset += InCount;
+	Range.Count -= InCount;
+	if (Range.Count == 0)
+	{
+		Page.FreeRanges.erase(Page.FreeRanges.begin() + RangeIndex);
+	}
+
+	FOpenGLBufferAllocation *Allocation = new FOpenGLBufferAllocation(this, PageIndex, kOffset, InCount);
+	Page.Allocations.push_back(Allocation);
+	if (InData)
+	{
+		Page.Buffer->UpdateData(kOffset * Stride, InCount * Stride, InData);
+	}
+
+	Stats.Allocations++;
+	Stats.UsedElements += InCount;
+	return Allocation;
+}
+
+void FOpenGLBufferArena::Free(FOpenGLBufferAllocation *InAllocation)
+{
+	assert(InAllocation->Page < Pages.size());
+	FPage &Page = Pages[InAllocation->Page];
+
+	std::vector<FOpenGLBufferAllocation*>::iterator It = std::find(Page.Allocations.begin(), Page.Allocations.end(), InAllocation);
+	assert(It != Page.Allocations.end());
+	Page.Allocations.erase(It);
+
+	// insert sorted, merge with the neighbours
+	FFreeRange Range = { InAllocation->Offset, InAllocation->Count };
+	size_t Index = 0;
+	while (Index < Page.FreeRanges.size() && Page.FreeRanges[Index].Offset < Range.Offset)
+	{
+		Index++;
+	} // end while
+
+	if (Index < Page.FreeRanges.size() && Range.Offset + Range.Count == Page.FreeRanges[Index].Offset)
+	{
+		Range.Count += Page.FreeRanges[Index].Count;
+		Page.FreeRanges.erase(Page.FreeRanges.begin() + Index);
+	}
+	if (Index > 0 && Page.FreeRanges[Index - 1].Offset + Page.FreeRanges[Index - 1].Count == Range.Offset)
+	{
+		Page.FreeRanges[Index - 1].Count += Range.Count;
+	}
+	else
+	{
+		Page.FreeRanges.insert(Page.FreeRanges.begin() + Index, Range);
+	}
+
+	Stats.Allocations--;
+	Stats.UsedElements -= InAllocation->Count;
+	bFragmented = true;
+}
+
+GLuint FOpenGLBufferArena::NewPage(GLuint InMinElements)
+{
+	FPage Page;
+	Page.Capacity = InMinElements > PageElements ? InMinElements : PageElements;
+
+	// immutable storage, the content is uploaded by glBufferSubData
+	GLbitfield StorageFlags = 0;
+#ifdef GL_ARB_buffer_storage
+	if (Owner.SupportsBufferStorage())
+	{
+		StorageFlags = GL_DYNAMIC_STORAGE_BIT;
+	}
+#endif
+	const GLsizeiptr kBytes = (GLsizeiptr)Page.Capacity * Stride;
+	if (Type == GL_ARRAY_BUFFER)
+	{
+		Page.Buffer = new FOpenGLVertexBuffer(Owner, kBytes, nullptr, GL_STATIC_DRAW, StorageFlags);
+	}
+	else
+	{
+		Page.Buffer = new FOpenGLIndexBuffer(Owner, kBytes, nullptr, Stride, GL_STATIC_DRAW, StorageFlags);
+	}
+
+	FFreeRange Range = { 0, Page.Capacity };
+	Page.FreeRanges.push_back(Range);
+	Pages.push_back(Page);
+	Stats.Pages++;
+
+	return (GLuint)Pages.size() - 1;
+}
+
+static bool CompareAllocationOffset(const FOpenGLBufferAllocation *A, const FOpenGLBufferAllocation *B)
+{
+	return A->GetOffset() < B->GetOffset();
+}
+
+void FOpenGLBufferArena::Defragment(GLuint InMaxPages)
+{
+	GLuint CompactedPages = 0;
+	GLuint PageIndex = 0;
+	while (PageIndex < Pages.size())
+	{
+		FPage &Page = Pages[PageIndex];
+		if (Page.Allocations.empty())
+		{
+			Pages.erase(Pages.begin() + PageIndex);
+			Stats.Pages--;
+			// the allocations of the later pages
+			for (GLuint Index = PageIndex; Index < Pages.size(); Index++)
+			{
+				for (size_t k = 0; k < Pages[Index].Allocations.size(); k++)
+				{
+					Pages[Index].Allocations[k]->Page = Index;
+				} // end for k
+			} // end for
+			continue;
+		}
+
+		// no hole if the only free range is the tail
+		const bool bHasHole = Page.FreeRanges.size() > 1
+			|| (Page.FreeRanges.size() == 1 && Page.FreeRanges[0].Offset + Page.FreeRanges[0].Count != Page.Capacity);
+		if (bHasHole)
+		{
+			if (CompactedPages == InMaxPages)
+			{
+				// the rest in the next call
+				return;
+			}
+			CompactedPages++;
+
+			std::sort(Page.Allocations.begin(), Page.Allocations.end(), CompareAllocationOffset);
+
+			GLuint Cursor = 0;
+			for (size_t k = 0; k < Page.Allocations.size(); k++)
+			{
+				FOpenGLBufferAllocation *Allocation = Page.Allocations[k];
+				if (Allocation->Offset != Cursor)
+				{
+					MoveElements(Page, Allocation->Offset, Cursor, Allocation->Count);
+					Allocation->Offset = Cursor;
+					Stats.Moves++;
+				}
+				Cursor += Allocation->Count;
+			} // end for k
+
+			Page.FreeRanges.clear();
+			if (Cursor < Page.Capacity)
+			{
+				FFreeRange Range = { Cursor, Page.Capacity - Cursor };
+				Page.FreeRanges.push_back(Range);
+			}
+		}
+		PageIndex++;
+	} // end while
+
+	bFragmented = false;
+}
+
+void FOpenGLBufferArena::MoveElements(FPage &InPage, GLuint InSrcOffset, GLuint InDstOffset, GLuint InCount)
+{
+	assert(InDstOffset < InSrcOffset);
+
+	const GLuint kName = InPage.Buffer->GetGLResource();
+	Owner.CachedBindBuffer(GL_COPY_READ_BUFFER, kName);
+	Owner.CachedBindBuffer(GL_COPY_WRITE_BUFFER, kName);
+
+	// the ranges of a copy in one buffer must not overlap, copy by chunks no larger than the distance
+	const GLuint kChunk = InSrcOffset - InDstOffset;
+	for (GLuint Copied = 0; Copied < InCount; Copied += kChunk)
+	{
+		GLuint Count = InCount - Copied < kChunk ? InCount - Copied : kChunk;
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			(GLintptr)(InSrcOffset + Copied) * Stride, (GLintptr)(InDstOffset + Copied) * Stride, (GLsizeiptr)Count * Stride);
+	} // end for
+	Owner.CheckError(__FILE__, __LINE__);
+}
@@ -0,0 +1,127 @@
+// \brief
+//		sub-allocator of large gl buffers, the static meshes share a few buffers
+//
+
+#ifndef __JETX_GL_BUFFER_ARENA_H__
+#define __JETX_GL_BUFFER_ARENA_H__
+
+#include <vector>
+#include <GL/glew.h>
+#include <Common/RefCounting.h>
+#include "GLBuffer.h"
+
+class FOpenGLDrv;
+class FOpenGLBufferArena;
+typedef TRefCountPtr<FOpenGLBufferArena>	FOpenGLBufferArenaRef;
+
+// bytes of a page buffer, a larger allocation has its own page
+#define GL_BUFFER_ARENA_PAGE_BYTES		(16 << 20)
+// pages compacted by FOpenGLDrv::EndFrame() in a frame
+#define GL_BUFFER_ARENA_DEFRAGMENT_PAGES	1
+
+
+// \brief
+//	elements allocated in a page of arena, they are freed when the allocation is released.
+//	the offset may be changed by FOpenGLBufferArena::Defragment(), read it at draw time.
+class FOpenGLBufferAllocation : public FRefCountedObject
+{
+public:
+	virtual ~FOpenGLBufferAllocation();
+
+	// the page buffer
+	FOpenGLBuffer* GetBuffer() const;
+	// first element in the page buffer, the base vertex or first index of draw
+	GLuint GetOffset() const { return Offset; }
+	GLuint GetCount() const { return Count; }
+
+protected:
+	friend class FOpenGLBufferArena;
+
+	FOpenGLBufferAllocation(FOpenGLBufferArena *InArena, GLuint InPage, GLuint InOffset, GLuint InCount)
+		: Arena(InArena)
+		, Page(InPage)
+		, Offset(InOffset)
+		, Count(InCount)
+	{}
+
+	FOpenGLBufferArenaRef	Arena;
+	GLuint		Page;
+	GLuint		Offset;		// in elements
+	GLuint		Count;
+};
+
+typedef TRefCountPtr<FOpenGLBufferAllocation>	FOpenGLBufferAllocationRef;
+
+// statistics of arena
+struct FOpenGLBufferArenaStats
+{
+	FOpenGLBufferArenaStats()
+		: Pages(0)
+		, Allocations(0)
+		, UsedElements(0)
+		, Moves(0)
+	{}
+
+	unsigned int	Pages;
+	unsigned int	Allocations;	// alive
+	unsigned int	UsedElements;
+	unsigned int	Moves;			// allocations moved by defragment
+};
+
+// \brief
+//	the elements of a fixed stride are sub-allocated from page buffers by first-fit on a sorted free list,
+//	the neighbour free ranges are merged on free. the pages are immutable storage if ARB_buffer_storage.
+//	Defragment() moves the allocations of a page to its front by glCopyBufferSubData, and deletes the empty pages.
+class FOpenGLBufferArena : public FRefCountedObject
+{
+public:
+	// InType: GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER, InStride: bytes of an element
+	FOpenGLBufferArena(FOpenGLDrv &InOwner, GLenum InType, GLuint InStride, GLuint InPageElements);
+	virtual ~FOpenGLBufferArena();
+
+	// allocate and upload InCount elements, InCount > 0
+	FOpenGLBufferAllocationRef Allocate(GLuint InCount, const GLvoid *InData);
+
+	// compact InMaxPages pages with holes at most, delete the empty pages
+	void Defragment(GLuint InMaxPages = 0xFFFFFFFF);
+	// a free made a hole that is not compacted yet
+	bool IsFragmented() const { return bFragmented; }
+
+	GLenum GetType() const { return Type; }
+	GLuint GetStride() const { return Stride; }
+	const FOpenGLBufferArenaStats& GetStats() const { return Stats; }
+
+protected:
+	friend class FOpenGLBufferAllocation;
+
+	struct FFreeRange
+	{
+		GLuint	Offset;
+		GLuint	Count;
+	};
+
+	struct FPage
+	{
+		TRefCountPtr<FOpenGLBuffer>				Buffer;
+		GLuint									Capacity;	// in elements
+		std::vector<FFreeRange>					FreeRanges;	// sorted by offset
+		std::vector<FOpenGLBufferAllocation*>	Allocations;
+	};
+
+	void Free(FOpenGLBufferAllocation *InAllocation);
+	GLuint NewPage(GLuint InMinElements);
+	// move elements to lower offset in the page
+	void MoveElements(FPage &InPage, GLuint InSrcOffset, GLuint InDstOffset, GLuint InCount);
+
+	FOpenGLDrv			&Owner;
+	GLenum				Type;
+	GLuint				Stride;
+	GLuint				PageElements;
+
+	std::vector<FPage>	Pages;
+	bool				bFragmented;
+
+	FOpenGLBufferArenaStats	Stats;
+};
+
+#endif // __JETX_GL_BUFFER_ARENA_H__
@@ -0,0 +1,364 @@
+// \brief
+//		implementation of command list
+//
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include "GLCommandList.h"
+#include "OpenGLDrv.h"
+
+
+// the command is a header and the payload, aligned to 8 bytes
+struct FOpenGLCommandHeader
+{
+	GLuint		Command;
+	GLuint		Size;		// bytes of header and payload
+};
+
+struct FSetPipelineStateCommand
+{
+	FOpenGLPipelineState		*PipelineState;
+};
+
+struct FSetShaderProgramCommand
+{
+	FOpenGLProgram				*Program;
+};
+
+// followed by the value, then the null-terminated name
+struct FSetShaderParameterCommand
+{
+	GLenum		Type;
+	GLsizei		Count;
+	GLuint		ValueSize;
+};
+
+struct FSetVertexDeclarationCommand
+{
+	FOpenGLVertexDeclaration	*VertexDeclaration;
+};
+
+struct FSetStreamSourceCommand
+{
+	GLuint						StreamIndex;
+	FOpenGLVertexBuffer			*VertexBuffer;
+};
+
+struct FSetTexture2DCommand
+{
+	GLuint						TexIndex;
+	FOpenGLTexture2D			*Texture;
+	FOpenGLSamplerState			*SamplerState;
+};
+
+struct FSetUniformBufferCommand
+{
+	GLuint						BindingPoint;
+	FOpenGLUniformBuffer		*UniformBuffer;
+	GLintptr					Offset;
+	GLsizeiptr					Size;
+};
+
+struct FDrawIndexedPrimitiveCommand
+{
+	FOpenGLIndexBuffer			*IndexBuffer;
+	GLenum						Mode;
+	GLuint						Start;
+	GLsizei						Count;
+	GLsizei						InstanceCount;	// 0 if not instanced
+	GLint						BaseVertex;
+};
+
+struct FDrawArrayedPrimitiveCommand
+{
+	GLenum						Mode;
+	GLint						Start;
+	GLsizei						Count;
+	GLsizei						InstanceCount;	// 0 if not instanced
+};
+
+struct FMultiDrawIndexedIndirectCommand
+{
+	FOpenGLIndexBuffer			*IndexBuffer;
+	GLenum						Mode;
+	FOpenGLIndirectBuffer		*IndirectBuffer;
+	GLsizei						FirstCommand;
+	GLsizei						CommandCount;
+};
+
+// parameter of the recorded value, allocated from frame allocator on the gl thread
+static FShaderParameter* CreateShaderParameter(const FSetShaderParameterCommand &InCommand)
+{
+	GLvoid *Value = (GLvoid*)(&InCommand + 1);
+	const GLchar *Name = (const GLchar*)Value + InCommand.ValueSize;
+
+	switch (InCommand.Type)
+	{
+	case GL_INT:
+		return new FShaderParameter_Integer1v(Name, (GLint*)Value, InCommand.Count);
+	case GL_INT_VEC2:
+		return new FShaderParameter_Integer2v(Name, (GLint*)Value, InCommand.Count);
+	case GL_INT_VEC3:
+		return new FShaderParameter_Integer3v(Name, (GLint*)Value, InCommand.Count);
+	case GL_INT_VEC4:
+		return new FShaderParameter_Integer4v(Name, (GLint*)Value, InCommand.Count);
+	case GL_UNSIGNED_INT:
+		return new FShaderParameter_UnInteger1v(Name, (GLuint*)Value, InCommand.Count);
+	case GL_UNSIGNED_INT_VEC2:
+		return new FShaderParameter_UnInteger2v(Name, (GLuint*)Value, InCommand.Count);
+	case GL_UNSIGNED_INT_VEC3:
+		return new FShaderParameter_UnInteger3v(Name, (GLuint*)Value, InCommand.Count);
+	case GL_UNSIGNED_INT_VEC4:
+		return new FShaderParameter_UnInteger4v(Name, (GLuint*)Value, InCommand.Count);
+	case GL_FLOAT:
+		return new FShaderParameter_Float1v(Name, (GLfloat*)Value, InCommand.Count);
+	case GL_FLOAT_VEC2:
+		return new FShaderParameter_Float2v(Name, (GLfloat*)Value, InCommand.Count);
+	case GL_FLOAT_VEC3:
+		return new FShaderParameter_Float3v(Name, (GLfloat*)Value, InCommand.Count);
+	case GL_FLOAT_VEC4:
+		return new FShaderParameter_Float4v(Name, (GLfloat*)Value, InCommand.Count);
+	case GL_FLOAT_MAT4:
+		return new FShaderParameter_Matrix4fv(Name, (GLfloat*)Value, InCommand.Count);
+	default:
+		std::cout << "Error: unsupported shader parameter type " << InCommand.Type << " of " << Name << std::endl;
+		assert(false);
+		break;
+	}
+
+	return nullptr;
+}
+
+FOpenGLCommandList::FOpenGLCommandList()
+	: CommandCount(0)
+	, DrawCount(0)
+{
+}
+
+FOpenGLCommandList::~FOpenGLCommandList()
+{
+}
+
+void FOpenGLCommandList::Reset()
+{
+	Data.clear();
+	CommandCount = 0;
+	DrawCount = 0;
+}
+
+void* FOpenGLCommandList::AllocCommand(EOpenGLCommand InCommand, size_t InPayloadSize)
+{
+	const size_t Size = (sizeof(FOpenGLCommandHeader) + InPayloadSize + 7) & ~(size_t)7;
+	const size_t Offset = Data.size();
+	Data.resize(Offset + Size);
+
+	FOpenGLCommandHeader *Header = (FOpenGLCommandHeader*)&Data[Offset];
+	Header->Command = InCommand;
+	Header->Size = (GLuint)Size;
+	CommandCount++;
+
+	return Header + 1;
+}
+
+void FOpenGLCommandList::SetPipelineState(const FOpenGLPipelineStateRef &InPipelineState)
+{
+	AllocCommand<FSetPipelineStateCommand>(GLCMD_SetPipelineState)->PipelineState = InPipelineState.DeRef();
+}
+
+void FOpenGLCommandList::SetShaderProgram(const FOpenGLProgramRef &InProgram)
+{
+	AllocCommand<FSetShaderProgramCommand>(GLCMD_SetShaderProgram)->Program = InProgram.DeRef();
+}
+
+void FOpenGLCommandList::SetVertexDeclaration(const FOpenGLVertexDeclarationRef &InVertexDecl)
+{
+	AllocCommand<FSetVertexDeclarationCommand>(GLCMD_SetVertexDeclaration)->VertexDeclaration = InVertexDecl.DeRef();
+}
+
+void FOpenGLCommandList::SetStreamSource(GLuint StreamIndex, const FOpenGLVertexBufferRef &InVertexBuffer)
+{
+	FSetStreamSourceCommand *Command = AllocCommand<FSetStreamSourceCommand>(GLCMD_SetStreamSource);
+	Command->StreamIndex = StreamIndex;
+	Command->VertexBuffer = InVertexBuffer.DeRef();
+}
+
+void FOpenGLCommandList::SetTexture2D(GLuint TexIndex, const FOpenGLTexture2DRef &InTexture, const FOpenGLSamplerStateRef &InSamplerState)
+{
+	FSetTexture2DCommand *Command = AllocCommand<FSetTexture2DCommand>(GLCMD_SetTexture2D);
+	Command->TexIndex = TexIndex;
+	Command->Texture = InTexture.DeRef();
+	Command->SamplerState = InSamplerState.DeRef();
+}
+
+void FOpenGLCommandList::SetUniformBuffer(GLuint InBindingPoint, const FOpenGLUniformBufferRef &InUniformBuffer, GLintptr InOffset, GLsizeiptr InSize)
+{
+	FSetUniformBufferCommand *Command = AllocCommand<FSetUniformBufferCommand>(GLCMD_SetUniformBuffer);
+	Command->BindingPoint = InBindingPoint;
+	Command->UniformBuffer = InUniformBuffer.DeRef();
+	Command->Offset = InOffset;
+	Command->Size = InSize;
+}
+
+void FOpenGLCommandList::SetShaderParameter(const GLchar *InName, GLenum InType, const GLvoid *InValue, GLsizei InCount)
+{
+	const GLuint ValueSize = FOpenGLDrv::LookupShaderUniformTypeSize(InType) * InCount;
+	const size_t NameSize = strlen(InName) + 1;
+	assert(ValueSize > 0);
+
+	FSetShaderParameterCommand *Command = (FSetShaderParameterCommand*)AllocCommand(GLCMD_SetShaderParameter, sizeof(FSetShaderParameterCommand) + ValueSize + NameSize);
+	Command->Type = InType;
+	Command->Count = InCount;
+	Command->ValueSize = ValueSize;
+	GLubyte *Value = (GLubyte*)(Command + 1);
+	memcpy(Value, InValue, ValueSize);
+	memcpy(Value + ValueSize, InName, NameSize);
+}
+
+void FOpenGLCommandList::DrawIndexedPrimitive(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLint InBaseVertex)
+{
+	DrawIndexedPrimitiveInstanced(InIndexBuffer, InMode, InStart, InCount, 0, InBaseVertex);
+}
+
+void FOpenGLCommandList::DrawIndexedPrimitiveInstanced(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLsizei InInstanceCount, GLint InBaseVertex)
+{
+	FDrawIndexedPrimitiveCommand *Command = AllocCommand<FDrawIndexedPrimitiveCommand>(GLCMD_DrawIndexedPrimitive);
+	Command->IndexBuffer = InIndexBuffer.DeRef();
+	Command->Mode = InMode;
+	Command->Start = InStart;
+	Command->Count = InCount;
+	Command->InstanceCount = InInstanceCount;
+	Command->BaseVertex = InBaseVertex;
+	DrawCount++;
+}
+
+void FOpenGLCommandList::DrawArrayedPrimitive(GLenum InMode, GLint InStart, GLsizei InCount)
+{
+	DrawArrayedPrimitiveInstanced(InMode, InStart, InCount, 0);
+}
+
+void FOpenGLCommandList::DrawArrayedPrimitiveInstanced(GLenum InMode, GLint InStart, GLsizei InCount, GLsizei InInstanceCount)
+{
+	FDrawArrayedPrimitiveCommand *Command = AllocCommand<FDrawArrayedPrimitiveCommand>(GLCMD_DrawArrayedPrimitive);
+	Command->Mode = InMode;
+	Command->Start = InStart;
+	Command->Count = InCount;
+	Command->InstanceCount = InInstanceCount;
+	DrawCount++;
+}
+
+void FOpenGLCommandList::MultiDrawIndexedIndirect(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, const FOpenGLIndirectBufferRef &InIndirectBuffer, GLsizei InFirstCommand, GLsizei InCommandCount)
+{
+	FMultiDrawIndexedIndirectCommand *Command = AllocCommand<FMultiDrawIndexedIndirectCommand>(GLCMD_MultiDrawIndexedIndirect);
+	Command->IndexBuffer = InIndexBuffer.DeRef();
+	Command->Mode = InMode;
+	Command->IndirectBuffer = InIndirectBuffer.DeRef();
+	Command->FirstCommand = InFirstCommand;
+	Command->CommandCount = InCommandCount;
+	DrawCount++;
+}
+
+void FOpenGLCommandList::Execute(FOpenGLDrv &InDriver) const
+{
+	// parameters of next draw, they point to the recorded values
+	FProgramParameters Parameters;
+	bool bParametersDrawn = false;
+
+	const GLubyte *Cursor = Data.data();
+	const GLubyte *End = Cursor + Data.size();
+	while (Cursor < End)
+	{
+		const FOpenGLCommandHeader *Header = (const FOpenGLCommandHeader*)Cursor;
+		const GLvoid *Payload = Header + 1;
+
+		switch (Header->Command)
+		{
+		case GLCMD_SetPipelineState:
+			InDriver.SetPipelineState(((const FSetPipelineStateCommand*)Payload)->PipelineState);
+			break;
+		case GLCMD_SetShaderProgram:
+			InDriver.SetShaderProgram(((const FSetShaderProgramCommand*)Payload)->Program);
+			break;
+		case GLCMD_SetShaderParameter:
+		{
+			if (bParametersDrawn)
+			{
+				Parameters.clear();
+				bParametersDrawn = false;
+			}
+			FShaderParameter *Parameter = CreateShaderParameter(*(const FSetShaderParameterCommand*)Payload);
+			if (Parameter)
+			{
+				Parameters.push_back(Parameter);
+			}
+			InDriver.SetShaderProgramParameters(&Parameters);
+		}
+		break;
+		case GLCMD_SetVertexDeclaration:
+			InDriver.SetVertexDeclaration(((const FSetVertexDeclarationCommand*)Payload)->VertexDeclaration);
+			break;
+		case GLCMD_SetStreamSource:
+		{
+			const FSetStreamSourceCommand *Command = (const FSetStreamSourceCommand*)Payload;
+			InDriver.SetStreamSource(Command->StreamIndex, Command->VertexBuffer);
+		}
+		break;
+		case GLCMD_SetTexture2D:
+		{
+			const FSetTexture2DCommand *Command = (const FSetTexture2DCommand*)Payload;
+			InDriver.SetTexture2D(Command->TexIndex, Command->Texture, Command->SamplerState);
+		}
+		break;
+		case GLCMD_SetUniformBuffer:
+		{
+			const FSetUniformBufferCommand *Command = (const FSetUniformBufferCommand*)Payload;
+			InDriver.SetUniformBuffer(Command->BindingPoint, Command->UniformBuffer, Command->Offset, Command->Size);
+		}
+		break;
+		case GLCMD_DrawIndexedPrimitive:
+		{
+			const FDrawIndexedPrimitiveCommand *Command = (const FDrawIndexedPrimitiveCommand*)Payload;
+			if (Command->InstanceCount > 0)
+			{
+				InDriver.DrawIndexedPrimitiveInstanced(Command->IndexBuffer, Command->Mode, Command->Start, Command->Count, Command->InstanceCount, Command->BaseVertex);
+			}
+			else
+			{
+				InDriver.DrawIndexedPrimitive(Command->IndexBuffer, Command->Mode, Command->Start, Command->Count, Command->BaseVertex);
+			}
+			bParametersDrawn = true;
+		}
+		break;
+		case GLCMD_DrawArrayedPrimitive:
+		{
+			const FDrawArrayedPrimitiveCommand *Command = (const FDrawArrayedPrimitiveCommand*)Payload;
+			if (Command->InstanceCount > 0)
+			{
+				InDriver.DrawArrayedPrimitiveInstanced(Command->Mode, Command->Start, Command->Count, Command->InstanceCount);
+			}
+			else
+			{
+				InDriver.DrawArrayedPrimitive(Command->Mode, Command->Start, Command->Count);
+			}
+			bParametersDrawn = true;
+		}
+		break;
+		case GLCMD_MultiDrawIndexedIndirect:
+		{
+			const FMultiDrawIndexedIndirectCommand *Command = (const FMultiDrawIndexedIndirectCommand*)Payload;
+			InDriver.MultiDrawIndexedIndirect(Command->IndexBuffer, Command->Mode, Command->IndirectBuffer, Command->FirstCommand, Command->CommandCount);
+			bParametersDrawn = true;
+		}
+		break;
+		default:
+			std::cout << "Error: unknown command " << Header->Command << " in command list" << std::endl;
+			assert(false);
+			return;
+		}
+
+		Cursor += Header->Size;
+	} // end while
+
+	// the parameters point to this list
+	InDriver.SetShaderProgramParameters(nullptr);
+}
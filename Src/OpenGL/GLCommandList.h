@@ -0,0 +1,104 @@
+// \brief
+//		command list, records the draws on any thread and replays them on the gl thread
+//
+
+#ifndef __JETX_GL_COMMAND_LIST_H__
+#define __JETX_GL_COMMAND_LIST_H__
+
+#include <vector>
+#include <GL/glew.h>
+
+// GLM Mathemtics
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <Common/RefCounting.h>
+#include "GLBuffer.h"
+#include "GLShader.h"
+#include "GLTexture.h"
+#include "GLSamplerState.h"
+#include "GLPipelineState.h"
+#include "GLVertexDeclaration.h"
+
+class FOpenGLDrv;
+
+
+// recorded commands
+enum EOpenGLCommand
+{
+	GLCMD_SetPipelineState,
+	GLCMD_SetShaderProgram,
+	GLCMD_SetShaderParameter,
+	GLCMD_SetVertexDeclaration,
+	GLCMD_SetStreamSource,
+	GLCMD_SetTexture2D,
+	GLCMD_SetUniformBuffer,
+	GLCMD_DrawIndexedPrimitive,
+	GLCMD_DrawArrayedPrimitive,
+	GLCMD_MultiDrawIndexedIndirect,
+};
+
+// \brief
+//	the commands are written to a byte stream, no gl call is made in recording,
+//	so a list can be recorded on any thread, one thread per list. FOpenGLDrv::ExecuteCommandList() replays it on the gl thread.
+//	the resources are recorded as pointers, not retained, they must live until the list is executed.
+//	the shader parameters are copied by value, the parameters recorded after a draw are applied to the next draw.
+class FOpenGLCommandList : public FRefCountedObject
+{
+public:
+	FOpenGLCommandList();
+	virtual ~FOpenGLCommandList();
+
+	// clear the commands, the memory is kept for next recording
+	void Reset();
+
+	void SetPipelineState(const FOpenGLPipelineStateRef &InPipelineState);
+	void SetShaderProgram(const FOpenGLProgramRef &InProgram);
+	void SetVertexDeclaration(const FOpenGLVertexDeclarationRef &InVertexDecl);
+	void SetStreamSource(GLuint StreamIndex, const FOpenGLVertexBufferRef &InVertexBuffer);
+	void SetTexture2D(GLuint TexIndex, const FOpenGLTexture2DRef &InTexture, const FOpenGLSamplerStateRef &InSamplerState = FOpenGLSamplerStateRef());
+	// InSize 0 for the whole buffer
+	void SetUniformBuffer(GLuint InBindingPoint, const FOpenGLUniformBufferRef &InUniformBuffer, GLintptr InOffset = 0, GLsizeiptr InSize = 0);
+
+	// InType is the uniform type, e.g. GL_FLOAT_VEC3, the value is copied
+	void SetShaderParameter(const GLchar *InName, GLenum InType, const GLvoid *InValue, GLsizei InCount);
+	void SetShaderParameter(const GLchar *InName, GLint InValue) { SetShaderParameter(InName, GL_INT, &InValue, 1); }
+	void SetShaderParameter(const GLchar *InName, GLfloat InValue) { SetShaderParameter(InName, GL_FLOAT, &InValue, 1); }
+	void SetShaderParameter(const GLchar *InName, const glm::vec3 &InValue) { SetShaderParameter(InName, GL_FLOAT_VEC3, glm::value_ptr(InValue), 1); }
+	void SetShaderParameter(const GLchar *InName, const glm::vec4 &InValue) { SetShaderParameter(InName, GL_FLOAT_VEC4, glm::value_ptr(InValue), 1); }
+	void SetShaderParameter(const GLchar *InName, const glm::mat4 &InValue) { SetShaderParameter(InName, GL_FLOAT_MAT4, glm::value_ptr(InValue), 1); }
+
+	void DrawIndexedPrimitive(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLint InBaseVertex = 0);
+	void DrawArrayedPrimitive(GLenum InMode, GLint InStart, GLsizei InCount);
+	void DrawIndexedPrimitiveInstanced(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLsizei InInstanceCount, GLint InBaseVertex = 0);
+	void DrawArrayedPrimitiveInstanced(GLenum InMode, GLint InStart, GLsizei InCount, GLsizei InInstanceCount);
+	void MultiDrawIndexedIndirect(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, const FOpenGLIndirectBufferRef &InIndirectBuffer, GLsizei InFirstCommand, GLsizei InCommandCount);
+
+	// replay the commands, only on the gl thread
+	void Execute(FOpenGLDrv &InDriver) const;
+
+	GLuint GetCommandCount() const { return CommandCount; }
+	GLuint GetDrawCount() const { return DrawCount; }
+	size_t GetSize() const { return Data.size(); }
+
+private:
+	FOpenGLCommandList(const FOpenGLCommandList&) = delete;
+	FOpenGLCommandList& operator=(const FOpenGLCommandList&) = delete;
+
+	// append a command of InPayloadSize bytes, return the payload
+	void* AllocCommand(EOpenGLCommand InCommand, size_t InPayloadSize);
+
+	template<typename T>
+	T* AllocCommand(EOpenGLCommand InCommand)
+	{
+		return (T*)AllocCommand(InCommand, sizeof(T));
+	}
+
+	std::vector<GLubyte>	Data;
+	GLuint					CommandCount;
+	GLuint					DrawCount;
+};
+
+typedef TRefCountPtr<FOpenGLCommandList>	FOpenGLCommandListRef;
+
+#endif // __JETX_GL_COMMAND_LIST_H__
@@ -0,0 +1,75 @@
+// \brief
+//		implementation of pipeline state
+//
+
+#include "GLPipelineState.h"
+
+
+bool FBlendStateInitializer::operator==(const FBlendStateInitializer &Other) const
+{
+	return bEnable == Other.bEnable
+		&& ColorOp == Other.ColorOp && ColorSrc == Other.ColorSrc && ColorDst == Other.ColorDst
+		&& AlphaOp == Other.AlphaOp && AlphaSrc == Other.AlphaSrc && AlphaDst == Other.AlphaDst
+		&& ColorWriteMask == Other.ColorWriteMask;
+}
+
+bool FDepthStencilStateInitializer::operator==(const FDepthStencilStateInitializer &Other) const
+{
+	return bDepthTest == Other.bDepthTest && bDepthWrite == Other.bDepthWrite && DepthFunc == Other.DepthFunc
+		&& bStencilTest == Other.bStencilTest && StencilFunc == Other.StencilFunc && StencilRef == Other.StencilRef
+		&& StencilReadMask == Other.StencilReadMask && StencilWriteMask == Other.StencilWriteMask
+		&& StencilFail == Other.StencilFail && StencilDepthFail == Other.StencilDepthFail && StencilPass == Other.StencilPass;
+}
+
+bool FRasterizerStateInitializer::operator==(const FRasterizerStateInitializer &Other) const
+{
+	return CullMode == Other.CullMode && FrontFace == Other.FrontFace && FillMode == Other.FillMode
+		&& DepthBias == Other.DepthBias && SlopeScaleDepthBias == Other.SlopeScaleDepthBias;
+}
+
+bool FPipelineStateInitializer::operator==(const FPipelineStateInitializer &Other) const
+{
+	return Program.DeRef() == Other.Program.DeRef() && VertexDeclaration.DeRef() == Other.VertexDeclaration.DeRef()
+		&& BlendState == Other.BlendState && DepthStencilState == Other.DepthStencilState && RasterizerState == Other.RasterizerState;
+}
+
+size_t FPipelineStateInitializerHash::operator()(const FPipelineStateInitializer &InInitializer) const
+{
+	const FBlendStateInitializer &Blend = InInitializer.BlendState;
+	const FDepthStencilStateInitializer &DepthStencil = InInitializer.DepthStencilState;
+	const FRasterizerStateInitializer &Rasterizer = InInitializer.RasterizerState;
+
+	size_t Hash = IsValidRef(InInitializer.Program) ? InInitializer.Program->GetUniqueId() : 0;
+	Hash = Hash * 31 + (IsValidRef(InInitializer.VertexDeclaration) ? InInitializer.VertexDeclaration->GetUniqueId() : 0);
+
+	Hash = Hash * 31 + Blend.bEnable;
+	Hash = Hash * 31 + Blend.ColorSrc;
+	Hash = Hash * 31 + Blend.ColorDst;
+	Hash = Hash * 31 + Blend.ColorWriteMask;
+
+	Hash = Hash * 31 + DepthStencil.bDepthTest;
+	Hash = Hash * 31 + DepthStencil.bDepthWrite;
+	Hash = Hash * 31 + DepthStencil.DepthFunc;
+	Hash = Hash * 31 + DepthStencil.bStencilTest;
+	Hash = Hash * 31 + DepthStencil.StencilFunc;
+	Hash = Hash * 31 + DepthStencil.StencilRef;
+
+	Hash = Hash * 31 + Rasterizer.CullMode;
+	Hash = Hash * 31 + Rasterizer.FillMode;
+
+	return Hash;
+}
+
+std::atomic<GLuint> FOpenGLPipelineState::NextUniqueId(1);
+
+FOpenGLPipelineState::FOpenGLPipelineState(const FPipelineStateInitializer &InInitializer)
+	: Initializer(InInitializer)
+	, UniqueId(NextUniqueId++)
+{
+	uint64_t ProgramId = IsValidRef(Initializer.Program) ? Initializer.Program->GetUniqueId() : 0;
+	SortKey = (ProgramId << 32) | UniqueId;
+}
+
+FOpenGLPipelineState::~FOpenGLPipelineState()
+{
+}
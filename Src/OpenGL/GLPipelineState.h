@@ -0,0 +1,141 @@
+// \brief
+//		immutable pipeline state: program, vertex declaration and the fixed function states
+//
+
+#ifndef __JETX_GL_PIPELINE_STATE_H__
+#define __JETX_GL_PIPELINE_STATE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <GL/glew.h>
+#include <Common/RefCounting.h>
+#include "GLShader.h"
+#include "GLVertexDeclaration.h"
+
+
+// blend state, the defaults are the gl defaults
+struct FBlendStateInitializer
+{
+	FBlendStateInitializer(bool bInEnable = false, GLenum InColorSrc = GL_ONE, GLenum InColorDst = GL_ZERO)
+		: bEnable(bInEnable)
+		, ColorOp(GL_FUNC_ADD)
+		, ColorSrc(InColorSrc)
+		, ColorDst(InColorDst)
+		, AlphaOp(GL_FUNC_ADD)
+		, AlphaSrc(InColorSrc)
+		, AlphaDst(InColorDst)
+		, ColorWriteMask(0xF)
+	{}
+
+	bool operator==(const FBlendStateInitializer &Other) const;
+	bool operator!=(const FBlendStateInitializer &Other) const { return !(*this == Other); }
+
+	bool		bEnable;
+	GLenum		ColorOp;
+	GLenum		ColorSrc;
+	GLenum		ColorDst;
+	GLenum		AlphaOp;
+	GLenum		AlphaSrc;
+	GLenum		AlphaDst;
+	GLuint		ColorWriteMask;		// bit 0-3 for r, g, b, a
+};
+
+// depth and stencil state, the stencil ops are shared by front and back faces
+struct FDepthStencilStateInitializer
+{
+	FDepthStencilStateInitializer(bool bInDepthTest = false, bool bInDepthWrite = true, GLenum InDepthFunc = GL_LESS)
+		: bDepthTest(bInDepthTest)
+		, bDepthWrite(bInDepthWrite)
+		, DepthFunc(InDepthFunc)
+		, bStencilTest(false)
+		, StencilFunc(GL_ALWAYS)
+		, StencilRef(0)
+		, StencilReadMask(0xFFFFFFFF)
+		, StencilWriteMask(0xFFFFFFFF)
+		, StencilFail(GL_KEEP)
+		, StencilDepthFail(GL_KEEP)
+		, StencilPass(GL_KEEP)
+	{}
+
+	bool operator==(const FDepthStencilStateInitializer &Other) const;
+	bool operator!=(const FDepthStencilStateInitializer &Other) const { return !(*this == Other); }
+
+	bool		bDepthTest;
+	bool		bDepthWrite;
+	GLenum		DepthFunc;
+	bool		bStencilTest;
+	GLenum		StencilFunc;
+	GLint		StencilRef;
+	GLuint		StencilReadMask;
+	GLuint		StencilWriteMask;
+	GLenum		StencilFail;
+	GLenum		StencilDepthFail;
+	GLenum		StencilPass;
+};
+
+// rasterizer state, GL_NONE cull mode disables culling
+struct FRasterizerStateInitializer
+{
+	FRasterizerStateInitializer(GLenum InCullMode = GL_NONE, GLenum InFillMode = GL_FILL)
+		: CullMode(InCullMode)
+		, FrontFace(GL_CCW)
+		, FillMode(InFillMode)
+		, DepthBias(0.f)
+		, SlopeScaleDepthBias(0.f)
+	{}
+
+	bool operator==(const FRasterizerStateInitializer &Other) const;
+	bool operator!=(const FRasterizerStateInitializer &Other) const { return !(*this == Other); }
+
+	GLenum		CullMode;
+	GLenum		FrontFace;
+	GLenum		FillMode;
+	GLfloat		DepthBias;				// glPolygonOffset, enabled if not zero
+	GLfloat		SlopeScaleDepthBias;
+};
+
+// descriptor of pipeline state.
+// the program and the vertex declaration may be null, then they are set by SetShaderProgram()/SetVertexDeclaration(), e.g. by the meshes
+struct FPipelineStateInitializer
+{
+	bool operator==(const FPipelineStateInitializer &Other) const;
+
+	FOpenGLProgramRef				Program;
+	FOpenGLVertexDeclarationRef		VertexDeclaration;
+	FBlendStateInitializer			BlendState;
+	FDepthStencilStateInitializer	DepthStencilState;
+	FRasterizerStateInitializer		RasterizerState;
+};
+
+struct FPipelineStateInitializerHash
+{
+	size_t operator()(const FPipelineStateInitializer &InInitializer) const;
+};
+
+// \brief
+//	get it by FOpenGLDrv::GetPipelineState(), the equal descriptors share one object,
+//	so the pipeline states are compared by pointer and only the changed states are applied at draw.
+class FOpenGLPipelineState : public FRefCountedObject
+{
+public:
+	FOpenGLPipelineState(const FPipelineStateInitializer &InInitializer);
+	virtual ~FOpenGLPipelineState();
+
+	const FPipelineStateInitializer& GetInitializer() const { return Initializer; }
+
+	// unique id of pipeline state, never reused.
+	GLuint GetUniqueId() const { return UniqueId; }
+	// key to sort the draws, the draws of the same program are adjacent
+	uint64_t GetSortKey() const { return SortKey; }
+
+private:
+	FPipelineStateInitializer	Initializer;
+	GLuint		UniqueId;
+	uint64_t	SortKey;
+
+	static std::atomic<GLuint>	NextUniqueId;
+};
+
+typedef TRefCountPtr<FOpenGLPipelineState>	FOpenGLPipelineStateRef;
+
+#endif // __JETX_GL_PIPELINE_STATE_H__
@@ -0,0 +1,165 @@
+// \brief
+//		implementation of program binary cache
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "GLProgramCache.h"
+#include "OpenGLDrv.h"
+
+
+// FNV-1a of 64 bits
+static uint64_t HashBytes(uint64_t InHash, const void *InData, size_t InSize)
+{
+	const unsigned char *Ptr = (const unsigned char*)InData;
+	for (size_t Index = 0; Index < InSize; Index++)
+	{
+		InHash ^= Ptr[Index];
+		InHash *= 1099511628211ull;
+	} // end for
+
+	return InHash;
+}
+
+static uint64_t HashString(uint64_t InHash, const GLchar *InString)
+{
+	// the terminator separates the strings
+	return InString ? HashBytes(InHash, InString, strlen(InString) + 1) : HashBytes(InHash, "", 1);
+}
+
+void FOpenGLProgramCacheStats::Print() const
+{
+	std::cout << "Program Cache: " << Hits << " hits, " << Misses << " misses, " << Rejected << " rejected, " << Stores << " stored" << std::endl
+		<< "    Load: " << LoadMs << "ms, Compile: " << CompileMs << "ms, Saved: " << SavedMs << "ms" << std::endl;
+}
+
+FOpenGLProgramCache::FOpenGLProgramCache(FOpenGLDrv &InOwner, const std::string &InDirectory)
+	: Owner(InOwner)
+	, Directory(InDirectory)
+	, DriverHash(14695981039346656037ull)
+{
+	DriverHash = HashString(DriverHash, (const GLchar*)glGetString(GL_VENDOR));
+	DriverHash = HashString(DriverHash, (const GLchar*)glGetString(GL_RENDERER));
+	DriverHash = HashString(DriverHash, (const GLchar*)glGetString(GL_VERSION));
+
+	// an existing directory fails silently
+#ifdef _WIN32
+	_mkdir(Directory.c_str());
+#else
+	mkdir(Directory.c_str(), 0755);
+#endif
+}
+
+uint64_t FOpenGLProgramCache::MakeKey(const GLchar *InVsSource, const GLchar *InPsSource) const
+{
+	uint64_t Key = DriverHash;
+	Key = HashString(Key, InVsSource);
+	Key = HashString(Key, InPsSource);
+
+	return Key;
+}
+
+std::string FOpenGLProgramCache::GetFilename(uint64_t InKey) const
+{
+	std::ostringstream Stream;
+	Stream << Directory << "/" << std::hex << InKey << ".bin";
+
+	return Stream.str();
+}
+
+FOpenGLProgramRef FOpenGLProgramCache::Load(uint64_t InKey)
+{
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+	FOpenGLProgramBinaryHeader Header;
+	std::vector<GLubyte> Binary;
+	std::ifstream File(GetFilename(InKey).c_str(), std::ios::in | std::ios::binary);
+	bool bValid = File.read((char*)&Header, sizeof(Header)).good()
+		&& Header.Magic == PROGRAM_BINARY_MAGIC && Header.Version == PROGRAM_BINARY_VERSION && Header.Key == InKey && Header.Length > 0;
+	if (bValid)
+	{
+		Binary.resize(Header.Length);
+		bValid = File.read((char*)Binary.data(), Binary.size()).good();
+	}
+	File.close();
+
+	FOpenGLProgramRef Program;
+	if (bValid)
+	{
+		Program = new FOpenGLProgram(Header.Format, Binary.data(), (GLsizei)Binary.size());
+		if (!Program->IsLinked())
+		{
+			Program.SafeRelease();
+		}
+	}
+
+	const double kLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+	std::lock_guard<std::mutex> Lock(Mutex);
+	if (IsValidRef(Program))
+	{
+		Stats.Hits++;
+		Stats.LoadMs += kLoadMs;
+		Stats.SavedMs += Header.CompileMs - kLoadMs;
+	}
+	else
+	{
+		Stats.Misses++;
+		Stats.Rejected += bValid ? 1 : 0;
+	}
+
+	return Program;
+}
+
+void FOpenGLProgramCache::Store(uint64_t InKey, const FOpenGLProgram &InProgram, double InCompileMs)
+{
+	GLenum Format = 0;
+	std::vector<GLubyte> Binary;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Stats.CompileMs += InCompileMs;
+	}
+	if (!InProgram.GetBinary(Format, Binary))
+	{
+		return;
+	}
+
+	FOpenGLProgramBinaryHeader Header;
+	Header.Magic = PROGRAM_BINARY_MAGIC;
+	Header.Version = PROGRAM_BINARY_VERSION;
+	Header.Key = InKey;
+	Header.Format = Format;
+	Header.Length = (uint32_t)Binary.size();
+	Header.CompileMs = InCompileMs;
+
+	const std::string Filename = GetFilename(InKey);
+	std::ofstream File(Filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	File.write((const char*)&Header, sizeof(Header));
+	File.write((const char*)Binary.data(), Binary.size());
+	File.close();
+	if (!File)
+	{
+		std::cout << "Error: Write Program Binary Failed: " << Filename << std::endl;
+		std::remove(Filename.c_str());
+		return;
+	}
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Stats.Stores++;
+}
+
+FOpenGLProgramCacheStats FOpenGLProgramCache::GetStats()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	return Stats;
+}
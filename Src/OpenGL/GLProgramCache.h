@@ -0,0 +1,90 @@
+// \brief
+//		on-disk cache of linked program binaries
+//
+
+#ifndef __JETX_GL_PROGRAM_CACHE_H__
+#define __JETX_GL_PROGRAM_CACHE_H__
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <GL/glew.h>
+#include <Common/RefCounting.h>
+#include "GLShader.h"
+
+class FOpenGLDrv;
+
+#define PROGRAM_BINARY_MAGIC	0x50424A58	// "XJBP"
+#define PROGRAM_BINARY_VERSION	1
+
+// file header, followed by the binary
+struct FOpenGLProgramBinaryHeader
+{
+	uint32_t	Magic;
+	uint32_t	Version;
+	uint64_t	Key;			// a file of another key with the same name is rejected
+	uint32_t	Format;			// of glGetProgramBinary
+	uint32_t	Length;
+	double		CompileMs;		// compiling and linking from source, the time a hit saves
+};
+
+// statistics of program cache
+struct FOpenGLProgramCacheStats
+{
+	FOpenGLProgramCacheStats()
+		: Hits(0)
+		, Misses(0)
+		, Rejected(0)
+		, Stores(0)
+		, LoadMs(0.0)
+		, CompileMs(0.0)
+		, SavedMs(0.0)
+	{}
+
+	void Print() const;
+
+	unsigned int	Hits;
+	unsigned int	Misses;			// not cached, or rejected
+	unsigned int	Rejected;		// the driver refused the binary, e.g. after a driver update
+	unsigned int	Stores;
+	double			LoadMs;			// of the hits
+	double			CompileMs;		// of the misses
+	double			SavedMs;		// the compile time of the hits less their load time
+};
+
+// \brief
+//	the binary of a linked program is stored as "<directory>/<key>.bin", the key hashes the sources and the driver identity,
+//	so the defines compiled into the sources and a driver change make another key.
+//	Load() falls back to nothing on any mismatch, the caller compiles from source then.
+//	requires ARB_get_program_binary with one format at least, see FOpenGLDrv::SetProgramCacheDirectory().
+class FOpenGLProgramCache : public FRefCountedObject
+{
+public:
+	FOpenGLProgramCache(FOpenGLDrv &InOwner, const std::string &InDirectory);
+
+	uint64_t MakeKey(const GLchar *InVsSource, const GLchar *InPsSource) const;
+
+	// null if not cached or rejected
+	FOpenGLProgramRef Load(uint64_t InKey);
+	// the program is linked with the retrievable hint, InCompileMs is of the source compilation
+	void Store(uint64_t InKey, const FOpenGLProgram &InProgram, double InCompileMs);
+
+	const std::string& GetDirectory() const { return Directory; }
+	FOpenGLProgramCacheStats GetStats();
+
+protected:
+	std::string GetFilename(uint64_t InKey) const;
+
+	FOpenGLDrv		&Owner;
+	std::string		Directory;
+	uint64_t		DriverHash;		// vendor, renderer and version strings
+
+	// the programs may be created on loader thread
+	std::mutex					Mutex;
+	FOpenGLProgramCacheStats	Stats;
+};
+
+typedef TRefCountPtr<FOpenGLProgramCache>	FOpenGLProgramCacheRef;
+
+#endif // __JETX_GL_PROGRAM_CACHE_H__
@@ -0,0 +1,193 @@
+// \brief
+//		implementation of ring buffer
+//
+
+#include <cassert>
+#include <iostream>
+#include "OpenGLDrv.h"
+#include "GLRingBuffer.h"
+
+
+static inline GLintptr AlignUp(GLintptr InOffset, GLsizeiptr InAlign)
+{
+	return (InOffset + InAlign - 1) / InAlign * InAlign;
+}
+
+FOpenGLRingBuffer::FOpenGLRingBuffer(FOpenGLDrv &InOwner, GLenum InType, GLsizeiptr InFrameSize, GLuint InIndexStride, GLuint InFramesInFlight)
+	: Owner(InOwner)
+	, Type(InType)
+	, FrameSize(InFrameSize)
+	, FramesInFlight(InFramesInFlight)
+	, MinAlign(1)
+	, MappedData(nullptr)
+	, CurrentFrame(0)
+	, WriteOffset(0)
+	, bIsLocked(false)
+{
+	assert(FramesInFlight > 0 && FramesInFlight <= MAX_GL_FRAMES_IN_FLIGHT);
+	for (GLuint Index = 0; Index < MAX_GL_FRAMES_IN_FLIGHT; Index++)
+	{
+		Fences[Index] = 0;
+	} // end for
+
+	const bool bPersistent = Owner.SupportsBufferStorage();
+	const GLsizeiptr kBufferSize = FrameSize * FramesInFlight;
+#ifdef GL_ARB_buffer_storage
+	const GLbitfield kStorageFlags = bPersistent ? (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT) : 0;
+#else
+	const GLbitfield kStorageFlags = 0;
+#endif
+	switch (Type)
+	{
+	case GL_ARRAY_BUFFER:
+		Buffer = new FOpenGLVertexBuffer(Owner, kBufferSize, nullptr, GL_STREAM_DRAW, kStorageFlags);
+		break;
+	case GL_ELEMENT_ARRAY_BUFFER:
+		Buffer = new FOpenGLIndexBuffer(Owner, kBufferSize, nullptr, InIndexStride, GL_STREAM_DRAW, kStorageFlags);
+		break;
+	case GL_UNIFORM_BUFFER:
+	{
+		GLint Alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+		MinAlign = Alignment > 0 ? Alignment : 256;
+		Buffer = new FOpenGLUniformBuffer(Owner, kBufferSize, nullptr, GL_STREAM_DRAW, kStorageFlags);
+	}
+	break;
+	default:
+		std::cout << "Error: Not Implement Type In FOpenGLRingBuffer()" << std::endl;
+		assert(false);
+		return;
+	}
+
+	if (bPersistent)
+	{
+		MappedData = (GLubyte*)Buffer->Lock(0, kBufferSize, BLF_Write | BLF_Persistent);
+		assert(MappedData);
+	}
+	Owner.OnCreateRingBuffer(this);
+}
+
+FOpenGLRingBuffer::~FOpenGLRingBuffer()
+{
+	Owner.OnDeleteRingBuffer(this);
+
+	for (GLuint Index = 0; Index < MAX_GL_FRAMES_IN_FLIGHT; Index++)
+	{
+		if (Fences[Index])
+		{
+			glDeleteSync(Fences[Index]);
+		}
+	} // end for
+	if (MappedData || bIsLocked)
+	{
+		Buffer->UnLock();
+	}
+}
+
+void* FOpenGLRingBuffer::Lock(GLsizeiptr InSize, GLsizeiptr InAlign, GLintptr &OutOffset)
+{
+	assert(!bIsLocked);
+	assert(InSize > 0 && InAlign > 0);
+
+	// the uniform alignment is power of 2, same as the usual InAlign of uniforms
+	const GLsizeiptr kAlign = InAlign > MinAlign ? InAlign : MinAlign;
+	GLintptr Offset = AlignUp(WriteOffset, kAlign);
+	Stats.Locks++;
+
+	if (MappedData)
+	{
+		if (Offset + InSize > FrameSize)
+		{
+			std::cout << "Error: ring buffer is out of space in frame, size=" << FrameSize << std::endl;
+			Stats.Overflows++;
+			return nullptr;
+		}
+
+		WriteOffset = Offset + InSize;
+		OutOffset = CurrentFrame * FrameSize + Offset;
+		bIsLocked = true;
+		return MappedData + OutOffset;
+	}
+
+	// not written since the last orphan, no synchronization needed
+	GLbitfield Flags = BLF_Write | BLF_DiscardRange | BLF_Unsynchronized;
+	if (Offset + InSize > Buffer->GetSize())
+	{
+		if (InSize > Buffer->GetSize())
+		{
+			std::cout << "Error: ring buffer is out of space, size=" << Buffer->GetSize() << std::endl;
+			Stats.Overflows++;
+			return nullptr;
+		}
+
+		Flags = BLF_Write | BLF_DiscardBuffer;
+		Offset = 0;
+		Stats.Discards++;
+	}
+
+	WriteOffset = Offset + InSize;
+	OutOffset = Offset;
+	bIsLocked = true;
+	return Buffer->Lock(Offset, InSize, Flags);
+}
+
+void FOpenGLRingBuffer::UnLock()
+{
+	assert(bIsLocked);
+	bIsLocked = false;
+
+	// the persistent mapping is coherent
+	if (!MappedData)
+	{
+		Buffer->UnLock();
+	}
+}
+
+void FOpenGLRingBuffer::EndFrame()
+{
+	assert(!bIsLocked);
+	if (!MappedData)
+	{
+		return;
+	}
+
+	Fences[CurrentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	CurrentFrame = (CurrentFrame + 1) % FramesInFlight;
+	WriteOffset = 0;
+
+	// wait for the gpu done with the section of next frame
+	GLsync Fence = Fences[CurrentFrame];
+	if (Fence)
+	{
+		GLenum Result = glClientWaitSync(Fence, 0, 0);
+		if (Result == GL_TIMEOUT_EXPIRED)
+		{
+			Stats.Waits++;
+			do 
+			{
+				Result = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			} while (Result == GL_TIMEOUT_EXPIRED);
+		}
+		glDeleteSync(Fence);
+		Fences[CurrentFrame] = 0;
+	}
+	Owner.CheckError(__FILE__, __LINE__);
+}
+
+FOpenGLVertexBufferRef FOpenGLRingBuffer::GetVertexBuffer() const
+{
+	assert(Type == GL_ARRAY_BUFFER);
+	return (FOpenGLVertexBuffer*)Buffer.DeRef();
+}
+
+FOpenGLIndexBufferRef FOpenGLRingBuffer::GetIndexBuffer() const
+{
+	assert(Type == GL_ELEMENT_ARRAY_BUFFER);
+	return (FOpenGLIndexBuffer*)Buffer.DeRef();
+}
+
+FOpenGLUniformBufferRef FOpenGLRingBuffer::GetUniformBuffer() const
+{
+	assert(Type == GL_UNIFORM_BUFFER);
+	return (FOpenGLUniformBuffer*)Buffer.DeRef();
+}
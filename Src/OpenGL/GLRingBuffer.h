@@ -0,0 +1,85 @@
+// \brief
+//		ring buffer for the transient data streamed per frame
+//
+
+#ifndef __JETX_GL_RING_BUFFER_H__
+#define __JETX_GL_RING_BUFFER_H__
+
+#include <GL/glew.h>
+#include <Common/RefCounting.h>
+#include "GLBuffer.h"
+
+class FOpenGLDrv;
+
+#define MAX_GL_FRAMES_IN_FLIGHT		4
+#define NUM_GL_FRAMES_IN_FLIGHT		3
+
+
+// statistics of ring buffer
+struct FOpenGLRingBufferStats
+{
+	FOpenGLRingBufferStats()
+		: Locks(0)
+		, Waits(0)
+		, Discards(0)
+		, Overflows(0)
+	{}
+
+	unsigned int	Locks;
+	unsigned int	Waits;		// the frame section was still used by gpu at the end of frame
+	unsigned int	Discards;	// buffer orphaned on wrap
+	unsigned int	Overflows;	// lock failed, the frame is out of space
+};
+
+// \brief
+//	the vertices, indices or uniforms written by cpu each frame, the writing never waits for the gpu.
+//	with ARB_buffer_storage the buffer is mapped once persistently and split into a section per frame in flight,
+//	a fence at the end of frame guards the section until the gpu is done with it.
+//	otherwise the buffer is written forward with unsynchronized locks and orphaned when it wraps.
+//	the data is addressed by offset: the start vertex/index of draw, or the range of uniform buffer.
+class FOpenGLRingBuffer : public FRefCountedObject
+{
+public:
+	// InType: GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER or GL_UNIFORM_BUFFER
+	// InFrameSize: bytes can be written in a frame
+	FOpenGLRingBuffer(FOpenGLDrv &InOwner, GLenum InType, GLsizeiptr InFrameSize, GLuint InIndexStride = sizeof(GLuint), GLuint InFramesInFlight = NUM_GL_FRAMES_IN_FLIGHT);
+	virtual ~FOpenGLRingBuffer();
+
+	// lock InSize bytes for write, OutOffset is the offset in buffer and aligned to InAlign (needn't be power of 2).
+	// return nullptr if the frame is out of space
+	void* Lock(GLsizeiptr InSize, GLsizeiptr InAlign, GLintptr &OutOffset);
+	void UnLock();
+
+	// fence the written section and move to the next frame, called by FOpenGLDrv::EndFrame()
+	void EndFrame();
+
+	bool IsPersistent() const { return MappedData != nullptr; }
+	GLenum GetType() const { return Type; }
+
+	FOpenGLVertexBufferRef GetVertexBuffer() const;
+	FOpenGLIndexBufferRef GetIndexBuffer() const;
+	FOpenGLUniformBufferRef GetUniformBuffer() const;
+
+	const FOpenGLRingBufferStats& GetStats() const { return Stats; }
+
+protected:
+	FOpenGLDrv			&Owner;
+	GLenum				Type;
+	TRefCountPtr<FOpenGLBuffer>	Buffer;
+
+	GLsizeiptr			FrameSize;
+	GLuint				FramesInFlight;
+	GLsizeiptr			MinAlign;
+
+	GLubyte				*MappedData;	// persistent mapping
+	GLuint				CurrentFrame;
+	GLintptr			WriteOffset;	// in the section of current frame if persistent, else in the whole buffer
+	GLsync				Fences[MAX_GL_FRAMES_IN_FLIGHT];
+	bool				bIsLocked;
+
+	FOpenGLRingBufferStats	Stats;
+};
+
+typedef TRefCountPtr<FOpenGLRingBuffer>		FOpenGLRingBufferRef;
+
+#endif // __JETX_GL_RING_BUFFER_H__
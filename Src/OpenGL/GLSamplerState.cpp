@@ -0,0 +1,63 @@
+// \brief
+//		implementation of sampler state
+//
+
+#include <cstring>
+#include "GLSamplerState.h"
+#include "OpenGLDrv.h"
+
+
+bool FSamplerStateInitializer::operator==(const FSamplerStateInitializer &Other) const
+{
+	return MinFilter == Other.MinFilter && MagFilter == Other.MagFilter
+		&& WrapS == Other.WrapS && WrapT == Other.WrapT && WrapR == Other.WrapR
+		&& CompareMode == Other.CompareMode && CompareFunc == Other.CompareFunc
+		&& MaxAnisotropy == Other.MaxAnisotropy
+		&& memcmp(BorderColor, Other.BorderColor, sizeof(BorderColor)) == 0;
+}
+
+size_t FSamplerStateInitializerHash::operator()(const FSamplerStateInitializer &InInitializer) const
+{
+	size_t Hash = InInitializer.MinFilter;
+	Hash = Hash * 31 + InInitializer.MagFilter;
+	Hash = Hash * 31 + InInitializer.WrapS;
+	Hash = Hash * 31 + InInitializer.WrapT;
+	Hash = Hash * 31 + InInitializer.WrapR;
+	Hash = Hash * 31 + InInitializer.CompareMode;
+	Hash = Hash * 31 + InInitializer.CompareFunc;
+	Hash = Hash * 31 + (size_t)InInitializer.MaxAnisotropy;
+	for (int Index = 0; Index < 4; Index++)
+	{
+		Hash = Hash * 31 + (size_t)(InInitializer.BorderColor[Index] * 255.f);
+	} // end for
+
+	return Hash;
+}
+
+FOpenGLSamplerState::FOpenGLSamplerState(FOpenGLDrv &InOwner, const FSamplerStateInitializer &InInitializer)
+	: Owner(InOwner)
+	, Resource(0)
+	, Initializer(InInitializer)
+{
+	glGenSamplers(1, &Resource);
+	glSamplerParameteri(Resource, GL_TEXTURE_MIN_FILTER, Initializer.MinFilter);
+	glSamplerParameteri(Resource, GL_TEXTURE_MAG_FILTER, Initializer.MagFilter);
+	glSamplerParameteri(Resource, GL_TEXTURE_WRAP_S, Initializer.WrapS);
+	glSamplerParameteri(Resource, GL_TEXTURE_WRAP_T, Initializer.WrapT);
+	glSamplerParameteri(Resource, GL_TEXTURE_WRAP_R, Initializer.WrapR);
+	glSamplerParameteri(Resource, GL_TEXTURE_COMPARE_MODE, Initializer.CompareMode);
+	glSamplerParameteri(Resource, GL_TEXTURE_COMPARE_FUNC, Initializer.CompareFunc);
+	glSamplerParameterfv(Resource, GL_TEXTURE_BORDER_COLOR, Initializer.BorderColor);
+	if (Initializer.MaxAnisotropy > 1.f && GLEW_EXT_texture_filter_anisotropic)
+	{
+		glSamplerParameterf(Resource, GL_TEXTURE_MAX_ANISOTROPY_EXT, Initializer.MaxAnisotropy);
+	}
+
+	Owner.CheckError(__FILE__, __LINE__);
+}
+
+FOpenGLSamplerState::~FOpenGLSamplerState()
+{
+	Owner.OnDeleteSampler(Resource);
+	glDeleteSamplers(1, &Resource);
+}
@@ -0,0 +1,83 @@
+// \brief
+//		immutable sampler state object, shared by the textures bound with it
+//
+
+#ifndef __JETX_GL_SAMPLER_STATE_H__
+#define __JETX_GL_SAMPLER_STATE_H__
+
+#include <GL/glew.h>
+#include <Common/RefCounting.h>
+
+class FOpenGLDrv;
+
+
+// descriptor of sampler state
+struct FSamplerStateInitializer
+{
+	FSamplerStateInitializer(GLint InMinFilter = GL_LINEAR_MIPMAP_LINEAR, GLint InMagFilter = GL_LINEAR, GLint InWrapS = GL_REPEAT, GLint InWrapT = GL_REPEAT)
+		: MinFilter(InMinFilter)
+		, MagFilter(InMagFilter)
+		, WrapS(InWrapS)
+		, WrapT(InWrapT)
+		, WrapR(InWrapT)
+		, CompareMode(GL_NONE)
+		, CompareFunc(GL_LEQUAL)
+		, MaxAnisotropy(1.f)
+	{
+		BorderColor[0] = BorderColor[1] = BorderColor[2] = BorderColor[3] = 0.f;
+	}
+
+	void SetBorderColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+	{
+		BorderColor[0] = r;
+		BorderColor[1] = g;
+		BorderColor[2] = b;
+		BorderColor[3] = a;
+	}
+
+	// depth texture compared with the r coordinate, e.g. sampler2DShadow
+	void SetCompare(GLint InCompareFunc)
+	{
+		CompareMode = GL_COMPARE_REF_TO_TEXTURE;
+		CompareFunc = InCompareFunc;
+	}
+
+	bool operator==(const FSamplerStateInitializer &Other) const;
+
+	GLint		MinFilter;
+	GLint		MagFilter;
+	GLint		WrapS;
+	GLint		WrapT;
+	GLint		WrapR;
+	GLint		CompareMode;
+	GLint		CompareFunc;
+	GLfloat		MaxAnisotropy;		// applied if EXT_texture_filter_anisotropic is supported
+	GLfloat		BorderColor[4];
+};
+
+struct FSamplerStateInitializerHash
+{
+	size_t operator()(const FSamplerStateInitializer &InInitializer) const;
+};
+
+// \brief
+//	the parameters are set once at creation, get it by FOpenGLDrv::GetSamplerState() then the equal descriptors share one object.
+//	the sampler bound to a unit overrides the parameters of the texture, so a texture can be sampled in different ways.
+class FOpenGLSamplerState : public FRefCountedObject
+{
+public:
+	FOpenGLSamplerState(FOpenGLDrv &InOwner, const FSamplerStateInitializer &InInitializer);
+	virtual ~FOpenGLSamplerState();
+
+	GLuint GetGLResource() const { return Resource; }
+	const FSamplerStateInitializer& GetInitializer() const { return Initializer; }
+
+protected:
+	FOpenGLDrv	&Owner;
+	GLuint		Resource;
+	FSamplerStateInitializer	Initializer;
+};
+
+typedef TRefCountPtr<FOpenGLSamplerState>	FOpenGLSamplerStateRef;
+
+#endif // __JETX_GL_SAMPLER_STATE_H__
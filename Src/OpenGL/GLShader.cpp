@@ -3,8 +3,10 @@
 //
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 
+#include <Common/UtilityHelper.h>
 #include "GLShader.h"
 #include "OpenGLDrv.h"
 
@@ -12,6 +14,7 @@
 FOpenGLShader::FOpenGLShader(GLenum InType, const GLchar *InSource, GLint InLength)
 	: ShaderType(InType)
 	, Resource(0)
+	, bResolved(false)
 	, CompileStatus(GL_FALSE)
 	, InfoLogLength(0)
 	, InfoLog(nullptr)
@@ -21,6 +24,22 @@ FOpenGLShader::FOpenGLShader(GLenum InType, const GLchar *InSource, GLint InLeng
 	Resource = glCreateShader(ShaderType);
 	glShaderSource(Resource, 1, &InSource, &InLength);
 	glCompileShader(Resource);
+
+	// the query waits for the compilation, the compilations run in parallel until then
+	if (!FOpenGLDrv::SharedInstance().IsShaderStatusDeferred())
+	{
+		Resolve();
+	}
+}
+
+void FOpenGLShader::Resolve()
+{
+	if (bResolved)
+	{
+		return;
+	}
+	bResolved = true;
+
 	glGetShaderiv(Resource, GL_COMPILE_STATUS, &CompileStatus);
 	glGetShaderiv(Resource, GL_INFO_LOG_LENGTH, &InfoLogLength);
 
@@ -36,7 +55,10 @@ FOpenGLShader::FOpenGLShader(GLenum InType, const GLchar *InSource, GLint InLeng
 
 FOpenGLShader::~FOpenGLShader()
 {
-	glDeleteShader(Resource);
+	if (!FOpenGLDrv::SharedInstance().DeferDeletion(GLOT_Shader, Resource))
+	{
+		glDeleteShader(Resource);
+	}
 	delete[] InfoLog;
 }
 
@@ -47,6 +69,7 @@ bool FOpenGLShader::IsValid() const
 
 void FOpenGLShader::DumpDebugInfo()
 {
+	Resolve();
 	std::cout << "GL-Shader Dump Debug Info:" << std::endl
 		      << "    CompileStatus: " << (CompileStatus ? "GL_TRUE" : "GL_FALSE") << std::endl
 		      << "    Info Log: " << (InfoLog ? InfoLog : "") << std::endl;
@@ -68,21 +91,91 @@ FOpenGLPixelShader::FOpenGLPixelShader(const GLchar *InSource, GLint InLength)
 
 //////////////////////////////////////////////////////////////////////////
 // Program
+FOpenGLUniformStats FOpenGLProgram::TotalUniformStats;
+std::atomic<GLuint> FOpenGLProgram::NextUniqueId(1);
+
 FOpenGLProgram::FOpenGLProgram(FOpenGLVertexShader *InVertexShader, FOpenGLPixelShader *InPixelShader)
-	: Resource(0)
+	: UniqueId(NextUniqueId++)
+	, Resource(0)
+	, bResolved(false)
 	, LinkStatus(GL_FALSE)
 	, InfoLogLength(0)
 	, InfoLog(nullptr)
 	, AttributesNum(0)
 	, UniformsNum(0)
+	, UniformBlocksNum(0)
 {
 	assert(InVertexShader && InPixelShader);
 
 	Resource = glCreateProgram();
 	glAttachShader(Resource, InVertexShader->GetGLResource());
 	glAttachShader(Resource, InPixelShader->GetGLResource());
+#ifdef GL_ARB_get_program_binary
+	if (IsValidRef(FOpenGLDrv::SharedInstance().GetProgramCache()))
+	{
+		glProgramParameteri(Resource, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+#endif
 	glLinkProgram(Resource);
+
+	if (!FOpenGLDrv::SharedInstance().IsShaderStatusDeferred())
+	{
+		Resolve();
+	}
+}
+
+FOpenGLProgram::FOpenGLProgram(GLenum InBinaryFormat, const GLvoid *InBinary, GLsizei InLength)
+	: UniqueId(NextUniqueId++)
+	, Resource(0)
+	, bResolved(false)
+	, LinkStatus(GL_FALSE)
+	, InfoLogLength(0)
+	, InfoLog(nullptr)
+	, AttributesNum(0)
+	, UniformsNum(0)
+	, UniformBlocksNum(0)
+{
+	Resource = glCreateProgram();
+#ifdef GL_ARB_get_program_binary
+	glProgramBinary(Resource, InBinaryFormat, InBinary, InLength);
 	glGetProgramiv(Resource, GL_LINK_STATUS, &LinkStatus);
+	// a rejected binary sets an error, not to be reported
+	glGetError();
+#endif
+
+	bResolved = true;
+	if (LinkStatus == GL_TRUE)
+	{
+		InitReflection();
+	}
+}
+
+bool FOpenGLProgram::IsReady() const
+{
+	if (bResolved || !FOpenGLDrv::SharedInstance().SupportsParallelShaderCompile())
+	{
+		return true;
+	}
+
+	GLint Completed = GL_TRUE;
+	glGetProgramiv(Resource, GL_COMPLETION_STATUS_KHR, &Completed);
+	return Completed == GL_TRUE;
+}
+
+void FOpenGLProgram::Resolve() const
+{
+	if (bResolved)
+	{
+		return;
+	}
+	bResolved = true;
+
+	glGetProgramiv(Resource, GL_LINK_STATUS, &LinkStatus);
+	InitReflection();
+}
+
+void FOpenGLProgram::InitReflection() const
+{
 	glGetProgramiv(Resource, GL_INFO_LOG_LENGTH, &InfoLogLength);
 
 	if (InfoLogLength > 0)
@@ -95,6 +188,7 @@ FOpenGLProgram::FOpenGLProgram(FOpenGLVertexShader *InVertexShader, FOpenGLPixel
 	}
 	glGetProgramiv(Resource, GL_ACTIVE_ATTRIBUTES, &AttributesNum);
 	glGetProgramiv(Resource, GL_ACTIVE_UNIFORMS, &UniformsNum);
+	glGetProgramiv(Resource, GL_ACTIVE_UNIFORM_BLOCKS, &UniformBlocksNum);
 
 	GLchar VarName[128];
 	GLint VarSize, VarLocation;
@@ -115,12 +209,51 @@ FOpenGLProgram::FOpenGLProgram(FOpenGLVertexShader *InVertexShader, FOpenGLPixel
 		VarLocation = glGetUniformLocation(Resource, VarName);
 		Uniforms.push_back(FOpenGLUniformParam(VarName, VarType, VarSize, VarLocation));
 	} // end for
+
+	// get uniform blocks, bind them to the shared binding points
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	for (GLint Index = 0; Index < UniformBlocksNum; Index++)
+	{
+		GLint DataSize = 0;
+		glGetActiveUniformBlockName(Resource, Index, sizeof(VarName), nullptr, VarName);
+		glGetActiveUniformBlockiv(Resource, Index, GL_UNIFORM_BLOCK_DATA_SIZE, &DataSize);
+
+		GLuint Binding = GLDriver.GetUniformBlockBinding(VarName);
+		glUniformBlockBinding(Resource, Index, Binding);
+		UniformBlocks.push_back(FOpenGLUniformBlock(VarName, Index, DataSize, Binding));
+	} // end for
+
+	// build the slots map and shadow storage
+	GLsizei ShadowBytes = 0;
+	for (size_t Index = 0; Index < Uniforms.size(); Index++)
+	{
+		FOpenGLUniformParam &Element = Uniforms[Index];
+		GLuint NameHash = FUtilityHelper::StringHash(Element.Name.c_str());
+
+		std::unordered_map<GLuint, GLint>::iterator It = SlotsMap.find(NameHash);
+		if (It == SlotsMap.end())
+		{
+			SlotsMap[NameHash] = (GLint)Index;
+		}
+		else
+		{
+			It->second = -2;
+		}
+
+		Element.ShadowOffset = ShadowBytes;
+		// the members of uniform block have no location
+		Element.ShadowSize = Element.Location < 0 ? 0 : FOpenGLDrv::LookupShaderUniformTypeSize(Element.Type) * Element.Size;
+		ShadowBytes += Element.ShadowSize;
+	} // end for
+	ShadowValues.resize(ShadowBytes);
 }
 
 FOpenGLProgram::~FOpenGLProgram()
 {
-	if (Resource)
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	if (Resource && !GLDriver.DeferDeletion(GLOT_Program, Resource))
 	{
+		GLDriver.OnDeleteProgram(Resource);
 		glDeleteProgram(Resource);
 	}
 	delete[] InfoLog;
@@ -131,8 +264,26 @@ bool FOpenGLProgram::IsValid() const
 	return glIsProgram(Resource) == GL_TRUE;
 }
 
+bool FOpenGLProgram::GetBinary(GLenum &OutFormat, std::vector<GLubyte> &OutBinary) const
+{
+	Resolve();
+#ifdef GL_ARB_get_program_binary
+	GLint Length = 0;
+	glGetProgramiv(Resource, GL_PROGRAM_BINARY_LENGTH, &Length);
+	if (LinkStatus == GL_TRUE && Length > 0)
+	{
+		OutBinary.resize(Length);
+		glGetProgramBinary(Resource, Length, nullptr, &OutFormat, OutBinary.data());
+		return true;
+	}
+#endif
+
+	return false;
+}
+
 void FOpenGLProgram::DumpDebugInfo()
 {
+	Resolve();
 	std::cout << "GL-Program Dump Debug Info:" << std::endl
 		<< "    LinkStatus: " << (LinkStatus ? "GL_TRUE" : "GL_FALSE") << std::endl
 		<< "    Active Attributes Count: " << AttributesNum << std::endl
@@ -154,6 +305,14 @@ void FOpenGLProgram::DumpDebugInfo()
 		std::cout << "       name=" << Element.Name << ", type=" << FOpenGLDrv::LookupShaderUniformTypeName(Element.Type) 
 			<< ", size=" << Element.Size << ", location=" << Element.Location << std::endl;
 	}
+	// dump uniform blocks
+	std::cout << "    Uniform Blocks List:" << std::endl;
+	for (size_t Index = 0; Index < UniformBlocks.size(); Index++)
+	{
+		const FOpenGLUniformBlock &Element = UniformBlocks[Index];
+		std::cout << "       name=" << Element.Name << ", index=" << Element.Index
+			<< ", size=" << Element.DataSize << ", binding=" << Element.Binding << std::endl;
+	}
 }
 
 GLint FOpenGLProgram::GetParamLocation(const std::string &InParamName) const
@@ -171,3 +330,75 @@ GLint FOpenGLProgram::GetParamLocation(const std::string &InParamName) const
 
 	return -1;
 }
+
+GLint FOpenGLProgram::GetUniformBlockBinding(const std::string &InBlockName) const
+{
+	for (size_t Index = 0; Index < UniformBlocks.size(); Index++)
+	{
+		if (UniformBlocks[Index].Name == InBlockName)
+		{
+			return (GLint)UniformBlocks[Index].Binding;
+		}
+	} // end for
+
+	return -1;
+}
+
+GLint FOpenGLProgram::GetParamSlot(const GLchar *InParamName, GLuint InNameHash)
+{
+	Resolve();
+	UniformStats.SlotLookups++;
+	TotalUniformStats.SlotLookups++;
+
+	std::unordered_map<GLuint, GLint>::const_iterator It = SlotsMap.find(InNameHash);
+	if (It == SlotsMap.end())
+	{
+		return -1;
+	}
+
+	GLint Slot = It->second;
+	if (Slot >= 0)
+	{
+		return (Uniforms[Slot].Name == InParamName) ? Slot : -1;
+	}
+
+	// hash collided
+	for (size_t Index = 0; Index < Uniforms.size(); Index++)
+	{
+		if (Uniforms[Index].Name == InParamName)
+		{
+			return (GLint)Index;
+		}
+	} // end for
+
+	return -1;
+}
+
+bool FOpenGLProgram::CommitUniformValue(GLint InSlot, const GLvoid *InData, GLsizei InBytes)
+{
+	assert(InSlot >= 0 && InSlot < (GLint)Uniforms.size());
+	FOpenGLUniformParam &Uniform = Uniforms[InSlot];
+
+	if (InBytes > Uniform.ShadowSize)
+	{
+		// can not shadow it, always upload
+		Uniform.ShadowCommitted = 0;
+	}
+	else
+	{
+		GLubyte *Shadow = &ShadowValues[Uniform.ShadowOffset];
+		if (Uniform.ShadowCommitted == InBytes && memcmp(Shadow, InData, InBytes) == 0)
+		{
+			UniformStats.Skipped++;
+			TotalUniformStats.Skipped++;
+			return false;
+		}
+
+		memcpy(Shadow, InData, InBytes);
+		Uniform.ShadowCommitted = InBytes;
+	}
+
+	UniformStats.Uploaded++;
+	TotalUniformStats.Uploaded++;
+	return true;
+}
@@ -5,16 +5,23 @@
 #ifndef __JETX_GL_SHADER_H__
 #define __JETX_GL_SHADER_H__
 
+#include <atomic>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <GL/glew.h>
 #include <Common/RefCounting.h>
 
 class FOpenGLDrv;
 
+// KHR_parallel_shader_compile, not in this glew
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR	0x91B1
+#endif
+
 
 // \brief
-//		OpenGL Shader
+//		OpenGL Shader, the compile status and log are queried when needed if the driver defers the shader status
 class FOpenGLShader : public FRefCountedObject
 {
 public:
@@ -22,6 +29,9 @@ public:
 	
 	GLuint GetGLResource() const { return Resource; }
 	bool IsValid() const;
+	// query the compile status and log, waits for the compilation
+	void Resolve();
+	bool IsCompiled() { Resolve(); return CompileStatus == GL_TRUE; }
 	void DumpDebugInfo();
 
 protected:
@@ -30,6 +40,7 @@ protected:
 private:
 	GLenum		ShaderType;
 	GLuint		Resource;
+	bool		bResolved;
 	GLint		CompileStatus;
 	GLint		InfoLogLength;
 	GLchar     *InfoLog;
@@ -93,6 +104,9 @@ public:
 		, Type(0)
 		, Size(0)
 		, Location(-1)
+		, ShadowOffset(0)
+		, ShadowSize(0)
+		, ShadowCommitted(0)
 	{
 	}
 
@@ -101,6 +115,9 @@ public:
 		, Type(InType)
 		, Size(InSize)
 		, Location(InLocation)
+		, ShadowOffset(0)
+		, ShadowSize(0)
+		, ShadowCommitted(0)
 	{
 	}
 
@@ -109,30 +126,116 @@ public:
 	GLenum			Type;
 	GLint			Size;
 	GLint			Location;
+
+	// shadow copy of the uploaded value, in FOpenGLProgram::ShadowValues
+	GLsizei			ShadowOffset;
+	GLsizei			ShadowSize;
+	GLsizei			ShadowCommitted;	// bytes of the last uploaded value, 0 means unknown
+};
+
+// Uniform Block of Program
+class FOpenGLUniformBlock
+{
+public:
+	FOpenGLUniformBlock(const GLchar* InName, GLuint InIndex, GLint InDataSize, GLuint InBinding)
+		: Name(InName)
+		, Index(InIndex)
+		, DataSize(InDataSize)
+		, Binding(InBinding)
+	{
+	}
+
+public:
+	std::string		Name;
+	GLuint			Index;
+	GLint			DataSize;
+	GLuint			Binding;
+};
+
+// Uniform upload statistics
+struct FOpenGLUniformStats
+{
+	FOpenGLUniformStats()
+		: SlotLookups(0)
+		, Uploaded(0)
+		, Skipped(0)
+	{}
+
+	unsigned int	SlotLookups;	// name to slot resolves
+	unsigned int	Uploaded;		// glUniform* issued
+	unsigned int	Skipped;		// value equals the shadow copy, glUniform* skipped
 };
 
 class FOpenGLProgram : public FRefCountedObject
 {
 public:
+	// the binary is retrievable if the driver has a program cache
 	FOpenGLProgram(FOpenGLVertexShader *InVertexShader, FOpenGLPixelShader *InPixelShader);
+	// from the binary of glGetProgramBinary, not linked if the driver rejects it
+	FOpenGLProgram(GLenum InBinaryFormat, const GLvoid *InBinary, GLsizei InLength);
 	virtual ~FOpenGLProgram();
 
 	GLuint GetGLResource() const { return Resource; }
 	bool IsValid() const;
+	// no waiting: the compilation and linking are done, always true without parallel shader compile
+	bool IsReady() const;
+	// query the link status and the reflection, waits for the linking. done on first use if the status is deferred
+	void Resolve() const;
+	bool IsResolved() const { return bResolved; }
+	bool IsLinked() const { Resolve(); return LinkStatus == GL_TRUE; }
 	void DumpDebugInfo();
 
+	// the linked binary, false if not supported
+	bool GetBinary(GLenum &OutFormat, std::vector<GLubyte> &OutBinary) const;
+
 	GLint GetParamLocation(const std::string &InParamName) const;
 
+	// the reflection below requires Resolve()
+	// binding point of the uniform block, -1 if not exist
+	GLint GetUniformBlockBinding(const std::string &InBlockName) const;
+	bool HasUniformBlock(const std::string &InBlockName) const { return GetUniformBlockBinding(InBlockName) >= 0; }
+
+	// uniform slot is the index of the active uniform, resolve it once and keep it
+	GLint GetParamSlot(const GLchar *InParamName, GLuint InNameHash);
+	GLint GetSlotLocation(GLint InSlot) const { return Uniforms[InSlot].Location; }
+
+	// compare the value with the shadow copy of the slot.
+	// return true if it is changed and should upload by glUniform*
+	bool CommitUniformValue(GLint InSlot, const GLvoid *InData, GLsizei InBytes);
+
+	// unique id of program, never reused. parameters cache the slot by it.
+	GLuint GetUniqueId() const { return UniqueId; }
+
+	const FOpenGLUniformStats& GetUniformStats() const { return UniformStats; }
+	static const FOpenGLUniformStats& GetTotalUniformStats() { return TotalUniformStats; }
+	static void ResetTotalUniformStats() { TotalUniformStats = FOpenGLUniformStats(); }
+
 private:
-	GLuint		Resource;
-	GLint		LinkStatus;
-	GLint		InfoLogLength;
-	GLchar     *InfoLog;
+	// info log, active attributes, uniforms and uniform blocks
+	void InitReflection() const;
 
-	GLint		AttributesNum;
-	GLint		UniformsNum;
-	std::vector<FOpenGLVertexAttribute>	Attributes;
-	std::vector<FOpenGLUniformParam>	Uniforms;
+	GLuint		UniqueId;
+	GLuint		Resource;
+	// resolved lazily, also through the const queries
+	mutable bool	bResolved;
+	mutable GLint	LinkStatus;
+	mutable GLint	InfoLogLength;
+	mutable GLchar *InfoLog;
+
+	mutable GLint	AttributesNum;
+	mutable GLint	UniformsNum;
+	mutable GLint	UniformBlocksNum;
+	mutable std::vector<FOpenGLVertexAttribute>	Attributes;
+	mutable std::vector<FOpenGLUniformParam>	Uniforms;
+	mutable std::vector<FOpenGLUniformBlock>	UniformBlocks;
+
+	// name-hash to slot, collided hashes map to -2 and fall back to search by name
+	mutable std::unordered_map<GLuint, GLint>	SlotsMap;
+	mutable std::vector<GLubyte>				ShadowValues;
+
+	FOpenGLUniformStats			UniformStats;
+	static FOpenGLUniformStats	TotalUniformStats;
+	static std::atomic<GLuint>	NextUniqueId;	// the loader thread creates programs too
 };
 
 typedef TRefCountPtr<FOpenGLProgram>	FOpenGLProgramRef;
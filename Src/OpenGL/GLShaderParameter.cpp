@@ -6,9 +6,25 @@
 #include "GLShaderParameter.h"
 
 
+GLint FShaderParameter::CommitValue(FOpenGLProgram& Program, const GLvoid *InData, GLsizei InBytes) const
+{
+	if (SlotCache->ProgramId != Program.GetUniqueId())
+	{
+		SlotCache->Slot = Program.GetParamSlot(Name, NameHash);
+		SlotCache->ProgramId = Program.GetUniqueId();
+	}
+
+	if (SlotCache->Slot < 0 || !Program.CommitUniformValue(SlotCache->Slot, InData, InBytes))
+	{
+		return -1;
+	}
+
+	return Program.GetSlotLocation(SlotCache->Slot);
+}
+
 void FShaderParameter_Integer1v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * sizeof(GLint));
 	if (Location >= 0)
 	{
 		glUniform1iv(Location, Count, pValue);
@@ -17,7 +33,7 @@ void FShaderParameter_Integer1v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Integer2v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 2 * sizeof(GLint));
 	if (Location >= 0)
 	{
 		glUniform2iv(Location, Count, pValue);
@@ -26,7 +42,7 @@ void FShaderParameter_Integer2v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Integer3v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 3 * sizeof(GLint));
 	if (Location >= 0)
 	{
 		glUniform3iv(Location, Count, pValue);
@@ -35,7 +51,7 @@ void FShaderParameter_Integer3v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Integer4v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 4 * sizeof(GLint));
 	if (Location >= 0)
 	{
 		glUniform4iv(Location, Count, pValue);
@@ -44,7 +60,7 @@ void FShaderParameter_Integer4v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_UnInteger1v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * sizeof(GLuint));
 	if (Location >= 0)
 	{
 		glUniform1uiv(Location, Count, pValue);
@@ -53,7 +69,7 @@ void FShaderParameter_UnInteger1v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_UnInteger2v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 2 * sizeof(GLuint));
 	if (Location >= 0)
 	{
 		glUniform2uiv(Location, Count, pValue);
@@ -62,7 +78,7 @@ void FShaderParameter_UnInteger2v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_UnInteger3v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 3 * sizeof(GLuint));
 	if (Location >= 0)
 	{
 		glUniform3uiv(Location, Count, pValue);
@@ -71,7 +87,7 @@ void FShaderParameter_UnInteger3v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_UnInteger4v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 4 * sizeof(GLuint));
 	if (Location >= 0)
 	{
 		glUniform4uiv(Location, Count, pValue);
@@ -80,7 +96,7 @@ void FShaderParameter_UnInteger4v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Float1v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * sizeof(GLfloat));
 	if (Location >= 0)
 	{
 		glUniform1fv(Location, Count, pValue);
@@ -89,7 +105,7 @@ void FShaderParameter_Float1v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Float2v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 2 * sizeof(GLfloat));
 	if (Location >= 0)
 	{
 		glUniform2fv(Location, Count, pValue);
@@ -98,7 +114,7 @@ void FShaderParameter_Float2v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Float3v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 3 * sizeof(GLfloat));
 	if (Location >= 0)
 	{
 		glUniform3fv(Location, Count, pValue);
@@ -107,7 +123,7 @@ void FShaderParameter_Float3v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Float4v::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 4 * sizeof(GLfloat));
 	if (Location >= 0)
 	{
 		glUniform4fv(Location, Count, pValue);
@@ -116,7 +132,7 @@ void FShaderParameter_Float4v::ApplyValue(FOpenGLProgram& Program) const
 
 void FShaderParameter_Matrix4fv::ApplyValue(FOpenGLProgram& Program) const
 {
-	GLint Location = Program.GetParamLocation(Name);
+	GLint Location = CommitValue(Program, pValue, Count * 16 * sizeof(GLfloat));
 	if (Location >= 0)
 	{
 		glUniformMatrix4fv(Location, Count, GL_FALSE, pValue);
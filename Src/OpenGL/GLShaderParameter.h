@@ -15,28 +15,65 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <Common/RefCounting.h>
+#include <Common/FrameAllocator.h>
+#include <Common/UtilityHelper.h>
 #include "GLShader.h"
 
 
+// the slot of a parameter in a program. parameters live one frame only,
+// so the slots are kept by the shader types and survive the frames
+struct FShaderParameterSlot
+{
+	FShaderParameterSlot()
+		: ProgramId(0)
+		, Slot(-1)
+	{}
+
+	GLuint	ProgramId;		// the program the slot is resolved in
+	GLint	Slot;
+};
+
 // \brief
 //	Abstract Shader Program Parameter
-class FShaderParameter : public FRefCountedObject
+//	parameters are transient objects of a frame, they are allocated from the frame allocator,
+//	and valid until FOpenGLDrv::EndFrame(). never delete them.
+class FShaderParameter
 {
 public:
-	FShaderParameter(const std::string &InName)
-		: Name(InName)
+	FShaderParameter(const GLchar *InName)
+		: Name(FFrameAllocator::SharedInstance().CopyString(InName))
+		, NameHash(FUtilityHelper::StringHash(InName))
+		, SlotCache(&LocalSlot)
 	{}
 
-	virtual ~FShaderParameter()
-	{}
+	static void* operator new(size_t InSize)
+	{
+		return FFrameAllocator::SharedInstance().Alloc(InSize);
+	}
 
-	const std::string& GetName() { return Name; }
+	static void operator delete(void *)
+	{
+		// memory is released by FFrameAllocator::Reset()
+	}
+
+	const GLchar* GetName() const { return Name; }
+
+	// resolve the slot into a cache that outlives the frame, e.g. a member of the shader type
+	FShaderParameter* BindSlot(FShaderParameterSlot &InSlot) { SlotCache = &InSlot; return this; }
 
 	virtual void ApplyValue(FOpenGLProgram& Program) const = 0;
 
 protected:
-	std::string		Name;
+	// resolve the slot in program (once per program and slot cache), then compare with the program's shadow value.
+	// return the location to upload, or -1 if not exist or not changed.
+	GLint CommitValue(FOpenGLProgram& Program, const GLvoid *InData, GLsizei InBytes) const;
+
+protected:
+	const GLchar	*Name;
+	unsigned int	NameHash;
+
+	mutable FShaderParameterSlot	LocalSlot;
+	FShaderParameterSlot			*SlotCache;
 };
 
 
@@ -44,7 +81,7 @@ protected:
 class FShaderParameter_IntegerVector : public FShaderParameter
 {
 public:
-	FShaderParameter_IntegerVector(const std::string &InName, GLint *InValue, GLsizei  InCount)
+	FShaderParameter_IntegerVector(const GLchar *InName, GLint *InValue, GLsizei  InCount)
 		: FShaderParameter(InName)
 		, pValue(InValue)
 		, Count(InCount)
@@ -59,12 +96,12 @@ protected:
 class FShaderParameter_Integer1v : public FShaderParameter_IntegerVector
 {
 public:
-	FShaderParameter_Integer1v(const std::string &InName, GLint *InValue, GLsizei  InCount)
+	FShaderParameter_Integer1v(const GLchar *InName, GLint *InValue, GLsizei  InCount)
 		: FShaderParameter_IntegerVector(InName, InValue, InCount)
 		, SavedVal(0)
 	{}
 
-	FShaderParameter_Integer1v(const std::string &InName, GLint InValue)
+	FShaderParameter_Integer1v(const GLchar *InName, GLint InValue)
 		: FShaderParameter_IntegerVector(InName, &SavedVal, 1)
 		, SavedVal(InValue)
 	{}
@@ -79,13 +116,13 @@ protected:
 class FShaderParameter_Integer2v : public FShaderParameter_IntegerVector
 {
 public:
-	FShaderParameter_Integer2v(const std::string &InName, GLint *InValue, GLsizei InCount)
+	FShaderParameter_Integer2v(const GLchar *InName, GLint *InValue, GLsizei InCount)
 		: FShaderParameter_IntegerVector(InName, InValue, InCount)
 	{
 		SavedVal[0] = SavedVal[1] = 0;
 	}
 
-	FShaderParameter_Integer2v(const std::string &InName, GLint InVal0, GLint InVal1)
+	FShaderParameter_Integer2v(const GLchar *InName, GLint InVal0, GLint InVal1)
 		: FShaderParameter_IntegerVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -102,13 +139,13 @@ protected:
 class FShaderParameter_Integer3v : public FShaderParameter_IntegerVector
 {
 public:
-	FShaderParameter_Integer3v(const std::string &InName, GLint *InValue, GLsizei InCount)
+	FShaderParameter_Integer3v(const GLchar *InName, GLint *InValue, GLsizei InCount)
 		: FShaderParameter_IntegerVector(InName, InValue, InCount)
 	{
 		SavedVal[0] = SavedVal[1] = SavedVal[2] = 0;
 	}
 
-	FShaderParameter_Integer3v(const std::string &InName, GLint InVal0, GLint InVal1, GLint InVal2)
+	FShaderParameter_Integer3v(const GLchar *InName, GLint InVal0, GLint InVal1, GLint InVal2)
 		: FShaderParameter_IntegerVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -126,13 +163,13 @@ protected:
 class FShaderParameter_Integer4v : public FShaderParameter_IntegerVector
 {
 public:
-	FShaderParameter_Integer4v(const std::string &InName, GLint *InValue, GLsizei InCount)
+	FShaderParameter_Integer4v(const GLchar *InName, GLint *InValue, GLsizei InCount)
 		: FShaderParameter_IntegerVector(InName, InValue, InCount)
 	{
 		SavedVal[0] = SavedVal[1] = SavedVal[2] = SavedVal[3] = 0;
 	}
 
-	FShaderParameter_Integer4v(const std::string &InName, GLint InVal0, GLint InVal1, GLint InVal2, GLint InVal3)
+	FShaderParameter_Integer4v(const GLchar *InName, GLint InVal0, GLint InVal1, GLint InVal2, GLint InVal3)
 		: FShaderParameter_IntegerVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -153,7 +190,7 @@ protected:
 class FShaderParameter_UnIntegerVector : public FShaderParameter
 {
 public:
-	FShaderParameter_UnIntegerVector(const std::string &InName, GLuint *InValue, GLsizei  InCount)
+	FShaderParameter_UnIntegerVector(const GLchar *InName, GLuint *InValue, GLsizei  InCount)
 		: FShaderParameter(InName)
 		, pValue(InValue)
 		, Count(InCount)
@@ -168,12 +205,12 @@ protected:
 class FShaderParameter_UnInteger1v : public FShaderParameter_UnIntegerVector
 {
 public:
-	FShaderParameter_UnInteger1v(const std::string &InName, GLuint *InValue, GLsizei  InCount)
+	FShaderParameter_UnInteger1v(const GLchar *InName, GLuint *InValue, GLsizei  InCount)
 		: FShaderParameter_UnIntegerVector(InName, InValue, InCount)
 		, SavedVal(0)
 	{}
 
-	FShaderParameter_UnInteger1v(const std::string &InName, GLuint InValue)
+	FShaderParameter_UnInteger1v(const GLchar *InName, GLuint InValue)
 		: FShaderParameter_UnIntegerVector(InName, &SavedVal, 1)
 		, SavedVal(InValue)
 	{}
@@ -188,13 +225,13 @@ protected:
 class FShaderParameter_UnInteger2v : public FShaderParameter_UnIntegerVector
 {
 public:
-	FShaderParameter_UnInteger2v(const std::string &InName, GLuint *InValue, GLsizei InCount)
+	FShaderParameter_UnInteger2v(const GLchar *InName, GLuint *InValue, GLsizei InCount)
 		: FShaderParameter_UnIntegerVector(InName, InValue, InCount)
 	{
 		SavedVal[0] = SavedVal[1] = 0;
 	}
 
-	FShaderParameter_UnInteger2v(const std::string &InName, GLuint InVal0, GLuint InVal1)
+	FShaderParameter_UnInteger2v(const GLchar *InName, GLuint InVal0, GLuint InVal1)
 		: FShaderParameter_UnIntegerVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -211,11 +248,11 @@ protected:
 class FShaderParameter_UnInteger3v : public FShaderParameter_UnIntegerVector
 {
 public:
-	FShaderParameter_UnInteger3v(const std::string &InName, GLuint *InValue, GLsizei InCount)
+	FShaderParameter_UnInteger3v(const GLchar *InName, GLuint *InValue, GLsizei InCount)
 		: FShaderParameter_UnIntegerVector(InName, InValue, InCount)
 	{}
 
-	FShaderParameter_UnInteger3v(const std::string &InName, GLuint InVal0, GLuint InVal1, GLuint InVal2)
+	FShaderParameter_UnInteger3v(const GLchar *InName, GLuint InVal0, GLuint InVal1, GLuint InVal2)
 		: FShaderParameter_UnIntegerVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -233,11 +270,11 @@ protected:
 class FShaderParameter_UnInteger4v : public FShaderParameter_UnIntegerVector
 {
 public:
-	FShaderParameter_UnInteger4v(const std::string &InName, GLuint *InValue, GLsizei InCount)
+	FShaderParameter_UnInteger4v(const GLchar *InName, GLuint *InValue, GLsizei InCount)
 		: FShaderParameter_UnIntegerVector(InName, InValue, InCount)
 	{}
 
-	FShaderParameter_UnInteger4v(const std::string &InName, GLuint InVal0, GLuint InVal1, GLuint InVal2, GLuint InVal3)
+	FShaderParameter_UnInteger4v(const GLchar *InName, GLuint InVal0, GLuint InVal1, GLuint InVal2, GLuint InVal3)
 		: FShaderParameter_UnIntegerVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -258,7 +295,7 @@ protected:
 class FShaderParameter_FloatVector : public FShaderParameter
 {
 public:
-	FShaderParameter_FloatVector(const std::string &InName, GLfloat *InValue, GLsizei  InCount)
+	FShaderParameter_FloatVector(const GLchar *InName, GLfloat *InValue, GLsizei  InCount)
 		: FShaderParameter(InName)
 		, pValue(InValue)
 		, Count(InCount)
@@ -273,11 +310,11 @@ protected:
 class FShaderParameter_Float1v : public FShaderParameter_FloatVector
 {
 public:
-	FShaderParameter_Float1v(const std::string &InName, GLfloat *InValue, GLsizei  InCount)
+	FShaderParameter_Float1v(const GLchar *InName, GLfloat *InValue, GLsizei  InCount)
 		: FShaderParameter_FloatVector(InName, InValue, InCount)
 	{}
 
-	FShaderParameter_Float1v(const std::string &InName, GLfloat InValue)
+	FShaderParameter_Float1v(const GLchar *InName, GLfloat InValue)
 		: FShaderParameter_FloatVector(InName, &SavedVal, 1)
 		, SavedVal(InValue)
 	{}
@@ -292,13 +329,13 @@ protected:
 class FShaderParameter_Float2v : public FShaderParameter_FloatVector
 {
 public:
-	FShaderParameter_Float2v(const std::string &InName, GLfloat *InValue, GLsizei InCount)
+	FShaderParameter_Float2v(const GLchar *InName, GLfloat *InValue, GLsizei InCount)
 		: FShaderParameter_FloatVector(InName, InValue, InCount)
 	{
 		SavedVal[0] = SavedVal[1] = 0.f;
 	}
 
-	FShaderParameter_Float2v(const std::string &InName, GLfloat InVal0, GLfloat InVal1)
+	FShaderParameter_Float2v(const GLchar *InName, GLfloat InVal0, GLfloat InVal1)
 		: FShaderParameter_FloatVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -315,13 +352,13 @@ protected:
 class FShaderParameter_Float3v : public FShaderParameter_FloatVector
 {
 public:
-	FShaderParameter_Float3v(const std::string &InName, GLfloat *InValue, GLsizei InCount)
+	FShaderParameter_Float3v(const GLchar *InName, GLfloat *InValue, GLsizei InCount)
 		: FShaderParameter_FloatVector(InName, InValue, InCount)
 	{
 		SavedVal[0] = SavedVal[1] = SavedVal[2] = 0.f;
 	}
 
-	FShaderParameter_Float3v(const std::string &InName, GLfloat InVal0, GLfloat InVal1, GLfloat InVal2)
+	FShaderParameter_Float3v(const GLchar *InName, GLfloat InVal0, GLfloat InVal1, GLfloat InVal2)
 		: FShaderParameter_FloatVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -339,13 +376,13 @@ protected:
 class FShaderParameter_Float4v : public FShaderParameter_FloatVector
 {
 public:
-	FShaderParameter_Float4v(const std::string &InName, GLfloat *InValue, GLsizei InCount)
+	FShaderParameter_Float4v(const GLchar *InName, GLfloat *InValue, GLsizei InCount)
 		: FShaderParameter_FloatVector(InName, InValue, InCount)
 	{
 		SavedVal[0] = SavedVal[1] = SavedVal[2] = SavedVal[3] = 0.f;
 	}
 
-	FShaderParameter_Float4v(const std::string &InName, GLfloat InVal0, GLfloat InVal1, GLfloat InVal2, GLfloat InVal3)
+	FShaderParameter_Float4v(const GLchar *InName, GLfloat InVal0, GLfloat InVal1, GLfloat InVal2, GLfloat InVal3)
 		: FShaderParameter_FloatVector(InName, SavedVal, 1)
 	{
 		SavedVal[0] = InVal0;
@@ -365,7 +402,7 @@ protected:
 class FShaderParameter_MatrixVector : public FShaderParameter
 {
 public:
-	FShaderParameter_MatrixVector(const std::string &InName, GLfloat *InValue, GLsizei InCount)
+	FShaderParameter_MatrixVector(const GLchar *InName, GLfloat *InValue, GLsizei InCount)
 		: FShaderParameter(InName)
 		, pValue(InValue)
 		, Count(InCount)
@@ -381,12 +418,12 @@ protected:
 class FShaderParameter_Matrix4fv : public FShaderParameter_MatrixVector
 {
 public:
-	FShaderParameter_Matrix4fv(const std::string &InName, GLfloat *InValue, GLsizei InCount)
+	FShaderParameter_Matrix4fv(const GLchar *InName, GLfloat *InValue, GLsizei InCount)
 		: FShaderParameter_MatrixVector(InName, InValue, InCount)
 	{
 	}
 
-	FShaderParameter_Matrix4fv(const std::string &InName, const glm::mat4 &InMat4)
+	FShaderParameter_Matrix4fv(const GLchar *InName, const glm::mat4 &InMat4)
 		: FShaderParameter_MatrixVector(InName, glm::value_ptr(Matrix4), 1)
 		, Matrix4(InMat4)
 	{
@@ -399,6 +436,6 @@ protected:
 };
 
 
-typedef std::vector<TRefCountPtr<FShaderParameter>> FProgramParameters;
+typedef std::vector<FShaderParameter*> FProgramParameters;
 
 #endif // __JETX_GL_SHADERPARAMETER_H__
@@ -2,6 +2,8 @@
 //		Implementation for GL-Texture
 //
 
+#include <algorithm>
+
 #include "GLTexture.h"
 #include "OpenGLDrv.h"
 
@@ -9,6 +11,7 @@
 FOpenGLTexture2D::FOpenGLTexture2D(FOpenGLDrv &InOwner, GLint InInternalFormat, GLsizei InWidth, GLsizei InHeight, GLenum InDataFormat, GLenum InDataType, const GLvoid* InData)
 	: Owner(InOwner)
 	, Resource(0)
+	, Levels(InData ? GetFullMipLevels(InWidth, InHeight) : 1)
 	, WrapS(GL_REPEAT)
 	, WrapT(GL_REPEAT)
 	, MinFilter(GL_LINEAR_MIPMAP_LINEAR)
@@ -19,10 +22,7 @@ FOpenGLTexture2D::FOpenGLTexture2D(FOpenGLDrv &InOwner, GLint InInternalFormat,
 	glGenTextures(1, &Resource);
 	Owner.CachedBindTextrue(0, GL_TEXTURE_2D, Resource);
 	glTexImage2D(GL_TEXTURE_2D, 0, InInternalFormat, InWidth, InHeight, 0, InDataFormat, InDataType, InData);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, WrapS);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, WrapT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, MinFilter);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, MagFilter);
+	InitParameters();
 	if (InData)
 	{
 		glGenerateMipmap(GL_TEXTURE_2D);
@@ -31,6 +31,88 @@ FOpenGLTexture2D::FOpenGLTexture2D(FOpenGLDrv &InOwner, GLint InInternalFormat,
 	Owner.CheckError(__FILE__, __LINE__);
 }
 
+FOpenGLTexture2D::FOpenGLTexture2D(FOpenGLDrv &InOwner, GLenum InCompressedFormat, const std::vector<FOpenGLTextureMip> &InMips)
+	: Owner(InOwner)
+	, Resource(0)
+	, Levels((GLsizei)InMips.size())
+	, WrapS(GL_REPEAT)
+	, WrapT(GL_REPEAT)
+	, MinFilter(InMips.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR)
+	, MagFilter(GL_LINEAR)
+{
+	BorderColor[0] = BorderColor[1] = BorderColor[2] = BorderColor[3] = 0.f;
+
+	glGenTextures(1, &Resource);
+	Owner.CachedBindTextrue(0, GL_TEXTURE_2D, Resource);
+	for (size_t Level = 0; Level < InMips.size(); Level++)
+	{
+		const FOpenGLTextureMip &Mip = InMips[Level];
+		glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)Level, InCompressedFormat, Mip.Width, Mip.Height, 0, Mip.Size, Mip.Data);
+	} // end for
+	// a chain not down to 1x1 is complete too
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, InMips.empty() ? 0 : (GLint)InMips.size() - 1);
+	InitParameters();
+
+	Owner.CheckError(__FILE__, __LINE__);
+}
+
+FOpenGLTexture2D::FOpenGLTexture2D(FOpenGLDrv &InOwner, GLenum InSizedFormat, GLsizei InWidth, GLsizei InHeight, GLsizei InLevels)
+	: Owner(InOwner)
+	, Resource(0)
+	, Levels(InLevels)
+	, WrapS(GL_REPEAT)
+	, WrapT(GL_REPEAT)
+	, MinFilter(InLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR)
+	, MagFilter(GL_LINEAR)
+{
+	BorderColor[0] = BorderColor[1] = BorderColor[2] = BorderColor[3] = 0.f;
+
+	glGenTextures(1, &Resource);
+	Owner.CachedBindTextrue(0, GL_TEXTURE_2D, Resource);
+#ifdef GL_ARB_texture_storage
+	if (Owner.SupportsTextureStorage())
+	{
+		glTexStorage2D(GL_TEXTURE_2D, InLevels, InSizedFormat, InWidth, InHeight);
+	}
+	else
+#endif
+	{
+		// the same levels by mutable storage
+		const GLenum kDataFormat = InSizedFormat == GL_RGBA8 ? GL_RGBA : GL_RGB;
+		for (GLsizei Level = 0; Level < InLevels; Level++)
+		{
+			glTexImage2D(GL_TEXTURE_2D, Level, InSizedFormat, std::max(1, InWidth >> Level), std::max(1, InHeight >> Level), 0, kDataFormat, GL_UNSIGNED_BYTE, nullptr);
+		} // end for
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, InLevels - 1);
+	}
+	InitParameters();
+
+	Owner.CheckError(__FILE__, __LINE__);
+}
+
+GLsizei FOpenGLTexture2D::GetFullMipLevels(GLsizei InWidth, GLsizei InHeight)
+{
+	GLsizei Size = std::max(InWidth, InHeight);
+	GLsizei Levels = 1;
+	while (Size > 1)
+	{
+		Size >>= 1;
+		Levels++;
+	} // end while
+
+	return Levels;
+}
+
+void FOpenGLTexture2D::InitParameters()
+{
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, WrapS);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, WrapT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, MinFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, MagFilter);
+}
+
 void FOpenGLTexture2D::SetWrapMode(GLint InWrapS, GLint InWrapT)
 {
 	WrapS = InWrapS;
@@ -64,8 +146,9 @@ void FOpenGLTexture2D::SetBorderColor(GLfloat r, float g, float b, float a)
 
 FOpenGLTexture2D::~FOpenGLTexture2D()
 {
-	if (Resource)
+	if (Resource && !Owner.DeferDeletion(GLOT_Texture, Resource))
 	{
+		Owner.OnDeleteTexture(Resource);
 		glDeleteTextures(1, &Resource);
 	}
 }
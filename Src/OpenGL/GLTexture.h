@@ -6,17 +6,32 @@
 #define __JETX_GL_TEXTURE_H__
 
 
+#include <vector>
+
 #include <GL/glew.h>
 #include <Common/RefCounting.h>
 
 class FOpenGLDrv;
 
+// a level of compressed texture
+struct FOpenGLTextureMip
+{
+	GLsizei			Width;
+	GLsizei			Height;
+	GLsizei			Size;	// bytes
+	const GLvoid	*Data;
+};
+
 // \brief
 //		Texture
 class FOpenGLTexture2D : public FRefCountedObject
 {
 public:
 	FOpenGLTexture2D(class FOpenGLDrv &InOwner, GLint InInternalFormat, GLsizei InWidth, GLsizei InHeight, GLenum InDataFormat, GLenum InDataType, const GLvoid* InData);
+	// compressed, the levels are uploaded as they are, no mipmap generation
+	FOpenGLTexture2D(class FOpenGLDrv &InOwner, GLenum InCompressedFormat, const std::vector<FOpenGLTextureMip> &InMips);
+	// storage of InLevels levels without content, immutable if ARB_texture_storage. InSizedFormat is GL_RGB8 or GL_RGBA8
+	FOpenGLTexture2D(class FOpenGLDrv &InOwner, GLenum InSizedFormat, GLsizei InWidth, GLsizei InHeight, GLsizei InLevels);
 	virtual ~FOpenGLTexture2D();
 
 	void SetWrapMode(GLint InWrapS, GLint InWrapT);
@@ -25,10 +40,18 @@ public:
 
 
 	GLuint GetGLResource() { return Resource; }
+	GLsizei GetLevels() const { return Levels; }
+
+	// the levels of a full mip chain
+	static GLsizei GetFullMipLevels(GLsizei InWidth, GLsizei InHeight);
+
+protected:
+	void InitParameters();
 
 protected:
 	FOpenGLDrv	&Owner;
 	GLuint		Resource;
+	GLsizei		Levels;
 	GLint		WrapS;
 	GLint		WrapT;
 	GLint		MinFilter;
@@ -0,0 +1,257 @@
+// \brief
+//		implementation of texture uploader
+//
+
+#include <cassert>
+#include <iostream>
+#include "OpenGLDrv.h"
+#include "GLTextureUploader.h"
+
+
+// the start of each range, enough for any texel
+static const GLsizeiptr kUploadAlignment = 16;
+
+static inline GLintptr AlignUp(GLintptr InOffset, GLsizeiptr InAlign)
+{
+	return (InOffset + InAlign - 1) / InAlign * InAlign;
+}
+
+FOpenGLTextureUpload::~FOpenGLTextureUpload()
+{
+	if (Fence)
+	{
+		glDeleteSync(Fence);
+	}
+}
+
+FOpenGLTextureUploader::FOpenGLTextureUploader(FOpenGLDrv &InOwner, GLsizeiptr InSize)
+	: Owner(InOwner)
+	, Capacity(InSize)
+	, bPersistent(InOwner.SupportsBufferStorage())
+	, MappedData(nullptr)
+	, Head(0)
+{
+#ifdef GL_ARB_buffer_storage
+	const GLbitfield kStorageFlags = bPersistent ? (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT) : 0;
+#else
+	const GLbitfield kStorageFlags = 0;
+#endif
+	Buffer = new FOpenGLBuffer(Owner, GL_PIXEL_UNPACK_BUFFER, Capacity, nullptr, GL_STREAM_DRAW, kStorageFlags);
+	if (bPersistent)
+	{
+		MappedData = (GLubyte*)Buffer->Lock(0, Capacity, BLF_Write | BLF_Persistent);
+		assert(MappedData);
+	}
+	Owner.CachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+FOpenGLTextureUploader::~FOpenGLTextureUploader()
+{
+	Flush();
+	for (size_t Index = 0; Index < Uploads.size(); Index++)
+	{
+		FOpenGLTextureUpload &Upload = *Uploads[Index];
+		if (Upload.Fence)
+		{
+			glClientWaitSync(Upload.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(Upload.Fence);
+			Upload.Fence = 0;
+		}
+		Upload.State.store(TUS_Complete, std::memory_order_release);
+	} // end for
+	Uploads.clear();
+
+	if (MappedData)
+	{
+		Buffer->UnLock();
+		MappedData = nullptr;
+	}
+	Owner.CachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+GLintptr FOpenGLTextureUploader::Reserve(GLsizeiptr InSize)
+{
+	if (Uploads.empty())
+	{
+		Head = 0;
+		return InSize <= Capacity ? 0 : -1;
+	}
+
+	// the used ranges are [Tail, Head), wrapped if Head <= Tail
+	const GLintptr kTail = Uploads.front()->Offset;
+	const GLintptr kOffset = AlignUp(Head, kUploadAlignment);
+	if (Head > kTail)
+	{
+		if (kOffset + InSize <= Capacity)
+		{
+			return kOffset;
+		}
+		// wrap, the end of ring is skipped
+		if (InSize < kTail)
+		{
+			return 0;
+		}
+	}
+	else if (Head < kTail && kOffset + InSize < kTail)
+	{
+		return kOffset;
+	}
+
+	return -1;
+}
+
+FOpenGLTextureUploadRef FOpenGLTextureUploader::Upload(const FOpenGLTexture2DRef &InTexture, GLsizei InWidth, GLsizei InHeight, GLenum InFormat, GLenum InType,
+	GLsizeiptr InSize, const FFillFunction &InFill)
+{
+	assert(IsValidRef(InTexture) && InSize > 0);
+
+	const GLintptr kOffset = Reserve(InSize);
+	if (kOffset < 0)
+	{
+		Stats.RingFull++;
+		return nullptr;
+	}
+
+	if (!MappedData)
+	{
+		// the ranges used by gpu are not written, no need to synchronize
+		MappedData = (GLubyte*)Buffer->Lock(0, Capacity, BLF_Write | BLF_Unsynchronized);
+		Owner.CachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (!MappedData)
+		{
+			std::cout << "Error: Map Texture Upload Ring Failed" << std::endl;
+			return nullptr;
+		}
+	}
+
+	FOpenGLTextureUploadRef NewUpload = new FOpenGLTextureUpload();
+	NewUpload->Texture = InTexture;
+	NewUpload->Width = InWidth;
+	NewUpload->Height = InHeight;
+	NewUpload->Format = InFormat;
+	NewUpload->Type = InType;
+	NewUpload->Offset = kOffset;
+	NewUpload->Size = InSize;
+	Uploads.push_back(NewUpload);
+	Head = kOffset + InSize;
+
+	// the upload is kept by Uploads until the copy is done
+	FOpenGLTextureUpload *RawUpload = NewUpload;
+	GLubyte *Dest = MappedData + kOffset;
+	FJobSystem::SharedInstance().Run([RawUpload, Dest, InFill]() {
+		InFill(Dest);
+		RawUpload->State.store(TUS_Copied, std::memory_order_release);
+	}, &NewUpload->CopyCounter);
+
+	return NewUpload;
+}
+
+void FOpenGLTextureUploader::Submit(FOpenGLTextureUpload &InUpload)
+{
+	Owner.CachedBindTextrue(0, GL_TEXTURE_2D, InUpload.Texture->GetGLResource());
+	// the rows are tightly packed, e.g. rgb of odd width
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, InUpload.Width, InUpload.Height, InUpload.Format, InUpload.Type, (const GLvoid*)InUpload.Offset);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	if (InUpload.Texture->GetLevels() > 1)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	InUpload.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	InUpload.State.store(TUS_Submitted, std::memory_order_release);
+	Stats.Uploads++;
+	Stats.BytesUploaded += InUpload.Size;
+}
+
+void FOpenGLTextureUploader::Tick()
+{
+	FJobSystem &JobSystem = FJobSystem::SharedInstance();
+
+	bool bCopying = false;
+	for (size_t Index = 0; Index < Uploads.size(); Index++)
+	{
+		FOpenGLTextureUpload &Upload = *Uploads[Index];
+		if (Upload.GetState() == TUS_Copying && JobSystem.GetNumWorkers() == 0)
+		{
+			// no worker runs the copy
+			JobSystem.Wait(Upload.CopyCounter);
+		}
+		bCopying |= Upload.GetState() == TUS_Copying;
+	} // end for
+
+	// the ring must be unmapped for the gl reading it, wait for all copies
+	bool bCanSubmit = true;
+	if (!bPersistent && MappedData)
+	{
+		bCanSubmit = !bCopying;
+		if (bCanSubmit)
+		{
+			Buffer->UnLock();
+			Owner.CachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			MappedData = nullptr;
+			Stats.Remaps++;
+		}
+	}
+
+	if (bCanSubmit)
+	{
+		bool bBound = false;
+		for (size_t Index = 0; Index < Uploads.size(); Index++)
+		{
+			FOpenGLTextureUpload &Upload = *Uploads[Index];
+			if (Upload.GetState() == TUS_Copied)
+			{
+				if (!bBound)
+				{
+					Owner.CachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, Buffer->GetGLResource());
+					bBound = true;
+				}
+				Submit(Upload);
+			}
+		} // end for
+
+		// the client memory uploads must not read from the ring
+		if (bBound)
+		{
+			Owner.CachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+	}
+
+	// poll the fences without waiting
+	for (size_t Index = 0; Index < Uploads.size(); Index++)
+	{
+		FOpenGLTextureUpload &Upload = *Uploads[Index];
+		if (Upload.GetState() != TUS_Submitted)
+		{
+			continue;
+		}
+		const GLenum kResult = glClientWaitSync(Upload.Fence, 0, 0);
+		if (kResult == GL_ALREADY_SIGNALED || kResult == GL_CONDITION_SATISFIED)
+		{
+			glDeleteSync(Upload.Fence);
+			Upload.Fence = 0;
+			Upload.State.store(TUS_Complete, std::memory_order_release);
+		}
+	} // end for
+
+	// the ranges are freed in order
+	while (!Uploads.empty() && Uploads.front()->IsComplete())
+	{
+		Uploads.front()->Texture.SafeRelease();
+		Uploads.pop_front();
+	} // end while
+
+	Owner.CheckError(__FILE__, __LINE__);
+}
+
+void FOpenGLTextureUploader::Flush()
+{
+	FJobSystem &JobSystem = FJobSystem::SharedInstance();
+	for (size_t Index = 0; Index < Uploads.size(); Index++)
+	{
+		JobSystem.Wait(Uploads[Index]->CopyCounter);
+	} // end for
+
+	Tick();
+}
@@ -0,0 +1,125 @@
+// \brief
+//		asynchronous texture upload through a ring of pixel unpack buffer
+//
+
+#ifndef __JETX_GL_TEXTURE_UPLOADER_H__
+#define __JETX_GL_TEXTURE_UPLOADER_H__
+
+#include <atomic>
+#include <deque>
+#include <functional>
+
+#include <GL/glew.h>
+#include <Common/JobSystem.h>
+#include <Common/RefCounting.h>
+#include "GLBuffer.h"
+#include "GLTexture.h"
+
+class FOpenGLDrv;
+
+#define DEFAULT_TEXTURE_UPLOAD_RING_SIZE	(32 * 1024 * 1024)
+
+
+// statistics of texture uploader
+struct FOpenGLTextureUploaderStats
+{
+	FOpenGLTextureUploaderStats()
+		: Uploads(0)
+		, BytesUploaded(0)
+		, RingFull(0)
+		, Remaps(0)
+	{}
+
+	unsigned int	Uploads;		// submitted
+	size_t			BytesUploaded;
+	unsigned int	RingFull;		// Upload() failed, the caller uploads synchronously
+	unsigned int	Remaps;			// the ring is unmapped for a submit, not persistent only
+};
+
+enum ETextureUploadState
+{
+	TUS_Copying,		// the fill job is writing the ring
+	TUS_Copied,			// waiting for Tick() on gl thread
+	TUS_Submitted,		// glTexSubImage2D issued, the fence not signaled yet
+	TUS_Complete,		// the gpu has read the ring, the range is reused
+};
+
+// an upload of level 0, the mip chain is generated after it
+class FOpenGLTextureUpload : public FRefCountedObject
+{
+public:
+	FOpenGLTextureUpload()
+		: Width(0), Height(0), Format(0), Type(0), Offset(0), Size(0), State(TUS_Copying), Fence(0)
+	{}
+	virtual ~FOpenGLTextureUpload();
+
+	ETextureUploadState GetState() const { return (ETextureUploadState)State.load(std::memory_order_acquire); }
+	// the texture has the content in gl commands, sampling it is valid
+	bool IsSubmitted() const { return GetState() >= TUS_Submitted; }
+	bool IsComplete() const { return GetState() == TUS_Complete; }
+
+private:
+	friend class FOpenGLTextureUploader;
+
+	FOpenGLTexture2DRef	Texture;
+	GLsizei				Width;
+	GLsizei				Height;
+	GLenum				Format;
+	GLenum				Type;
+	GLintptr			Offset;		// in ring
+	GLsizeiptr			Size;
+	std::atomic<int>	State;
+	GLsync				Fence;
+	FJobCounter			CopyCounter;
+};
+
+typedef TRefCountPtr<FOpenGLTextureUpload>	FOpenGLTextureUploadRef;
+
+// \brief
+//	Upload() reserves a range of the ring and copies the pixels into it by a job, so the gl thread doesn't copy.
+//	Tick() issues glTexSubImage2D from the copied ranges and fences them, the upload runs while the gpu draws.
+//	a range is reused after its fence is signaled, the ranges are freed in the order of reservation.
+//	with ARB_buffer_storage the ring is mapped once persistently, otherwise it is mapped unsynchronized
+//	while the jobs copy and unmapped by Tick() when none is copying.
+//	all calls on gl thread, only the fill functions run on workers.
+class FOpenGLTextureUploader : public FRefCountedObject
+{
+public:
+	typedef std::function<void(void*)>	FFillFunction;
+
+	FOpenGLTextureUploader(FOpenGLDrv &InOwner, GLsizeiptr InSize);
+	virtual ~FOpenGLTextureUploader();
+
+	// InFill writes InSize bytes of level 0 in InFormat/InType, rows are tightly packed.
+	// null if the ring is out of space now, then nothing is done
+	FOpenGLTextureUploadRef Upload(const FOpenGLTexture2DRef &InTexture, GLsizei InWidth, GLsizei InHeight, GLenum InFormat, GLenum InType,
+		GLsizeiptr InSize, const FFillFunction &InFill);
+
+	// submit the copied uploads and complete the fenced ones, called by FOpenGLDrv::EndFrame()
+	void Tick();
+	// wait for the copies and submit all
+	void Flush();
+
+	bool IsPersistent() const { return bPersistent; }
+	const FOpenGLTextureUploaderStats& GetStats() const { return Stats; }
+
+protected:
+	// the ring offset of InSize bytes, -1 if no space
+	GLintptr Reserve(GLsizeiptr InSize);
+	void Submit(FOpenGLTextureUpload &InUpload);
+
+	FOpenGLDrv			&Owner;
+	TRefCountPtr<FOpenGLBuffer>	Buffer;
+	GLsizeiptr			Capacity;
+	bool				bPersistent;
+	GLubyte				*MappedData;	// persistent, or mapped while copying
+
+	GLintptr			Head;			// next reservation
+	std::deque<FOpenGLTextureUploadRef>	Uploads;	// not complete, in the order of reservation
+
+	FOpenGLTextureUploaderStats	Stats;
+};
+
+typedef TRefCountPtr<FOpenGLTextureUploader>	FOpenGLTextureUploaderRef;
+
+#endif // __JETX_GL_TEXTURE_UPLOADER_H__
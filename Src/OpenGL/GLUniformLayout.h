@@ -0,0 +1,69 @@
+// \brief
+//		helper to pack uniform block data in std140 layout
+//
+
+#ifndef __JETX_GL_UNIFORM_LAYOUT_H__
+#define __JETX_GL_UNIFORM_LAYOUT_H__
+
+#include <cstring>
+#include <vector>
+#include <GL/glew.h>
+
+// GLM Mathemtics
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+// \brief
+//	write the members of a uniform block in declaration order, the std140 rules:
+//	scalar aligns to 4, vec2 to 8, vec3/vec4 to 16, mat4 is 4 vec4 columns.
+//	a struct or an array element aligns to 16 and its size rounds up to 16, wrap it with BeginStruct()/EndStruct().
+class FStd140Layout
+{
+public:
+	FStd140Layout()
+		: Offset(0)
+	{}
+
+	// rewind for refill, the memory is kept
+	void Reset() { Offset = 0; }
+
+	void PushInt(GLint InValue) { Write(&InValue, sizeof(GLint), 4); }
+	void PushUInt(GLuint InValue) { Write(&InValue, sizeof(GLuint), 4); }
+	void PushFloat(GLfloat InValue) { Write(&InValue, sizeof(GLfloat), 4); }
+	void PushVec2(const glm::vec2 &InValue) { Write(glm::value_ptr(InValue), sizeof(GLfloat) * 2, 8); }
+	void PushVec3(const glm::vec3 &InValue) { Write(glm::value_ptr(InValue), sizeof(GLfloat) * 3, 16); }
+	void PushVec4(const glm::vec4 &InValue) { Write(glm::value_ptr(InValue), sizeof(GLfloat) * 4, 16); }
+	void PushMat4(const glm::mat4 &InValue) { Write(glm::value_ptr(InValue), sizeof(GLfloat) * 16, 16); }
+
+	void BeginStruct() { AlignTo(16); }
+	void EndStruct() { AlignTo(16); }
+
+	const GLubyte* GetData() const { return Data.data(); }
+	// size of block, rounds up to vec4
+	GLsizeiptr GetSize() const { return GetSizeFor(Offset); }
+
+protected:
+	void AlignTo(GLsizeiptr InAlign)
+	{
+		Offset = (Offset + InAlign - 1) & ~(InAlign - 1);
+	}
+
+	void Write(const GLvoid *InValue, GLsizeiptr InSize, GLsizeiptr InAlign)
+	{
+		AlignTo(InAlign);
+		if (Data.size() < (size_t)GetSizeFor(Offset + InSize))
+		{
+			Data.resize(GetSizeFor(Offset + InSize), 0);
+		}
+		memcpy(&Data[Offset], InValue, InSize);
+		Offset += InSize;
+	}
+
+	static GLsizeiptr GetSizeFor(GLsizeiptr InBytes) { return (InBytes + 15) & ~(GLsizeiptr)15; }
+
+	std::vector<GLubyte>	Data;
+	GLsizeiptr				Offset;
+};
+
+#endif // __JETX_GL_UNIFORM_LAYOUT_H__
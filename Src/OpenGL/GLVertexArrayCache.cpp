@@ -0,0 +1,248 @@
+// \brief
+//		implementation of vertex array cache
+//
+
+#include <cassert>
+#include <cstring>
+#include "OpenGLDrv.h"
+#include "GLVertexArrayCache.h"
+
+
+bool FOpenGLVertexArrayKey::operator==(const FOpenGLVertexArrayKey &Other) const
+{
+	return memcmp(this, &Other, sizeof(FOpenGLVertexArrayKey)) == 0;
+}
+
+size_t FOpenGLVertexArrayKeyHash::operator()(const FOpenGLVertexArrayKey &InKey) const
+{
+	size_t Hash = InKey.DeclarationId;
+	for (GLuint Index = 0; Index < NUM_GL_STREAM_SOURCE; Index++)
+	{
+		Hash = Hash * 31 + InKey.StreamBuffers[Index];
+	} // end for
+	Hash = Hash * 31 + InKey.IndexBuffer;
+
+	return Hash;
+}
+
+FOpenGLVertexArrayCache::FOpenGLVertexArrayCache(FOpenGLDrv &InOwner, size_t InCapacity)
+	: Owner(InOwner)
+	, Capacity(InCapacity)
+	, bSeparateFormat(false)
+{
+	assert(Capacity > 0);
+}
+
+FOpenGLVertexArrayCache::~FOpenGLVertexArrayCache()
+{
+	// the gl objects are deleted by Empty() while the context is alive
+}
+
+void FOpenGLVertexArrayCache::SetSeparateFormat(bool bInSeparateFormat)
+{
+	if (bSeparateFormat != bInSeparateFormat)
+	{
+		Empty();
+		bSeparateFormat = bInSeparateFormat;
+	}
+}
+
+void FOpenGLVertexArrayCache::BindVertexArray(const FOpenGLVertexDeclaration *InDeclaration, const FOpenGLStream *InStreams, GLuint InIndexBuffer)
+{
+	assert(InDeclaration);
+
+	FOpenGLVertexArrayKey Key;
+	memset(&Key, 0, sizeof(Key));
+	Key.DeclarationId = InDeclaration->GetUniqueId();
+	if (!bSeparateFormat)
+	{
+		const FOpenGLVertexElementsList &VertexElementList = InDeclaration->GLVertexElements;
+		for (size_t Index = 0; Index < VertexElementList.size(); Index++)
+		{
+			const GLuint kStreamIndex = VertexElementList[Index].StreamIndex;
+			assert(kStreamIndex < NUM_GL_STREAM_SOURCE);
+			assert(InStreams[kStreamIndex].VertexBuffer);
+			Key.StreamBuffers[kStreamIndex] = InStreams[kStreamIndex].VertexBuffer->GetGLResource();
+		} // end for
+		Key.IndexBuffer = InIndexBuffer;
+	}
+
+	FVertexArrayMap::iterator It = VertexArraysMap.find(Key);
+	if (It != VertexArraysMap.end())
+	{
+		Stats.Hits++;
+		VertexArrays.splice(VertexArrays.begin(), VertexArrays, It->second);
+	}
+	else
+	{
+		Stats.Misses++;
+		if (VertexArrays.size() >= Capacity)
+		{
+			Stats.Evictions++;
+			DeleteVertexArray(--VertexArrays.end());
+		}
+
+		VertexArrays.push_front(FOpenGLVertexArray());
+		VertexArrays.front().Key = Key;
+		InitVertexArray(VertexArrays.front(), InDeclaration, InStreams, InIndexBuffer);
+		VertexArraysMap[Key] = VertexArrays.begin();
+	}
+
+	FOpenGLVertexArray &VertexArray = VertexArrays.front();
+	Owner.CachedBindVertexArray(VertexArray.Resource, VertexArray.IndexBuffer);
+	if (bSeparateFormat)
+	{
+		BindSeparateBuffers(VertexArray, InStreams, InIndexBuffer);
+	}
+}
+
+void FOpenGLVertexArrayCache::InitVertexArray(FOpenGLVertexArray &OutVertexArray, const FOpenGLVertexDeclaration *InDeclaration, const FOpenGLStream *InStreams, GLuint InIndexBuffer)
+{
+	memset(OutVertexArray.StreamBuffers, 0, sizeof(OutVertexArray.StreamBuffers));
+	memset(OutVertexArray.StreamStrides, 0, sizeof(OutVertexArray.StreamStrides));
+	OutVertexArray.StreamsMask = 0;
+	OutVertexArray.IndexBuffer = 0;
+
+	glGenVertexArrays(1, &OutVertexArray.Resource);
+	Owner.CachedBindVertexArray(OutVertexArray.Resource, 0);
+
+	const FOpenGLVertexElementsList &VertexElementList = InDeclaration->GLVertexElements;
+	for (size_t Index = 0; Index < VertexElementList.size(); Index++)
+	{
+		const FOpenGLVertexElement &Element = VertexElementList[Index];
+		const GLuint kStreamIndex = Element.StreamIndex;
+		const GLuint kAttriIndex = Element.AttributeIndex;
+
+		assert(kStreamIndex < NUM_GL_STREAM_SOURCE);
+		assert(kAttriIndex < NUM_GL_VERTEX_ATTRIS);
+		OutVertexArray.StreamsMask |= (1u << kStreamIndex);
+		OutVertexArray.StreamStrides[kStreamIndex] = Element.Stride;
+
+		glEnableVertexAttribArray(kAttriIndex);
+		if (bSeparateFormat)
+		{
+			// format only, the buffer is bound by glBindVertexBuffer
+			if (Element.ShouldConvertToFloat)
+			{
+				glVertexAttribFormat(kAttriIndex, Element.Size, Element.Type, Element.Normalized, Element.Offset);
+			}
+			else
+			{
+				glVertexAttribIFormat(kAttriIndex, Element.Size, Element.Type, Element.Offset);
+			}
+			glVertexAttribBinding(kAttriIndex, kStreamIndex);
+			// the divisor belongs to the binding, elements of a stream share it
+			glVertexBindingDivisor(kStreamIndex, Element.Divisor);
+		}
+		else
+		{
+			FOpenGLVertexBuffer *SourceStream = InStreams[kStreamIndex].VertexBuffer;
+			assert(SourceStream);
+
+			Owner.CachedBindBuffer(GL_ARRAY_BUFFER, SourceStream->GetGLResource());
+			if (Element.ShouldConvertToFloat)
+			{
+				glVertexAttribPointer(kAttriIndex, Element.Size, Element.Type, Element.Normalized, Element.Stride, (GLvoid*)(size_t)Element.Offset);
+			}
+			else
+			{
+				glVertexAttribIPointer(kAttriIndex, Element.Size, Element.Type, Element.Stride, (GLvoid*)(size_t)Element.Offset);
+			}
+			if (Element.Divisor != 0)
+			{
+				glVertexAttribDivisor(kAttriIndex, Element.Divisor);
+			}
+			OutVertexArray.StreamBuffers[kStreamIndex] = SourceStream->GetGLResource();
+		}
+		Owner.CheckError(__FILE__, __LINE__);
+	} // end for
+
+	if (!bSeparateFormat && InIndexBuffer != 0)
+	{
+		Owner.CachedBindBuffer(GL_ELEMENT_ARRAY_BUFFER, InIndexBuffer);
+		OutVertexArray.IndexBuffer = InIndexBuffer;
+	}
+}
+
+void FOpenGLVertexArrayCache::BindSeparateBuffers(FOpenGLVertexArray &InVertexArray, const FOpenGLStream *InStreams, GLuint InIndexBuffer)
+{
+	for (GLuint Index = 0; Index < NUM_GL_STREAM_SOURCE; Index++)
+	{
+		if ((InVertexArray.StreamsMask & (1u << Index)) == 0)
+		{
+			continue;
+		}
+
+		FOpenGLVertexBuffer *SourceStream = InStreams[Index].VertexBuffer;
+		assert(SourceStream);
+		if (InVertexArray.StreamBuffers[Index] != SourceStream->GetGLResource())
+		{
+			glBindVertexBuffer(Index, SourceStream->GetGLResource(), 0, InVertexArray.StreamStrides[Index]);
+			Owner.CheckError(__FILE__, __LINE__);
+			InVertexArray.StreamBuffers[Index] = SourceStream->GetGLResource();
+		}
+	} // end for
+
+	if (InIndexBuffer != 0 && InVertexArray.IndexBuffer != InIndexBuffer)
+	{
+		Owner.CachedBindBuffer(GL_ELEMENT_ARRAY_BUFFER, InIndexBuffer);
+		InVertexArray.IndexBuffer = InIndexBuffer;
+	}
+}
+
+void FOpenGLVertexArrayCache::OnDeleteBuffer(GLuint InName)
+{
+	FVertexArrayList::iterator It = VertexArrays.begin();
+	while (It != VertexArrays.end())
+	{
+		FOpenGLVertexArray &VertexArray = *It;
+		bool bReferenced = VertexArray.IndexBuffer == InName;
+		for (GLuint Index = 0; Index < NUM_GL_STREAM_SOURCE && !bReferenced; Index++)
+		{
+			bReferenced = VertexArray.StreamBuffers[Index] == InName;
+		} // end for
+
+		if (!bReferenced)
+		{
+			It++;
+		}
+		else if (bSeparateFormat)
+		{
+			// keep the format, forget the buffer then it is bound again when the name is reused
+			for (GLuint Index = 0; Index < NUM_GL_STREAM_SOURCE; Index++)
+			{
+				if (VertexArray.StreamBuffers[Index] == InName)
+				{
+					VertexArray.StreamBuffers[Index] = 0;
+				}
+			} // end for
+			if (VertexArray.IndexBuffer == InName)
+			{
+				VertexArray.IndexBuffer = 0;
+			}
+			It++;
+		}
+		else
+		{
+			Stats.Evictions++;
+			It = DeleteVertexArray(It);
+		}
+	} // end while
+}
+
+void FOpenGLVertexArrayCache::Empty()
+{
+	while (!VertexArrays.empty())
+	{
+		DeleteVertexArray(VertexArrays.begin());
+	} // end while
+}
+
+FOpenGLVertexArrayCache::FVertexArrayList::iterator FOpenGLVertexArrayCache::DeleteVertexArray(FVertexArrayList::iterator InIterator)
+{
+	VertexArraysMap.erase(InIterator->Key);
+	Owner.OnDeleteVertexArray(InIterator->Resource);
+	glDeleteVertexArrays(1, &InIterator->Resource);
+
+	return VertexArrays.erase(InIterator);
+}
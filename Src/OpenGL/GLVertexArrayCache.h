@@ -0,0 +1,102 @@
+// \brief
+//		cache of vertex array objects, keyed by vertex declaration and bound buffers
+//
+
+#ifndef __JETX_GL_VERTEX_ARRAY_CACHE_H__
+#define __JETX_GL_VERTEX_ARRAY_CACHE_H__
+
+#include <list>
+#include <unordered_map>
+#include <GL/glew.h>
+#include "OpenGLState.h"
+
+class FOpenGLDrv;
+
+
+// key of vertex array
+struct FOpenGLVertexArrayKey
+{
+	GLuint		DeclarationId;
+	GLuint		StreamBuffers[NUM_GL_STREAM_SOURCE];	// 0 for the streams not used by declaration
+	GLuint		IndexBuffer;
+
+	bool operator==(const FOpenGLVertexArrayKey &Other) const;
+};
+
+struct FOpenGLVertexArrayKeyHash
+{
+	size_t operator()(const FOpenGLVertexArrayKey &InKey) const;
+};
+
+// cached vertex array object
+struct FOpenGLVertexArray
+{
+	FOpenGLVertexArrayKey	Key;
+	GLuint		Resource;
+
+	// buffers bound in the vertex array
+	GLuint		StreamBuffers[NUM_GL_STREAM_SOURCE];
+	GLsizei		StreamStrides[NUM_GL_STREAM_SOURCE];
+	GLuint		StreamsMask;		// bit n is set if stream n is used
+	GLuint		IndexBuffer;
+};
+
+// statistics of vertex array cache
+struct FOpenGLVertexArrayCacheStats
+{
+	FOpenGLVertexArrayCacheStats()
+		: Hits(0)
+		, Misses(0)
+		, Evictions(0)
+	{}
+
+	unsigned int	Hits;
+	unsigned int	Misses;		// vertex array created
+	unsigned int	Evictions;	// by lru or deleted buffer
+};
+
+// \brief
+//	switching to a seen mesh is one glBindVertexArray.
+//	with separate attrib format (ARB_vertex_attrib_binding) the vertex array is keyed only by the declaration,
+//	its format is set once, and the buffers are re-bound by glBindVertexBuffer when changed.
+class FOpenGLVertexArrayCache
+{
+public:
+	FOpenGLVertexArrayCache(FOpenGLDrv &InOwner, size_t InCapacity = 256);
+	~FOpenGLVertexArrayCache();
+
+	// empty the cache if the mode is changed
+	void SetSeparateFormat(bool bInSeparateFormat);
+	bool IsSeparateFormat() const { return bSeparateFormat; }
+
+	// find or create the vertex array for declaration and buffers, and bind it
+	void BindVertexArray(const FOpenGLVertexDeclaration *InDeclaration, const FOpenGLStream *InStreams, GLuint InIndexBuffer);
+
+	// the buffer is deleting, drop the vertex arrays which reference it
+	void OnDeleteBuffer(GLuint InName);
+
+	// delete all vertex arrays
+	void Empty();
+
+	const FOpenGLVertexArrayCacheStats& GetStats() const { return Stats; }
+
+private:
+	typedef std::list<FOpenGLVertexArray>	FVertexArrayList;
+	typedef std::unordered_map<FOpenGLVertexArrayKey, FVertexArrayList::iterator, FOpenGLVertexArrayKeyHash>	FVertexArrayMap;
+
+	void InitVertexArray(FOpenGLVertexArray &OutVertexArray, const FOpenGLVertexDeclaration *InDeclaration, const FOpenGLStream *InStreams, GLuint InIndexBuffer);
+	void BindSeparateBuffers(FOpenGLVertexArray &InVertexArray, const FOpenGLStream *InStreams, GLuint InIndexBuffer);
+	// return the next of deleted
+	FVertexArrayList::iterator DeleteVertexArray(FVertexArrayList::iterator InIterator);
+
+	FOpenGLDrv			&Owner;
+	size_t				Capacity;
+	bool				bSeparateFormat;
+
+	FVertexArrayList	VertexArrays;		// most recently used first
+	FVertexArrayMap		VertexArraysMap;
+
+	FOpenGLVertexArrayCacheStats	Stats;
+};
+
+#endif // __JETX_GL_VERTEX_ARRAY_CACHE_H__
@@ -14,7 +14,33 @@ static void SetGLElement(FOpenGLVertexElement &GLElement, GLenum InType, GLint I
 	GLElement.ShouldConvertToFloat = InShouldConvertToFloat;
 }
 
+bool FVertexElement::operator==(const FVertexElement &Other) const
+{
+	return StreamIndex == Other.StreamIndex && AttributeIndex == Other.AttributeIndex
+		&& Offset == Other.Offset && Stride == Other.Stride
+		&& DataType == Other.DataType && Divisor == Other.Divisor;
+}
+
+size_t FVertexElementsListHash::operator()(const FVertexElementsList &InVertexElements) const
+{
+	size_t Hash = InVertexElements.size();
+	for (FVertexElementsList::const_iterator Itr = InVertexElements.begin(); Itr != InVertexElements.end(); Itr++)
+	{
+		Hash = Hash * 31 + Itr->StreamIndex;
+		Hash = Hash * 31 + Itr->AttributeIndex;
+		Hash = Hash * 31 + Itr->Offset;
+		Hash = Hash * 31 + Itr->Stride;
+		Hash = Hash * 31 + Itr->DataType;
+		Hash = Hash * 31 + Itr->Divisor;
+	} // end for Itr
+
+	return Hash;
+}
+
+std::atomic<GLuint> FOpenGLVertexDeclaration::NextUniqueId(1);
+
 FOpenGLVertexDeclaration::FOpenGLVertexDeclaration(const FVertexElementsList &InVertexElements)
+	: UniqueId(NextUniqueId++)
 {
 	for (FVertexElementsList::const_iterator Itr = InVertexElements.begin(); Itr != InVertexElements.end(); Itr++)
 	{
@@ -25,6 +51,7 @@ FOpenGLVertexDeclaration::FOpenGLVertexDeclaration(const FVertexElementsList &In
 		GLElement.AttributeIndex = VertexElement.AttributeIndex;
 		GLElement.Offset = VertexElement.Offset;
 		GLElement.Stride = VertexElement.Stride;
+		GLElement.Divisor = VertexElement.Divisor;
 		switch (VertexElement.DataType)
 		{
 		case VET_Float1:	SetGLElement(GLElement, GL_FLOAT, 1, GL_FALSE, GL_TRUE); break;
@@ -5,6 +5,7 @@
 #ifndef __JETX_GL_VERTEX_DECLARATION_H__
 #define __JETX_GL_VERTEX_DECLARATION_H__
 
+#include <atomic>
 #include <GL/glew.h>
 #include <vector>
 #include <Common/RefCounting.h>
@@ -47,20 +48,29 @@ struct FVertexElement
 	unsigned short 		Offset;
 	unsigned short 		Stride;
 	EVertexElementType	DataType;
+	unsigned short		Divisor;	// 0: per-vertex, N: advance once every N instances
 	
-	FVertexElement() {}
-	FVertexElement(unsigned short InStreamIndex, unsigned short InAttriIndex, unsigned short InOffset, unsigned short InStride, EVertexElementType InType)
+	FVertexElement() : Divisor(0) {}
+	FVertexElement(unsigned short InStreamIndex, unsigned short InAttriIndex, unsigned short InOffset, unsigned short InStride, EVertexElementType InType, unsigned short InDivisor = 0)
 		: StreamIndex(InStreamIndex)
 		, AttributeIndex(InAttriIndex)
 		, Offset(InOffset)
 		, Stride(InStride)
 		, DataType(InType)
+		, Divisor(InDivisor)
 	{
 	}
+
+	bool operator==(const FVertexElement &Other) const;
 };
 
 typedef std::vector<FVertexElement>		FVertexElementsList;
 
+struct FVertexElementsListHash
+{
+	size_t operator()(const FVertexElementsList &InVertexElements) const;
+};
+
 
 // GL vertex element
 struct FOpenGLVertexElement
@@ -73,11 +83,12 @@ struct FOpenGLVertexElement
 	GLuint		Offset;
 	GLboolean	Normalized;
 	GLboolean	ShouldConvertToFloat;
+	GLuint		Divisor;
 
-	FOpenGLVertexElement() {}
+	FOpenGLVertexElement() : Divisor(0) {}
 
 	FOpenGLVertexElement(GLuint InStreamIndex, GLuint InAttributeIndex, GLint InSize, GLenum InType, GLsizei InStride, GLuint InOffset, GLboolean InNormalized,
-		GLboolean InShouldConvertToFloat)
+		GLboolean InShouldConvertToFloat, GLuint InDivisor = 0)
 		: StreamIndex(InStreamIndex)
 		, AttributeIndex(InAttributeIndex)
 		, Size(InSize)
@@ -86,9 +97,11 @@ struct FOpenGLVertexElement
 		, Offset(InOffset)
 		, Normalized(InNormalized)
 		, ShouldConvertToFloat(InShouldConvertToFloat)
+		, Divisor(InDivisor)
 	{}
 
-	void SetValue(GLuint InStreamIndex, GLuint InAttributeIndex, GLint InSize, GLenum InType, GLsizei InStride, GLuint InOffset, GLboolean InNormalized, GLboolean InShouldConvertToFloat)
+	void SetValue(GLuint InStreamIndex, GLuint InAttributeIndex, GLint InSize, GLenum InType, GLsizei InStride, GLuint InOffset, GLboolean InNormalized, GLboolean InShouldConvertToFloat,
+		GLuint InDivisor = 0)
 	{
 		StreamIndex = InStreamIndex;
 		AttributeIndex = InAttributeIndex;
@@ -98,6 +111,7 @@ struct FOpenGLVertexElement
 		Offset = InOffset;
 		Normalized = InNormalized;
 		ShouldConvertToFloat = InShouldConvertToFloat;
+		Divisor = InDivisor;
 	}
 };
 
@@ -109,7 +123,14 @@ class FOpenGLVertexDeclaration : public FRefCountedObject
 public:
 	FOpenGLVertexDeclaration(const FVertexElementsList &InVertexElements);
 
+	// unique id of declaration, never reused. vertex arrays are cached by it.
+	GLuint GetUniqueId() const { return UniqueId; }
+
 	FOpenGLVertexElementsList	GLVertexElements;
+
+private:
+	GLuint			UniqueId;
+	static std::atomic<GLuint>	NextUniqueId;	// the mesh declarations are created on the loader thread
 };
 
 typedef TRefCountPtr<FOpenGLVertexDeclaration>		FOpenGLVertexDeclarationRef;
@@ -2,6 +2,8 @@
 // NOTE: the glew init code is from glew-project,visualinfo.c
 //
 
+#include <chrono>
+#include <cstring>
 #include <iostream>
 
 #include <GL/glew.h>
@@ -56,6 +58,26 @@ static void InitContext(GLContext* ctx);
 static GLboolean CreateContext(GLContext* ctx);
 static void DestroyContext(GLContext* ctx);
 
+// the entry points glew doesn't know
+static void* GetGLProcAddress(const char *InName)
+{
+#if defined(GLEW_OSMESA)
+	return (void*)OSMesaGetProcAddress(InName);
+#elif defined(GLEW_EGL)
+	return (void*)eglGetProcAddress(InName);
+#elif defined(_WIN32)
+	return (void*)wglGetProcAddress(InName);
+#elif defined(__APPLE__) && !defined(GLEW_APPLE_GLX)
+	return nullptr;
+#elif !defined(__HAIKU__)
+	return (void*)glXGetProcAddressARB((const GLubyte*)InName);
+#else
+	return nullptr;
+#endif
+}
+
+typedef void (GLAPIENTRY *PFNGLMAXSHADERCOMPILERTHREADSPROC)(GLuint InCount);
+
 //\brief
 //	initialize the gl extension functions address.
 static bool InitializeGlew()
@@ -329,6 +351,18 @@ FOpenGLDrv& FOpenGLDrv::SharedInstance()
 
 
 FOpenGLDrv::FOpenGLDrv()
+	: VertexArrayCache(*this)
+	, DrawVertexArray(0)
+	, RenderThreadId(std::this_thread::get_id())
+	, bSupportsMultiDrawIndirect(false)
+	, bSupportsDrawIndirect(false)
+	, bSupportsBaseInstance(false)
+	, bSupportsBufferStorage(false)
+	, bSupportsTextureStorage(false)
+	, bSupportsTextureCompressionS3TC(false)
+	, bSupportsProgramBinary(false)
+	, bSupportsParallelShaderCompile(false)
+	, bShaderStatusDeferred(false)
 {
 
 }
@@ -350,14 +384,94 @@ bool FOpenGLDrv::Initialize()
 
 void FOpenGLDrv::DeferredInitialize()
 {
+	// split vertex format and buffer binding if supported
+	VertexArrayCache.SetSeparateFormat(GLEW_ARB_vertex_attrib_binding == GL_TRUE);
 	CachedBindSharedVertexArrayObject();
+
+	bSupportsDrawIndirect = GLEW_ARB_draw_indirect == GL_TRUE;
+	bSupportsMultiDrawIndirect = bSupportsDrawIndirect && GLEW_ARB_multi_draw_indirect == GL_TRUE;
+	bSupportsBaseInstance = GLEW_ARB_base_instance == GL_TRUE;
+#ifdef GL_ARB_buffer_storage
+	bSupportsBufferStorage = GLEW_ARB_buffer_storage == GL_TRUE;
+#endif
+#ifdef GL_ARB_texture_storage
+	bSupportsTextureStorage = GLEW_ARB_texture_storage == GL_TRUE;
+#endif
+	bSupportsTextureCompressionS3TC = GLEW_EXT_texture_compression_s3tc == GL_TRUE;
+#ifdef GL_ARB_get_program_binary
+	GLint NumBinaryFormats = 0;
+	if (GLEW_ARB_get_program_binary == GL_TRUE)
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &NumBinaryFormats);
+	}
+	bSupportsProgramBinary = NumBinaryFormats > 0;
+#endif
+
+	// the driver compiles on its threads, as many as it has
+	bSupportsParallelShaderCompile = HasExtension("GL_KHR_parallel_shader_compile") || HasExtension("GL_ARB_parallel_shader_compile");
+	if (bSupportsParallelShaderCompile)
+	{
+		const bool kKHR = HasExtension("GL_KHR_parallel_shader_compile");
+		PFNGLMAXSHADERCOMPILERTHREADSPROC MaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC)GetGLProcAddress(
+			kKHR ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB");
+		if (MaxShaderCompilerThreads)
+		{
+			MaxShaderCompilerThreads(0xFFFFFFFF);
+		}
+	}
+}
+
+bool FOpenGLDrv::HasExtension(const char *InName) const
+{
+	GLint NumExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &NumExtensions);
+	for (GLint Index = 0; Index < NumExtensions; Index++)
+	{
+		const GLubyte *Name = glGetStringi(GL_EXTENSIONS, Index);
+		if (Name && strcmp((const char*)Name, InName) == 0)
+		{
+			return true;
+		}
+	} // end for
+
+	return false;
 }
 
 void FOpenGLDrv::Terminate()
 {
-	if (CurrentState.SharedVertexArray == 0)
+	if (IsValidRef(ProgramCache))
+	{
+		{
+			std::lock_guard<std::mutex> Lock(PendingProgramStoreMutex);
+			StorePendingPrograms(true);
+		}
+		ProgramCache->GetStats().Print();
+		ProgramCache.SafeRelease();
+	}
+	if (IsValidRef(TextureUploader))
+	{
+		TextureUploader->Flush();
+		TextureUploader.SafeRelease();
+	}
+	BufferArenas.clear();
+	for (int Index = 0; Index < NUM_GL_TEXTURE_UNITS; Index++)
 	{
+		PendingState.Texture2DStages[Index].SamplerStateRef.SafeRelease();
+	} // end for
+	SamplerStates.clear();
+	PendingState.PipelineState = nullptr;
+	CurrentState.PipelineState = nullptr;
+	PipelineStates.clear();
+	{
+		std::lock_guard<std::mutex> Lock(VertexDeclarationMutex);
+		VertexDeclarations.clear();
+	}
+	VertexArrayCache.Empty();
+	if (CurrentState.SharedVertexArray != 0)
+	{
+		OnDeleteVertexArray(CurrentState.SharedVertexArray);
 		glDeleteVertexArrays(1, &CurrentState.SharedVertexArray);
+		CurrentState.SharedVertexArray = 0;
 	}
 }
 
@@ -382,6 +496,47 @@ FOpenGLIndexBufferRef FOpenGLDrv::CreateIndexBuffer(GLsizeiptr InSize, const GLv
 	return new FOpenGLIndexBuffer(*this, InSize, InData, InStride, InUsage);
 }
 
+FOpenGLUniformBufferRef FOpenGLDrv::CreateUniformBuffer(GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage)
+{
+	return new FOpenGLUniformBuffer(*this, InSize, InData, InUsage);
+}
+
+FOpenGLRingBufferRef FOpenGLDrv::CreateRingBuffer(GLenum InType, GLsizeiptr InFrameSize, GLuint InIndexStride)
+{
+	return new FOpenGLRingBuffer(*this, InType, InFrameSize, InIndexStride);
+}
+
+FOpenGLBufferArenaRef FOpenGLDrv::GetBufferArena(GLenum InType, GLuint InStride)
+{
+	for (size_t Index = 0; Index < BufferArenas.size(); Index++)
+	{
+		if (BufferArenas[Index]->GetType() == InType && BufferArenas[Index]->GetStride() == InStride)
+		{
+			return BufferArenas[Index];
+		}
+	} // end for
+
+	FOpenGLBufferArenaRef Arena = new FOpenGLBufferArena(*this, InType, InStride, GL_BUFFER_ARENA_PAGE_BYTES / InStride);
+	BufferArenas.push_back(Arena);
+	return Arena;
+}
+
+void FOpenGLDrv::DefragmentBufferArenas(GLuint InMaxPages)
+{
+	for (size_t Index = 0; Index < BufferArenas.size(); Index++)
+	{
+		if (BufferArenas[Index]->IsFragmented())
+		{
+			BufferArenas[Index]->Defragment(InMaxPages);
+		}
+	} // end for
+}
+
+FOpenGLIndirectBufferRef FOpenGLDrv::CreateIndirectBuffer(GLsizei InCommandCount, const FDrawElementsIndirectCommand *InCommands, GLenum InUsage)
+{
+	return new FOpenGLIndirectBuffer(*this, InCommandCount, InCommands, InUsage);
+}
+
 FOpenGLVertexShaderRef FOpenGLDrv::CreateVertexShader(const GLchar *InSource, GLint InLength)
 {
 	return new FOpenGLVertexShader(InSource, InLength);
@@ -397,16 +552,159 @@ FOpenGLProgramRef FOpenGLDrv::CreateProgram(const FOpenGLVertexShaderRef &InVert
 	return new FOpenGLProgram((FOpenGLVertexShader*)InVertexShader, (FOpenGLPixelShader*)InPixelShader);
 }
 
+FOpenGLProgramRef FOpenGLDrv::CreateProgram(const GLchar *InVsSource, const GLchar *InPsSource,
+	FOpenGLVertexShaderRef *OutVertexShader, FOpenGLPixelShaderRef *OutPixelShader)
+{
+	// the cache may be disabled by another thread meanwhile
+	FOpenGLProgramCacheRef Cache = ProgramCache;
+	const uint64_t kKey = IsValidRef(Cache) ? Cache->MakeKey(InVsSource, InPsSource) : 0;
+	FOpenGLProgramRef Program = IsValidRef(Cache) ? Cache->Load(kKey) : nullptr;
+	if (IsValidRef(Program))
+	{
+		return Program;
+	}
+
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	FOpenGLVertexShaderRef VertexShader = CreateVertexShader(InVsSource);
+	FOpenGLPixelShaderRef PixelShader = CreatePixelShader(InPsSource);
+	Program = CreateProgram(VertexShader, PixelShader);
+	if (IsValidRef(Cache))
+	{
+		// the binary is retrieved when linked, not to wait for the linking now
+		FPendingProgramStore Pending;
+		Pending.Program = Program;
+		Pending.Key = kKey;
+		Pending.Start = Start;
+		std::lock_guard<std::mutex> Lock(PendingProgramStoreMutex);
+		PendingProgramStores.push_back(Pending);
+		if (!bShaderStatusDeferred)
+		{
+			StorePendingPrograms(true);
+		}
+	}
+
+	if (OutVertexShader)
+	{
+		*OutVertexShader = VertexShader;
+	}
+	if (OutPixelShader)
+	{
+		*OutPixelShader = PixelShader;
+	}
+	return Program;
+}
+
+void FOpenGLDrv::StorePendingPrograms(bool bInWait)
+{
+	for (size_t Index = 0; Index < PendingProgramStores.size();)
+	{
+		FPendingProgramStore &Pending = PendingProgramStores[Index];
+		if (!bInWait && !Pending.Program->IsReady())
+		{
+			Index++;
+			continue;
+		}
+
+		// the compile time is up to the linking observed, the upper bound with deferred status
+		if (IsValidRef(ProgramCache) && Pending.Program->IsLinked())
+		{
+			ProgramCache->Store(Pending.Key, *Pending.Program, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Pending.Start).count());
+		}
+		PendingProgramStores.erase(PendingProgramStores.begin() + Index);
+	} // end for
+}
+
+void FOpenGLDrv::SetProgramCacheDirectory(const std::string &InDirectory)
+{
+	{
+		std::lock_guard<std::mutex> Lock(PendingProgramStoreMutex);
+		StorePendingPrograms(true);
+	}
+	ProgramCache.SafeRelease();
+	if (InDirectory.empty())
+	{
+		return;
+	}
+
+	if (!bSupportsProgramBinary)
+	{
+		std::cout << "Error: Program Binary is not supported, the program cache is disabled" << std::endl;
+		return;
+	}
+	ProgramCache = new FOpenGLProgramCache(*this, InDirectory);
+}
+
 FOpenGLVertexDeclarationRef FOpenGLDrv::CreateVertexDeclaration(const FVertexElementsList &InVertexElements)
 {
 	return new FOpenGLVertexDeclaration(InVertexElements);
 }
 
+FOpenGLVertexDeclarationRef FOpenGLDrv::GetVertexDeclaration(const FVertexElementsList &InVertexElements)
+{
+	std::lock_guard<std::mutex> Lock(VertexDeclarationMutex);
+
+	FVertexDeclarationMap::iterator It = VertexDeclarations.find(InVertexElements);
+	if (It != VertexDeclarations.end())
+	{
+		return It->second;
+	}
+
+	FOpenGLVertexDeclarationRef VertexDeclaration = new FOpenGLVertexDeclaration(InVertexElements);
+	VertexDeclarations[InVertexElements] = VertexDeclaration;
+	return VertexDeclaration;
+}
+
 FOpenGLTexture2DRef FOpenGLDrv::CreateTexture2D(GLint InInternalFormat, GLsizei InWidth, GLsizei InHeight, GLenum InDataFormat, GLenum InDataType, const GLvoid* InData)
 {
 	return new FOpenGLTexture2D(*this, InInternalFormat, InWidth, InHeight, InDataFormat, InDataType, InData);
 }
 
+FOpenGLTexture2DRef FOpenGLDrv::CreateCompressedTexture2D(GLenum InCompressedFormat, const std::vector<FOpenGLTextureMip> &InMips)
+{
+	return new FOpenGLTexture2D(*this, InCompressedFormat, InMips);
+}
+
+FOpenGLTexture2DRef FOpenGLDrv::CreateTexture2DStorage(GLenum InSizedFormat, GLsizei InWidth, GLsizei InHeight, GLsizei InLevels)
+{
+	return new FOpenGLTexture2D(*this, InSizedFormat, InWidth, InHeight, InLevels);
+}
+
+FOpenGLTextureUploaderRef FOpenGLDrv::GetTextureUploader()
+{
+	if (!IsValidRef(TextureUploader))
+	{
+		TextureUploader = new FOpenGLTextureUploader(*this, DEFAULT_TEXTURE_UPLOAD_RING_SIZE);
+	}
+
+	return TextureUploader;
+}
+
+FOpenGLSamplerStateRef FOpenGLDrv::GetSamplerState(const FSamplerStateInitializer &InInitializer)
+{
+	FSamplerStateMap::iterator It = SamplerStates.find(InInitializer);
+	if (It != SamplerStates.end())
+	{
+		return It->second;
+	}
+
+	FOpenGLSamplerStateRef SamplerState = new FOpenGLSamplerState(*this, InInitializer);
+	SamplerStates[InInitializer] = SamplerState;
+	return SamplerState;
+}
+
+FOpenGLPipelineStateRef FOpenGLDrv::GetPipelineState(const FPipelineStateInitializer &InInitializer)
+{
+	FPipelineStateMap::iterator It = PipelineStates.find(InInitializer);
+	if (It != PipelineStates.end())
+	{
+		return It->second;
+	}
+
+	FOpenGLPipelineStateRef PipelineState = new FOpenGLPipelineState(InInitializer);
+	PipelineStates[InInitializer] = PipelineState;
+	return PipelineState;
+}
+
 FOpenGLRenderBufferRef FOpenGLDrv::CreateRenderBuffer(GLenum InInternalformat, GLsizei InWidth, GLsizei InHeight)
 {
 	return new FOpenGLRenderBuffer(*this, InInternalformat, InWidth, InHeight);
@@ -425,6 +723,33 @@ void FOpenGLDrv::SetClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
 
 void FOpenGLDrv::ClearBuffer(GLbitfield mask)
 {
+	// the write masks also mask the clear
+	bool bMaskChanged = false;
+	if ((mask & GL_COLOR_BUFFER_BIT) && CurrentState.BlendState.ColorWriteMask != 0xF)
+	{
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		CurrentState.BlendState.ColorWriteMask = 0xF;
+		bMaskChanged = true;
+	}
+	if ((mask & GL_DEPTH_BUFFER_BIT) && !CurrentState.DepthStencilState.bDepthWrite)
+	{
+		glDepthMask(GL_TRUE);
+		CurrentState.DepthStencilState.bDepthWrite = true;
+		bMaskChanged = true;
+	}
+	if ((mask & GL_STENCIL_BUFFER_BIT) && CurrentState.DepthStencilState.StencilWriteMask != 0xFFFFFFFF)
+	{
+		glStencilMask(0xFFFFFFFF);
+		CurrentState.DepthStencilState.StencilWriteMask = 0xFFFFFFFF;
+		bMaskChanged = true;
+	}
+	if (bMaskChanged)
+	{
+		// re-apply the pipeline state at next draw
+		CurrentState.PipelineState = nullptr;
+		PendingState.DirtyFlags |= GLDS_PipelineState;
+	}
+
 	glClear(mask);
 }
 
@@ -432,22 +757,35 @@ void FOpenGLDrv::SetStreamSource(GLuint StreamIndex, const FOpenGLVertexBufferRe
 {
 	assert(StreamIndex < NUM_GL_STREAM_SOURCE);
 
-	PendingState.VertexStreams[StreamIndex].VertexBuffer = (FOpenGLVertexBuffer*)InVertexBuffer;
+	FOpenGLStream &Stream = PendingState.VertexStreams[StreamIndex];
+	if (Stream.VertexBuffer != (FOpenGLVertexBuffer*)InVertexBuffer)
+	{
+		Stream.VertexBuffer = (FOpenGLVertexBuffer*)InVertexBuffer;
+		PendingState.DirtyFlags |= GLDS_VertexArray;
+	}
 }
 
 void FOpenGLDrv::SetVertexDeclaration(const FOpenGLVertexDeclarationRef &InVertexDecl)
 {
-	PendingState.VertexDeclaration = (FOpenGLVertexDeclaration*)InVertexDecl;
+	if (PendingState.VertexDeclaration != (FOpenGLVertexDeclaration*)InVertexDecl)
+	{
+		PendingState.VertexDeclaration = (FOpenGLVertexDeclaration*)InVertexDecl;
+		PendingState.DirtyFlags |= GLDS_VertexArray;
+	}
 }
 
 void FOpenGLDrv::SetShaderProgram(const FOpenGLProgramRef &InProgram)
 {
-	PendingState.BindProgram = 0;
-	PendingState.ShaderProgram = (FOpenGLProgram*)InProgram;
-	if (PendingState.ShaderProgram)
+	FOpenGLProgram *Program = (FOpenGLProgram*)InProgram;
+	const GLuint kBindProgram = Program ? Program->GetGLResource() : 0;
+	if (PendingState.ShaderProgram == Program && PendingState.BindProgram == kBindProgram)
 	{
-		PendingState.BindProgram = InProgram->GetGLResource();
+		return;
 	}
+
+	PendingState.ShaderProgram = Program;
+	PendingState.BindProgram = kBindProgram;
+	PendingState.DirtyFlags |= GLDS_ShaderProgram;
 }
 
 void FOpenGLDrv::SetShaderProgramParameters(FProgramParameters *InParameters)
@@ -455,10 +793,81 @@ void FOpenGLDrv::SetShaderProgramParameters(FProgramParameters *InParameters)
 	PendingState.ShaderParameters = InParameters;
 }
 
-void FOpenGLDrv::SetTexture2D(GLuint TexIndex, const FOpenGLTexture2DRef &InTexture)
+void FOpenGLDrv::SetPipelineState(const FOpenGLPipelineStateRef &InPipelineState)
+{
+	PendingState.PipelineState = (FOpenGLPipelineState*)InPipelineState;
+	PendingState.DirtyFlags |= GLDS_PipelineState;
+	if (PendingState.PipelineState)
+	{
+		const FPipelineStateInitializer &Initializer = PendingState.PipelineState->GetInitializer();
+		if (IsValidRef(Initializer.Program))
+		{
+			SetShaderProgram(Initializer.Program);
+		}
+		if (IsValidRef(Initializer.VertexDeclaration))
+		{
+			SetVertexDeclaration(Initializer.VertexDeclaration);
+		}
+	}
+}
+
+void FOpenGLDrv::SetUniformBuffer(GLuint InBindingPoint, const FOpenGLUniformBufferRef &InUniformBuffer)
+{
+	SetUniformBuffer(InBindingPoint, InUniformBuffer, 0, 0);
+}
+
+void FOpenGLDrv::SetUniformBuffer(GLuint InBindingPoint, const FOpenGLUniformBufferRef &InUniformBuffer, GLintptr InOffset, GLsizeiptr InSize)
+{
+	assert(InBindingPoint < NUM_GL_UNIFORM_BUFFER_BINDINGS);
+	FOpenGLUniformBufferStage &Stage = PendingState.UniformBufferStages[InBindingPoint];
+	if (Stage.UniformBuffer == (FOpenGLUniformBuffer*)InUniformBuffer && Stage.Offset == InOffset && Stage.Size == InSize)
+	{
+		return;
+	}
+
+	Stage.UniformBuffer = (FOpenGLUniformBuffer*)InUniformBuffer;
+	Stage.Offset = InOffset;
+	Stage.Size = InSize;
+	PendingState.DirtyUniformBuffers |= (1u << InBindingPoint);
+}
+
+void FOpenGLDrv::SetUniformBuffer(const GLchar *InBlockName, const FOpenGLUniformBufferRef &InUniformBuffer)
+{
+	SetUniformBuffer(GetUniformBlockBinding(InBlockName), InUniformBuffer);
+}
+
+GLuint FOpenGLDrv::GetUniformBlockBinding(const GLchar *InBlockName)
+{
+	std::lock_guard<std::mutex> Lock(UniformBlockMutex);
+	for (size_t Index = 0; Index < UniformBlockNames.size(); Index++)
+	{
+		if (UniformBlockNames[Index] == InBlockName)
+		{
+			return (GLuint)Index;
+		}
+	} // end for
+
+	if (UniformBlockNames.size() >= NUM_GL_UNIFORM_BUFFER_BINDINGS)
+	{
+		std::cout << "Error: Too Many Uniform Blocks, " << InBlockName << std::endl;
+		assert(false);
+		return NUM_GL_UNIFORM_BUFFER_BINDINGS - 1;
+	}
+
+	UniformBlockNames.push_back(InBlockName);
+	return (GLuint)(UniformBlockNames.size() - 1);
+}
+
+void FOpenGLDrv::SetTexture2D(GLuint TexIndex, const FOpenGLTexture2DRef &InTexture, const FOpenGLSamplerStateRef &InSamplerState)
 {
 	assert(TexIndex < NUM_GL_TEXTURE_UNITS);
-	PendingState.Texture2DStages[TexIndex].Texture2DRef = InTexture;
+	FOpenGLSamplerStage &Stage = PendingState.Texture2DStages[TexIndex];
+	if (Stage.Texture2DRef.DeRef() != InTexture.DeRef() || Stage.SamplerStateRef.DeRef() != InSamplerState.DeRef())
+	{
+		Stage.Texture2DRef = InTexture;
+		Stage.SamplerStateRef = InSamplerState;
+		PendingState.DirtyTextureUnits |= (1u << TexIndex);
+	}
 }
 
 void FOpenGLDrv::SetFrameBuffer(const FOpenGLFrameBufferRef &InFrameBuffer)
@@ -492,135 +901,336 @@ void FOpenGLDrv::BlitFramebuffer(const FOpenGLFrameBufferRef &InSrcFrameBuffer,
 	glBlitFramebuffer(0, 0, InWidth, InHeight, 0, 0, InWidth, InHeight, InMask, InFilter);
 }
 
-void FOpenGLDrv::DrawIndexedPrimitive(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount)
+void FOpenGLDrv::DrawIndexedPrimitive(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLint InBaseVertex)
 {
-	// bind shader program
-	SetupPendingShaderProgram();
-	// Set Program Parameters
-	SetupPendingShaderProgramParameters();
-	// Bind Vertex Attributes
-	SetupPendingVertexAttributeArray();
-	// Setup Texture
-	SetupPendingTexture();
+	SetupPendingDrawState(InIndexBuffer->GetGLResource());
 
 	GLenum IndexType = InIndexBuffer->GetStride() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
-	GLuint StartPtr = InStart * InIndexBuffer->GetStride();
-	CachedBindBuffer(GL_ELEMENT_ARRAY_BUFFER, InIndexBuffer->GetGLResource());
-	glDrawElements(InMode, InCount, IndexType, (GLvoid*)StartPtr);
+	size_t StartPtr = InStart * InIndexBuffer->GetStride();
+	if (InBaseVertex != 0)
+	{
+		glDrawElementsBaseVertex(InMode, InCount, IndexType, (GLvoid*)StartPtr, InBaseVertex);
+	}
+	else
+	{
+		glDrawElements(InMode, InCount, IndexType, (GLvoid*)StartPtr);
+	}
 	CheckError(__FILE__, __LINE__);
 }
 
 void FOpenGLDrv::DrawArrayedPrimitive(GLenum InMode, GLint InStart, GLsizei InCount)
 {
-	// bind shader program
-	SetupPendingShaderProgram();
-	// Set Program Parameters
-	SetupPendingShaderProgramParameters();
-	// Bind Vertex Attributes
-	SetupPendingVertexAttributeArray();
-	// Setup Texture
-	SetupPendingTexture();
+	SetupPendingDrawState(0);
 
 	glDrawArrays(InMode, InStart, InCount);
 	CheckError(__FILE__, __LINE__);
 }
 
-void FOpenGLDrv::SetupPendingShaderProgram()
+void FOpenGLDrv::DrawIndexedPrimitiveInstanced(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLsizei InInstanceCount, GLint InBaseVertex)
 {
-	assert(PendingState.ShaderProgram);
-	if (CurrentState.BindProgram != PendingState.BindProgram)
-	{
-		glUseProgram(PendingState.BindProgram);
-		CheckError(__FILE__, __LINE__);
+	SetupPendingDrawState(InIndexBuffer->GetGLResource());
 
-		CurrentState.BindProgram = PendingState.BindProgram;
+	GLenum IndexType = InIndexBuffer->GetStride() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	size_t StartPtr = InStart * InIndexBuffer->GetStride();
+	if (InBaseVertex != 0)
+	{
+		glDrawElementsInstancedBaseVertex(InMode, InCount, IndexType, (GLvoid*)StartPtr, InInstanceCount, InBaseVertex);
 	}
+	else
+	{
+		glDrawElementsInstanced(InMode, InCount, IndexType, (GLvoid*)StartPtr, InInstanceCount);
+	}
+	CheckError(__FILE__, __LINE__);
 }
 
-void FOpenGLDrv::SetupPendingVertexAttributeArray()
+void FOpenGLDrv::DrawArrayedPrimitiveInstanced(GLenum InMode, GLint InStart, GLsizei InCount, GLsizei InInstanceCount)
 {
-	assert(PendingState.VertexDeclaration);
-	GLboolean VertexAttrisEnables[NUM_GL_VERTEX_ATTRIS] = { GL_FALSE };
-	const FOpenGLVertexElementsList &VertexElementList = PendingState.VertexDeclaration->GLVertexElements;
-	for (size_t Index = 0; Index < VertexElementList.size(); Index++)
+	SetupPendingDrawState(0);
+
+	glDrawArraysInstanced(InMode, InStart, InCount, InInstanceCount);
+	CheckError(__FILE__, __LINE__);
+}
+
+void FOpenGLDrv::MultiDrawIndexedIndirect(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, const FOpenGLIndirectBufferRef &InIndirectBuffer, GLsizei InFirstCommand, GLsizei InCommandCount)
+{
+	assert(InFirstCommand >= 0 && InFirstCommand + InCommandCount <= InIndirectBuffer->GetCommandCount());
+	if (InCommandCount <= 0)
 	{
-		const FOpenGLVertexElement &Element = VertexElementList[Index];
-		const GLuint kStreamIndex = Element.StreamIndex;
-		const GLuint kAttriIndex = Element.AttributeIndex;
+		return;
+	}
 
-		assert(kStreamIndex < NUM_GL_STREAM_SOURCE);
-		assert(kAttriIndex < NUM_GL_VERTEX_ATTRIS);
-		FOpenGLVertexBuffer *SourceStream = PendingState.VertexStreams[kStreamIndex].VertexBuffer;
-		assert(SourceStream);
+	SetupPendingDrawState(InIndexBuffer->GetGLResource());
 
-		CachedEnableVertexAttributePointer(SourceStream->GetGLResource(), Element);
-		VertexAttrisEnables[kAttriIndex] = GL_TRUE;
-	} // end for
-	for (GLuint Index = 0; Index < NUM_GL_VERTEX_ATTRIS; Index++)
+	GLenum IndexType = InIndexBuffer->GetStride() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	const GLsizei kCommandStride = sizeof(FDrawElementsIndirectCommand);
+	if (bSupportsMultiDrawIndirect)
 	{
-		if (VertexAttrisEnables[Index] == GL_FALSE && CurrentState.CachedAttris[Index].Enabled)
+		CachedBindBuffer(GL_DRAW_INDIRECT_BUFFER, InIndirectBuffer->GetGLResource());
+		glMultiDrawElementsIndirect(InMode, IndexType, (GLvoid*)(size_t)(InFirstCommand * kCommandStride), InCommandCount, kCommandStride);
+	}
+	else if (bSupportsDrawIndirect)
+	{
+		CachedBindBuffer(GL_DRAW_INDIRECT_BUFFER, InIndirectBuffer->GetGLResource());
+		for (GLsizei Index = InFirstCommand; Index < InFirstCommand + InCommandCount; Index++)
 		{
-			glDisableVertexAttribArray(Index);
-			CheckError(__FILE__, __LINE__);
-			CurrentState.CachedAttris[Index].Enabled = GL_FALSE;
-		}
-	} // end for
+			glDrawElementsIndirect(InMode, IndexType, (GLvoid*)(size_t)(Index * kCommandStride));
+		} // end for
+	}
+	else
+	{
+		// emulate with the copy of commands
+		const FDrawElementsIndirectCommand *Commands = InIndirectBuffer->GetCommands();
+		for (GLsizei Index = InFirstCommand; Index < InFirstCommand + InCommandCount; Index++)
+		{
+			const FDrawElementsIndirectCommand &Command = Commands[Index];
+			GLvoid *StartPtr = (GLvoid*)(size_t)(Command.FirstIndex * InIndexBuffer->GetStride());
+			if (Command.BaseInstance != 0 && bSupportsBaseInstance)
+			{
+				glDrawElementsInstancedBaseVertexBaseInstance(InMode, Command.Count, IndexType, StartPtr, Command.InstanceCount, Command.BaseVertex, Command.BaseInstance);
+			}
+			else
+			{
+				assert(Command.BaseInstance == 0);
+				glDrawElementsInstancedBaseVertex(InMode, Command.Count, IndexType, StartPtr, Command.InstanceCount, Command.BaseVertex);
+			}
+		} // end for
+	}
+	CheckError(__FILE__, __LINE__);
 }
 
-void FOpenGLDrv::CachedEnableVertexAttributePointer(GLuint InBuffer, const FOpenGLVertexElement &InVertexElement)
+void FOpenGLDrv::ExecuteCommandList(const FOpenGLCommandList &InCommandList)
 {
-	const GLuint kAttriIndex = InVertexElement.AttributeIndex;
-	FOpenGLCachedAttri &CurrentAttri = CurrentState.CachedAttris[kAttriIndex];
+	InCommandList.Execute(*this);
+}
 
-	if (CurrentAttri.Buffer != InBuffer ||
-		CurrentAttri.Type != InVertexElement.Type ||
-		CurrentAttri.Size != InVertexElement.Size ||
-		CurrentAttri.Stride != InVertexElement.Stride ||
-		CurrentAttri.Offset != InVertexElement.Offset ||
-		CurrentAttri.Normalized != InVertexElement.Normalized)
+void FOpenGLDrv::SetupPendingDrawState(GLuint InIndexBuffer)
+{
+	// fixed function states
+	if (PendingState.DirtyFlags & GLDS_PipelineState)
+	{
+		SetupPendingPipelineState();
+	}
+	// bind shader program
+	if (PendingState.DirtyFlags & GLDS_ShaderProgram)
+	{
+		SetupPendingShaderProgram();
+	}
+	// Set Program Parameters, the values are compared with the shadow copy of program
+	SetupPendingShaderProgramParameters();
+	// Bind Uniform Buffers
+	if (PendingState.DirtyUniformBuffers)
 	{
-		CachedBindBuffer(GL_ARRAY_BUFFER, InBuffer);
-		if (InVertexElement.ShouldConvertToFloat)
+		SetupPendingUniformBuffers();
+	}
+	// Bind Vertex Attributes and Index Buffer, other vertex array may be bound for buffer update
+	if ((PendingState.DirtyFlags & GLDS_VertexArray) || CurrentState.BindVertexArray != DrawVertexArray
+		|| (InIndexBuffer != 0 && CurrentState.BindIndexBuffer != InIndexBuffer))
+	{
+		SetupPendingVertexAttributeArray(InIndexBuffer);
+	}
+	// Setup Texture
+	if (PendingState.DirtyTextureUnits)
+	{
+		SetupPendingTexture();
+	}
+	PendingState.DirtyFlags = 0;
+
+	assert(PendingState.ShaderProgram && CurrentState.BindProgram == PendingState.BindProgram);
+	assert(InIndexBuffer == 0 || CurrentState.BindIndexBuffer == InIndexBuffer);
+}
+
+void FOpenGLDrv::SetupPendingPipelineState()
+{
+	// the states are kept if no pipeline state is set
+	if (!PendingState.PipelineState || PendingState.PipelineState == CurrentState.PipelineState)
+	{
+		return;
+	}
+
+	const FPipelineStateInitializer &Initializer = PendingState.PipelineState->GetInitializer();
+	ApplyBlendState(Initializer.BlendState);
+	ApplyDepthStencilState(Initializer.DepthStencilState);
+	ApplyRasterizerState(Initializer.RasterizerState);
+	CheckError(__FILE__, __LINE__);
+
+	CurrentState.PipelineState = PendingState.PipelineState;
+}
+
+void FOpenGLDrv::ApplyBlendState(const FBlendStateInitializer &InBlendState)
+{
+	FBlendStateInitializer &Current = CurrentState.BlendState;
+	if (Current.bEnable != InBlendState.bEnable)
+	{
+		InBlendState.bEnable ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+	}
+	if (Current.ColorOp != InBlendState.ColorOp || Current.AlphaOp != InBlendState.AlphaOp)
+	{
+		glBlendEquationSeparate(InBlendState.ColorOp, InBlendState.AlphaOp);
+	}
+	if (Current.ColorSrc != InBlendState.ColorSrc || Current.ColorDst != InBlendState.ColorDst
+		|| Current.AlphaSrc != InBlendState.AlphaSrc || Current.AlphaDst != InBlendState.AlphaDst)
+	{
+		glBlendFuncSeparate(InBlendState.ColorSrc, InBlendState.ColorDst, InBlendState.AlphaSrc, InBlendState.AlphaDst);
+	}
+	if (Current.ColorWriteMask != InBlendState.ColorWriteMask)
+	{
+		const GLuint Mask = InBlendState.ColorWriteMask;
+		glColorMask((Mask & 1) != 0, (Mask & 2) != 0, (Mask & 4) != 0, (Mask & 8) != 0);
+	}
+	Current = InBlendState;
+}
+
+void FOpenGLDrv::ApplyDepthStencilState(const FDepthStencilStateInitializer &InDepthStencilState)
+{
+	FDepthStencilStateInitializer &Current = CurrentState.DepthStencilState;
+	if (Current.bDepthTest != InDepthStencilState.bDepthTest)
+	{
+		InDepthStencilState.bDepthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+	}
+	if (Current.bDepthWrite != InDepthStencilState.bDepthWrite)
+	{
+		glDepthMask(InDepthStencilState.bDepthWrite ? GL_TRUE : GL_FALSE);
+	}
+	if (Current.DepthFunc != InDepthStencilState.DepthFunc)
+	{
+		glDepthFunc(InDepthStencilState.DepthFunc);
+	}
+	if (Current.bStencilTest != InDepthStencilState.bStencilTest)
+	{
+		InDepthStencilState.bStencilTest ? glEnable(GL_STENCIL_TEST) : glDisable(GL_STENCIL_TEST);
+	}
+	if (Current.StencilFunc != InDepthStencilState.StencilFunc || Current.StencilRef != InDepthStencilState.StencilRef
+		|| Current.StencilReadMask != InDepthStencilState.StencilReadMask)
+	{
+		glStencilFunc(InDepthStencilState.StencilFunc, InDepthStencilState.StencilRef, InDepthStencilState.StencilReadMask);
+	}
+	if (Current.StencilWriteMask != InDepthStencilState.StencilWriteMask)
+	{
+		glStencilMask(InDepthStencilState.StencilWriteMask);
+	}
+	if (Current.StencilFail != InDepthStencilState.StencilFail || Current.StencilDepthFail != InDepthStencilState.StencilDepthFail
+		|| Current.StencilPass != InDepthStencilState.StencilPass)
+	{
+		glStencilOp(InDepthStencilState.StencilFail, InDepthStencilState.StencilDepthFail, InDepthStencilState.StencilPass);
+	}
+	Current = InDepthStencilState;
+}
+
+void FOpenGLDrv::ApplyRasterizerState(const FRasterizerStateInitializer &InRasterizerState)
+{
+	FRasterizerStateInitializer &Current = CurrentState.RasterizerState;
+	if (Current.CullMode != InRasterizerState.CullMode)
+	{
+		if (InRasterizerState.CullMode == GL_NONE)
 		{
-			glVertexAttribPointer(kAttriIndex, InVertexElement.Size, InVertexElement.Type, InVertexElement.Normalized, InVertexElement.Stride, (GLvoid*)InVertexElement.Offset);
+			glDisable(GL_CULL_FACE);
 		}
 		else
 		{
-			glVertexAttribIPointer(kAttriIndex, InVertexElement.Size, InVertexElement.Type, InVertexElement.Stride, (GLvoid*)InVertexElement.Offset);
+			if (Current.CullMode == GL_NONE)
+			{
+				glEnable(GL_CULL_FACE);
+			}
+			glCullFace(InRasterizerState.CullMode);
 		}
-		CheckError(__FILE__, __LINE__);
-
-		CurrentAttri.Buffer = InBuffer;
-		CurrentAttri.Type = InVertexElement.Type;
-		CurrentAttri.Size = InVertexElement.Size;
-		CurrentAttri.Stride = InVertexElement.Stride;
-		CurrentAttri.Offset = InVertexElement.Offset;
-		CurrentAttri.Normalized = InVertexElement.Normalized;
 	}
+	if (Current.FrontFace != InRasterizerState.FrontFace)
+	{
+		glFrontFace(InRasterizerState.FrontFace);
+	}
+	if (Current.FillMode != InRasterizerState.FillMode)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, InRasterizerState.FillMode);
+	}
+	const bool bDepthBias = InRasterizerState.DepthBias != 0.f || InRasterizerState.SlopeScaleDepthBias != 0.f;
+	const bool bCurrentDepthBias = Current.DepthBias != 0.f || Current.SlopeScaleDepthBias != 0.f;
+	if (bCurrentDepthBias != bDepthBias)
+	{
+		bDepthBias ? glEnable(GL_POLYGON_OFFSET_FILL) : glDisable(GL_POLYGON_OFFSET_FILL);
+	}
+	if (bDepthBias && (Current.DepthBias != InRasterizerState.DepthBias || Current.SlopeScaleDepthBias != InRasterizerState.SlopeScaleDepthBias))
+	{
+		glPolygonOffset(InRasterizerState.SlopeScaleDepthBias, InRasterizerState.DepthBias);
+	}
+	Current = InRasterizerState;
+}
 
-	if (!CurrentAttri.Enabled)
+void FOpenGLDrv::SetupPendingShaderProgram()
+{
+	assert(PendingState.ShaderProgram);
+	if (CurrentState.BindProgram != PendingState.BindProgram)
 	{
-		glEnableVertexAttribArray(kAttriIndex);
+		// first use of a program with deferred status
+		PendingState.ShaderProgram->Resolve();
+		glUseProgram(PendingState.BindProgram);
 		CheckError(__FILE__, __LINE__);
 
-		CurrentAttri.Enabled = GL_TRUE;
+		CurrentState.BindProgram = PendingState.BindProgram;
 	}
 }
 
+void FOpenGLDrv::SetupPendingVertexAttributeArray(GLuint InIndexBuffer)
+{
+	assert(PendingState.VertexDeclaration);
+	VertexArrayCache.BindVertexArray(PendingState.VertexDeclaration, PendingState.VertexStreams, InIndexBuffer);
+	DrawVertexArray = CurrentState.BindVertexArray;
+}
+
 void FOpenGLDrv::CachedBindSharedVertexArrayObject()
 {
+	if (!IsRenderThread())
+	{
+		// a vertex array is not shared by contexts, each one has its own for binding the element array buffers
+		static thread_local GLuint GContextVertexArray = 0;
+		if (GContextVertexArray == 0)
+		{
+			glGenVertexArrays(1, &GContextVertexArray);
+			glBindVertexArray(GContextVertexArray);
+		}
+		return;
+	}
+
 	if (CurrentState.SharedVertexArray == 0)
 	{
 		glGenVertexArrays(1, &CurrentState.SharedVertexArray);
-		glBindVertexArray(CurrentState.SharedVertexArray);
+	}
+	CachedBindVertexArray(CurrentState.SharedVertexArray, UNKNOWN_GL_BINDING);
+}
+
+void FOpenGLDrv::CachedBindVertexArray(GLuint InName, GLuint InIndexBuffer)
+{
+	if (CurrentState.BindVertexArray != InName)
+	{
+		glBindVertexArray(InName);
+		CheckError(__FILE__, __LINE__);
+
+		CurrentState.BindVertexArray = InName;
+		// element array buffer binding is part of vertex array
+		CurrentState.BindIndexBuffer = InIndexBuffer;
+	}
+}
+
+void FOpenGLDrv::OnDeleteVertexArray(GLuint InName)
+{
+	if (CurrentState.BindVertexArray == InName)
+	{
+		CurrentState.BindVertexArray = 0;
+		CurrentState.BindIndexBuffer = UNKNOWN_GL_BINDING;
 	}
 }
 
 void FOpenGLDrv::SetupPendingTexture()
 {
-	for (int Index = 0; Index < NUM_GL_TEXTURE_UNITS; Index++)
+	GLuint DirtyUnits = PendingState.DirtyTextureUnits;
+	for (int Index = 0; DirtyUnits != 0; Index++, DirtyUnits >>= 1)
 	{
-		FOpenGLTexture2D *Texture = (FOpenGLTexture2D*)(PendingState.Texture2DStages[Index].Texture2DRef);
+		if ((DirtyUnits & 1) == 0)
+		{
+			continue;
+		}
+
+		const FOpenGLSamplerStage &Stage = PendingState.Texture2DStages[Index];
+		FOpenGLTexture2D *Texture = (FOpenGLTexture2D*)(Stage.Texture2DRef);
 		if (!Texture)
 		{
 			CachedBindTextrue(Index, GL_TEXTURE_2D, 0);
@@ -628,7 +1238,86 @@ void FOpenGLDrv::SetupPendingTexture()
 		}
 
 		CachedBindTextrue(Index, GL_TEXTURE_2D, Texture->GetGLResource());
+		CachedBindSampler(Index, IsValidRef(Stage.SamplerStateRef) ? Stage.SamplerStateRef->GetGLResource() : 0);
 	} // end for
+	PendingState.DirtyTextureUnits = 0;
+}
+
+void FOpenGLDrv::EndFrame()
+{
+	// parameters are allocated from frame allocator
+	PendingState.ShaderParameters = nullptr;
+
+	FFrameAllocator::SharedInstance().Reset();
+
+	for (size_t Index = 0; Index < RingBuffers.size(); Index++)
+	{
+		RingBuffers[Index]->EndFrame();
+	} // end for
+
+	if (IsValidRef(TextureUploader))
+	{
+		TextureUploader->Tick();
+	}
+
+	// fill the holes of the unloaded meshes, spread over the frames
+	DefragmentBufferArenas(GL_BUFFER_ARENA_DEFRAGMENT_PAGES);
+
+	if (IsValidRef(ProgramCache))
+	{
+		std::lock_guard<std::mutex> Lock(PendingProgramStoreMutex);
+		StorePendingPrograms(false);
+	}
+
+	std::vector<FDeferredDeletion> Deletions;
+	{
+		std::lock_guard<std::mutex> Lock(DeferredDeletionMutex);
+		Deletions.swap(DeferredDeletions);
+	}
+	for (size_t Index = 0; Index < Deletions.size(); Index++)
+	{
+		const FDeferredDeletion &Deletion = Deletions[Index];
+		switch (Deletion.Type)
+		{
+		case GLOT_Buffer:
+			OnDeleteBuffer(Deletion.BufferType, Deletion.Name);
+			glDeleteBuffers(1, &Deletion.Name);
+			break;
+		case GLOT_Texture:
+			OnDeleteTexture(Deletion.Name);
+			glDeleteTextures(1, &Deletion.Name);
+			break;
+		case GLOT_Shader:
+			glDeleteShader(Deletion.Name);
+			break;
+		case GLOT_Program:
+			OnDeleteProgram(Deletion.Name);
+			glDeleteProgram(Deletion.Name);
+			break;
+		}
+	} // end for
+}
+
+void FOpenGLDrv::SetRenderThread()
+{
+	RenderThreadId.store(std::this_thread::get_id());
+}
+
+bool FOpenGLDrv::DeferDeletion(EOpenGLObjectType InType, GLuint InName, GLenum InBufferType)
+{
+	if (IsRenderThread())
+	{
+		return false;
+	}
+
+	FDeferredDeletion Deletion;
+	Deletion.Type = InType;
+	Deletion.Name = InName;
+	Deletion.BufferType = InBufferType;
+
+	std::lock_guard<std::mutex> Lock(DeferredDeletionMutex);
+	DeferredDeletions.push_back(Deletion);
+	return true;
 }
 
 void FOpenGLDrv::SetupPendingShaderProgramParameters()
@@ -649,9 +1338,31 @@ void FOpenGLDrv::SetupPendingShaderProgramParameters()
 	}
 }
 
+void FOpenGLDrv::SetupPendingUniformBuffers()
+{
+	GLuint DirtyBindings = PendingState.DirtyUniformBuffers;
+	for (GLuint Index = 0; DirtyBindings != 0; Index++, DirtyBindings >>= 1)
+	{
+		const FOpenGLUniformBufferStage &Stage = PendingState.UniformBufferStages[Index];
+		if ((DirtyBindings & 1) != 0 && Stage.UniformBuffer)
+		{
+			CachedBindUniformBuffer(Index, Stage.UniformBuffer->GetGLResource(), Stage.Offset, Stage.Size);
+		}
+	} // end for
+	PendingState.DirtyUniformBuffers = 0;
+}
+
 // bind gl-buffer
 void FOpenGLDrv::CachedBindBuffer(GLenum InType, GLuint InName)
 {
+	if (!IsRenderThread())
+	{
+		// the cache is of the render context
+		glBindBuffer(InType, InName);
+		CheckError(__FILE__, __LINE__);
+		return;
+	}
+
 	switch (InType)
 	{
 	case GL_ARRAY_BUFFER:
@@ -674,6 +1385,35 @@ void FOpenGLDrv::CachedBindBuffer(GLenum InType, GLuint InName)
 		}
 	}
 	break;
+	case GL_UNIFORM_BUFFER:
+	{
+		if (CurrentState.BindUniformBuffer != InName)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, InName);
+			CheckError(__FILE__, __LINE__);
+			CurrentState.BindUniformBuffer = InName;
+		}
+	}
+	break;
+	case GL_DRAW_INDIRECT_BUFFER:
+	{
+		if (CurrentState.BindIndirectBuffer != InName)
+		{
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, InName);
+			CheckError(__FILE__, __LINE__);
+			CurrentState.BindIndirectBuffer = InName;
+		}
+	}
+	break;
+	case GL_COPY_READ_BUFFER:
+	case GL_COPY_WRITE_BUFFER:
+	case GL_PIXEL_UNPACK_BUFFER:
+	{
+		// not used by draws, no cache
+		glBindBuffer(InType, InName);
+		CheckError(__FILE__, __LINE__);
+	}
+	break;
 	default:
 		std::cout << "Error: Not Implement Type In CachedBindBuffer()" << std::endl;
 		assert(false);
@@ -687,6 +1427,9 @@ void FOpenGLDrv::OnDeleteBuffer(GLenum InType, GLuint InName)
 	{
 	case GL_ARRAY_BUFFER:
 	{
+		// the name may be reused by a buffer set to the same stream
+		PendingState.DirtyFlags |= GLDS_VertexArray;
+		VertexArrayCache.OnDeleteBuffer(InName);
 		if (CurrentState.BindVertexBuffer == InName)
 		{
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -696,6 +1439,8 @@ void FOpenGLDrv::OnDeleteBuffer(GLenum InType, GLuint InName)
 	break;
 	case GL_ELEMENT_ARRAY_BUFFER:
 	{
+		PendingState.DirtyFlags |= GLDS_VertexArray;
+		VertexArrayCache.OnDeleteBuffer(InName);
 		if (CurrentState.BindIndexBuffer == InName)
 		{
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -703,6 +1448,40 @@ void FOpenGLDrv::OnDeleteBuffer(GLenum InType, GLuint InName)
 		}
 	}
 	break;
+	case GL_UNIFORM_BUFFER:
+	{
+		if (CurrentState.BindUniformBuffer == InName)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			CurrentState.BindUniformBuffer = 0;
+		}
+		for (GLuint Index = 0; Index < NUM_GL_UNIFORM_BUFFER_BINDINGS; Index++)
+		{
+			if (CurrentState.UniformBufferStages[Index].Buffer == InName)
+			{
+				CurrentState.UniformBufferStages[Index].Buffer = 0;
+				PendingState.DirtyUniformBuffers |= (1u << Index);
+			}
+			FOpenGLUniformBuffer *UniformBuffer = PendingState.UniformBufferStages[Index].UniformBuffer;
+			if (UniformBuffer && UniformBuffer->GetGLResource() == InName)
+			{
+				PendingState.UniformBufferStages[Index].UniformBuffer = nullptr;
+			}
+		} // end for
+	}
+	break;
+	case GL_DRAW_INDIRECT_BUFFER:
+	{
+		if (CurrentState.BindIndirectBuffer == InName)
+		{
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			CurrentState.BindIndirectBuffer = 0;
+		}
+	}
+	break;
+	case GL_COPY_WRITE_BUFFER:
+	case GL_PIXEL_UNPACK_BUFFER:
+		break;
 	default:
 		std::cout << "Error: Not Implement Type In OnDeleteBuffer()" << std::endl;
 		assert(false);
@@ -710,9 +1489,60 @@ void FOpenGLDrv::OnDeleteBuffer(GLenum InType, GLuint InName)
 	}
 }
 
+void FOpenGLDrv::CachedBindUniformBuffer(GLuint InBindingPoint, GLuint InName, GLintptr InOffset, GLsizeiptr InSize)
+{
+	assert(InBindingPoint < NUM_GL_UNIFORM_BUFFER_BINDINGS);
+
+	FOpenGLUniformBufferStage &Stage = CurrentState.UniformBufferStages[InBindingPoint];
+	if (Stage.Buffer != InName || Stage.Offset != InOffset || Stage.Size != InSize)
+	{
+		if (InSize > 0)
+		{
+			glBindBufferRange(GL_UNIFORM_BUFFER, InBindingPoint, InName, InOffset, InSize);
+		}
+		else
+		{
+			glBindBufferBase(GL_UNIFORM_BUFFER, InBindingPoint, InName);
+		}
+		CheckError(__FILE__, __LINE__);
+		Stage.Buffer = InName;
+		Stage.Offset = InOffset;
+		Stage.Size = InSize;
+		// glBindBufferBase also binds the generic binding point
+		CurrentState.BindUniformBuffer = InName;
+		// bound out of the draw setup, reconcile the binding point at next draw
+		PendingState.DirtyUniformBuffers |= (1u << InBindingPoint);
+	}
+}
+
+void FOpenGLDrv::OnCreateRingBuffer(FOpenGLRingBuffer *InRingBuffer)
+{
+	RingBuffers.push_back(InRingBuffer);
+}
+
+void FOpenGLDrv::OnDeleteRingBuffer(FOpenGLRingBuffer *InRingBuffer)
+{
+	for (size_t Index = 0; Index < RingBuffers.size(); Index++)
+	{
+		if (RingBuffers[Index] == InRingBuffer)
+		{
+			RingBuffers.erase(RingBuffers.begin() + Index);
+			break;
+		}
+	} // end for
+}
+
 void FOpenGLDrv::CachedBindTextrue(GLuint InTexUnit, GLenum InTarget, GLuint InTexName)
 {
 	assert(InTexUnit < NUM_GL_TEXTURE_UNITS);
+	if (!IsRenderThread())
+	{
+		glActiveTexture(GL_TEXTURE0 + InTexUnit);
+		glBindTexture(InTarget, InTexName);
+		CheckError(__FILE__, __LINE__);
+		return;
+	}
+
 	if (InTexUnit != CurrentState.ActivetTexUnitIndex)
 	{
 		glActiveTexture(GL_TEXTURE0 + InTexUnit);
@@ -720,16 +1550,75 @@ void FOpenGLDrv::CachedBindTextrue(GLuint InTexUnit, GLenum InTarget, GLuint InT
 		CheckError(__FILE__, __LINE__);
 	}
 
-	FOpenGLSamplerState &SamplerState = CurrentState.Texture2DUnits[InTexUnit];
-	if (SamplerState.Texture != InTexName)
+	FOpenGLTextureUnit &TextureUnit = CurrentState.Texture2DUnits[InTexUnit];
+	if (TextureUnit.Texture != InTexName)
 	{
 		assert(InTarget == GL_TEXTURE_2D);
 		glBindTexture(InTarget, InTexName);
-		SamplerState.Texture = InTexName;
+		TextureUnit.Texture = InTexName;
+		CheckError(__FILE__, __LINE__);
+		// bound out of the draw setup (e.g. texture upload), reconcile the unit at next draw
+		PendingState.DirtyTextureUnits |= (1u << InTexUnit);
+	}
+}
+
+void FOpenGLDrv::OnDeleteTexture(GLuint InName)
+{
+	// the deleted texture is unbound from the units by gl, the name may be reused by a new texture
+	for (int Index = 0; Index < NUM_GL_TEXTURE_UNITS; Index++)
+	{
+		if (CurrentState.Texture2DUnits[Index].Texture == InName)
+		{
+			CurrentState.Texture2DUnits[Index].Texture = 0;
+			PendingState.DirtyTextureUnits |= (1u << Index);
+		}
+	} // end for
+}
+
+void FOpenGLDrv::OnDeleteProgram(GLuint InName)
+{
+	// the pending program is the deleting object
+	if (PendingState.BindProgram == InName)
+	{
+		PendingState.ShaderProgram = nullptr;
+		PendingState.BindProgram = 0;
+	}
+	if (CurrentState.BindProgram == InName)
+	{
+		CurrentState.BindProgram = 0;
+		if (PendingState.ShaderProgram)
+		{
+			PendingState.DirtyFlags |= GLDS_ShaderProgram;
+		}
+	}
+}
+
+void FOpenGLDrv::CachedBindSampler(GLuint InTexUnit, GLuint InSamplerName)
+{
+	assert(InTexUnit < NUM_GL_TEXTURE_UNITS);
+	FOpenGLTextureUnit &TextureUnit = CurrentState.Texture2DUnits[InTexUnit];
+	if (TextureUnit.Sampler != InSamplerName)
+	{
+		// no active texture unit is needed
+		glBindSampler(InTexUnit, InSamplerName);
+		TextureUnit.Sampler = InSamplerName;
 		CheckError(__FILE__, __LINE__);
 	}
 }
 
+void FOpenGLDrv::OnDeleteSampler(GLuint InName)
+{
+	// the deleted sampler is unbound from the units by gl
+	for (int Index = 0; Index < NUM_GL_TEXTURE_UNITS; Index++)
+	{
+		if (CurrentState.Texture2DUnits[Index].Sampler == InName)
+		{
+			CurrentState.Texture2DUnits[Index].Sampler = 0;
+			PendingState.DirtyTextureUnits |= (1u << Index);
+		}
+	} // end for
+}
+
 // bind-render-buffer
 void FOpenGLDrv::CachedBindRenderBuffer(GLuint InName)
 {
@@ -961,6 +1850,62 @@ const GLchar* FOpenGLDrv::LookupShaderUniformTypeName(GLenum InType)
 	return kUnknown;
 }
 
+// bytes of one element of uniform type in client memory. 0 means unknown.
+GLsizei FOpenGLDrv::LookupShaderUniformTypeSize(GLenum InType)
+{
+	switch (InType)
+	{
+	case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+		return 4;
+	case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+		return 8;
+	case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+		return 12;
+	case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+	case GL_FLOAT_MAT2:
+		return 16;
+	case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2:
+		return 24;
+	case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2:
+		return 32;
+	case GL_FLOAT_MAT3:
+		return 36;
+	case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3:
+		return 48;
+	case GL_FLOAT_MAT4:
+		return 64;
+	case GL_DOUBLE:
+		return 8;
+	case GL_DOUBLE_VEC2:
+		return 16;
+	case GL_DOUBLE_VEC3:
+		return 24;
+	case GL_DOUBLE_VEC4: case GL_DOUBLE_MAT2:
+		return 32;
+	case GL_DOUBLE_MAT2x3: case GL_DOUBLE_MAT3x2:
+		return 48;
+	case GL_DOUBLE_MAT2x4: case GL_DOUBLE_MAT4x2:
+		return 64;
+	case GL_DOUBLE_MAT3:
+		return 72;
+	case GL_DOUBLE_MAT3x4: case GL_DOUBLE_MAT4x3:
+		return 96;
+	case GL_DOUBLE_MAT4:
+		return 128;
+	default:
+		break;
+	}
+
+	// samplers and images are set by glUniform1i
+	const GLchar *Name = LookupShaderUniformTypeName(InType);
+	if (Name != kUnknown)
+	{
+		return 4;
+	}
+
+	return 0;
+}
+
 const GLchar* FOpenGLDrv::LookupErrorCode(GLenum InError)
 {
 	static const FTypeNamePair kTypeNames[] =
@@ -5,16 +5,40 @@
 #ifndef __JETX_OPENGLDRV_H__
 #define __JETX_OPENGLDRV_H__
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <GL/glew.h>
 #include "GLBuffer.h"
 #include "GLShader.h"
+#include "GLProgramCache.h"
 #include "GLTexture.h"
+#include "GLSamplerState.h"
+#include "GLPipelineState.h"
 #include "GLVertexDeclaration.h"
 #include "OpenGLState.h"
+#include "GLVertexArrayCache.h"
+#include "GLRingBuffer.h"
+#include "GLTextureUploader.h"
+#include "GLBufferArena.h"
 #include "GLRenderBuffer.h"
 #include "GLFrameBuffer.h"
+#include "GLCommandList.h"
 
 
+// gl objects shared by contexts, deleted by name
+enum EOpenGLObjectType
+{
+	GLOT_Buffer,
+	GLOT_Texture,
+	GLOT_Shader,
+	GLOT_Program,
+};
+
 // OpenGL Device 
 class FOpenGLDrv
 {
@@ -28,11 +52,44 @@ public:
 	// Create Resource
 	FOpenGLVertexBufferRef CreateVertexBuffer(GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage = GL_STATIC_DRAW);
 	FOpenGLIndexBufferRef CreateIndexBuffer(GLsizeiptr InSize, const GLvoid *InData, GLuint InStride, GLenum InUsage = GL_STATIC_DRAW);
+	FOpenGLUniformBufferRef CreateUniformBuffer(GLsizeiptr InSize, const GLvoid *InData, GLenum InUsage = GL_DYNAMIC_DRAW);
+	// transient data written each frame, InType is GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER or GL_UNIFORM_BUFFER
+	FOpenGLRingBufferRef CreateRingBuffer(GLenum InType, GLsizeiptr InFrameSize, GLuint InIndexStride = sizeof(GLuint));
+	// shared arena of the static vertices or indices of a stride, created on first use
+	FOpenGLBufferArenaRef GetBufferArena(GLenum InType, GLuint InStride);
+	// compact the fragmented arenas, InMaxPages of each at most. EndFrame() compacts a few pages a frame
+	void DefragmentBufferArenas(GLuint InMaxPages = 0xFFFFFFFF);
+	FOpenGLIndirectBufferRef CreateIndirectBuffer(GLsizei InCommandCount, const FDrawElementsIndirectCommand *InCommands, GLenum InUsage = GL_DYNAMIC_DRAW);
 	FOpenGLVertexShaderRef CreateVertexShader(const GLchar *InSource, GLint InLength = -1);
 	FOpenGLPixelShaderRef CreatePixelShader(const GLchar *InSource, GLint InLength = -1);
 	FOpenGLProgramRef CreateProgram(const FOpenGLVertexShaderRef &InVertexShader, const FOpenGLPixelShaderRef &InPixelShader);
+	// from the program cache if a binary of the sources is there, otherwise compiled and stored.
+	// the shaders are output if compiled, null on a cache hit
+	FOpenGLProgramRef CreateProgram(const GLchar *InVsSource, const GLchar *InPsSource,
+		FOpenGLVertexShaderRef *OutVertexShader = nullptr, FOpenGLPixelShaderRef *OutPixelShader = nullptr);
 	FOpenGLVertexDeclarationRef CreateVertexDeclaration(const FVertexElementsList &InVertexElements);
+	// the equal element lists get the same declaration, so the meshes sharing buffers share one vertex array too.
+	// thread safe, the loader thread creates the declarations of meshes
+	FOpenGLVertexDeclarationRef GetVertexDeclaration(const FVertexElementsList &InVertexElements);
 	FOpenGLTexture2DRef CreateTexture2D(GLint InInternalFormat, GLsizei InWidth, GLsizei InHeight, GLenum InDataFormat, GLenum InDataType, const GLvoid* InData);
+	// the levels of a compressed format, e.g. from a dds file
+	FOpenGLTexture2DRef CreateCompressedTexture2D(GLenum InCompressedFormat, const std::vector<FOpenGLTextureMip> &InMips);
+	// the levels without content, filled by the texture uploader
+	FOpenGLTexture2DRef CreateTexture2DStorage(GLenum InSizedFormat, GLsizei InWidth, GLsizei InHeight, GLsizei InLevels);
+	// the staging ring of asynchronous texture uploads, created on first use
+	FOpenGLTextureUploaderRef GetTextureUploader();
+	// enable the program binary cache in InDirectory, after DeferredInitialize(). empty disables it
+	void SetProgramCacheDirectory(const std::string &InDirectory);
+	// null if disabled or not supported
+	FOpenGLProgramCacheRef GetProgramCache() const { return ProgramCache; }
+	// deferred: the shaders and programs are submitted without querying the status, the compilations run in parallel
+	// on the driver threads with parallel shader compile. a program is resolved on first use, poll IsReady() not to wait
+	void SetShaderStatusDeferred(bool bInDeferred) { bShaderStatusDeferred = bInDeferred; }
+	bool IsShaderStatusDeferred() const { return bShaderStatusDeferred; }
+	// the sampler states are immutable, the equal descriptors get the same object
+	FOpenGLSamplerStateRef GetSamplerState(const FSamplerStateInitializer &InInitializer);
+	// the pipeline states are immutable, the equal descriptors get the same object
+	FOpenGLPipelineStateRef GetPipelineState(const FPipelineStateInitializer &InInitializer);
 	FOpenGLRenderBufferRef CreateRenderBuffer(GLenum InInternalformat, GLsizei InWidth, GLsizei InHeight);
 	FOpenGLFrameBufferRef CreateFrameBuffer();
 
@@ -44,25 +101,73 @@ public:
 	void SetVertexDeclaration(const FOpenGLVertexDeclarationRef &InVertexDecl);
 	void SetShaderProgram(const FOpenGLProgramRef &InProgram);
 	void SetShaderProgramParameters(FProgramParameters *InParameters);
+	// set the program and vertex declaration of pipeline state if not null, the fixed function states are applied at draw
+	void SetPipelineState(const FOpenGLPipelineStateRef &InPipelineState);
+	void SetUniformBuffer(GLuint InBindingPoint, const FOpenGLUniformBufferRef &InUniformBuffer);
+	void SetUniformBuffer(const GLchar *InBlockName, const FOpenGLUniformBufferRef &InUniformBuffer);
+	// bind the range [InOffset, InOffset + InSize) of buffer, e.g. the uniforms in ring buffer
+	void SetUniformBuffer(GLuint InBindingPoint, const FOpenGLUniformBufferRef &InUniformBuffer, GLintptr InOffset, GLsizeiptr InSize);
 
-	void SetTexture2D(GLuint TexIndex, const FOpenGLTexture2DRef &InTexture);
+	// binding point of the named uniform block, the same name shares one binding point in all programs
+	GLuint GetUniformBlockBinding(const GLchar *InBlockName);
+
+	// without sampler state the parameters of texture are used
+	void SetTexture2D(GLuint TexIndex, const FOpenGLTexture2DRef &InTexture, const FOpenGLSamplerStateRef &InSamplerState = FOpenGLSamplerStateRef());
 	void SetFrameBuffer(const FOpenGLFrameBufferRef &InFrameBuffer);
 
-	void DrawIndexedPrimitive(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount);
+	// InBaseVertex is added to the indices, the start of sub-allocated vertices
+	void DrawIndexedPrimitive(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLint InBaseVertex = 0);
 	void DrawArrayedPrimitive(GLenum InMode, GLint InStart, GLsizei InCount);
+	// the streams with divisor advance per instance
+	void DrawIndexedPrimitiveInstanced(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, GLuint InStart, GLsizei InCount, GLsizei InInstanceCount, GLint InBaseVertex = 0);
+	void DrawArrayedPrimitiveInstanced(GLenum InMode, GLint InStart, GLsizei InCount, GLsizei InInstanceCount);
+	// draw the commands [InFirstCommand, InFirstCommand + InCommandCount) of indirect buffer,
+	// it is a loop of draws if ARB_multi_draw_indirect is missing
+	void MultiDrawIndexedIndirect(const FOpenGLIndexBufferRef &InIndexBuffer, GLenum InMode, const FOpenGLIndirectBufferRef &InIndirectBuffer, GLsizei InFirstCommand, GLsizei InCommandCount);
+
+	// replay the recorded commands in order, the shader parameters are reset after it
+	void ExecuteCommandList(const FOpenGLCommandList &InCommandList);
 
 	// Frame-Buffer operate
 	void BlitFramebuffer(const FOpenGLFrameBufferRef &InSrcFrameBuffer, const FOpenGLFrameBufferRef &InDstFrameBuffer, GLint InWidth, GLint InHeight,
 		GLbitfield InMask = (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT), GLenum InFilter = GL_NEAREST);
 
+	// end of frame, release the transient objects (shader parameters etc.) of this frame, fence the ring buffers,
+	// submit the copied texture uploads and delete the objects released off the render thread
+	void EndFrame();
+
 	// Helper Functions
 	void CheckError(const char* FILE, int LINE);
 
+	// the thread of the render context, the state cache is of it. the creator of driver by default
+	void SetRenderThread();
+	bool IsRenderThread() const { return RenderThreadId.load() == std::this_thread::get_id(); }
+	// off the render thread (e.g. a shared context, or no context) the deletion is queued for the next EndFrame(),
+	// so the cache is updated and no name is reused while cached.
+	// return false on render thread, the caller updates the cache by OnDelete*() and deletes
+	bool DeferDeletion(EOpenGLObjectType InType, GLuint InName, GLenum InBufferType = 0);
+
 	// bind gl-buffer
 	void CachedBindBuffer(GLenum InType, GLuint InName);
 	void OnDeleteBuffer(GLenum InType, GLuint InName);
+	// bind vertex-array, InIndexBuffer is the element array buffer recorded in it
+	void CachedBindVertexArray(GLuint InName, GLuint InIndexBuffer);
+	void OnDeleteVertexArray(GLuint InName);
+	// bind the shared vertex-array, element array buffer can be bound for update without touching the cached vertex-arrays
+	void CachedBindSharedVertexArrayObject();
+	// bind uniform-buffer to binding point, InSize 0 for the whole buffer
+	void CachedBindUniformBuffer(GLuint InBindingPoint, GLuint InName, GLintptr InOffset = 0, GLsizeiptr InSize = 0);
+	// ring-buffers are fenced at the end of frame
+	void OnCreateRingBuffer(FOpenGLRingBuffer *InRingBuffer);
+	void OnDeleteRingBuffer(FOpenGLRingBuffer *InRingBuffer);
 	// bind-texture
 	void CachedBindTextrue(GLuint InTexUnit, GLenum InTarget, GLuint InTexName);
+	void OnDeleteTexture(GLuint InName);
+	// the program of name is deleting, it is not cached as the used one
+	void OnDeleteProgram(GLuint InName);
+	// bind sampler to texture unit
+	void CachedBindSampler(GLuint InTexUnit, GLuint InSamplerName);
+	void OnDeleteSampler(GLuint InName);
 	// bind-render-buffer
 	void CachedBindRenderBuffer(GLuint InName);
 	// bind-frame-buffer
@@ -71,21 +176,103 @@ public:
 	// helpers
 	static const GLchar* LookupShaderAttributeTypeName(GLenum InType);
 	static const GLchar* LookupShaderUniformTypeName(GLenum InType);
+	static GLsizei LookupShaderUniformTypeSize(GLenum InType);
 	static const GLchar* LookupErrorCode(GLenum InError);
 
+	const FOpenGLVertexArrayCache& GetVertexArrayCache() const { return VertexArrayCache; }
+
+	// capabilities, valid after DeferredInitialize()
+	bool SupportsMultiDrawIndirect() const { return bSupportsMultiDrawIndirect; }
+	bool SupportsDrawIndirect() const { return bSupportsDrawIndirect; }
+	// the BaseInstance of draw commands is applied
+	bool SupportsBaseInstance() const { return bSupportsBaseInstance; }
+	// immutable storage, persistent mapping
+	bool SupportsBufferStorage() const { return bSupportsBufferStorage; }
+	// immutable texture storage
+	bool SupportsTextureStorage() const { return bSupportsTextureStorage; }
+	// DXT1/DXT5 textures, not core in gl 3.3
+	bool SupportsTextureCompressionS3TC() const { return bSupportsTextureCompressionS3TC; }
+	// glGetProgramBinary with one binary format at least
+	bool SupportsProgramBinary() const { return bSupportsProgramBinary; }
+	// KHR/ARB_parallel_shader_compile, GL_COMPLETION_STATUS is polled
+	bool SupportsParallelShaderCompile() const { return bSupportsParallelShaderCompile; }
+	bool HasExtension(const char *InName) const;
+
 protected:
 	FOpenGLDrv();
 	virtual ~FOpenGLDrv();
 
+	// with the lock held, store the linked programs to the cache
+	void StorePendingPrograms(bool bInWait);
+
+	void SetupPendingDrawState(GLuint InIndexBuffer);
 	void SetupPendingShaderProgram();
-	void SetupPendingVertexAttributeArray();
-	void CachedEnableVertexAttributePointer(GLuint InBuffer, const FOpenGLVertexElement &InVertexElement);
-	void CachedBindSharedVertexArrayObject();
+	void SetupPendingVertexAttributeArray(GLuint InIndexBuffer);
 	void SetupPendingTexture();
 	void SetupPendingShaderProgramParameters();
+	void SetupPendingUniformBuffers();
+	void SetupPendingPipelineState();
+	// apply the states differ from the current
+	void ApplyBlendState(const FBlendStateInitializer &InBlendState);
+	void ApplyDepthStencilState(const FDepthStencilStateInitializer &InDepthStencilState);
+	void ApplyRasterizerState(const FRasterizerStateInitializer &InRasterizerState);
 
 	FOpenGLState	PendingState;
 	FOpenGLState	CurrentState;
+
+	FOpenGLVertexArrayCache		VertexArrayCache;
+	// vertex array bound by last draw, it is re-bound if others are bound since
+	GLuint						DrawVertexArray;
+
+	// uniform block name of each binding point, the programs may be linked on a shared context
+	std::vector<std::string>	UniformBlockNames;
+	std::mutex					UniformBlockMutex;
+
+	std::atomic<std::thread::id>	RenderThreadId;
+
+	struct FDeferredDeletion
+	{
+		EOpenGLObjectType	Type;
+		GLuint				Name;
+		GLenum				BufferType;
+	};
+	std::vector<FDeferredDeletion>	DeferredDeletions;
+	std::mutex						DeferredDeletionMutex;
+
+	bool	bSupportsMultiDrawIndirect;
+	bool	bSupportsDrawIndirect;
+	bool	bSupportsBaseInstance;
+	bool	bSupportsBufferStorage;
+	bool	bSupportsTextureStorage;
+	bool	bSupportsTextureCompressionS3TC;
+	bool	bSupportsProgramBinary;
+	bool	bSupportsParallelShaderCompile;
+	bool	bShaderStatusDeferred;
+
+	std::vector<FOpenGLRingBuffer*>	RingBuffers;
+	std::vector<FOpenGLBufferArenaRef>	BufferArenas;
+	FOpenGLTextureUploaderRef			TextureUploader;
+	FOpenGLProgramCacheRef				ProgramCache;
+
+	// the programs compiled for the cache, stored when linked
+	struct FPendingProgramStore
+	{
+		FOpenGLProgramRef	Program;
+		uint64_t			Key;
+		std::chrono::steady_clock::time_point	Start;
+	};
+	std::vector<FPendingProgramStore>	PendingProgramStores;
+	std::mutex							PendingProgramStoreMutex;
+
+	typedef std::unordered_map<FSamplerStateInitializer, FOpenGLSamplerStateRef, FSamplerStateInitializerHash>	FSamplerStateMap;
+	FSamplerStateMap	SamplerStates;
+
+	typedef std::unordered_map<FPipelineStateInitializer, FOpenGLPipelineStateRef, FPipelineStateInitializerHash>	FPipelineStateMap;
+	FPipelineStateMap	PipelineStates;
+
+	typedef std::unordered_map<FVertexElementsList, FOpenGLVertexDeclarationRef, FVertexElementsListHash>	FVertexDeclarationMap;
+	FVertexDeclarationMap	VertexDeclarations;
+	std::mutex				VertexDeclarationMutex;
 };
 
 
@@ -9,6 +9,8 @@
 #include "GLBuffer.h"
 #include "GLShader.h"
 #include "GLTexture.h"
+#include "GLSamplerState.h"
+#include "GLPipelineState.h"
 #include "GLVertexDeclaration.h"
 #include "GLShaderParameter.h"
 
@@ -16,6 +18,19 @@
 #define	NUM_GL_STREAM_SOURCE		16
 #define NUM_GL_VERTEX_ATTRIS		16
 #define NUM_GL_TEXTURE_UNITS		8
+#define NUM_GL_UNIFORM_BUFFER_BINDINGS	16
+
+// the binding is not known, e.g. element array buffer after the vertex array changed
+#define UNKNOWN_GL_BINDING			((GLuint)-1)
+
+// dirty bits of pending state, a draw only reconciles the dirty pieces
+enum EOpenGLDirtyState
+{
+	GLDS_PipelineState	= 1 << 0,
+	GLDS_ShaderProgram	= 1 << 1,
+	GLDS_VertexArray	= 1 << 2,		// vertex declaration or streams
+	GLDS_All			= 0xFFFFFFFF,
+};
 
 // Vertex Stream State
 struct FOpenGLStream
@@ -28,44 +43,38 @@ struct FOpenGLStream
 	}
 };
 
-// Vertex Attributes State
-struct FOpenGLCachedAttri
-{
-	GLuint		Buffer;
-	GLint		Size;
-	GLenum		Type;
-	GLsizei		Stride;
-	GLuint		Offset;
-	GLboolean	Normalized;
-
-	GLboolean	Enabled;
-
-	FOpenGLCachedAttri()
-		: Buffer(0)
-		, Size(0)
-		, Type(GL_NONE)
-		, Stride(0)
-		, Offset(0)
-		, Normalized(GL_FALSE)
-		, Enabled(GL_FALSE)
-	{
-	}
-};
-
-
-// Texture Sampler State
-struct FOpenGLSamplerState
+// Texture Unit, the bound names
+struct FOpenGLTextureUnit
 {
 	GLuint		Texture;
-	FOpenGLSamplerState()
+	GLuint		Sampler;		// 0 if the parameters of texture are used
+	FOpenGLTextureUnit()
 		: Texture(0)
+		, Sampler(0)
 	{}
 };
 
 // Texture Sampler Stage
 struct FOpenGLSamplerStage
 {
-	FOpenGLTexture2DRef	Texture2DRef;
+	FOpenGLTexture2DRef		Texture2DRef;
+	FOpenGLSamplerStateRef	SamplerStateRef;
+};
+
+// Uniform Buffer Binding Point
+struct FOpenGLUniformBufferStage
+{
+	FOpenGLUniformBuffer	*UniformBuffer;
+	GLuint					Buffer;
+	GLintptr				Offset;
+	GLsizeiptr				Size;		// 0 for the whole buffer
+
+	FOpenGLUniformBufferStage()
+		: UniformBuffer(nullptr)
+		, Buffer(0)
+		, Offset(0)
+		, Size(0)
+	{}
 };
 
 struct FOpenGLState
@@ -74,34 +83,56 @@ struct FOpenGLState
 		: VertexDeclaration(nullptr)
 		, ShaderProgram(nullptr)
 		, ShaderParameters(nullptr)
+		, PipelineState(nullptr)
 		, ActivetTexUnitIndex(0)
 		, BindVertexBuffer(0)
 		, BindIndexBuffer(0)
+		, BindUniformBuffer(0)
+		, BindIndirectBuffer(0)
 		, BindProgram(0)
 		, SharedVertexArray(0)
+		, BindVertexArray(0)
 		, BindRenderBuffer(0)
 		, BindDrawFrameBuffer(0)
 		, BindReadFrameBuffer(0)
+		, DirtyFlags(GLDS_All)
+		, DirtyTextureUnits((1u << NUM_GL_TEXTURE_UNITS) - 1)
+		, DirtyUniformBuffers((1u << NUM_GL_UNIFORM_BUFFER_BINDINGS) - 1)
 	{
 	}
 
 	FOpenGLVertexDeclaration		*VertexDeclaration;
 	FOpenGLStream					VertexStreams[NUM_GL_STREAM_SOURCE];
-	FOpenGLCachedAttri				CachedAttris[NUM_GL_VERTEX_ATTRIS];
 	FOpenGLProgram					*ShaderProgram;
 	FProgramParameters				*ShaderParameters;
 
+	// fixed function states, applied from the pipeline state
+	FOpenGLPipelineState			*PipelineState;
+	FBlendStateInitializer			BlendState;
+	FDepthStencilStateInitializer	DepthStencilState;
+	FRasterizerStateInitializer		RasterizerState;
+
 	FOpenGLSamplerStage				Texture2DStages[NUM_GL_TEXTURE_UNITS];
-	FOpenGLSamplerState				Texture2DUnits[NUM_GL_TEXTURE_UNITS];
+	FOpenGLTextureUnit				Texture2DUnits[NUM_GL_TEXTURE_UNITS];
 	GLint							ActivetTexUnitIndex;
 
+	FOpenGLUniformBufferStage		UniformBufferStages[NUM_GL_UNIFORM_BUFFER_BINDINGS];
+
 	GLuint							BindVertexBuffer;
 	GLuint							BindIndexBuffer;
+	GLuint							BindUniformBuffer;
+	GLuint							BindIndirectBuffer;
 	GLuint							BindProgram;
 	GLuint							SharedVertexArray;
+	GLuint							BindVertexArray;
 	GLuint							BindRenderBuffer;
 	GLuint							BindDrawFrameBuffer;
 	GLuint							BindReadFrameBuffer;
+
+	// only used by pending state
+	GLuint							DirtyFlags;				// EOpenGLDirtyState
+	GLuint							DirtyTextureUnits;		// bit n for texture unit n
+	GLuint							DirtyUniformBuffers;	// bit n for binding point n
 };
 #endif // __JETX_GL_STATE_H__
 
@@ -0,0 +1,172 @@
+// \brief
+//		implementation of asset registry
+//
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "AssetRegistry.h"
+
+
+FAssetRegistry& FAssetRegistry::SharedInstance()
+{
+	static FAssetRegistry Registry;
+
+	return Registry;
+}
+
+std::string FAssetRegistry::CanonicalizePath(const std::string &InPath)
+{
+	std::string Path = InPath;
+	std::replace(Path.begin(), Path.end(), '\\', '/');
+#ifdef _WIN32
+	std::transform(Path.begin(), Path.end(), Path.begin(), [](char c) { return (char)::tolower((unsigned char)c); });
+#endif
+
+	const bool bAbsolute = !Path.empty() && Path[0] == '/';
+	std::vector<std::string> Segments;
+	size_t Begin = 0;
+	while (Begin <= Path.size())
+	{
+		size_t End = Path.find('/', Begin);
+		if (End == std::string::npos)
+		{
+			End = Path.size();
+		}
+
+		const std::string Segment = Path.substr(Begin, End - Begin);
+		if (Segment == "..")
+		{
+			if (!Segments.empty() && Segments.back() != "..")
+			{
+				Segments.pop_back();
+			}
+			else if (!bAbsolute)
+			{
+				Segments.push_back(Segment);
+			}
+		}
+		else if (!Segment.empty() && Segment != ".")
+		{
+			Segments.push_back(Segment);
+		}
+		Begin = End + 1;
+	} // end while
+
+	std::string Canonical = bAbsolute ? "/" : "";
+	for (size_t Index = 0; Index < Segments.size(); Index++)
+	{
+		if (Index > 0)
+		{
+			Canonical += '/';
+		}
+		Canonical += Segments[Index];
+	} // end for
+
+	return Canonical;
+}
+
+std::string FAssetRegistry::MakeKey(const char *InType, const std::string &InPath, unsigned int InOptions)
+{
+	char Options[16];
+	snprintf(Options, sizeof(Options), "#%08x", InOptions);
+
+	return std::string(InType) + ':' + CanonicalizePath(InPath) + Options;
+}
+
+FRefCountedObjectRef FAssetRegistry::Find(const std::string &InKey)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	std::map<std::string, FAssetEntry>::iterator itr = Assets.find(InKey);
+	if (itr != Assets.end() && itr->second.Asset->TryRetain())
+	{
+		Stats.Hits++;
+		// retained by TryRetain()
+		return FRefCountedObjectRef(itr->second.Asset, false);
+	}
+	Stats.Misses++;
+
+	return nullptr;
+}
+
+FRefCountedObjectRef FAssetRegistry::Register(const std::string &InKey, FRefCountedObject *InAsset)
+{
+	assert(InAsset && InAsset->RetainCount() > 0);
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	std::map<std::string, FAssetEntry>::iterator itr = Assets.find(InKey);
+	if (itr != Assets.end())
+	{
+		if (itr->second.Asset == InAsset)
+		{
+			return InAsset;
+		}
+		if (itr->second.Asset->TryRetain())
+		{
+			// loaded by another thread meanwhile
+			return FRefCountedObjectRef(itr->second.Asset, false);
+		}
+		// the old one is being destroyed, its Unregister() skips the key
+	}
+
+	FAssetEntry Entry;
+	Entry.Asset = InAsset;
+	Entry.bResident = false;
+	Assets[InKey] = Entry;
+	AssetKeys[InAsset] = InKey;
+
+	return InAsset;
+}
+
+void FAssetRegistry::Unregister(FRefCountedObject *InAsset)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	std::map<FRefCountedObject*, std::string>::iterator itr = AssetKeys.find(InAsset);
+	if (itr == AssetKeys.end())
+	{
+		return;
+	}
+
+	std::map<std::string, FAssetEntry>::iterator AssetItr = Assets.find(itr->second);
+	if (AssetItr != Assets.end() && AssetItr->second.Asset == InAsset)
+	{
+		Assets.erase(AssetItr);
+	}
+	AssetKeys.erase(itr);
+	Stats.Unloads++;
+}
+
+void FAssetRegistry::SetResident(FRefCountedObject *InAsset, bool bInResident)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	std::map<FRefCountedObject*, std::string>::iterator itr = AssetKeys.find(InAsset);
+	if (itr != AssetKeys.end())
+	{
+		Assets[itr->second].bResident = bInResident;
+	}
+}
+
+FAssetRegistryStats FAssetRegistry::GetStats()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	return Stats;
+}
+
+void FAssetRegistry::DumpAssets()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	std::cout << "======== Assets: " << Assets.size() << ", Hits: " << Stats.Hits << ", Misses: " << Stats.Misses << ", Unloads: " << Stats.Unloads << std::endl;
+	for (std::map<std::string, FAssetEntry>::iterator itr = Assets.begin(); itr != Assets.end(); itr++)
+	{
+		std::cout << "  " << itr->first << ", Refs: " << itr->second.Asset->RetainCount() << (itr->second.bResident ? ", Resident" : "") << std::endl;
+	} // end for
+}
@@ -0,0 +1,74 @@
+// \brief
+//		registry of loaded assets, deduplicated by canonical path and import options
+//
+
+#ifndef __JETX_SCENE_ASSET_REGISTRY_H__
+#define __JETX_SCENE_ASSET_REGISTRY_H__
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <Common/RefCounting.h>
+
+
+// statistics of asset registry
+struct FAssetRegistryStats
+{
+	FAssetRegistryStats()
+		: Hits(0)
+		, Misses(0)
+		, Unloads(0)
+	{}
+
+	unsigned int	Hits;		// an alive asset returned
+	unsigned int	Misses;		// loaded from file
+	unsigned int	Unloads;	// asset destroyed on last release
+};
+
+// \brief
+//	the registry holds weak references, an asset is not kept alive by it.
+//	the asset unregisters itself in destructor, so it is unloaded on the last release.
+//	thread safe, the lookup may race with the last release, TryRetain() decides the winner.
+class FAssetRegistry
+{
+public:
+	static FAssetRegistry& SharedInstance();
+
+	// '\' to '/', "." and ".." resolved, lower case on windows
+	static std::string CanonicalizePath(const std::string &InPath);
+	// key of an asset type, file and import options
+	static std::string MakeKey(const char *InType, const std::string &InPath, unsigned int InOptions);
+
+	// the alive asset of key, null if none
+	FRefCountedObjectRef Find(const std::string &InKey);
+	// register a referenced asset, if an alive one has the key already it is kept and returned
+	FRefCountedObjectRef Register(const std::string &InKey, FRefCountedObject *InAsset);
+	// called by the destructor of asset
+	void Unregister(FRefCountedObject *InAsset);
+	// the gl resources of asset are created or released, ignored if not registered
+	void SetResident(FRefCountedObject *InAsset, bool bInResident);
+
+	FAssetRegistryStats GetStats();
+	// print the alive assets with their reference counts and residency
+	void DumpAssets();
+
+private:
+	FAssetRegistry() {}
+	FAssetRegistry(const FAssetRegistry&) = delete;
+	FAssetRegistry& operator=(const FAssetRegistry&) = delete;
+
+	struct FAssetEntry
+	{
+		FRefCountedObject	*Asset;
+		bool				bResident;
+	};
+
+	std::mutex		Mutex;
+	std::map<std::string, FAssetEntry>			Assets;
+	std::map<FRefCountedObject*, std::string>	AssetKeys;
+
+	FAssetRegistryStats	Stats;
+};
+
+#endif // __JETX_SCENE_ASSET_REGISTRY_H__
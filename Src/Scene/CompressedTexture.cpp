@@ -0,0 +1,338 @@
+// \brief
+//		implementation of compressed texture
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <SOIL.h>
+extern "C" {
+#include <image_DXT.h>
+}
+#include <image_helper.h>
+
+#include <Common/UtilityHelper.h>
+#include <OpenGL/OpenGLDrv.h>
+#include "CompressedTexture.h"
+
+
+#define MAKE_FOURCC(a, b, c, d)	((unsigned int)(a) | ((unsigned int)(b) << 8) | ((unsigned int)(c) << 16) | ((unsigned int)(d) << 24))
+
+static const unsigned int kFourCC_DDS = MAKE_FOURCC('D', 'D', 'S', ' ');
+static const unsigned int kFourCC_DXT1 = MAKE_FOURCC('D', 'X', 'T', '1');
+static const unsigned int kFourCC_DXT5 = MAKE_FOURCC('D', 'X', 'T', '5');
+static const unsigned int kFourCC_ATI2 = MAKE_FOURCC('A', 'T', 'I', '2');
+static const unsigned int kFourCC_BC5U = MAKE_FOURCC('B', 'C', '5', 'U');
+// dwReserved1[0] of the cooked files, followed by the stamp of source
+static const unsigned int kFourCC_Stamp = MAKE_FOURCC('J', 'E', 'T', 'X');
+
+
+// BC4: two endpoints and a 3-bit index per texel, the endpoint max first selects 8 interpolated values
+static void EncodeBC4Block(const unsigned char InValues[16], unsigned char OutBlock[8])
+{
+	unsigned char MaxValue = InValues[0], MinValue = InValues[0];
+	for (int k = 1; k < 16; k++)
+	{
+		MaxValue = std::max(MaxValue, InValues[k]);
+		MinValue = std::min(MinValue, InValues[k]);
+	} // end for k
+
+	int Palette[8];
+	Palette[0] = MaxValue;
+	Palette[1] = MinValue;
+	for (int k = 1; k < 7; k++)
+	{
+		Palette[k + 1] = ((7 - k) * MaxValue + k * MinValue + 3) / 7;
+	} // end for k
+
+	unsigned long long Bits = 0;
+	for (int k = 0; k < 16; k++)
+	{
+		int Best = 0;
+		for (int Code = 1; Code < 8; Code++)
+		{
+			if (std::abs(InValues[k] - Palette[Code]) < std::abs(InValues[k] - Palette[Best]))
+			{
+				Best = Code;
+			}
+		} // end for Code
+		Bits |= (unsigned long long)Best << (3 * k);
+	} // end for k
+
+	OutBlock[0] = MaxValue;
+	OutBlock[1] = MinValue;
+	for (int k = 0; k < 6; k++)
+	{
+		OutBlock[2 + k] = (unsigned char)(Bits >> (8 * k));
+	} // end for k
+}
+
+// BC5: the red and green channels of rgba texels as two BC4 blocks, the edge texels are repeated
+static void CompressBC5(const unsigned char *InRGBA, int InWidth, int InHeight, std::vector<unsigned char> &OutData)
+{
+	for (int BlockY = 0; BlockY < InHeight; BlockY += 4)
+	{
+		for (int BlockX = 0; BlockX < InWidth; BlockX += 4)
+		{
+			unsigned char Red[16], Green[16];
+			for (int k = 0; k < 16; k++)
+			{
+				const int X = std::min(BlockX + (k & 3), InWidth - 1);
+				const int Y = std::min(BlockY + (k >> 2), InHeight - 1);
+				Red[k] = InRGBA[(Y * InWidth + X) * 4 + 0];
+				Green[k] = InRGBA[(Y * InWidth + X) * 4 + 1];
+			} // end for k
+
+			unsigned char Block[16];
+			EncodeBC4Block(Red, Block);
+			EncodeBC4Block(Green, Block + 8);
+			OutData.insert(OutData.end(), Block, Block + 16);
+		} // end for BlockX
+	} // end for BlockY
+}
+
+static void CompressLevel(const unsigned char *InRGBA, int InWidth, int InHeight, unsigned int InFourCC, std::vector<unsigned char> &OutData)
+{
+	if (InFourCC == kFourCC_ATI2)
+	{
+		CompressBC5(InRGBA, InWidth, InHeight, OutData);
+		return;
+	}
+
+	int Size = 0;
+	unsigned char *Compressed = InFourCC == kFourCC_DXT5 ? convert_image_to_DXT5(InRGBA, InWidth, InHeight, 4, &Size)
+		: convert_image_to_DXT1(InRGBA, InWidth, InHeight, 4, &Size);
+	if (Compressed)
+	{
+		OutData.insert(OutData.end(), Compressed, Compressed + Size);
+		free(Compressed);
+	}
+}
+
+static bool IsHeaderValid(const DDS_header &InHeader, const std::string &InSourceFilename)
+{
+	if (InHeader.dwMagic != kFourCC_DDS || InHeader.dwSize != 124 || !(InHeader.sPixelFormat.dwFlags & DDPF_FOURCC)
+		|| InHeader.dwWidth == 0 || InHeader.dwHeight == 0)
+	{
+		return false;
+	}
+
+	const unsigned int kFourCC = InHeader.sPixelFormat.dwFourCC;
+	if (kFourCC != kFourCC_DXT1 && kFourCC != kFourCC_DXT5 && kFourCC != kFourCC_ATI2 && kFourCC != kFourCC_BC5U)
+	{
+		return false;
+	}
+
+	// the stamp of source, the source may be absent when only the dds files are shipped
+	unsigned long long SourceSize = 0;
+	long long SourceTime = 0;
+	if (InHeader.dwReserved1[0] == kFourCC_Stamp && FUtilityHelper::GetFileStamp(InSourceFilename.c_str(), SourceSize, SourceTime))
+	{
+		return InHeader.dwReserved1[1] == (unsigned int)SourceSize && InHeader.dwReserved1[2] == (unsigned int)(SourceSize >> 32)
+			&& InHeader.dwReserved1[3] == (unsigned int)SourceTime && InHeader.dwReserved1[4] == (unsigned int)((unsigned long long)SourceTime >> 32);
+	}
+
+	return true;
+}
+
+bool FCompressedTexture::Cook(const std::string &InSourceFilename, ETextureUsage InUsage)
+{
+	unsigned long long SourceSize = 0;
+	long long SourceTime = 0;
+	if (!FUtilityHelper::GetFileStamp(InSourceFilename.c_str(), SourceSize, SourceTime))
+	{
+		std::cout << "Error: Cook Texture, Source Not Found: " << InSourceFilename << std::endl;
+		return false;
+	}
+
+	int Width = 0, Height = 0, Channels = 0;
+	unsigned char *Image = SOIL_load_image(InSourceFilename.c_str(), &Width, &Height, &Channels, SOIL_LOAD_RGBA);
+	if (!Image)
+	{
+		std::cout << "Error: Cook Texture, Decode Failed: " << InSourceFilename << std::endl;
+		return false;
+	}
+	std::vector<unsigned char> Level(Image, Image + Width * Height * 4);
+	SOIL_free_image_data(Image);
+
+	// the alpha is kept only if it is used
+	bool bAlpha = false;
+	if (InUsage == TU_Color && (Channels == 2 || Channels == 4))
+	{
+		for (size_t Index = 3; Index < Level.size() && !bAlpha; Index += 4)
+		{
+			bAlpha = Level[Index] < 255;
+		} // end for
+	}
+	const unsigned int kFourCC = InUsage == TU_Normal ? kFourCC_ATI2 : (bAlpha ? kFourCC_DXT5 : kFourCC_DXT1);
+
+	// the mip chain down to 1x1, box filtered
+	std::vector<unsigned char> Data;
+	unsigned int NumMips = 0;
+	int LevelWidth = Width, LevelHeight = Height;
+	while (true)
+	{
+		CompressLevel(Level.data(), LevelWidth, LevelHeight, kFourCC, Data);
+		NumMips++;
+		if (LevelWidth == 1 && LevelHeight == 1)
+		{
+			break;
+		}
+
+		const int kMipWidth = std::max(1, LevelWidth / 2);
+		const int kMipHeight = std::max(1, LevelHeight / 2);
+		std::vector<unsigned char> Mip(kMipWidth * kMipHeight * 4);
+		mipmap_image(Level.data(), LevelWidth, LevelHeight, 4, Mip.data(), 2, 2);
+		Level.swap(Mip);
+		LevelWidth = kMipWidth;
+		LevelHeight = kMipHeight;
+	} // end while
+
+	DDS_header Header;
+	memset(&Header, 0, sizeof(Header));
+	Header.dwMagic = kFourCC_DDS;
+	Header.dwSize = 124;
+	Header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE | DDSD_MIPMAPCOUNT;
+	Header.dwWidth = Width;
+	Header.dwHeight = Height;
+	Header.dwPitchOrLinearSize = ((Width + 3) / 4) * ((Height + 3) / 4) * (kFourCC == kFourCC_DXT1 ? 8 : 16);
+	Header.dwMipMapCount = NumMips;
+	Header.dwReserved1[0] = kFourCC_Stamp;
+	Header.dwReserved1[1] = (unsigned int)SourceSize;
+	Header.dwReserved1[2] = (unsigned int)(SourceSize >> 32);
+	Header.dwReserved1[3] = (unsigned int)SourceTime;
+	Header.dwReserved1[4] = (unsigned int)((unsigned long long)SourceTime >> 32);
+	Header.sPixelFormat.dwSize = 32;
+	Header.sPixelFormat.dwFlags = DDPF_FOURCC;
+	Header.sPixelFormat.dwFourCC = kFourCC;
+	Header.sCaps.dwCaps1 = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+	const std::string CompressedFilename = GetCompressedFilename(InSourceFilename);
+	std::ofstream File(CompressedFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	File.write((const char*)&Header, sizeof(Header));
+	File.write((const char*)Data.data(), Data.size());
+	File.close();
+	if (!File)
+	{
+		std::cout << "Error: Write Compressed Texture Failed: " << CompressedFilename << std::endl;
+		std::remove(CompressedFilename.c_str());
+		return false;
+	}
+
+	const char *FormatName = kFourCC == kFourCC_ATI2 ? "BC5" : (kFourCC == kFourCC_DXT5 ? "BC3" : "BC1");
+	std::cout << "Info: Cooked Texture: " << CompressedFilename << ", " << FormatName << ", " << Width << "x" << Height
+		<< ", Mips: " << NumMips << ", " << Data.size() / 1024 << "KB" << std::endl;
+	return true;
+}
+
+bool FCompressedTexture::IsUpToDate(const std::string &InSourceFilename)
+{
+	FMappedFileRef File = FMappedFile::Open(GetCompressedFilename(InSourceFilename));
+	if (!IsValidRef(File) || File->GetSize() < sizeof(DDS_header))
+	{
+		return false;
+	}
+
+	DDS_header Header;
+	memcpy(&Header, File->GetData(), sizeof(Header));
+	return IsHeaderValid(Header, InSourceFilename);
+}
+
+FCompressedTextureRef FCompressedTexture::Load(const std::string &InSourceFilename)
+{
+	const std::string CompressedFilename = GetCompressedFilename(InSourceFilename);
+	FMappedFileRef File = FMappedFile::Open(CompressedFilename);
+	if (!IsValidRef(File))
+	{
+		return nullptr;
+	}
+
+	DDS_header Header;
+	if (File->GetSize() < sizeof(Header))
+	{
+		std::cout << "Error: Compressed Texture Is Corrupted: " << CompressedFilename << std::endl;
+		return nullptr;
+	}
+	memcpy(&Header, File->GetData(), sizeof(Header));
+	if (!IsHeaderValid(Header, InSourceFilename))
+	{
+		std::cout << "Info: Compressed Texture Is Stale Or Unsupported: " << CompressedFilename << std::endl;
+		return nullptr;
+	}
+
+	// rgtc is core, the decoded image is used if s3tc is not supported
+	const unsigned int kFourCC = Header.sPixelFormat.dwFourCC;
+	if ((kFourCC == kFourCC_DXT1 || kFourCC == kFourCC_DXT5) && !FOpenGLDrv::SharedInstance().SupportsTextureCompressionS3TC())
+	{
+		std::cout << "Info: S3TC Is Not Supported: " << CompressedFilename << std::endl;
+		return nullptr;
+	}
+
+	FCompressedTextureRef Texture = new FCompressedTexture();
+	Texture->File = File;
+
+	const GLsizei kBlockBytes = kFourCC == kFourCC_DXT1 ? 8 : 16;
+	if (kFourCC == kFourCC_DXT1)
+	{
+		Texture->Format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	}
+	else if (kFourCC == kFourCC_DXT5)
+	{
+		Texture->Format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	else
+	{
+		Texture->Format = GL_COMPRESSED_RG_RGTC2;
+	}
+
+	const unsigned int kNumMips = (Header.dwFlags & DDSD_MIPMAPCOUNT) ? std::max(1u, Header.dwMipMapCount) : 1;
+	size_t Offset = sizeof(Header);
+	GLsizei LevelWidth = Header.dwWidth, LevelHeight = Header.dwHeight;
+	for (unsigned int Level = 0; Level < kNumMips; Level++)
+	{
+		FOpenGLTextureMip Mip;
+		Mip.Width = LevelWidth;
+		Mip.Height = LevelHeight;
+		Mip.Size = ((LevelWidth + 3) / 4) * ((LevelHeight + 3) / 4) * kBlockBytes;
+		if ((size_t)Mip.Size > File->GetSize() - Offset)
+		{
+			std::cout << "Error: Compressed Texture Is Corrupted: " << CompressedFilename << std::endl;
+			return nullptr;
+		}
+		Mip.Data = File->GetData() + Offset;
+		Texture->Mips.push_back(Mip);
+
+		Offset += Mip.Size;
+		LevelWidth = std::max(1, LevelWidth / 2);
+		LevelHeight = std::max(1, LevelHeight / 2);
+	} // end for
+
+	return Texture;
+}
+
+size_t FCompressedTexture::GetDataSize(int InFirstMip) const
+{
+	size_t Size = 0;
+	for (size_t Index = (size_t)InFirstMip; Index < Mips.size(); Index++)
+	{
+		Size += Mips[Index].Size;
+	} // end for
+
+	return Size;
+}
+
+size_t FCompressedTexture::GetUncompressedSize() const
+{
+	const size_t kTexelBytes = Format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 4 : 3;
+	size_t Size = 0;
+	for (size_t Index = 0; Index < Mips.size(); Index++)
+	{
+		Size += (size_t)Mips[Index].Width * Mips[Index].Height * kTexelBytes;
+	} // end for
+
+	return Size;
+}
@@ -0,0 +1,60 @@
+// \brief
+//		block compressed texture with the mip chain, cooked offline to a dds file
+//
+
+#ifndef __JETX_SCENE_COMPRESSED_TEXTURE_H__
+#define __JETX_SCENE_COMPRESSED_TEXTURE_H__
+
+#include <string>
+#include <vector>
+
+#include <Common/MappedFile.h>
+#include <Common/RefCounting.h>
+#include <OpenGL/GLTexture.h>
+
+
+// how the texture is sampled, decides the compressed format
+enum ETextureUsage
+{
+	TU_Color,		// BC1, or BC3 if any texel is not opaque
+	TU_Normal,		// BC5, x and y of the normal, z = sqrt(1 - x*x - y*y). blue reads 0, no shader samples "normalTex" yet
+};
+
+class FCompressedTexture;
+typedef TRefCountPtr<FCompressedTexture>	FCompressedTextureRef;
+
+// \brief
+//	the file is "<source>.dds" with the stamp of source in the reserved words of header,
+//	it is rejected if the source is changed later. the dds files of other tools are loaded too.
+//	the levels point into the mapped file, which is kept until the texture is released.
+class FCompressedTexture : public FRefCountedObject
+{
+public:
+	static std::string GetCompressedFilename(const std::string &InSourceFilename) { return InSourceFilename + ".dds"; }
+
+	// decode the source, build the mip chain, compress each level and write the dds file
+	static bool Cook(const std::string &InSourceFilename, ETextureUsage InUsage);
+	static bool IsUpToDate(const std::string &InSourceFilename);
+
+	// null if there is no valid dds file, or its format is not supported by the driver. no gl call
+	static FCompressedTextureRef Load(const std::string &InSourceFilename);
+
+	GLenum GetFormat() const { return Format; }
+	int GetWidth() const { return Mips.empty() ? 0 : Mips[0].Width; }
+	int GetHeight() const { return Mips.empty() ? 0 : Mips[0].Height; }
+	const std::vector<FOpenGLTextureMip>& GetMips() const { return Mips; }
+
+	// bytes of the levels from InFirstMip, in file and in video memory
+	size_t GetDataSize(int InFirstMip = 0) const;
+	// the uncompressed rgb(a) of the same levels, for the statistics
+	size_t GetUncompressedSize() const;
+
+private:
+	FCompressedTexture() : Format(0) {}
+
+	FMappedFileRef					File;
+	GLenum							Format;
+	std::vector<FOpenGLTextureMip>	Mips;
+};
+
+#endif // __JETX_SCENE_COMPRESSED_TEXTURE_H__
@@ -0,0 +1,552 @@
+// \brief
+//		implementation of cooked model
+//
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#include <Common/MappedFile.h>
+#include <Common/UtilityHelper.h>
+#include "CookedModel.h"
+#include "SkinMesh.h"
+
+
+// sequential writing of the sections
+class FCookedWriter
+{
+public:
+	void Write(const void *InData, size_t InSize)
+	{
+		const unsigned char *Bytes = (const unsigned char*)InData;
+		Buffer.insert(Buffer.end(), Bytes, Bytes + InSize);
+	}
+
+	void WriteU32(uint32_t InValue) { Write(&InValue, sizeof(InValue)); }
+	void WriteI32(int32_t InValue) { Write(&InValue, sizeof(InValue)); }
+	void WriteF32(float InValue) { Write(&InValue, sizeof(InValue)); }
+	void WriteF64(double InValue) { Write(&InValue, sizeof(InValue)); }
+
+	void WriteString(const std::string &InString)
+	{
+		WriteU32((uint32_t)InString.size());
+		Write(InString.data(), InString.size());
+	}
+
+	void Align()
+	{
+		Buffer.resize((Buffer.size() + COOKED_MODEL_ALIGNMENT - 1) & ~(size_t)(COOKED_MODEL_ALIGNMENT - 1), 0);
+	}
+
+	std::vector<unsigned char>	Buffer;
+};
+
+// sequential reading of the mapped file, a read past the end marks the reader overflowed
+class FCookedReader
+{
+public:
+	FCookedReader(const unsigned char *InData, size_t InSize)
+		: Data(InData)
+		, Size(InSize)
+		, Offset(0)
+		, bOverflow(false)
+	{}
+
+	// pointer into the mapping, null if overflowed
+	const void* Skip(size_t InSize)
+	{
+		if (bOverflow || InSize > Size - Offset)
+		{
+			bOverflow = true;
+			return nullptr;
+		}
+
+		const void *Ptr = Data + Offset;
+		Offset += InSize;
+		return Ptr;
+	}
+
+	// checked before an array is read, so a broken count doesn't make a huge allocation
+	bool CanRead(size_t InCount, size_t InElementSize)
+	{
+		if (bOverflow || InCount > (Size - Offset) / InElementSize)
+		{
+			bOverflow = true;
+		}
+		return !bOverflow;
+	}
+
+	void Read(void *OutData, size_t InSize)
+	{
+		const void *Ptr = Skip(InSize);
+		if (Ptr)
+		{
+			memcpy(OutData, Ptr, InSize);
+		}
+	}
+
+	uint32_t ReadU32() { uint32_t Value = 0; Read(&Value, sizeof(Value)); return Value; }
+	int32_t ReadI32() { int32_t Value = 0; Read(&Value, sizeof(Value)); return Value; }
+	float ReadF32() { float Value = 0.f; Read(&Value, sizeof(Value)); return Value; }
+	double ReadF64() { double Value = 0.0; Read(&Value, sizeof(Value)); return Value; }
+
+	std::string ReadString()
+	{
+		const uint32_t kLength = ReadU32();
+		const char *Chars = (const char*)Skip(kLength);
+		return Chars ? std::string(Chars, kLength) : std::string();
+	}
+
+	void Align()
+	{
+		const size_t kAligned = (Offset + COOKED_MODEL_ALIGNMENT - 1) & ~(size_t)(COOKED_MODEL_ALIGNMENT - 1);
+		Skip(kAligned - Offset);
+	}
+
+	bool IsOverflow() const { return bOverflow; }
+
+private:
+	const unsigned char	*Data;
+	size_t			Size;
+	size_t			Offset;
+	bool			bOverflow;
+};
+
+//===========================================================================================
+
+// the source may be absent when only the cooked files are shipped
+static bool IsHeaderValid(const FCookedModelHeader &InHeader, size_t InFileSize, const std::string &InSourceFilename, unsigned int InImportFlags)
+{
+	if (InHeader.Magic != COOKED_MODEL_MAGIC || InHeader.Version != COOKED_MODEL_VERSION || InHeader.FileSize != InFileSize
+		|| InHeader.ImportFlags != InImportFlags || InHeader.VertexSize != sizeof(FVertex) || InHeader.VertexSkinSize != sizeof(FVertexSkin))
+	{
+		return false;
+	}
+
+	unsigned long long SourceSize = 0;
+	long long SourceTime = 0;
+	if (FUtilityHelper::GetFileStamp(InSourceFilename.c_str(), SourceSize, SourceTime))
+	{
+		return InHeader.SourceSize == SourceSize && InHeader.SourceTime == SourceTime;
+	}
+
+	return true;
+}
+
+static void Cooked_WriteTexture(FCookedWriter &Writer, const FTexture2DRef &InTexture)
+{
+	Writer.WriteString(IsValidRef(InTexture) ? InTexture->GetFilename() : std::string());
+}
+
+static void Cooked_WriteVectorKeys(FCookedWriter &Writer, const std::vector<FKeyFrame_Vector> &InKeys)
+{
+	Writer.WriteU32((uint32_t)InKeys.size());
+	for (size_t Index = 0; Index < InKeys.size(); Index++)
+	{
+		Writer.WriteF64(InKeys[Index].Time);
+		Writer.WriteF32(InKeys[Index].Value.x);
+		Writer.WriteF32(InKeys[Index].Value.y);
+		Writer.WriteF32(InKeys[Index].Value.z);
+	} // end for
+}
+
+static void Cooked_ReadVectorKeys(FCookedReader &Reader, std::vector<FKeyFrame_Vector> &OutKeys)
+{
+	const uint32_t kNumKeys = Reader.ReadU32();
+	if (!Reader.CanRead(kNumKeys, sizeof(double) + sizeof(float) * 3))
+	{
+		return;
+	}
+
+	OutKeys.resize(kNumKeys);
+	for (uint32_t Index = 0; Index < kNumKeys; Index++)
+	{
+		OutKeys[Index].Time = Reader.ReadF64();
+		OutKeys[Index].Value.x = Reader.ReadF32();
+		OutKeys[Index].Value.y = Reader.ReadF32();
+		OutKeys[Index].Value.z = Reader.ReadF32();
+	} // end for
+}
+
+bool FCookedModel::Cook(const FModel &InModel, const std::string &InSourceFilename, unsigned int InImportFlags)
+{
+	FCookedModelHeader Header;
+	memset(&Header, 0, sizeof(Header));
+	Header.Magic = COOKED_MODEL_MAGIC;
+	Header.Version = COOKED_MODEL_VERSION;
+	Header.ImportFlags = InImportFlags;
+	Header.VertexSize = sizeof(FVertex);
+	Header.VertexSkinSize = sizeof(FVertexSkin);
+	unsigned long long SourceSize = 0;
+	long long SourceTime = 0;
+	if (!FUtilityHelper::GetFileStamp(InSourceFilename.c_str(), SourceSize, SourceTime))
+	{
+		std::cout << "Error: Cook Model, Source Not Found: " << InSourceFilename << std::endl;
+		return false;
+	}
+	Header.SourceSize = SourceSize;
+	Header.SourceTime = SourceTime;
+
+	FCookedWriter Writer;
+	Writer.Write(&Header, sizeof(Header));
+
+	// materials
+	Writer.WriteU32((uint32_t)InModel.Materials.size());
+	for (size_t Index = 0; Index < InModel.Materials.size(); Index++)
+	{
+		const FMaterialRef &Material = InModel.Materials[Index];
+		Cooked_WriteTexture(Writer, Material->TexDiffuse);
+		Cooked_WriteTexture(Writer, Material->TexSpecular);
+		Cooked_WriteTexture(Writer, Material->TexNormal);
+	} // end for
+
+	// meshes
+	Writer.WriteU32((uint32_t)InModel.Meshes.size());
+	for (size_t Index = 0; Index < InModel.Meshes.size(); Index++)
+	{
+		FMesh *Mesh = InModel.Meshes[Index];
+
+		uint32_t MaterialIdx = 0;
+		while (MaterialIdx < InModel.Materials.size() && InModel.Materials[MaterialIdx] != Mesh->Material)
+		{
+			MaterialIdx++;
+		} // end while
+		assert(MaterialIdx < InModel.Materials.size());
+
+		const size_t kNumVertices = Mesh->VertexBuffer->GetVertexCount();
+		const size_t kNumIndices = Mesh->IndexBuffer->GetElementCount();
+		Writer.WriteU32(MaterialIdx);
+		Writer.WriteU32((uint32_t)Mesh->PrimitiveMode);
+		Writer.WriteU32(Mesh->IsSkinned() ? 1 : 0);
+		Writer.WriteU32((uint32_t)kNumVertices);
+		Writer.WriteU32((uint32_t)kNumIndices);
+
+		Writer.Align();
+		Writer.Write(Mesh->VertexBuffer->GetVertexData(), kNumVertices * sizeof(FVertex));
+		Writer.Align();
+		Writer.Write(Mesh->IndexBuffer->GetIndexData(), kNumIndices * sizeof(GLuint));
+
+		if (Mesh->IsSkinned())
+		{
+			const FSkinMesh *SkinMesh = (const FSkinMesh*)Mesh;
+			assert(SkinMesh->VertexSkinBuffer->GetVertexCount() == kNumVertices);
+
+			Writer.Align();
+			Writer.Write(SkinMesh->VertexSkinBuffer->GetVertexData(), kNumVertices * sizeof(FVertexSkin));
+
+			Writer.WriteU32((uint32_t)SkinMesh->MeshBones.size());
+			for (size_t k = 0; k < SkinMesh->MeshBones.size(); k++)
+			{
+				Writer.WriteString(SkinMesh->MeshBones[k].BoneName);
+				Writer.Write(&SkinMesh->MeshBones[k].MeshToBone, sizeof(glm::mat4));
+			} // end for k
+		}
+	} // end for
+
+	// node hierarchy
+	const FNodeHierarchyRef &Hierarchy = InModel.OrgNodeHierarchy;
+	const unsigned int kNumNodes = IsValidRef(Hierarchy) ? Hierarchy->GetNodesCount() : 0;
+	Writer.WriteU32(kNumNodes);
+	for (unsigned int Index = 0; Index < kNumNodes; Index++)
+	{
+		const FNode &Node = Hierarchy->GetNode(Index);
+		Writer.WriteI32(Node.ParentIdx);
+		Writer.WriteString(Node.NodeName);
+		Writer.Write(&Node.LocalMat, sizeof(glm::mat4));
+	} // end for
+
+	// mesh instances
+	Writer.WriteU32((uint32_t)InModel.MeshInstances.size());
+	for (size_t Index = 0; Index < InModel.MeshInstances.size(); Index++)
+	{
+		Writer.WriteI32(InModel.MeshInstances[Index].NodeIdx);
+		Writer.WriteI32(InModel.MeshInstances[Index].MeshIdx);
+	} // end for
+
+	// animation sequences
+	Writer.WriteU32((uint32_t)InModel.NodeAnimSequences.size());
+	for (size_t Index = 0; Index < InModel.NodeAnimSequences.size(); Index++)
+	{
+		const FNodeAnimationSequenceRef &AnimSeq = InModel.NodeAnimSequences[Index];
+		Writer.WriteString(AnimSeq->SeqName);
+		Writer.WriteF64(AnimSeq->Duration);
+
+		Writer.WriteU32((uint32_t)AnimSeq->Tracks.size());
+		for (size_t TrackIdx = 0; TrackIdx < AnimSeq->Tracks.size(); TrackIdx++)
+		{
+			const FNodeAnimRef &Track = AnimSeq->Tracks[TrackIdx];
+			Writer.WriteString(Track->NodeName);
+			Cooked_WriteVectorKeys(Writer, Track->PositionKeys);
+			Cooked_WriteVectorKeys(Writer, Track->ScalingKeys);
+
+			Writer.WriteU32((uint32_t)Track->RotationKeys.size());
+			for (size_t k = 0; k < Track->RotationKeys.size(); k++)
+			{
+				const FRotationKey &Key = Track->RotationKeys[k];
+				Writer.WriteF64(Key.Time);
+				Writer.WriteF32(Key.Value.w);
+				Writer.WriteF32(Key.Value.x);
+				Writer.WriteF32(Key.Value.y);
+				Writer.WriteF32(Key.Value.z);
+			} // end for k
+		} // end for TrackIdx
+	} // end for
+
+	Writer.WriteU32(COOKED_MODEL_MAGIC);
+
+	Header.FileSize = Writer.Buffer.size();
+	memcpy(Writer.Buffer.data(), &Header, sizeof(Header));
+
+	const std::string CookedFilename = GetCookedFilename(InSourceFilename);
+	std::ofstream File(CookedFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	File.write((const char*)Writer.Buffer.data(), Writer.Buffer.size());
+	File.close();
+	if (!File)
+	{
+		std::cout << "Error: Write Cooked Model Failed: " << CookedFilename << std::endl;
+		std::remove(CookedFilename.c_str());
+		return false;
+	}
+
+	std::cout << "Info: Cooked Model: " << CookedFilename << ", " << Writer.Buffer.size() / 1024 << "KB" << std::endl;
+	return true;
+}
+
+bool FCookedModel::IsUpToDate(const std::string &InSourceFilename, unsigned int InImportFlags)
+{
+	FMappedFileRef File = FMappedFile::Open(GetCookedFilename(InSourceFilename));
+	if (!IsValidRef(File) || File->GetSize() < sizeof(FCookedModelHeader))
+	{
+		return false;
+	}
+
+	FCookedModelHeader Header;
+	memcpy(&Header, File->GetData(), sizeof(Header));
+	return IsHeaderValid(Header, File->GetSize(), InSourceFilename, InImportFlags);
+}
+
+// the textures shared by materials are created once
+static FTexture2DRef Cooked_LoadTexture(const std::string &InPathname, std::map<std::string, FTexture2DRef> &Textures, std::vector<FTexture2DRef> *OutDeferredTextures)
+{
+	if (InPathname.empty())
+	{
+		return nullptr;
+	}
+
+	std::map<std::string, FTexture2DRef>::iterator itr = Textures.find(InPathname);
+	if (itr != Textures.end())
+	{
+		return itr->second;
+	}
+
+	FTexture2DRef Texture;
+	if (OutDeferredTextures)
+	{
+		Texture = FTexture2D::CreateTextureDeferred(InPathname);
+		OutDeferredTextures->push_back(Texture);
+	}
+	else
+	{
+		Texture = FTexture2D::CreateTexture(InPathname);
+	}
+	Textures[InPathname] = Texture;
+
+	return Texture;
+}
+
+FModelRef FCookedModel::Load(const std::string &InSourceFilename, unsigned int InImportFlags, std::vector<FTexture2DRef> *OutDeferredTextures)
+{
+	const std::string CookedFilename = GetCookedFilename(InSourceFilename);
+	FMappedFileRef File = FMappedFile::Open(CookedFilename);
+	if (!IsValidRef(File))
+	{
+		return nullptr;
+	}
+
+	FCookedReader Reader(File->GetData(), File->GetSize());
+	FCookedModelHeader Header;
+	Reader.Read(&Header, sizeof(Header));
+	if (Reader.IsOverflow() || !IsHeaderValid(Header, File->GetSize(), InSourceFilename, InImportFlags))
+	{
+		std::cout << "Info: Cooked Model Is Stale: " << CookedFilename << std::endl;
+		return nullptr;
+	}
+
+	FModelRef NewModel = new FModel();
+	NewModel->AssetPathname = InSourceFilename;
+	// the buffers refer to the mapping
+	FRefCountedObjectRef Owner = File.DeRef();
+
+	// materials, the deferred textures are handed out only if the whole file is valid
+	std::map<std::string, FTexture2DRef> Textures;
+	std::vector<FTexture2DRef> DeferredTextures;
+	const uint32_t kNumMaterials = Reader.ReadU32();
+	for (uint32_t Index = 0; Index < kNumMaterials && !Reader.IsOverflow(); Index++)
+	{
+		// read in order, the arguments of a call are not
+		const std::string DiffusePath = Reader.ReadString();
+		const std::string SpecularPath = Reader.ReadString();
+		const std::string NormalPath = Reader.ReadString();
+
+		FMaterialRef NewMaterial = new FMaterial();
+		NewMaterial->TexDiffuse = Cooked_LoadTexture(DiffusePath, Textures, OutDeferredTextures ? &DeferredTextures : nullptr);
+		NewMaterial->TexSpecular = Cooked_LoadTexture(SpecularPath, Textures, OutDeferredTextures ? &DeferredTextures : nullptr);
+		NewMaterial->TexNormal = Cooked_LoadTexture(NormalPath, Textures, OutDeferredTextures ? &DeferredTextures : nullptr);
+		NewModel->Materials.push_back(NewMaterial);
+	} // end for
+
+	// meshes
+	bool bCorrupted = false;
+	const uint32_t kNumMeshes = Reader.ReadU32();
+	for (uint32_t Index = 0; Index < kNumMeshes && !Reader.IsOverflow(); Index++)
+	{
+		const uint32_t kMaterialIdx = Reader.ReadU32();
+		const GLenum kPrimitiveMode = (GLenum)Reader.ReadU32();
+		const bool bSkinned = Reader.ReadU32() != 0;
+		const uint32_t kNumVertices = Reader.ReadU32();
+		const uint32_t kNumIndices = Reader.ReadU32();
+
+		Reader.Align();
+		const FVertex *Vertexes = Reader.CanRead(kNumVertices, sizeof(FVertex)) ? (const FVertex*)Reader.Skip(kNumVertices * sizeof(FVertex)) : nullptr;
+		Reader.Align();
+		const GLuint *Indices = Reader.CanRead(kNumIndices, sizeof(GLuint)) ? (const GLuint*)Reader.Skip(kNumIndices * sizeof(GLuint)) : nullptr;
+		if (Reader.IsOverflow() || kMaterialIdx >= NewModel->Materials.size())
+		{
+			bCorrupted = true;
+			break;
+		}
+
+		FVertexBufferRef VBufferRef = new FVertexBuffer();
+		FIndexBufferRef IBufferRef = new FIndexBuffer();
+		VBufferRef->FillBufferExternal(Vertexes, kNumVertices, Owner);
+		IBufferRef->FillBufferExternal(Indices, kNumIndices, Owner);
+		const FMaterialRef &Material = NewModel->Materials[kMaterialIdx];
+
+		if (!bSkinned)
+		{
+			NewModel->Meshes.push_back(new FMesh(Material, VBufferRef, IBufferRef, kPrimitiveMode));
+			continue;
+		}
+
+		Reader.Align();
+		const FVertexSkin *SkinVertexes = Reader.CanRead(kNumVertices, sizeof(FVertexSkin)) ? (const FVertexSkin*)Reader.Skip(kNumVertices * sizeof(FVertexSkin)) : nullptr;
+
+		std::vector<FMeshBone> MeshBones;
+		const uint32_t kNumBones = Reader.ReadU32();
+		for (uint32_t k = 0; k < kNumBones && !Reader.IsOverflow(); k++)
+		{
+			const std::string BoneName = Reader.ReadString();
+			glm::mat4 MeshToBone;
+			Reader.Read(&MeshToBone, sizeof(glm::mat4));
+			MeshBones.push_back(FMeshBone(BoneName, MeshToBone));
+		} // end for k
+		if (Reader.IsOverflow())
+		{
+			bCorrupted = true;
+			break;
+		}
+
+		FVertexSkinBufferRef VSkinBufferRef = new FVertexSkinBuffer();
+		VSkinBufferRef->FillBufferExternal(SkinVertexes, kNumVertices, Owner);
+		// the base vertex would offset the skin stream too, keep the vertices in own buffer
+		VBufferRef->bPooled = false;
+
+		FSkinMeshRef NewMesh = new FSkinMesh(Material, VBufferRef, VSkinBufferRef, IBufferRef, kPrimitiveMode, MeshBones);
+		NewModel->Meshes.push_back(NewMesh.DeRef());
+	} // end for
+
+	// node hierarchy
+	FNodeHierarchyRef NewHierarchy = new FNodeHierarchy();
+	const uint32_t kNumNodes = bCorrupted ? 0 : Reader.ReadU32();
+	for (uint32_t Index = 0; Index < kNumNodes && !Reader.IsOverflow(); Index++)
+	{
+		const int32_t kParentIdx = Reader.ReadI32();
+		const std::string NodeName = Reader.ReadString();
+		glm::mat4 LocalMat;
+		Reader.Read(&LocalMat, sizeof(glm::mat4));
+
+		// the parents are before the children
+		if (kParentIdx != NODE_INDEX_NONE && (kParentIdx < 0 || (uint32_t)kParentIdx >= Index))
+		{
+			bCorrupted = true;
+			break;
+		}
+		NewHierarchy->AddNode(FNode(NodeName, kParentIdx, LocalMat));
+	} // end for
+	NewHierarchy->CalculateNodesModelMatrix();
+	NewModel->OrgNodeHierarchy = NewHierarchy;
+
+	// mesh instances
+	const uint32_t kNumInstances = bCorrupted ? 0 : Reader.ReadU32();
+	for (uint32_t Index = 0; Index < kNumInstances && !Reader.IsOverflow(); Index++)
+	{
+		const int32_t kNodeIdx = Reader.ReadI32();
+		const int32_t kMeshIdx = Reader.ReadI32();
+		if (kNodeIdx < 0 || (uint32_t)kNodeIdx >= kNumNodes || kMeshIdx < 0 || (uint32_t)kMeshIdx >= NewModel->Meshes.size())
+		{
+			bCorrupted = true;
+			break;
+		}
+		NewModel->MeshInstances.push_back(FMeshInstance(kNodeIdx, kMeshIdx));
+	} // end for
+
+	// animation sequences
+	const uint32_t kNumSequences = bCorrupted ? 0 : Reader.ReadU32();
+	for (uint32_t Index = 0; Index < kNumSequences && !Reader.IsOverflow(); Index++)
+	{
+		FNodeAnimationSequenceRef AnimSeq = new FNodeAnimationSequence();
+		AnimSeq->SeqName = Reader.ReadString();
+		AnimSeq->Duration = Reader.ReadF64();
+
+		const uint32_t kNumTracks = Reader.ReadU32();
+		for (uint32_t TrackIdx = 0; TrackIdx < kNumTracks && !Reader.IsOverflow(); TrackIdx++)
+		{
+			FNodeAnimRef NewTrack = new FNodeAnim();
+			NewTrack->NodeName = Reader.ReadString();
+			Cooked_ReadVectorKeys(Reader, NewTrack->PositionKeys);
+			Cooked_ReadVectorKeys(Reader, NewTrack->ScalingKeys);
+
+			const uint32_t kNumKeys = Reader.ReadU32();
+			if (Reader.CanRead(kNumKeys, sizeof(double) + sizeof(float) * 4))
+			{
+				NewTrack->RotationKeys.resize(kNumKeys);
+				for (uint32_t k = 0; k < kNumKeys; k++)
+				{
+					FRotationKey &Key = NewTrack->RotationKeys[k];
+					Key.Time = Reader.ReadF64();
+					Key.Value.w = Reader.ReadF32();
+					Key.Value.x = Reader.ReadF32();
+					Key.Value.y = Reader.ReadF32();
+					Key.Value.z = Reader.ReadF32();
+				} // end for k
+			}
+
+			AnimSeq->Tracks.push_back(NewTrack);
+		} // end for TrackIdx
+
+		AnimSeq->CachedTrans.resize(AnimSeq->Tracks.size());
+		for (size_t TrackIdx = 0; TrackIdx < AnimSeq->Tracks.size(); TrackIdx++)
+		{
+			AnimSeq->CachedTrans[TrackIdx].NodeName = AnimSeq->Tracks[TrackIdx]->NodeName;
+		} // end for TrackIdx
+
+		NewModel->NodeAnimSequences.push_back(AnimSeq);
+	} // end for
+
+	if (bCorrupted || Reader.ReadU32() != COOKED_MODEL_MAGIC || Reader.IsOverflow())
+	{
+		std::cout << "Error: Cooked Model Is Corrupted: " << CookedFilename << std::endl;
+		return nullptr;
+	}
+
+	if (OutDeferredTextures)
+	{
+		OutDeferredTextures->insert(OutDeferredTextures->end(), DeferredTextures.begin(), DeferredTextures.end());
+	}
+
+	std::cout << "Info: Load Cooked Model: " << CookedFilename << std::endl;
+	return NewModel;
+}
@@ -0,0 +1,52 @@
+// \brief
+//		cooked model, a binary image of the imported model loaded by memory mapping
+//
+
+#ifndef __JETX_SCENE_COOKED_MODEL_H__
+#define __JETX_SCENE_COOKED_MODEL_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+
+
+#define COOKED_MODEL_MAGIC		0x4D584A43	// "CJXM"
+#define COOKED_MODEL_VERSION	1
+#define COOKED_MODEL_ALIGNMENT	16			// the vertex and index arrays start at the alignment
+
+// file header, the stamp of source file decides whether the cooked file is stale
+struct FCookedModelHeader
+{
+	uint32_t	Magic;
+	uint32_t	Version;
+	uint32_t	ImportFlags;		// assimp post-processing of the source
+	uint32_t	VertexSize;			// sizeof(FVertex), the arrays are in the layout of the cooking build
+	uint32_t	VertexSkinSize;		// sizeof(FVertexSkin)
+	uint32_t	Reserved;
+	uint64_t	SourceSize;
+	int64_t		SourceTime;			// modification time of source
+	uint64_t	FileSize;			// the whole cooked file, a truncated one is rejected
+};
+
+// \brief
+//	the file is "<source>.jxm" in the native byte order.
+//	Load() maps the file, the vertex and index arrays are uploaded from the mapping without a copy,
+//	the mapping is kept by the buffers until the model is destroyed.
+class FCookedModel
+{
+public:
+	static std::string GetCookedFilename(const std::string &InSourceFilename) { return InSourceFilename + ".jxm"; }
+
+	// write InModel, imported from InSourceFilename with InImportFlags
+	static bool Cook(const FModel &InModel, const std::string &InSourceFilename, unsigned int InImportFlags);
+
+	// the cooked file exists, and matches the version, the import flags and the source if it exists
+	static bool IsUpToDate(const std::string &InSourceFilename, unsigned int InImportFlags);
+
+	// null if there is no valid cooked file. no gl call, the textures are created as FModel::ImportModel() does
+	static FModelRef Load(const std::string &InSourceFilename, unsigned int InImportFlags, std::vector<FTexture2DRef> *OutDeferredTextures);
+};
+
+#endif // __JETX_SCENE_COOKED_MODEL_H__
@@ -10,6 +10,7 @@
 
 FLinesPatch::FLinesPatch(unsigned int InLinesCount)
 	: VertexCount(InLinesCount << 1)
+	, StartVertex(0)
 {
 
 }
@@ -22,28 +23,34 @@ void FLinesPatch::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolic
 	{
 		FVertexElementsList VertexElementList;
 		VertexElementList.push_back(FVertexElement(0, 0, STRUCT_VAR_OFFSET(FSimpleVertex, Position), sizeof(FSimpleVertex), VET_Float3));	// POSITION
-		VertexDeclRef = GLDriver.CreateVertexDeclaration(VertexElementList);
+		VertexDeclRef = GLDriver.GetVertexDeclaration(VertexElementList);
 	}
 
 	// set up shader & parameters
 	InPolicy.LinesShader->SetUp(InViewContext, *this);
 
-	GLDriver.SetStreamSource(0, VertexBuffer);
+	GLDriver.SetStreamSource(0, VertexRingBuffer->GetVertexBuffer());
 	GLDriver.SetVertexDeclaration(VertexDeclRef);
 
-	GLDriver.DrawArrayedPrimitive(GL_LINES, 0, VertexCount);
+	GLDriver.DrawArrayedPrimitive(GL_LINES, StartVertex, VertexCount);
 }
 
 void FLinesPatch::UpdateVertex(const std::vector<FSimpleVertex> &InVertexes)
 {
-	if (IsValidRef(VertexBuffer))
+	if (IsValidRef(VertexRingBuffer))
 	{
 		unsigned int Count = MIN(VertexCount, InVertexes.size());
 		unsigned int Bytes = Count*sizeof(FSimpleVertex);
 
-		void* PtrDst = VertexBuffer->Lock(0, Bytes, false, false);
-		memcpy_s(PtrDst, Bytes, InVertexes.data(), Bytes);
-		VertexBuffer->UnLock();
+		// a new range each update, the draws of previous frames are not waited
+		GLintptr Offset = 0;
+		void* PtrDst = VertexRingBuffer->Lock(VertexCount*sizeof(FSimpleVertex), sizeof(FSimpleVertex), Offset);
+		if (PtrDst)
+		{
+			memcpy_s(PtrDst, Bytes, InVertexes.data(), Bytes);
+			VertexRingBuffer->UnLock();
+			StartVertex = (GLint)(Offset / sizeof(FSimpleVertex));
+		}
 	}
 }
 
@@ -51,13 +58,13 @@ void FLinesPatch::InitRHI()
 {
 	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
 
-	VertexBuffer = GLDriver.CreateVertexBuffer(VertexCount*sizeof(FSimpleVertex), nullptr, GL_DYNAMIC_DRAW);
+	VertexRingBuffer = GLDriver.CreateRingBuffer(GL_ARRAY_BUFFER, VertexCount*sizeof(FSimpleVertex));
 }
 
 void FLinesPatch::ReleaseRHI()
 {
-	if (IsValidRef(VertexBuffer))
+	if (IsValidRef(VertexRingBuffer))
 	{
-		VertexBuffer.SafeRelease();
+		VertexRingBuffer.SafeRelease();
 	}
 }
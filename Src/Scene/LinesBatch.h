@@ -27,9 +27,10 @@ public:
 	virtual void ReleaseRHI();
 public:
 	FOpenGLVertexDeclarationRef		VertexDeclRef;
-	FOpenGLVertexBufferRef			VertexBuffer;
+	FOpenGLRingBufferRef			VertexRingBuffer;	// updated vertices each frame
 
 	unsigned int	VertexCount;
+	GLint			StartVertex;	// of the last update in ring buffer
 };
 typedef TRefCountPtr<FLinesPatch>		FLinesPatchRef;
 
@@ -0,0 +1,162 @@
+// \brief
+//		implementation of loader thread
+//
+
+#include <cassert>
+#include <chrono>
+#include <OpenGL/OpenGLDrv.h>
+
+#include "LoaderThread.h"
+
+
+FLoaderThread& FLoaderThread::SharedInstance()
+{
+	static FLoaderThread Loader;
+
+	return Loader;
+}
+
+void FLoaderThread::Start(const FCallback &InBeginThread, const FCallback &InEndThread)
+{
+	assert(!IsRunning());
+	assert(FOpenGLDrv::SharedInstance().IsRenderThread());
+
+	BeginThread = InBeginThread;
+	EndThread = InEndThread;
+	bStopping = false;
+	Thread = std::thread(&FLoaderThread::Run, this);
+}
+
+void FLoaderThread::Stop()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bStopping = true;
+	}
+	TaskQueued.notify_one();
+	Thread.join();
+
+	std::vector<FLoaderTask> Published;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		TakePublishedTasks(Published, true);
+	}
+	for (size_t Index = 0; Index < Published.size(); Index++)
+	{
+		if (Published[Index].OnPublished)
+		{
+			Published[Index].OnPublished();
+		}
+	} // end for
+}
+
+void FLoaderThread::Enqueue(const FCallback &InTask, const FCallback &InOnPublished)
+{
+	FLoaderTask NewTask;
+	NewTask.Task = InTask;
+	NewTask.OnPublished = InOnPublished;
+	NewTask.Fence = 0;
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		QueuedTasks.push_back(NewTask);
+	}
+	TaskQueued.notify_one();
+}
+
+void FLoaderThread::Tick()
+{
+	std::vector<FLoaderTask> Published;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		TakePublishedTasks(Published, false);
+	}
+
+	// the callbacks may enqueue
+	for (size_t Index = 0; Index < Published.size(); Index++)
+	{
+		if (Published[Index].OnPublished)
+		{
+			Published[Index].OnPublished();
+		}
+	} // end for
+}
+
+void FLoaderThread::TakePublishedTasks(std::vector<FLoaderTask> &OutTasks, bool bInWait)
+{
+	// the sync objects are shared, the render context waits on the fences of loader context
+	while (!FencedTasks.empty())
+	{
+		FLoaderTask &Task = FencedTasks.front();
+		const GLenum kResult = glClientWaitSync(Task.Fence, 0, bInWait ? GL_TIMEOUT_IGNORED : 0);
+		if (kResult != GL_ALREADY_SIGNALED && kResult != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+
+		glDeleteSync(Task.Fence);
+		Task.Fence = 0;
+		OutTasks.push_back(Task);
+		FencedTasks.pop_front();
+		Stats.TasksPublished++;
+	} // end while
+}
+
+size_t FLoaderThread::GetPendingCount()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	return QueuedTasks.size() + FencedTasks.size();
+}
+
+FLoaderThreadStats FLoaderThread::GetStats()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	return Stats;
+}
+
+void FLoaderThread::Run()
+{
+	if (BeginThread)
+	{
+		BeginThread();
+	}
+
+	for (;;)
+	{
+		FLoaderTask Task;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			TaskQueued.wait(Lock, [this]() { return bStopping || !QueuedTasks.empty(); });
+			if (QueuedTasks.empty())
+			{
+				break;
+			}
+			Task = QueuedTasks.front();
+			QueuedTasks.pop_front();
+		}
+
+		std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+		Task.Task();
+		// the fence is visible to render context after the flush
+		Task.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+		const double kBusySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		FencedTasks.push_back(Task);
+		Stats.TasksRun++;
+		Stats.BusySeconds += kBusySeconds;
+	} // end for
+
+	if (EndThread)
+	{
+		EndThread();
+	}
+}
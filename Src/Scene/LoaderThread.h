@@ -0,0 +1,95 @@
+// \brief
+//		loader thread, creates gl resources on a context shared with the render context
+//
+
+#ifndef __JETX_SCENE_LOADER_THREAD_H__
+#define __JETX_SCENE_LOADER_THREAD_H__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+
+// statistics of loader thread
+struct FLoaderThreadStats
+{
+	FLoaderThreadStats()
+		: TasksRun(0)
+		, TasksPublished(0)
+		, BusySeconds(0.0)
+	{}
+
+	unsigned int	TasksRun;
+	unsigned int	TasksPublished;		// the fence is signaled, the resources are visible to render context
+	double			BusySeconds;		// running the tasks
+};
+
+// \brief
+//	the tasks run on a thread with its own gl context, shared with the render context, e.g. a hidden window
+//	created with the main one as share. each task is followed by a fence, Tick() on render thread polls
+//	the fences in order and calls the published callbacks of signaled ones, the resources are drawn after that.
+//	a resource created on loader thread is not pooled in the buffer arenas or uploaded by the ring of render context.
+//	the objects released off the render thread are deleted by FOpenGLDrv::EndFrame().
+//	Start()/Stop()/Tick() on render thread, Enqueue() on any thread.
+class FLoaderThread
+{
+public:
+	typedef std::function<void()>	FCallback;
+
+	static FLoaderThread& SharedInstance();
+
+	// InBeginThread makes the shared context current on loader thread, InEndThread releases it
+	void Start(const FCallback &InBeginThread, const FCallback &InEndThread);
+	// run the queued tasks, join the thread and publish them
+	void Stop();
+
+	bool IsRunning() const { return Thread.joinable(); }
+
+	// InTask runs on loader thread, InOnPublished on render thread when the gpu has done the commands of InTask
+	void Enqueue(const FCallback &InTask, const FCallback &InOnPublished);
+
+	// render thread: publish the tasks done, no waiting
+	void Tick();
+
+	// tasks not published yet
+	size_t GetPendingCount();
+
+	// copy of statistics, safe on any thread
+	FLoaderThreadStats GetStats();
+
+private:
+	FLoaderThread() : bStopping(false) {}
+	FLoaderThread(const FLoaderThread&) = delete;
+	FLoaderThread& operator=(const FLoaderThread&) = delete;
+
+	struct FLoaderTask
+	{
+		FCallback	Task;
+		FCallback	OnPublished;
+		GLsync		Fence;
+	};
+
+	void Run();
+	// with the lock held, the tasks of signaled fences in order. wait for all if bInWait
+	void TakePublishedTasks(std::vector<FLoaderTask> &OutTasks, bool bInWait);
+
+	std::deque<FLoaderTask>		QueuedTasks;	// waiting for loader thread
+	std::deque<FLoaderTask>		FencedTasks;	// run, waiting for the fence
+
+	std::mutex					Mutex;
+	std::condition_variable		TaskQueued;
+	bool						bStopping;
+
+	std::thread					Thread;
+	FCallback					BeginThread;
+	FCallback					EndThread;
+
+	FLoaderThreadStats			Stats;
+};
+
+#endif // __JETX_SCENE_LOADER_THREAD_H__
@@ -7,10 +7,95 @@
 
 #include "Mesh.h"
 #include "Model.h"
+#include "RenderProxy.h"
 
 
+void FMesh::InitVertexDeclaration()
+{
+	FVertexElementsList VertexElementList;
+	VertexElementList.push_back(FVertexElement(0, 0, STRUCT_VAR_OFFSET(FVertex, Position), sizeof(FVertex), VET_Float3));	// POSITION
+	VertexElementList.push_back(FVertexElement(0, 1, STRUCT_VAR_OFFSET(FVertex, Normal), sizeof(FVertex), VET_Float3));		// NORMAL
+	VertexElementList.push_back(FVertexElement(0, 2, STRUCT_VAR_OFFSET(FVertex, TexCoords), sizeof(FVertex), VET_Float2));	// TEX-COORD
+	VertexElementList.push_back(FVertexElement(0, 3, STRUCT_VAR_OFFSET(FVertex, Tangent), sizeof(FVertex), VET_Float3));	// Tangent
+	VertexElementList.push_back(FVertexElement(0, 4, STRUCT_VAR_OFFSET(FVertex, Bitangent), sizeof(FVertex), VET_Float3));	// BiTangent
+
+	VertexDeclRef = FOpenGLDrv::SharedInstance().GetVertexDeclaration(VertexElementList);
+}
+
+void FMesh::InitStreamingBounds()
+{
+	BoundsCenter = glm::vec3(0.f);
+	BoundsRadius = 0.f;
+	TexelFactor = 0.f;
+	if (!IsValidRef(VertexBuffer) || VertexBuffer->GetVertexCount() == 0)
+	{
+		return;
+	}
+
+	const FVertex *Vertexes = VertexBuffer->GetVertexData();
+	const size_t kNumVertexes = VertexBuffer->GetVertexCount();
+
+	glm::vec3 BoxMin = Vertexes[0].Position;
+	glm::vec3 BoxMax = Vertexes[0].Position;
+	for (size_t Index = 1; Index < kNumVertexes; Index++)
+	{
+		BoxMin = glm::min(BoxMin, Vertexes[Index].Position);
+		BoxMax = glm::max(BoxMax, Vertexes[Index].Position);
+	} // end for
+	BoundsCenter = (BoxMin + BoxMax) * 0.5f;
+	BoundsRadius = glm::length(BoxMax - BoundsCenter);
+
+	if (!IsValidRef(IndexBuffer) || PrimitiveMode != GL_TRIANGLES)
+	{
+		return;
+	}
+
+	// sqrt of the ratio of world area to uv area over all triangles
+	const GLuint *Indices = IndexBuffer->GetIndexData();
+	const GLuint kNumIndices = IndexBuffer->GetElementCount();
+	double WorldArea = 0.0, UVArea = 0.0;
+	for (GLuint Index = 0; Index + 2 < kNumIndices; Index += 3)
+	{
+		const FVertex &V0 = Vertexes[Indices[Index]];
+		const FVertex &V1 = Vertexes[Indices[Index + 1]];
+		const FVertex &V2 = Vertexes[Indices[Index + 2]];
+
+		WorldArea += glm::length(glm::cross(V1.Position - V0.Position, V2.Position - V0.Position));
+		const glm::vec2 E1 = V1.TexCoords - V0.TexCoords;
+		const glm::vec2 E2 = V2.TexCoords - V0.TexCoords;
+		UVArea += glm::abs(E1.x * E2.y - E1.y * E2.x);
+	} // end for
+	if (UVArea > 0.0)
+	{
+		TexelFactor = (float)glm::sqrt(WorldArea / UVArea);
+	}
+}
+
 void FMesh::InitRHI()
 {
+	std::lock_guard<std::mutex> Lock(ResidentMutex);
+	if (ResidentCount++ == 0)
+	{
+		InitResources();
+	}
+}
+
+void FMesh::ReleaseRHI()
+{
+	std::lock_guard<std::mutex> Lock(ResidentMutex);
+	if (ResidentCount > 0 && --ResidentCount == 0)
+	{
+		ReleaseResources();
+	}
+}
+
+void FMesh::InitResources()
+{
+	if (!IsValidRef(VertexDeclRef))
+	{
+		InitVertexDeclaration();
+		InitStreamingBounds();
+	}
 	if (IsValidRef(Material))
 	{
 		Material->InitRHI();
@@ -25,7 +110,7 @@ void FMesh::InitRHI()
 	}
 }
 
-void FMesh::ReleaseRHI()
+void FMesh::ReleaseResources()
 {
 	if (IsValidRef(Material))
 	{
@@ -46,6 +131,86 @@ void FMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy, con
 	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
 
 	if (!IsValidRef(VertexDeclRef))
+	{
+		InitVertexDeclaration();
+	}
+
+	FViewContext LocalViewContext(InViewContext);
+	if (MeshInstance.NodeIdx != NODE_INDEX_NONE)
+	{
+		FNodeHierarchyRef NodeHierarchy = InModel.GetNodeHierarchy();
+		assert(IsValidRef(NodeHierarchy));
+
+		glm::mat4 ModelTrans = NodeHierarchy->GetNode(MeshInstance.NodeIdx).ModelMat;
+		LocalViewContext.model = LocalViewContext.model * ModelTrans;
+	}
+
+	// set up shader & parameters
+	InPolicy.MeshShader->SetUp(LocalViewContext, *this);
+
+	GLDriver.SetStreamSource(0, VertexBuffer->GetRHIBuffer());
+	GLDriver.SetVertexDeclaration(VertexDeclRef);
+
+	GLDriver.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, IndexBuffer->GetFirstIndex(), IndexBuffer->GetElementCount(), VertexBuffer->GetBaseVertex());
+}
+
+void FMesh::Record(FOpenGLCommandList &InCommandList, const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance)
+{
+	assert(IsValidRef(VertexDeclRef));
+
+	FViewContext LocalViewContext(InViewContext);
+	if (MeshInstance.NodeIdx != NODE_INDEX_NONE)
+	{
+		FNodeHierarchyRef NodeHierarchy = InModel.GetNodeHierarchy();
+		assert(IsValidRef(NodeHierarchy));
+
+		glm::mat4 ModelTrans = NodeHierarchy->GetNode(MeshInstance.NodeIdx).ModelMat;
+		LocalViewContext.model = LocalViewContext.model * ModelTrans;
+	}
+
+	// record shader & parameters
+	InPolicy.MeshShader->Record(InCommandList, LocalViewContext, *this);
+
+	InCommandList.SetStreamSource(0, VertexBuffer->GetRHIBuffer());
+	InCommandList.SetVertexDeclaration(VertexDeclRef);
+
+	InCommandList.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, IndexBuffer->GetFirstIndex(), IndexBuffer->GetElementCount(), VertexBuffer->GetBaseVertex());
+}
+
+void FMesh::Snapshot(FRenderFrame &OutFrame, const glm::mat4 &InTransform, const FModel &InModel, const FMeshInstance &MeshInstance)
+{
+	glm::mat4 Transform = InTransform;
+	if (MeshInstance.NodeIdx != NODE_INDEX_NONE)
+	{
+		FNodeHierarchyRef NodeHierarchy = InModel.GetNodeHierarchy();
+		assert(IsValidRef(NodeHierarchy));
+
+		Transform = Transform * NodeHierarchy->GetNode(MeshInstance.NodeIdx).ModelMat;
+	}
+
+	OutFrame.AddMesh(this, Material, Transform);
+}
+
+void FMesh::DrawProxy(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FMeshRenderProxy &InProxy)
+{
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	assert(IsValidRef(VertexDeclRef));
+
+	FViewContext LocalViewContext(InViewContext);
+	LocalViewContext.model = InProxy.Transform;
+
+	// set up shader & parameters
+	InPolicy.MeshShader->SetUp(LocalViewContext, InProxy);
+
+	GLDriver.SetStreamSource(0, VertexBuffer->GetRHIBuffer());
+	GLDriver.SetVertexDeclaration(VertexDeclRef);
+
+	GLDriver.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, IndexBuffer->GetFirstIndex(), IndexBuffer->GetElementCount(), VertexBuffer->GetBaseVertex());
+}
+
+const FOpenGLVertexDeclarationRef& FMesh::GetInstancedVertexDeclaration()
+{
+	if (!IsValidRef(InstancedVertexDeclRef))
 	{
 		FVertexElementsList VertexElementList;
 		VertexElementList.push_back(FVertexElement(0, 0, STRUCT_VAR_OFFSET(FVertex, Position), sizeof(FVertex), VET_Float3));	// POSITION
@@ -53,10 +218,23 @@ void FMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy, con
 		VertexElementList.push_back(FVertexElement(0, 2, STRUCT_VAR_OFFSET(FVertex, TexCoords), sizeof(FVertex), VET_Float2));	// TEX-COORD
 		VertexElementList.push_back(FVertexElement(0, 3, STRUCT_VAR_OFFSET(FVertex, Tangent), sizeof(FVertex), VET_Float3));	// Tangent
 		VertexElementList.push_back(FVertexElement(0, 4, STRUCT_VAR_OFFSET(FVertex, Bitangent), sizeof(FVertex), VET_Float3));	// BiTangent
+		// instance transform, a column per attribute
+		for (unsigned short Column = 0; Column < 4; Column++)
+		{
+			VertexElementList.push_back(FVertexElement(1, 7 + Column, Column * sizeof(glm::vec4), sizeof(glm::mat4), VET_Float4, 1));
+		} // end for
 
-		VertexDeclRef = GLDriver.CreateVertexDeclaration(VertexElementList);
+		InstancedVertexDeclRef = FOpenGLDrv::SharedInstance().GetVertexDeclaration(VertexElementList);
 	}
 
+	return InstancedVertexDeclRef;
+}
+
+void FMesh::DrawInstanced(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance,
+	const FOpenGLVertexBufferRef &InInstanceBuffer, GLsizei InInstanceCount)
+{
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+
 	FViewContext LocalViewContext(InViewContext);
 	if (MeshInstance.NodeIdx != NODE_INDEX_NONE)
 	{
@@ -68,10 +246,11 @@ void FMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy, con
 	}
 
 	// set up shader & parameters
-	InPolicy.MeshShader->SetUp(LocalViewContext, *this);
+	InPolicy.InstancedMeshShader->SetUp(LocalViewContext, *this);
 
 	GLDriver.SetStreamSource(0, VertexBuffer->GetRHIBuffer());
-	GLDriver.SetVertexDeclaration(VertexDeclRef);
+	GLDriver.SetStreamSource(1, InInstanceBuffer);
+	GLDriver.SetVertexDeclaration(GetInstancedVertexDeclaration());
 
-	GLDriver.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, 0, IndexBuffer->GetElementCount());
+	GLDriver.DrawIndexedPrimitiveInstanced(IndexBuffer->GetRHIBuffer(), PrimitiveMode, IndexBuffer->GetFirstIndex(), IndexBuffer->GetElementCount(), InInstanceCount, VertexBuffer->GetBaseVertex());
 }
@@ -15,6 +15,9 @@
 
 class FModel;
 struct FMeshInstance;
+class FOpenGLCommandList;
+class FRenderFrame;
+struct FMeshRenderProxy;
 
 // class mesh
 class FMesh : public FRefCountedObject
@@ -22,6 +25,9 @@ class FMesh : public FRefCountedObject
 public:
 	FMesh() 
 		: PrimitiveMode(GL_TRIANGLES)
+		, BoundsRadius(0.f)
+		, TexelFactor(0.f)
+		, ResidentCount(0)
 	{}
 
 	FMesh(const FMaterialRef& InMaterial, const FVertexBufferRef& VBuffer, const FIndexBufferRef& IBuffer, GLenum InPrimitiveMode)
@@ -29,20 +35,65 @@ public:
 		, VertexBuffer(VBuffer)
 		, IndexBuffer(IBuffer)
 		, PrimitiveMode(InPrimitiveMode)
+		, BoundsRadius(0.f)
+		, TexelFactor(0.f)
+		, ResidentCount(0)
 	{
 	}
 
 	virtual void Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance);
+	// draw instances in one call, InInstanceBuffer holds a mat4 transform per instance
+	virtual void DrawInstanced(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance,
+		const FOpenGLVertexBufferRef &InInstanceBuffer, GLsizei InInstanceCount);
+
+	// record the draw to command list without gl call, the meshes of a model are recorded on one thread
+	virtual void Record(FOpenGLCommandList &InCommandList, const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance);
+
+	// game thread: add the proxy of the mesh instance to frame, with the pose of model
+	virtual void Snapshot(FRenderFrame &OutFrame, const glm::mat4 &InTransform, const FModel &InModel, const FMeshInstance &MeshInstance);
+	// render thread: draw the proxy snapshotted by this mesh
+	virtual void DrawProxy(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FMeshRenderProxy &InProxy);
+
+	// vertex format on stream 0, instance transform on stream 1 (attributes 7~10), shared by all meshes
+	const FOpenGLVertexDeclarationRef& GetInstancedVertexDeclaration();
+
+	// the skinning is not applied in instanced draws
+	virtual bool IsSkinned() const { return false; }
+
+	// the mesh is shared by the instances of a model, each holder pairs InitRHI() with ReleaseRHI().
+	// the gl resources are created by the first InitRHI() and released by the last ReleaseRHI()
+	void InitRHI();
+	void ReleaseRHI();
+	bool IsResident() const { return ResidentCount > 0; }
+
+protected:
+	// the gl resources of InitRHI() and ReleaseRHI(), with the resident lock held
+	virtual void InitResources();
+	virtual void ReleaseResources();
+
+	// created by InitRHI(), so the recording threads only read it
+	virtual void InitVertexDeclaration();
+	// bounding sphere and uv density from the vertices, for texture streaming
+	void InitStreamingBounds();
 
-	virtual void InitRHI();
-	virtual void ReleaseRHI();
 public:
 	FOpenGLVertexDeclarationRef		VertexDeclRef;
+	FOpenGLVertexDeclarationRef		InstancedVertexDeclRef;
 
 	FMaterialRef		Material;
 	FVertexBufferRef	VertexBuffer;
 	FIndexBufferRef		IndexBuffer;
 	GLenum				PrimitiveMode;
+
+	// in mesh space, set by InitRHI()
+	glm::vec3			BoundsCenter;
+	float				BoundsRadius;
+	float				TexelFactor;	// world length per uv unit, 0 if the uv has no area
+
+protected:
+	// the holders may be on loader thread and render thread
+	std::mutex			ResidentMutex;
+	int					ResidentCount;
 };
 
 typedef TRefCountPtr<FMesh>		FMeshRef;
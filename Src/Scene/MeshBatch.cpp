@@ -0,0 +1,181 @@
+// \brief
+//		FMeshBatchBuilder implementation
+//
+
+#include <cassert>
+#include <OpenGL/OpenGLDrv.h>
+
+#include "MeshBatch.h"
+#include "Model.h"
+
+
+bool FMeshBatchBuilder::FBatchKey::operator<(const FBatchKey &Other) const
+{
+	if (VertexDeclaration != Other.VertexDeclaration) return VertexDeclaration < Other.VertexDeclaration;
+	if (VertexBuffer != Other.VertexBuffer) return VertexBuffer < Other.VertexBuffer;
+	if (IndexBuffer != Other.IndexBuffer) return IndexBuffer < Other.IndexBuffer;
+	if (Material != Other.Material) return Material < Other.Material;
+
+	return PrimitiveMode < Other.PrimitiveMode;
+}
+
+void FMeshBatchBuilder::AddModel(const FModel &InModel, const glm::mat4 &InModelMatrix)
+{
+	FNodeHierarchyRef NodeHierarchy = InModel.GetNodeHierarchy();
+	for (size_t Index = 0; Index < InModel.MeshInstances.size(); Index++)
+	{
+		const FMeshInstance &MeshInstance = InModel.MeshInstances[Index];
+
+		FMeshDraw Draw;
+		Draw.Mesh = InModel.Meshes[MeshInstance.MeshIdx];
+		Draw.Model = &InModel;
+		Draw.InstanceIdx = (int)Index;
+		Draw.ModelMatrix = InModelMatrix;
+		Draw.Transform = InModelMatrix;
+		if (MeshInstance.NodeIdx != NODE_INDEX_NONE)
+		{
+			assert(IsValidRef(NodeHierarchy));
+			Draw.Transform = InModelMatrix * NodeHierarchy->GetNode(MeshInstance.NodeIdx).ModelMat;
+		}
+		Draws.push_back(Draw);
+	} // end for
+}
+
+void FMeshBatchBuilder::Flush(const FViewContext &InViewContext, FRenderPolicy &InPolicy)
+{
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+
+	Stats = FMeshBatchStats();
+	Stats.Instances = Draws.size();
+
+	// group the instances
+	const bool bBatching = GLDriver.SupportsBaseInstance() && IsValidRef(InPolicy.InstancedMeshShader);
+	for (size_t Index = 0; Index < Draws.size(); Index++)
+	{
+		const FMeshDraw &Draw = Draws[Index];
+		if (!bBatching || Draw.Mesh->IsSkinned())
+		{
+			DrawUnbatched(InViewContext, InPolicy, Draw);
+			continue;
+		}
+
+		FBatchKey Key;
+		Key.VertexDeclaration = Draw.Mesh->GetInstancedVertexDeclaration();
+		Key.VertexBuffer = Draw.Mesh->VertexBuffer->GetRHIBuffer();
+		Key.IndexBuffer = Draw.Mesh->IndexBuffer->GetRHIBuffer();
+		Key.Material = Draw.Mesh->Material;
+		Key.PrimitiveMode = Draw.Mesh->PrimitiveMode;
+
+		FBatch &Batch = Batches[Key];
+		if (Batch.Draws.empty())
+		{
+			Batch.Mesh = Draw.Mesh;
+		}
+		Batch.Meshes.insert(Draw.Mesh);
+		Batch.Draws.push_back(Index);
+	} // end for
+
+	// build the commands, the draw id (BaseInstance) indexes the transforms
+	Transforms.clear();
+	Commands.clear();
+	for (std::map<FBatchKey, FBatch>::iterator It = Batches.begin(); It != Batches.end(); It++)
+	{
+		FBatch &Batch = It->second;
+		Batch.FirstCommand = (GLsizei)Commands.size();
+		for (size_t k = 0; k < Batch.Draws.size(); k++)
+		{
+			const FMeshDraw &Draw = Draws[Batch.Draws[k]];
+
+			FDrawElementsIndirectCommand Command;
+			Command.Count = Draw.Mesh->IndexBuffer->GetElementCount();
+			Command.InstanceCount = 1;
+			Command.FirstIndex = Draw.Mesh->IndexBuffer->GetFirstIndex();
+			Command.BaseVertex = Draw.Mesh->VertexBuffer->GetBaseVertex();
+			Command.BaseInstance = (GLuint)Transforms.size();
+			Transforms.push_back(Draw.Transform);
+
+			// the consecutive draws of same range are instances of one command
+			if ((GLsizei)Commands.size() > Batch.FirstCommand)
+			{
+				FDrawElementsIndirectCommand &Last = Commands.back();
+				if (Last.Count == Command.Count && Last.FirstIndex == Command.FirstIndex && Last.BaseVertex == Command.BaseVertex
+					&& Last.BaseInstance + Last.InstanceCount == Command.BaseInstance)
+				{
+					Last.InstanceCount++;
+					continue;
+				}
+			}
+			Commands.push_back(Command);
+		} // end for k
+		Batch.CommandCount = (GLsizei)Commands.size() - Batch.FirstCommand;
+	} // end for
+
+	if (!Commands.empty())
+	{
+		UploadBuffers();
+
+		// the transforms include the model matrix
+		FViewContext BatchViewContext(InViewContext);
+		BatchViewContext.model = glm::mat4();
+		for (std::map<FBatchKey, FBatch>::iterator It = Batches.begin(); It != Batches.end(); It++)
+		{
+			FBatch &Batch = It->second;
+			FMesh *Mesh = Batch.Mesh;
+
+			InPolicy.InstancedMeshShader->SetUp(BatchViewContext, *Mesh);
+
+			GLDriver.SetStreamSource(0, Mesh->VertexBuffer->GetRHIBuffer());
+			GLDriver.SetStreamSource(1, InstanceBuffer);
+			GLDriver.SetVertexDeclaration(Mesh->GetInstancedVertexDeclaration());
+			GLDriver.MultiDrawIndexedIndirect(Mesh->IndexBuffer->GetRHIBuffer(), Mesh->PrimitiveMode, IndirectBuffer, Batch.FirstCommand, Batch.CommandCount);
+
+			Stats.Batches++;
+			Stats.Meshes += Batch.Meshes.size();
+			Stats.DrawCalls++;
+		} // end for
+	}
+	Stats.Commands = Commands.size();
+
+	Draws.clear();
+	Batches.clear();
+}
+
+void FMeshBatchBuilder::DrawUnbatched(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FMeshDraw &InDraw)
+{
+	FViewContext LocalViewContext(InViewContext);
+	LocalViewContext.model = InDraw.ModelMatrix;
+
+	InDraw.Mesh->Draw(LocalViewContext, InPolicy, *InDraw.Model, InDraw.Model->MeshInstances[InDraw.InstanceIdx]);
+	Stats.DrawCalls++;
+}
+
+void FMeshBatchBuilder::UploadBuffers()
+{
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+
+	GLsizeiptr Bytes = Transforms.size() * sizeof(glm::mat4);
+	if (!IsValidRef(InstanceBuffer) || InstanceBuffer->GetSize() < Bytes)
+	{
+		InstanceBuffer = GLDriver.CreateVertexBuffer(Bytes, Transforms.data(), GL_DYNAMIC_DRAW);
+	}
+	else
+	{
+		InstanceBuffer->UpdateData(0, Bytes, Transforms.data());
+	}
+
+	GLsizei CommandCount = (GLsizei)Commands.size();
+	if (!IsValidRef(IndirectBuffer) || IndirectBuffer->GetCommandCount() < CommandCount)
+	{
+		IndirectBuffer = GLDriver.CreateIndirectBuffer(CommandCount, Commands.data());
+	}
+	else
+	{
+		IndirectBuffer->UpdateCommands(CommandCount, Commands.data());
+	}
+}
+
+void FMeshBatchBuilder::ReleaseRHI()
+{
+	InstanceBuffer.SafeRelease();
+	IndirectBuffer.SafeRelease();
+}
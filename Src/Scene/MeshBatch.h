@@ -0,0 +1,105 @@
+// \brief
+//		Mesh batch builder, draws the mesh instances by multi-draw indirect
+//
+
+#ifndef __JETX_SCENE_MESHBATCH_H__
+#define __JETX_SCENE_MESHBATCH_H__
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <OpenGL/GLBuffer.h>
+#include "RenderResource.h"
+#include "Render.h"
+#include "Mesh.h"
+
+
+class FModel;
+struct FMeshInstance;
+
+// statistics of last flush
+struct FMeshBatchStats
+{
+	FMeshBatchStats()
+		: Instances(0)
+		, Batches(0)
+		, Commands(0)
+		, DrawCalls(0)
+		, Meshes(0)
+	{}
+
+	unsigned int	Instances;	// mesh instances added
+	unsigned int	Batches;	// multi-draw calls
+	unsigned int	Commands;	// indirect commands
+	unsigned int	DrawCalls;	// all draw calls, include the not batched
+	unsigned int	Meshes;		// distinct meshes of the batches, more than Batches if meshes are grouped
+};
+
+// \brief
+//	the mesh instances sharing vertex declaration, program, buffers and material are grouped into one
+//	MultiDrawIndexedIndirect. the per-draw transform is an instanced attribute, BaseInstance of a command is
+//	its draw id to fetch the transform. without ARB_base_instance the draw id can not be passed,
+//	then each instance is drawn by FMesh::Draw, as the skinning meshes always are.
+class FMeshBatchBuilder
+{
+public:
+	FMeshBatchBuilder()
+	{}
+
+	// collect the mesh instances of model, the model must be alive until Flush()
+	void AddModel(const FModel &InModel, const glm::mat4 &InModelMatrix);
+
+	// draw the collected instances with the policy's InstancedMeshShader, then reset for next frame
+	void Flush(const FViewContext &InViewContext, FRenderPolicy &InPolicy);
+
+	void ReleaseRHI();
+
+	const FMeshBatchStats& GetStats() const { return Stats; }
+
+protected:
+	struct FMeshDraw
+	{
+		FMesh			*Mesh;
+		const FModel	*Model;
+		int				InstanceIdx;
+		glm::mat4		ModelMatrix;	// of model
+		glm::mat4		Transform;		// of mesh instance
+	};
+
+	// the declaration is shared and the buffers are the arena pages, so the meshes of a page and material are one batch
+	struct FBatchKey
+	{
+		const FOpenGLVertexDeclaration	*VertexDeclaration;
+		const FOpenGLVertexBuffer		*VertexBuffer;
+		const FOpenGLIndexBuffer		*IndexBuffer;
+		const FMaterial					*Material;
+		GLenum							PrimitiveMode;
+
+		bool operator<(const FBatchKey &Other) const;
+	};
+
+	struct FBatch
+	{
+		FMesh			*Mesh;	// the buffers & material are shared by the batch
+		std::set<const FMesh*>	Meshes;
+		GLsizei			FirstCommand;
+		GLsizei			CommandCount;
+		std::vector<size_t>	Draws;
+	};
+
+	void DrawUnbatched(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FMeshDraw &InDraw);
+	void UploadBuffers();
+
+	std::vector<FMeshDraw>		Draws;
+	std::map<FBatchKey, FBatch>	Batches;
+
+	std::vector<glm::mat4>						Transforms;
+	std::vector<FDrawElementsIndirectCommand>	Commands;
+	FOpenGLVertexBufferRef		InstanceBuffer;
+	FOpenGLIndirectBufferRef	IndirectBuffer;
+
+	FMeshBatchStats		Stats;
+};
+
+#endif // __JETX_SCENE_MESHBATCH_H__
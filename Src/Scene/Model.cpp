@@ -3,6 +3,7 @@
 //
 
 #include <cassert>
+#include <chrono>
 #include <iostream>
 #include <queue>
 #include <vector>
@@ -12,8 +13,12 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <Common/JobSystem.h>
 #include "Model.h"
 #include "SkinMesh.h"
+#include "AssetRegistry.h"
+#include "CookedModel.h"
+#include "CompressedTexture.h"
 
 
 //===========================================================================================
@@ -25,6 +30,11 @@ struct FAssimpLoadContext
 	std::string		AssetFolder;
 	const aiScene	*Scene;
 	FModelRef		Model;
+
+	// the textures shared by materials are loaded once
+	std::map<std::string, FTexture2DRef>	Textures;
+	// not null for deferred decoding, collects the textures to decode
+	std::vector<FTexture2DRef>	*DeferredTextures;
 };
 
 
@@ -329,6 +339,8 @@ static void Assimp_Process_One_Mesh(FAssimpLoadContext &Context, aiMesh *InMesh)
 
 		FVertexSkinBufferRef VSkinBufferRef = new FVertexSkinBuffer();
 		VSkinBufferRef->FillBuffer(SkinVertexInfo);
+		// the base vertex would offset the skin stream too, keep the vertices in own buffer
+		VBufferRef->bPooled = false;
 
 		FSkinMeshRef NewMesh = new FSkinMesh(Material, VBufferRef, VSkinBufferRef, IBufferRef, GL_TRIANGLES, MeshBones);
 		Context.Model->Meshes.push_back(NewMesh.DeRef());
@@ -361,8 +373,26 @@ static FTexture2DRef Assimp_ProcessMaterialTexture(FAssimpLoadContext &Context,
 
 	std::string Pathname = Context.AssetFolder + '/' + Filename.C_Str();
 
+	std::map<std::string, FTexture2DRef>::iterator itr = Context.Textures.find(Pathname);
+	if (itr != Context.Textures.end())
+	{
+		return itr->second;
+	}
+
 	std::cout << "Assimp_ProcessMaterialTexture: " << Pathname.c_str() << std::endl;
-	return FTexture2D::CreateTexture(Pathname);
+	FTexture2DRef Texture;
+	if (Context.DeferredTextures)
+	{
+		Texture = FTexture2D::CreateTextureDeferred(Pathname);
+		Context.DeferredTextures->push_back(Texture);
+	}
+	else
+	{
+		Texture = FTexture2D::CreateTexture(Pathname);
+	}
+	Context.Textures[Pathname] = Texture;
+
+	return Texture;
 }
 
 // process materials
@@ -387,11 +417,15 @@ static void Assimp_ProcessMaterials(FAssimpLoadContext &Context)
 
 }
 
-FModelRef FModel::CreateModel(const std::string &InFilename)
+// post-processing of assimp import
+static const unsigned int kAssimpImportFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_LimitBoneWeights;
+
+// import by assimp, no gl call
+static FModelRef Assimp_ImportModel(const std::string &InFilename, std::vector<FTexture2DRef> *OutDeferredTextures)
 {
 	// Read file via ASSIMP
 	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(InFilename, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_LimitBoneWeights);
+	const aiScene* scene = importer.ReadFile(InFilename, kAssimpImportFlags);
 	// Check for errors
 	if (!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
 	{
@@ -409,6 +443,7 @@ FModelRef FModel::CreateModel(const std::string &InFilename)
 	Context.AssetFolder = AssetFolder;
 	Context.Scene = scene;
 	Context.Model = NewModel;
+	Context.DeferredTextures = OutDeferredTextures;
 
 	// Process Materials;
 	Assimp_ProcessMaterials(Context);
@@ -428,6 +463,168 @@ FModelRef FModel::CreateModel(const std::string &InFilename)
 	return NewModel;
 }
 
+
+FModel::~FModel()
+{
+	FAssetRegistry::SharedInstance().Unregister(this);
+}
+
+std::string FModel::GetAssetKey(const std::string &InFilename)
+{
+	return FAssetRegistry::MakeKey("Model", InFilename, kAssimpImportFlags);
+}
+
+FModelRef FModel::CreateModel(const std::string &InFilename)
+{
+	FAssetRegistry &Registry = FAssetRegistry::SharedInstance();
+	const std::string Key = GetAssetKey(InFilename);
+
+	FModelRef Model = (FModel*)Registry.Find(Key).DeRef();
+	if (!IsValidRef(Model))
+	{
+		// the textures are found first, then decoded in parallel
+		std::vector<FTexture2DRef> Textures;
+		Model = ImportModel(InFilename, &Textures);
+		if (IsValidRef(Model))
+		{
+			DecodeTextures(Textures, Model->ImportStats);
+			Model->ImportStats.Print(InFilename);
+			Model = (FModel*)Registry.Register(Key, Model).DeRef();
+		}
+	}
+
+	return IsValidRef(Model) ? Model->CreateInstance() : Model;
+}
+
+FModelRef FModel::CreateInstance()
+{
+	FModelRef Instance = new FModel();
+	Instance->Materials = Materials;
+	Instance->Meshes = Meshes;
+	Instance->AssetPathname = AssetPathname;
+	Instance->ImportStats = ImportStats;
+	Instance->NodeAnimSequences = NodeAnimSequences;
+	Instance->OrgNodeHierarchy = OrgNodeHierarchy;
+	Instance->MeshInstances = MeshInstances;
+	Instance->SourceModel = IsValidRef(SourceModel) ? SourceModel : FModelRef(this);
+
+	return Instance;
+}
+
+void FModel::DecodeTextures(const std::vector<FTexture2DRef> &InTextures, FModelImportStats &OutStats)
+{
+	std::chrono::steady_clock::time_point DecodeStart = std::chrono::steady_clock::now();
+
+	// a flag per texture, no shared write
+	std::vector<char> Decoded(InTextures.size(), 0);
+	FJobSystem::SharedInstance().ParallelFor(0, InTextures.size(), 1, [&InTextures, &Decoded](size_t Begin, size_t End) {
+		for (size_t k = Begin; k < End; k++)
+		{
+			Decoded[k] = InTextures[k]->LoadDeferred();
+		} // end for k
+	});
+
+	OutStats.AccumulateDecodes(InTextures, Decoded);
+	OutStats.DecodeWallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - DecodeStart).count();
+}
+
+void FModelImportStats::AccumulateDecodes(const std::vector<FTexture2DRef> &InTextures, const std::vector<char> &InDecoded)
+{
+	assert(InTextures.size() == InDecoded.size());
+	for (size_t Index = 0; Index < InTextures.size(); Index++)
+	{
+		if (InDecoded[Index])
+		{
+			TexturesDecoded++;
+			TexturesCompressed += InTextures[Index]->IsCompressed() ? 1 : 0;
+			BytesDecoded += InTextures[Index]->GetDecodedBytes();
+			VramBytes += InTextures[Index]->GetGPUBytes();
+			VramBytesUncompressed += InTextures[Index]->GetUncompressedGPUBytes();
+			DecodeCpuMs += InTextures[Index]->GetDecodeMs();
+			DecodeMsPerFile.push_back(std::make_pair(InTextures[Index]->GetFilename(), InTextures[Index]->GetDecodeMs()));
+		}
+	} // end for
+}
+
+void FModelImportStats::Print(const std::string &InFilename) const
+{
+	std::cout << "Import: " << InFilename << (bCooked ? " (cooked)" : "") << ", Parse: " << ParseMs << "ms, Textures: " << TexturesDecoded
+		<< ", Decoded: " << BytesDecoded / 1024 << "KB, Decode CPU: " << DecodeCpuMs << "ms, Decode Wall: " << DecodeWallMs << "ms" << std::endl;
+	std::cout << "    Compressed: " << TexturesCompressed << "/" << TexturesDecoded << ", VRAM: " << VramBytes / 1024 << "KB, Uncompressed: " << VramBytesUncompressed / 1024 << "KB" << std::endl;
+	for (size_t Index = 0; Index < DecodeMsPerFile.size(); Index++)
+	{
+		std::cout << "    " << DecodeMsPerFile[Index].first << ": " << DecodeMsPerFile[Index].second << "ms" << std::endl;
+	} // end for
+}
+
+FModelRef FModel::ImportModel(const std::string &InFilename, std::vector<FTexture2DRef> *OutDeferredTextures)
+{
+	std::chrono::steady_clock::time_point ParseStart = std::chrono::steady_clock::now();
+
+	// the cooked file is mapped, assimp is the fallback when it is stale or absent
+	FModelRef NewModel = FCookedModel::Load(InFilename, kAssimpImportFlags, OutDeferredTextures);
+	if (IsValidRef(NewModel))
+	{
+		NewModel->ImportStats.bCooked = true;
+	}
+	else
+	{
+		NewModel = Assimp_ImportModel(InFilename, OutDeferredTextures);
+	}
+
+	if (IsValidRef(NewModel))
+	{
+		NewModel->ImportStats.ParseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ParseStart).count();
+	}
+	return NewModel;
+}
+
+// cook the texture if the dds file is stale
+static bool CookTexture(const FTexture2DRef &InTexture, ETextureUsage InUsage)
+{
+	if (!IsValidRef(InTexture) || FCompressedTexture::IsUpToDate(InTexture->GetFilename()))
+	{
+		return true;
+	}
+
+	return FCompressedTexture::Cook(InTexture->GetFilename(), InUsage);
+}
+
+bool FModel::CookModel(const std::string &InFilename)
+{
+	// the textures are referenced by path, no need to decode
+	std::vector<FTexture2DRef> Textures;
+	FModelRef Model;
+	if (FCookedModel::IsUpToDate(InFilename, kAssimpImportFlags))
+	{
+		std::cout << "Info: Cooked Model Is Up To Date: " << FCookedModel::GetCookedFilename(InFilename) << std::endl;
+		Model = FCookedModel::Load(InFilename, kAssimpImportFlags, &Textures);
+	}
+	else
+	{
+		Model = Assimp_ImportModel(InFilename, &Textures);
+		if (IsValidRef(Model) && !FCookedModel::Cook(*Model, InFilename, kAssimpImportFlags))
+		{
+			return false;
+		}
+	}
+
+	if (!IsValidRef(Model))
+	{
+		return false;
+	}
+
+	bool bSuccess = true;
+	for (size_t Index = 0; Index < Model->Materials.size(); Index++)
+	{
+		const FMaterialRef &Material = Model->Materials[Index];
+		bSuccess &= CookTexture(Material->TexDiffuse, TU_Color);
+		bSuccess &= CookTexture(Material->TexSpecular, TU_Color);
+		bSuccess &= CookTexture(Material->TexNormal, TU_Normal);
+	} // end for
+	return bSuccess;
+}
+
 // Create Plane
 FModelRef FModel::CreatePlane(const char* InDiffuseTex)
 {
@@ -570,18 +767,33 @@ FModelRef FModel::CreateCube(const char *InDiffuseTex)
 
 void FModel::InitRHI()
 {
+	ResidentCount++;
 	for (size_t Index = 0; Index < Meshes.size(); Index++)
 	{
 		Meshes[Index]->InitRHI();
 	}
+	FAssetRegistry::SharedInstance().SetResident(IsValidRef(SourceModel) ? SourceModel.DeRef() : this, true);
 }
 
 void FModel::ReleaseRHI()
 {
+	if (ResidentCount == 0)
+	{
+		return;
+	}
+	ResidentCount--;
+
 	for (size_t Index = 0; Index < Meshes.size(); Index++)
 	{
 		Meshes[Index]->ReleaseRHI();
 	}
+	if (ResidentCount == 0)
+	{
+		InstanceBuffer.SafeRelease();
+	}
+	// resident while another instance holds the meshes
+	const bool bResident = !Meshes.empty() && Meshes[0]->IsResident();
+	FAssetRegistry::SharedInstance().SetResident(IsValidRef(SourceModel) ? SourceModel.DeRef() : this, bResident);
 }
 
 void FModel::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy)
@@ -593,6 +805,48 @@ void FModel::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy)
 	}
 }
 
+void FModel::Record(FOpenGLCommandList &InCommandList, const FViewContext &InViewContext, FRenderPolicy &InPolicy)
+{
+	for (size_t Index = 0; Index < MeshInstances.size(); Index++)
+	{
+		FMeshRef Mesh = Meshes[MeshInstances[Index].MeshIdx];
+		Mesh->Record(InCommandList, InViewContext, InPolicy, *this, MeshInstances[Index]);
+	}
+}
+
+void FModel::Snapshot(FRenderFrame &OutFrame, const glm::mat4 &InTransform)
+{
+	for (size_t Index = 0; Index < MeshInstances.size(); Index++)
+	{
+		FMeshRef Mesh = Meshes[MeshInstances[Index].MeshIdx];
+		Mesh->Snapshot(OutFrame, InTransform, *this, MeshInstances[Index]);
+	}
+}
+
+void FModel::DrawInstanced(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const std::vector<glm::mat4> &InTransforms)
+{
+	if (InTransforms.empty())
+	{
+		return;
+	}
+
+	GLsizeiptr Bytes = InTransforms.size() * sizeof(glm::mat4);
+	if (!IsValidRef(InstanceBuffer) || InstanceBuffer->GetSize() < Bytes)
+	{
+		InstanceBuffer = FOpenGLDrv::SharedInstance().CreateVertexBuffer(Bytes, InTransforms.data(), GL_DYNAMIC_DRAW);
+	}
+	else
+	{
+		InstanceBuffer->UpdateData(0, Bytes, InTransforms.data());
+	}
+
+	for (size_t Index = 0; Index < MeshInstances.size(); Index++)
+	{
+		FMeshRef Mesh = Meshes[MeshInstances[Index].MeshIdx];
+		Mesh->DrawInstanced(InViewContext, InPolicy, *this, MeshInstances[Index], InstanceBuffer, (GLsizei)InTransforms.size());
+	}
+}
+
 void FModel::Tick(float deltTime)
 {
 	if (SeqPlayedIndex == NODE_INDEX_NONE)
@@ -5,6 +5,7 @@
 #ifndef __JETX_SCENE_MODEL_H__
 #define __JETX_SCENE_MODEL_H__
 
+#include <functional>
 #include <vector>
 #include <string>
 #include <map>
@@ -191,6 +192,10 @@ typedef TRefCountPtr<FNodeAnimationSequence> FNodeAnimationSequenceRef;
 class FModel;
 typedef TRefCountPtr<FModel>	FModelRef;
 
+class FModelLoadRequest;
+typedef TRefCountPtr<FModelLoadRequest>	FModelLoadRequestRef;
+typedef std::function<void(FModelLoadRequest&)>	FModelLoadCallback;
+
 struct FMeshInstance
 {
 	FMeshInstance()
@@ -207,22 +212,82 @@ struct FMeshInstance
 	int		MeshIdx;
 };
 
+// statistics of a model import
+struct FModelImportStats
+{
+	FModelImportStats()
+		: bCooked(false)
+		, ParseMs(0.0)
+		, TexturesDecoded(0)
+		, TexturesCompressed(0)
+		, BytesDecoded(0)
+		, VramBytes(0)
+		, VramBytesUncompressed(0)
+		, DecodeCpuMs(0.0)
+		, DecodeWallMs(0.0)
+	{}
+
+	// add the textures decoded by this import, InDecoded[k] is set if InTextures[k] is decoded by it
+	void AccumulateDecodes(const std::vector<FTexture2DRef> &InTextures, const std::vector<char> &InDecoded);
+	void Print(const std::string &InFilename) const;
+
+	bool			bCooked;		// loaded from the cooked file
+	double			ParseMs;		// assimp import and vertex conversion, or loading of the cooked file
+	unsigned int	TexturesDecoded;	// the shared textures decoded before are not counted
+	unsigned int	TexturesCompressed;	// loaded from the dds files
+	size_t			BytesDecoded;
+	size_t			VramBytes;			// the texture levels in video memory
+	size_t			VramBytesUncompressed;	// the same levels if none were compressed
+	double			DecodeCpuMs;	// summed over the textures
+	double			DecodeWallMs;	// the decoding phase, less than cpu time when parallel
+
+	std::vector<std::pair<std::string, double>>	DecodeMsPerFile;
+};
+
 // class Model
 class FModel : public FRefCountedObject
 {
 public:
 	FModel()
-		: TimeElapse(0.f)
+		: ResidentCount(0)
+		, TimeElapse(0.f)
 		, IsPlaying(false)
 		, SeqPlayedIndex(NODE_INDEX_NONE)
 	{}
+	virtual ~FModel();
 
+	// the meshes, materials and animations are shared by path through FAssetRegistry,
+	// each call returns a new instance with its own play state
 	static FModelRef CreateModel(const std::string &InFilename);
+	// parse, convert and decode on the job system, InitRHI is time-sliced by FModelLoader::Tick() on the gl thread.
+	// the callbacks are called on the gl thread
+	static FModelLoadRequestRef CreateModelAsync(const std::string &InFilename, const FModelLoadCallback &InOnComplete = FModelLoadCallback(),
+		const FModelLoadCallback &InOnProgress = FModelLoadCallback());
+	// no gl call, safe on worker threads. the textures are not decoded if OutDeferredTextures is not null,
+	// they are appended to it for the caller to decode
+	// the cooked file of FCookedModel is loaded if it is up to date, otherwise the source is imported by assimp
+	static FModelRef ImportModel(const std::string &InFilename, std::vector<FTexture2DRef> *OutDeferredTextures);
+	// offline: import the source by assimp and write the cooked file, skipped if it is up to date
+	static bool CookModel(const std::string &InFilename);
+	// key in FAssetRegistry, with the import options
+	static std::string GetAssetKey(const std::string &InFilename);
+	// decode the textures on the job system concurrently, returns when all are done
+	static void DecodeTextures(const std::vector<FTexture2DRef> &InTextures, FModelImportStats &OutStats);
 	static FModelRef CreatePlane(const char *InDiffuseTex);
 	static FModelRef CreateCube(const char *InDiffuseTex);
 
-	void Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy);
+	// a model sharing the meshes, materials, hierarchy and animations of this one, not playing
+	FModelRef CreateInstance();
 
+	void Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy);
+	// record the draws to command list without gl call, e.g. on a worker thread, then execute the list on the gl thread
+	void Record(FOpenGLCommandList &InCommandList, const FViewContext &InViewContext, FRenderPolicy &InPolicy);
+	// game thread: snapshot the current pose to the proxies of frame, drawn later by render thread
+	void Snapshot(FRenderFrame &OutFrame, const glm::mat4 &InTransform);
+	// draw the model once per transform with instanced draw calls, the skinned meshes are in bind pose
+	void DrawInstanced(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const std::vector<glm::mat4> &InTransforms);
+
+	// each instance pairs InitRHI() with ReleaseRHI(), the shared meshes are released by the last one
 	void InitRHI();
 	void ReleaseRHI();
 
@@ -242,6 +307,7 @@ public:
 	std::vector<FMaterialRef>	Materials;
 	std::vector<FMeshRef>		Meshes;
 	std::string					AssetPathname;
+	FModelImportStats			ImportStats;
 
 	std::vector<FNodeAnimationSequenceRef>	NodeAnimSequences;
 	FNodeHierarchyRef			OrgNodeHierarchy;  // Origin Hierarchy
@@ -249,6 +315,13 @@ public:
 	// Mesh Instances
 	std::vector<FMeshInstance>	MeshInstances;
 
+	// per-instance transforms of DrawInstanced
+	FOpenGLVertexBufferRef		InstanceBuffer;
+
+	// the registered model of the shared data, kept alive by its instances. null if this one is registered or not shared
+	FModelRef			SourceModel;
+	int					ResidentCount;	// InitRHI() not released yet
+
 	// PlayInstance Information
 	FNodeHierarchyRef	PlayingHierarchy;
 	float				TimeElapse;
@@ -0,0 +1,217 @@
+// \brief
+//		implementation of asynchronous model loading
+//
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include "AssetRegistry.h"
+#include "LoaderThread.h"
+#include "ModelLoader.h"
+
+
+FModelLoadRequestRef FModel::CreateModelAsync(const std::string &InFilename, const FModelLoadCallback &InOnComplete, const FModelLoadCallback &InOnProgress)
+{
+	return FModelLoader::SharedInstance().Load(InFilename, InOnComplete, InOnProgress);
+}
+
+FModelLoader& FModelLoader::SharedInstance()
+{
+	static FModelLoader Loader;
+
+	return Loader;
+}
+
+FModelLoadRequestRef FModelLoader::Load(const std::string &InFilename, const FModelLoadCallback &InOnComplete, const FModelLoadCallback &InOnProgress)
+{
+	FJobSystem &JobSystem = FJobSystem::SharedInstance();
+	assert(JobSystem.GetNumWorkers() > 0);
+
+	FModelLoadRequestRef Request = new FModelLoadRequest(InFilename);
+	Request->OnComplete = InOnComplete;
+	Request->OnProgress = InOnProgress;
+	Requests.push_back(Request);
+
+	// the data of a loaded model is shared, only its gl resources are made sure. the request completes with a new instance
+	FModelRef Model = (FModel*)FAssetRegistry::SharedInstance().Find(FModel::GetAssetKey(InFilename)).DeRef();
+	if (IsValidRef(Model))
+	{
+		Request->Model = Model;
+		Request->StepsTotal = 1 + (unsigned int)Model->Meshes.size();
+		Request->StepsDone = 1;
+		PrepareUploadJob(Request);
+		return Request;
+	}
+
+	// the request is kept alive by Requests until it is finished
+	FModelLoadRequest *RawRequest = Request;
+	JobSystem.Run([RawRequest]() { ParseJob(RawRequest); });
+
+	return Request;
+}
+
+void FModelLoader::ParseJob(FModelLoadRequest *InRequest)
+{
+	FJobSystem &JobSystem = FJobSystem::SharedInstance();
+
+	FModelRef Model = FModel::ImportModel(InRequest->Filename, &InRequest->Textures);
+	if (!IsValidRef(Model))
+	{
+		std::cout << "Error: Load Model Failed: " << InRequest->Filename << std::endl;
+		InRequest->State.store(MLS_Failed, std::memory_order_release);
+		return;
+	}
+	InRequest->Model = Model;
+
+	const unsigned int kNumTextures = (unsigned int)InRequest->Textures.size();
+	InRequest->StepsTotal = 1 + kNumTextures + kNumTextures + (unsigned int)Model->Meshes.size();
+	InRequest->StepsDone = 1;
+	InRequest->TexturesDecoded.resize(kNumTextures, 0);
+	InRequest->DecodeStart = std::chrono::steady_clock::now();
+	InRequest->State.store(MLS_Decoding, std::memory_order_release);
+
+	for (unsigned int Index = 0; Index < kNumTextures; Index++)
+	{
+		JobSystem.Run([InRequest, Index]() {
+			InRequest->TexturesDecoded[Index] = InRequest->Textures[Index]->LoadDeferred();
+			InRequest->StepsDone++;
+		}, &InRequest->DecodeCounter);
+	} // end for
+	JobSystem.Run([InRequest]() { PrepareUploadJob(InRequest); }, nullptr, &InRequest->DecodeCounter);
+}
+
+void FModelLoader::PrepareUploadJob(FModelLoadRequest *InRequest)
+{
+	if (!InRequest->TexturesDecoded.empty())
+	{
+		FModelImportStats &Stats = InRequest->Model->ImportStats;
+		Stats.AccumulateDecodes(InRequest->Textures, InRequest->TexturesDecoded);
+		Stats.DecodeWallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - InRequest->DecodeStart).count();
+		Stats.Print(InRequest->Filename);
+	}
+
+	for (size_t Index = 0; Index < InRequest->Textures.size(); Index++)
+	{
+		FTexture2DRef Texture = InRequest->Textures[Index];
+		InRequest->UploadItems.push_back([Texture]() { Texture->InitRHIAsync(); });
+	} // end for
+
+	// the materials of meshes are initialized already
+	const std::vector<FMeshRef> &Meshes = InRequest->Model->Meshes;
+	for (size_t Index = 0; Index < Meshes.size(); Index++)
+	{
+		FMeshRef Mesh = Meshes[Index];
+		InRequest->UploadItems.push_back([Mesh]() { Mesh->InitRHI(); });
+	} // end for
+
+	InRequest->State.store(MLS_Uploading, std::memory_order_release);
+}
+
+bool FModelLoader::AreTexturesSubmitted(const FModelLoadRequest &InRequest)
+{
+	for (size_t Index = 0; Index < InRequest.Textures.size(); Index++)
+	{
+		if (!InRequest.Textures[Index]->IsUploadSubmitted())
+		{
+			return false;
+		}
+	} // end for
+
+	return true;
+}
+
+void FModelLoader::Tick(double InBudgetMs)
+{
+	typedef std::chrono::steady_clock FClock;
+	const FClock::time_point Deadline = FClock::now() + std::chrono::microseconds((long long)(InBudgetMs * 1000.0));
+	bool bUploaded = false;
+
+	FLoaderThread &LoaderThread = FLoaderThread::SharedInstance();
+	if (LoaderThread.IsRunning())
+	{
+		LoaderThread.Tick();
+	}
+
+	for (size_t Index = 0; Index < Requests.size();)
+	{
+		FModelLoadRequestRef Request = Requests[Index];
+
+		if (Request->GetState() == MLS_Uploading)
+		{
+			if (!Request->bEnqueued && LoaderThread.IsRunning())
+			{
+				// no frame time, the items are visible after the fence of the task. the request is kept alive by Requests
+				FModelLoadRequest *RawRequest = Request;
+				Request->bEnqueued = true;
+				LoaderThread.Enqueue([RawRequest]() {
+					for (size_t Item = 0; Item < RawRequest->UploadItems.size(); Item++)
+					{
+						RawRequest->UploadItems[Item]();
+						RawRequest->StepsDone++;
+					} // end for
+				}, [RawRequest]() {
+					RawRequest->NextUpload = RawRequest->UploadItems.size();
+				});
+			}
+			else if (!Request->bEnqueued)
+			{
+				// one item at least per tick, so a tiny budget still makes progress
+				while (Request->NextUpload < Request->UploadItems.size() && (!bUploaded || FClock::now() < Deadline))
+				{
+					Request->UploadItems[Request->NextUpload++]();
+					Request->StepsDone++;
+					bUploaded = true;
+				} // end while
+			}
+
+			if (Request->NextUpload == Request->UploadItems.size() && !AreTexturesSubmitted(*Request))
+			{
+				// the pixels are copied by jobs, submit the copied ones now instead of at the end of frame
+				FOpenGLDrv::SharedInstance().GetTextureUploader()->Tick();
+			}
+
+			if (Request->NextUpload == Request->UploadItems.size() && AreTexturesSubmitted(*Request))
+			{
+				// the same file may be loaded by two requests at a time, the first one is kept
+				FModelRef Loaded = Request->Model;
+				FModelRef Registered = (FModel*)FAssetRegistry::SharedInstance().Register(FModel::GetAssetKey(Request->Filename), Loaded).DeRef();
+				Request->Model = Registered->CreateInstance();
+				Request->Model->InitRHI();
+
+				// the instance holds the meshes and their textures now, drop the holds of the upload items
+				for (size_t Mesh = 0; Mesh < Loaded->Meshes.size(); Mesh++)
+				{
+					Loaded->Meshes[Mesh]->ReleaseRHI();
+				} // end for
+				for (size_t Texture = 0; Texture < Request->Textures.size(); Texture++)
+				{
+					Request->Textures[Texture]->ReleaseRHI();
+				} // end for
+				Request->UploadItems.clear();
+				Request->Textures.clear();
+				Request->State.store(MLS_Done, std::memory_order_release);
+			}
+		}
+
+		const unsigned int kStepsDone = Request->StepsDone.load();
+		if (Request->OnProgress && kStepsDone != Request->LastReportedSteps)
+		{
+			Request->LastReportedSteps = kStepsDone;
+			Request->OnProgress(*Request);
+		}
+
+		if (Request->IsFinished())
+		{
+			if (Request->OnComplete)
+			{
+				Request->OnComplete(*Request);
+			}
+			Requests.erase(Requests.begin() + Index);
+		}
+		else
+		{
+			Index++;
+		}
+	} // end for
+}
@@ -0,0 +1,110 @@
+// \brief
+//		asynchronous model loading, cpu phases on job system and gl phase time-sliced on gl thread
+//
+
+#ifndef __JETX_SCENE_MODEL_LOADER_H__
+#define __JETX_SCENE_MODEL_LOADER_H__
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <Common/JobSystem.h>
+#include "Model.h"
+
+
+enum EModelLoadState
+{
+	MLS_Parsing,		// assimp import and vertex conversion
+	MLS_Decoding,		// texture decoding
+	MLS_Uploading,		// waiting or running InitRHI on gl thread
+	MLS_Done,
+	MLS_Failed,
+};
+
+// handle of a model loading
+class FModelLoadRequest : public FRefCountedObject
+{
+public:
+	FModelLoadRequest(const std::string &InFilename)
+		: Filename(InFilename)
+		, State(MLS_Parsing)
+		, StepsTotal(1)
+		, StepsDone(0)
+		, NextUpload(0)
+		, bEnqueued(false)
+		, LastReportedSteps(0)
+	{}
+
+	EModelLoadState GetState() const { return (EModelLoadState)State.load(std::memory_order_acquire); }
+	bool IsFinished() const { EModelLoadState kState = GetState(); return kState == MLS_Done || kState == MLS_Failed; }
+
+	// 0 ~ 1, the total is known after parsing
+	float GetProgress() const { return (float)StepsDone.load() / (float)StepsTotal.load(); }
+
+	// valid when done
+	const FModelRef& GetModel() const { return Model; }
+	const std::string& GetFilename() const { return Filename; }
+
+private:
+	friend class FModelLoader;
+
+	std::string			Filename;
+	std::atomic<int>	State;
+	std::atomic<unsigned int>	StepsTotal;		// parse + decodes + uploads
+	std::atomic<unsigned int>	StepsDone;
+
+	// written by jobs before the state is uploading, then owned by gl thread
+	FModelRef					Model;
+	std::vector<FTexture2DRef>	Textures;
+	std::vector<char>			TexturesDecoded;	// set by the decoding job of each texture
+	std::chrono::steady_clock::time_point	DecodeStart;
+	FJobCounter					DecodeCounter;
+	std::vector<std::function<void()>>	UploadItems;	// InitRHI of textures, then meshes
+	size_t						NextUpload;
+	bool						bEnqueued;		// the items are run by loader thread
+
+	FModelLoadCallback	OnComplete;
+	FModelLoadCallback	OnProgress;
+	unsigned int		LastReportedSteps;
+};
+
+// \brief
+//	Load() queues the parsing on job system, the textures are decoded by parallel jobs.
+//	Tick() on gl thread runs InitRHI of loaded textures and meshes until the budget is used up,
+//	a texture or a mesh is not split, one is run at least per tick. the pixels of textures are copied to the upload ring by jobs,
+//	the request is done after the uploads are submitted.
+//	if FLoaderThread is running, all items of a request run on it instead, and the request is done when they are published.
+//	the job system must have workers, the gl thread doesn't run the cpu phases.
+class FModelLoader
+{
+public:
+	static FModelLoader& SharedInstance();
+
+	FModelLoadRequestRef Load(const std::string &InFilename, const FModelLoadCallback &InOnComplete, const FModelLoadCallback &InOnProgress);
+
+	// gl thread: upload within InBudgetMs milliseconds, and call the callbacks. publish the loader thread tasks if running
+	void Tick(double InBudgetMs);
+
+	// requests not finished yet
+	size_t GetPendingCount() const { return Requests.size(); }
+
+private:
+	FModelLoader() {}
+	FModelLoader(const FModelLoader&) = delete;
+	FModelLoader& operator=(const FModelLoader&) = delete;
+
+	// job: import the model, then decode the textures in parallel
+	static void ParseJob(FModelLoadRequest *InRequest);
+	// job: after decoding, make the list of gl work
+	static void PrepareUploadJob(FModelLoadRequest *InRequest);
+	// the texture uploads are issued, the model is not done before
+	static bool AreTexturesSubmitted(const FModelLoadRequest &InRequest);
+
+	// gl thread only
+	std::vector<FModelLoadRequestRef>	Requests;
+};
+
+#endif // __JETX_SCENE_MODEL_LOADER_H__
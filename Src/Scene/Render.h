@@ -11,6 +11,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <OpenGL/OpenGLDrv.h>
+#include <OpenGL/GLUniformLayout.h>
 #include "ShaderType.h"
 
 
@@ -23,12 +24,86 @@ struct FViewContext
 	glm::mat4	projection;
 };
 
+// per-view uniform block "ViewBlock" shared by programs.
+// the buffer is uploaded only when the view changes, not per draw
+class FViewUniformBuffer
+{
+public:
+	static FViewUniformBuffer& SharedInstance()
+	{
+		static FViewUniformBuffer ViewUniformBuffer;
+
+		return ViewUniformBuffer;
+	}
+
+	static const GLchar* GetBlockName() { return "ViewBlock"; }
+
+	void SetUp(const FViewContext &InView)
+	{
+		FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+
+		if (!IsValidRef(UniformBuffer) || InView.view != CachedView || InView.projection != CachedProjection)
+		{
+			Layout.Reset();
+			Layout.PushMat4(InView.view);
+			Layout.PushMat4(InView.projection);
+
+			if (!IsValidRef(UniformBuffer))
+			{
+				UniformBuffer = GLDriver.CreateUniformBuffer(Layout.GetSize(), Layout.GetData());
+				Binding = GLDriver.GetUniformBlockBinding(GetBlockName());
+			}
+			else
+			{
+				UniformBuffer->UpdateData(0, Layout.GetSize(), Layout.GetData());
+			}
+			CachedView = InView.view;
+			CachedProjection = InView.projection;
+		}
+
+		GLDriver.SetUniformBuffer(Binding, UniformBuffer);
+	}
+
+protected:
+	FViewUniformBuffer()
+		: Binding(0)
+	{}
+
+	FOpenGLUniformBufferRef	UniformBuffer;
+	GLuint					Binding;
+	FStd140Layout			Layout;
+	glm::mat4				CachedView;
+	glm::mat4				CachedProjection;
+};
+
 // class render-policy
 struct FRenderPolicy
 {
 	TRefCountPtr<FMeshShaderType>			MeshShader;
+	TRefCountPtr<FMeshShaderType>			InstancedMeshShader;	// reads the instance transform from attributes 7~10
 	TRefCountPtr<FSkinningMeshShaderType>	SkinMeshShader;
 	TRefCountPtr<FLinesShaderType>			LinesShader;
+
+	// gl thread: resolve the shader types before the draws are recorded on the worker threads
+	void Resolve()
+	{
+		if (IsValidRef(MeshShader))
+		{
+			MeshShader->Resolve();
+		}
+		if (IsValidRef(InstancedMeshShader))
+		{
+			InstancedMeshShader->Resolve();
+		}
+		if (IsValidRef(SkinMeshShader))
+		{
+			SkinMeshShader->Resolve();
+		}
+		if (IsValidRef(LinesShader))
+		{
+			LinesShader->Resolve();
+		}
+	}
 };
 
 // draw full screen quad
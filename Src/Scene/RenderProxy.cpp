@@ -0,0 +1,47 @@
+// \brief
+//		implementation of render proxies
+//
+
+#include <cassert>
+#include "RenderProxy.h"
+
+
+void FRenderFrame::AddMesh(const FMeshRef &InMesh, const FMaterialRef &InMaterial, const glm::mat4 &InTransform, const glm::mat4 *InBones, GLuint InBoneCount)
+{
+	assert(!bSealed);
+	assert(IsValidRef(InMesh));
+
+	FMeshRenderProxy Proxy;
+	Proxy.Mesh = InMesh;
+	Proxy.Material = InMaterial;
+	Proxy.Transform = InTransform;
+	Proxy.BoneOffset = (GLuint)BonePalette.size();
+	Proxy.BoneCount = InBoneCount;
+	Proxy.Bones = nullptr;
+
+	if (InBoneCount > 0)
+	{
+		assert(InBones);
+		BonePalette.insert(BonePalette.end(), InBones, InBones + InBoneCount);
+	}
+	Meshes.push_back(Proxy);
+}
+
+void FRenderFrame::Seal()
+{
+	assert(!bSealed);
+	for (size_t Index = 0; Index < Meshes.size(); Index++)
+	{
+		FMeshRenderProxy &Proxy = Meshes[Index];
+		Proxy.Bones = Proxy.BoneCount > 0 ? &BonePalette[Proxy.BoneOffset] : nullptr;
+	} // end for
+	bSealed = true;
+}
+
+void FRenderFrame::Reset()
+{
+	Meshes.clear();
+	BonePalette.clear();
+	Policy = FRenderPolicy();
+	bSealed = false;
+}
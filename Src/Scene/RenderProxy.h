@@ -0,0 +1,61 @@
+// \brief
+//		render proxies, the snapshot of game-side models drawn by render thread
+//
+
+#ifndef __JETX_SCENE_RENDER_PROXY_H__
+#define __JETX_SCENE_RENDER_PROXY_H__
+
+#include <vector>
+
+#include "Mesh.h"
+#include "Render.h"
+
+
+// a mesh instance at the moment of snapshot
+struct FMeshRenderProxy
+{
+	FMeshRef		Mesh;		// buffers and declaration, not changed after InitRHI
+	FMaterialRef	Material;
+	glm::mat4		Transform;	// model matrix of the draw
+	GLuint			BoneOffset;	// bone palette in frame, BoneCount is 0 for static mesh
+	GLuint			BoneCount;
+	const glm::mat4	*Bones;		// resolved by FRenderFrame::Seal()
+};
+
+// \brief
+//	all that render thread needs to draw a frame, filled by game thread.
+//	after Seal() the frame is immutable until render thread has drawn it.
+class FRenderFrame
+{
+public:
+	FRenderFrame()
+		: FrameNumber(0)
+		, ClearColor(0.f, 0.f, 0.f, 1.f)
+		, bSealed(false)
+	{}
+
+	// add a proxy, the bones are copied into the palette of frame
+	void AddMesh(const FMeshRef &InMesh, const FMaterialRef &InMaterial, const glm::mat4 &InTransform, const glm::mat4 *InBones = nullptr, GLuint InBoneCount = 0);
+
+	// resolve the bone pointers, no proxy can be added after it
+	void Seal();
+
+	// drop the proxies, the memory is kept for reuse
+	void Reset();
+
+	bool IsSealed() const { return bSealed; }
+
+public:
+	unsigned int		FrameNumber;
+	FViewContext		View;
+	FRenderPolicy		Policy;
+	glm::vec4			ClearColor;
+
+	std::vector<FMeshRenderProxy>	Meshes;
+	std::vector<glm::mat4>			BonePalette;
+
+private:
+	bool				bSealed;
+};
+
+#endif // __JETX_SCENE_RENDER_PROXY_H__
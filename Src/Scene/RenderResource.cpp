@@ -3,25 +3,49 @@
 //
 
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 
 #include <SOIL.h>
 
 #include <OpenGL/OpenGLDrv.h>
 #include "RenderResource.h"
+#include "AssetRegistry.h"
+#include "TextureStreamer.h"
 
 //////////////////////////////////////////////////////////////////////////
 
 void FVertexBuffer::FillBuffer(const std::vector<FVertex> &InVertexes)
 {
 	Vertexes = InVertexes;
+	ExternalData = nullptr;
+	ExternalCount = 0;
+	ExternalOwner.SafeRelease();
+}
+
+void FVertexBuffer::FillBufferExternal(const FVertex *InData, size_t InCount, const FRefCountedObjectRef &InOwner)
+{
+	Vertexes.clear();
+	ExternalData = InData;
+	ExternalCount = InCount;
+	ExternalOwner = InOwner;
 }
 
 void FVertexBuffer::InitRHI()
 {
 	if (!bInitialized)
 	{
-		Buffer = FOpenGLDrv::SharedInstance().CreateVertexBuffer(Vertexes.size()*sizeof(FVertex), Vertexes.data());
+		FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+		// the arenas are of the render context, and have no empty allocation
+		if (bPooled && GLDriver.IsRenderThread() && GetVertexCount() > 0)
+		{
+			Allocation = GLDriver.GetBufferArena(GL_ARRAY_BUFFER, sizeof(FVertex))->Allocate(GetVertexCount(), GetVertexData());
+		}
+		else
+		{
+			Buffer = GLDriver.CreateVertexBuffer(GetVertexCount()*sizeof(FVertex), GetVertexData());
+		}
 		bInitialized = true;
 	}
 }
@@ -31,6 +55,7 @@ void FVertexBuffer::ReleaseRHI()
 	if (bInitialized)
 	{
 		Buffer.SafeRelease();
+		Allocation.SafeRelease();
 		bInitialized = false;
 	}
 }
@@ -40,13 +65,24 @@ void FVertexBuffer::ReleaseRHI()
 void FVertexSkinBuffer::FillBuffer(const std::vector<FVertexSkin> &InVertexes)
 {
 	Vertexes = InVertexes;
+	ExternalData = nullptr;
+	ExternalCount = 0;
+	ExternalOwner.SafeRelease();
+}
+
+void FVertexSkinBuffer::FillBufferExternal(const FVertexSkin *InData, size_t InCount, const FRefCountedObjectRef &InOwner)
+{
+	Vertexes.clear();
+	ExternalData = InData;
+	ExternalCount = InCount;
+	ExternalOwner = InOwner;
 }
 
 void FVertexSkinBuffer::InitRHI()
 {
 	if (!bInitialized)
 	{
-		Buffer = FOpenGLDrv::SharedInstance().CreateVertexBuffer(Vertexes.size()*sizeof(FVertexSkin), Vertexes.data());
+		Buffer = FOpenGLDrv::SharedInstance().CreateVertexBuffer(GetVertexCount()*sizeof(FVertexSkin), GetVertexData());
 		bInitialized = true;
 	}
 }
@@ -65,13 +101,32 @@ void FVertexSkinBuffer::ReleaseRHI()
 void FIndexBuffer::FillBuffer(const std::vector<GLuint> &InIndices)
 {
 	Indices = InIndices;
+	ExternalData = nullptr;
+	ExternalCount = 0;
+	ExternalOwner.SafeRelease();
+}
+
+void FIndexBuffer::FillBufferExternal(const GLuint *InData, size_t InCount, const FRefCountedObjectRef &InOwner)
+{
+	Indices.clear();
+	ExternalData = InData;
+	ExternalCount = InCount;
+	ExternalOwner = InOwner;
 }
 
 void FIndexBuffer::InitRHI()
 {
 	if (!bInitialized)
 	{
-		Buffer = FOpenGLDrv::SharedInstance().CreateIndexBuffer(Indices.size()*sizeof(GLint), Indices.data(), sizeof(GLuint));
+		FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+		if (GLDriver.IsRenderThread() && GetElementCount() > 0)
+		{
+			Allocation = GLDriver.GetBufferArena(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint))->Allocate(GetElementCount(), GetIndexData());
+		}
+		else
+		{
+			Buffer = GLDriver.CreateIndexBuffer(GetElementCount()*sizeof(GLuint), GetIndexData(), sizeof(GLuint));
+		}
 		bInitialized = true;
 	}
 }
@@ -80,6 +135,7 @@ void FIndexBuffer::ReleaseRHI()
 {
 	if (bInitialized)
 	{
+		Allocation.SafeRelease();
 		Buffer.SafeRelease();
 		bInitialized = false;
 	}
@@ -90,13 +146,19 @@ void FIndexBuffer::ReleaseRHI()
 FTexture2D::FTexture2D()
 	: Width(0)
 	, Height(0)
+	, Channels(0)
 	, ImageData(nullptr)
+	, FirstMip(0)
+	, DecodeMs(0.0)
+	, ResidentCount(0)
 {
 
 }
 
 FTexture2D::~FTexture2D()
 {
+	FAssetRegistry::SharedInstance().Unregister(this);
+	FTextureStreamer::SharedInstance().Unregister(this);
 	SafeReleaseData();
 }
 
@@ -106,43 +168,213 @@ void FTexture2D::SafeReleaseData()
 	{
 		SOIL_free_image_data(ImageData); ImageData = nullptr;
 	}
+	Compressed.SafeRelease();
+}
+
+// the images are decoded with their channels
+static std::string GetTextureAssetKey(const std::string &InFilename)
+{
+	return FAssetRegistry::MakeKey("Texture2D", InFilename, SOIL_LOAD_AUTO);
 }
 
 FTexture2DRef FTexture2D::CreateTexture(const std::string &InFilename)
 {
-	FTexture2D *NewTex2D = new FTexture2D();
-	NewTex2D->LoadFromFile(InFilename);
+	FTexture2DRef Texture = CreateTextureDeferred(InFilename);
+	Texture->LoadDeferred();
 
-	return NewTex2D;
+	return Texture;
+}
+
+FTexture2DRef FTexture2D::CreateTextureDeferred(const std::string &InFilename)
+{
+	FAssetRegistry &Registry = FAssetRegistry::SharedInstance();
+	const std::string Key = GetTextureAssetKey(InFilename);
+
+	FTexture2DRef Texture = (FTexture2D*)Registry.Find(Key).DeRef();
+	if (!IsValidRef(Texture))
+	{
+		Texture = new FTexture2D();
+		Texture->Filename = InFilename;
+		Texture = (FTexture2D*)Registry.Register(Key, Texture).DeRef();
+	}
+
+	return Texture;
 }
 
 void FTexture2D::LoadFromFile(const std::string &InFilename)
 {
 	SafeReleaseData();
-	int channels = 0;
-	ImageData = SOIL_load_image(InFilename.c_str(), &Width, &Height, &channels, SOIL_LOAD_RGB);
-	if (!ImageData)
+	Filename = InFilename;
+	std::chrono::steady_clock::time_point DecodeStart = std::chrono::steady_clock::now();
+
+	Compressed = FCompressedTexture::Load(InFilename);
+	if (IsValidRef(Compressed))
+	{
+		Width = Compressed->GetWidth();
+		Height = Compressed->GetHeight();
+		Channels = Compressed->GetFormat() == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 4 : 3;
+	}
+	else
+	{
+		ImageData = SOIL_load_image(InFilename.c_str(), &Width, &Height, &Channels, SOIL_LOAD_AUTO);
+		// grey and grey-alpha are expanded, the shaders sample rgb
+		if (ImageData && Channels < 3)
+		{
+			const int kForceChannels = Channels == 2 ? SOIL_LOAD_RGBA : SOIL_LOAD_RGB;
+			SOIL_free_image_data(ImageData);
+			ImageData = SOIL_load_image(InFilename.c_str(), &Width, &Height, &Channels, kForceChannels);
+			Channels = kForceChannels;
+		}
+	}
+
+	DecodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - DecodeStart).count();
+	if (!ImageData && !IsValidRef(Compressed))
 	{
 		std::cout << "FTexture2D::LoadFromFile Failed: " << InFilename.c_str() << std::endl;
 	}
 }
 
+size_t FTexture2D::GetDecodedBytes() const
+{
+	if (IsValidRef(Compressed))
+	{
+		return Compressed->GetDataSize();
+	}
+
+	return ImageData ? (size_t)Width * Height * Channels : 0;
+}
+
+size_t FTexture2D::GetGPUBytes() const
+{
+	return IsValidRef(Compressed) ? Compressed->GetDataSize() : GetUncompressedGPUBytes();
+}
+
+size_t FTexture2D::GetUncompressedGPUBytes() const
+{
+	if (IsValidRef(Compressed))
+	{
+		return Compressed->GetUncompressedSize();
+	}
+
+	// the generated mip chain adds a third
+	return (size_t)Width * Height * Channels * 4 / 3;
+}
+
+bool FTexture2D::LoadDeferred()
+{
+	std::lock_guard<std::mutex> Lock(LoadMutex);
+	if (!ImageData && !IsValidRef(Compressed) && !bInitialized)
+	{
+		LoadFromFile(Filename);
+		return true;
+	}
+
+	return false;
+}
+
+size_t FTexture2D::GetMipsBytes(int InFirstMip) const
+{
+	return IsValidRef(Compressed) ? Compressed->GetDataSize(InFirstMip) : GetGPUBytes();
+}
+
+void FTexture2D::PrefetchMips(int InFirstMip, int InLastMip) const
+{
+	if (!IsValidRef(Compressed))
+	{
+		return;
+	}
+
+	// a read per page faults the mapping in
+	const size_t kPageSize = 4096;
+	volatile unsigned char Sum = 0;
+	const std::vector<FOpenGLTextureMip> &Mips = Compressed->GetMips();
+	for (int Level = InFirstMip; Level < InLastMip && Level < (int)Mips.size(); Level++)
+	{
+		const unsigned char *Data = (const unsigned char*)Mips[Level].Data;
+		for (size_t Offset = 0; Offset < (size_t)Mips[Level].Size; Offset += kPageSize)
+		{
+			Sum += Data[Offset];
+		} // end for
+	} // end for
+}
+
+void FTexture2D::StreamMips(int InFirstMip)
+{
+	assert(bInitialized && IsStreamable());
+	assert(InFirstMip >= 0 && InFirstMip < GetMipCount());
+
+	const std::vector<FOpenGLTextureMip> &Mips = Compressed->GetMips();
+	std::vector<FOpenGLTextureMip> ResidentMips(Mips.begin() + InFirstMip, Mips.end());
+	Tex2D = FOpenGLDrv::SharedInstance().CreateCompressedTexture2D(Compressed->GetFormat(), ResidentMips);
+	FirstMip = InFirstMip;
+}
+
 void FTexture2D::InitRHI()
 {
-	if (!bInitialized)
+	InitRHI(false);
+}
+
+void FTexture2D::InitRHIAsync()
+{
+	InitRHI(true);
+}
+
+void FTexture2D::InitRHI(bool bInAsyncUpload)
+{
+	// a texture shared by models may be initialized on loader thread and render thread at a time
+	std::lock_guard<std::mutex> Lock(LoadMutex);
+	if (ResidentCount++ == 0)
 	{
-		assert(ImageData);
-		Tex2D = FOpenGLDrv::SharedInstance().CreateTexture2D(GL_RGB, Width, Height, GL_RGB, GL_UNSIGNED_BYTE, ImageData);
+		FTextureStreamer &Streamer = FTextureStreamer::SharedInstance();
+		if (IsValidRef(Compressed))
+		{
+			// only the mip tail at first if streamed, the streamer loads the levels needed
+			FirstMip = Streamer.IsEnabled() && IsStreamable() ? Streamer.GetMipTailFirstMip(*this) : 0;
+			std::vector<FOpenGLTextureMip> ResidentMips(Compressed->GetMips().begin() + FirstMip, Compressed->GetMips().end());
+			Tex2D = FOpenGLDrv::SharedInstance().CreateCompressedTexture2D(Compressed->GetFormat(), ResidentMips);
+		}
+		else
+		{
+			assert(ImageData);
+			FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+			const GLenum kFormat = Channels == 4 ? GL_RGBA : GL_RGB;
+			const GLsizeiptr kSize = (GLsizeiptr)Width * Height * Channels;
+
+			// the upload ring is of the render context, the loader thread uploads directly
+			if (bInAsyncUpload && GLDriver.IsRenderThread())
+			{
+				Tex2D = GLDriver.CreateTexture2DStorage(Channels == 4 ? GL_RGBA8 : GL_RGB8, Width, Height, FOpenGLTexture2D::GetFullMipLevels(Width, Height));
+				// the image is kept by the texture, which is kept alive by the copy
+				FRefCountedObjectRef Owner = this;
+				const unsigned char *Pixels = ImageData;
+				Upload = GLDriver.GetTextureUploader()->Upload(Tex2D, Width, Height, kFormat, GL_UNSIGNED_BYTE, kSize, [Owner, Pixels, kSize](void *Dest) {
+					memcpy(Dest, Pixels, kSize);
+				});
+			}
+			if (!IsValidRef(Upload))
+			{
+				Tex2D = GLDriver.CreateTexture2D(kFormat, Width, Height, kFormat, GL_UNSIGNED_BYTE, ImageData);
+			}
+			FirstMip = 0;
+		}
 		bInitialized = true;
+		FAssetRegistry::SharedInstance().SetResident(this, true);
+		Streamer.Register(this);
 	}
 }
 
 void FTexture2D::ReleaseRHI()
 {
-	if (bInitialized)
+	std::lock_guard<std::mutex> Lock(LoadMutex);
+	// the other holders still sample it
+	if (ResidentCount > 0 && --ResidentCount == 0)
 	{
+		FTextureStreamer::SharedInstance().Unregister(this);
 		Tex2D.SafeRelease();
+		Upload.SafeRelease();
+		FirstMip = 0;
 		bInitialized = false;
+		FAssetRegistry::SharedInstance().SetResident(this, false);
 	}
 }
 
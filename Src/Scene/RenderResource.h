@@ -5,13 +5,18 @@
 #ifndef __JETX_SCENE_RENDERRESOURCE_H__
 #define __JETX_SCENE_RENDERRESOURCE_H__
 
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <Common/RefCounting.h>
 #include <OpenGL/GLBuffer.h>
+#include <OpenGL/GLBufferArena.h>
 #include <OpenGL/GLTexture.h>
+#include <OpenGL/GLTextureUploader.h>
+#include "CompressedTexture.h"
 
 
 // Base Resource
@@ -26,6 +31,8 @@ public:
 	virtual void InitRHI() = 0;
 	virtual void ReleaseRHI() = 0;
 
+	bool IsInitialized() const { return bInitialized; }
+
 protected:
 	bool	bInitialized;
 };
@@ -62,19 +69,35 @@ struct FVertexSkin
 class FVertexBuffer : public FRenderResource
 {
 public:
-	FVertexBuffer() {}
+	FVertexBuffer() : bPooled(true), ExternalData(nullptr), ExternalCount(0) {}
 	virtual ~FVertexBuffer() {}
 
 	void FillBuffer(const std::vector<FVertex> &InVertexes);
+	// no copy, the vertices are uploaded from the memory kept alive by InOwner, e.g. a mapped cooked file
+	void FillBufferExternal(const FVertex *InData, size_t InCount, const FRefCountedObjectRef &InOwner);
+
+	const FVertex* GetVertexData() const { return ExternalData ? ExternalData : Vertexes.data(); }
+	size_t GetVertexCount() const { return ExternalData ? ExternalCount : Vertexes.size(); }
 
 	void InitRHI() override;
 	void ReleaseRHI() override;
 
-	FOpenGLVertexBufferRef GetRHIBuffer() { return Buffer; }
+	FOpenGLVertexBufferRef GetRHIBuffer() { return IsValidRef(Allocation) ? (FOpenGLVertexBuffer*)Allocation->GetBuffer() : Buffer.DeRef(); }
+	// the first vertex in buffer, the base vertex of draw
+	GLint GetBaseVertex() const { return IsValidRef(Allocation) ? (GLint)Allocation->GetOffset() : 0; }
 
 public:
 	std::vector<FVertex>	Vertexes;
-	FOpenGLVertexBufferRef	Buffer;
+	FOpenGLVertexBufferRef	Buffer;		// own buffer if not pooled
+
+	// sub-allocated in the shared vertex arena, own buffer if created on loader thread
+	bool						bPooled;
+	FOpenGLBufferAllocationRef	Allocation;
+
+protected:
+	const FVertex			*ExternalData;
+	size_t					ExternalCount;
+	FRefCountedObjectRef	ExternalOwner;
 };
 
 typedef TRefCountPtr<FVertexBuffer>		FVertexBufferRef;
@@ -83,10 +106,14 @@ typedef TRefCountPtr<FVertexBuffer>		FVertexBufferRef;
 class FVertexSkinBuffer : public FRenderResource
 {
 public:
-	FVertexSkinBuffer() {}
+	FVertexSkinBuffer() : ExternalData(nullptr), ExternalCount(0) {}
 	virtual ~FVertexSkinBuffer() {}
 
 	void FillBuffer(const std::vector<FVertexSkin> &InVertexes);
+	void FillBufferExternal(const FVertexSkin *InData, size_t InCount, const FRefCountedObjectRef &InOwner);
+
+	const FVertexSkin* GetVertexData() const { return ExternalData ? ExternalData : Vertexes.data(); }
+	size_t GetVertexCount() const { return ExternalData ? ExternalCount : Vertexes.size(); }
 
 	void InitRHI() override;
 	void ReleaseRHI() override;
@@ -96,6 +123,11 @@ public:
 public:
 	std::vector<FVertexSkin>	Vertexes;
 	FOpenGLVertexBufferRef	Buffer;
+
+protected:
+	const FVertexSkin		*ExternalData;
+	size_t					ExternalCount;
+	FRefCountedObjectRef	ExternalOwner;
 };
 
 typedef TRefCountPtr<FVertexSkinBuffer>	FVertexSkinBufferRef;
@@ -104,20 +136,30 @@ typedef TRefCountPtr<FVertexSkinBuffer>	FVertexSkinBufferRef;
 class FIndexBuffer : public FRenderResource
 {
 public:
-	FIndexBuffer() {}
+	FIndexBuffer() : ExternalData(nullptr), ExternalCount(0) {}
 	virtual ~FIndexBuffer() {}
 
 	void FillBuffer(const std::vector<GLuint> &InIndexes);
+	void FillBufferExternal(const GLuint *InData, size_t InCount, const FRefCountedObjectRef &InOwner);
+
+	const GLuint* GetIndexData() const { return ExternalData ? ExternalData : Indices.data(); }
 
 	void InitRHI() override;
 	void ReleaseRHI() override;
 
-	FOpenGLIndexBufferRef GetRHIBuffer() { return Buffer; }
-	GLuint GetElementCount() { return Indices.size(); }
+	// the indices are sub-allocated in the shared index arena, own buffer if created on loader thread
+	FOpenGLIndexBufferRef GetRHIBuffer() { return IsValidRef(Allocation) ? (FOpenGLIndexBuffer*)Allocation->GetBuffer() : Buffer.DeRef(); }
+	GLuint GetFirstIndex() const { return IsValidRef(Allocation) ? (GLuint)Allocation->GetOffset() : 0; }
+	GLuint GetElementCount() const { return ExternalData ? (GLuint)ExternalCount : (GLuint)Indices.size(); }
 
 protected:
-	std::vector<GLuint>		Indices;
-	FOpenGLIndexBufferRef	Buffer;
+	std::vector<GLuint>			Indices;
+	FOpenGLBufferAllocationRef	Allocation;
+	FOpenGLIndexBufferRef		Buffer;
+
+	const GLuint			*ExternalData;
+	size_t					ExternalCount;
+	FRefCountedObjectRef	ExternalOwner;
 };
 
 typedef TRefCountPtr<FIndexBuffer>		FIndexBufferRef;
@@ -132,21 +174,67 @@ public:
 	FTexture2D();
 	virtual ~FTexture2D();
 
+	// the textures are shared by path through FAssetRegistry, a found one is returned
 	static FTexture2DRef CreateTexture(const std::string &InFilename);
+	// the image is decoded later by LoadDeferred(), e.g. on a worker thread
+	static FTexture2DRef CreateTextureDeferred(const std::string &InFilename);
 	void LoadFromFile(const std::string &InFilename);
-
+	// the cooked "<file>.dds" of FCompressedTexture is mapped if it is up to date, otherwise the image is decoded with its alpha.
+	// decode the image of GetFilename() if not yet, the concurrent callers wait for the first one.
+	// return true if it is decoded by this call
+	bool LoadDeferred();
+
+	const std::string& GetFilename() const { return Filename; }
+	int GetWidth() const { return Width; }
+	int GetHeight() const { return Height; }
+	// statistics of the last decoding
+	double GetDecodeMs() const { return DecodeMs; }
+	size_t GetDecodedBytes() const;
+	// video memory of the levels, and of the same levels uncompressed
+	size_t GetGPUBytes() const;
+	size_t GetUncompressedGPUBytes() const;
+	bool IsCompressed() const { return IsValidRef(Compressed); }
+
+	// the levels of a compressed texture are streamed by FTextureStreamer, the others are resident at full resolution
+	bool IsStreamable() const { return IsValidRef(Compressed) && Compressed->GetMips().size() > 1; }
+	int GetMipCount() const { return IsValidRef(Compressed) ? (int)Compressed->GetMips().size() : 1; }
+	int GetResidentFirstMip() const { return FirstMip; }
+	// video memory if the levels from InFirstMip are resident
+	size_t GetMipsBytes(int InFirstMip) const;
+	// any thread: read the mapped levels [InFirstMip, InLastMip) so the upload doesn't wait for the disk
+	void PrefetchMips(int InFirstMip, int InLastMip) const;
+	// gl thread: recreate the texture with the levels from InFirstMip, level InFirstMip becomes the base level
+	void StreamMips(int InFirstMip);
+
+	// the decoded image is uploaded before the return.
+	// the materials sharing the texture pair InitRHI() with ReleaseRHI(), the last ReleaseRHI() frees it
 	void InitRHI() override;
 	void ReleaseRHI() override;
+	// as InitRHI(), but on render thread the image is copied to the upload ring by a job and uploaded by the gpu later,
+	// poll IsUploadSubmitted() before drawing with it. synchronously if the ring is full or on loader thread
+	void InitRHIAsync();
+	// the content is sampled correctly after the upload is submitted, and the staging is freed when complete
+	bool IsUploadSubmitted() const { return !IsValidRef(Upload) || Upload->IsSubmitted(); }
+	bool IsUploadComplete() const { return !IsValidRef(Upload) || Upload->IsComplete(); }
 
 	FOpenGLTexture2DRef GetRHITexture() { return Tex2D; }
 
 protected:
 	void SafeReleaseData();
+	void InitRHI(bool bInAsyncUpload);
 
 protected:
+	std::string Filename;
+	std::mutex LoadMutex;
 	int Width, Height;
+	int Channels;	// 3 or 4
 	unsigned char* ImageData;
+	FCompressedTextureRef Compressed;
+	int FirstMip;	// the first resident level
+	double DecodeMs;
 	FOpenGLTexture2DRef Tex2D;
+	FOpenGLTextureUploadRef Upload;
+	int ResidentCount;	// holders of the gl texture
 };
 
 
@@ -0,0 +1,181 @@
+// \brief
+//		implementation of render thread
+//
+
+#include <cassert>
+#include <chrono>
+#include <OpenGL/OpenGLDrv.h>
+
+#include "LoaderThread.h"
+#include "RenderThread.h"
+#include "TextureStreamer.h"
+
+
+// time of texture streaming per frame
+static const double kTextureStreamingMs = 1.0;
+
+static double SecondsSince(const std::chrono::steady_clock::time_point &InStart)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - InStart).count();
+}
+
+FRenderThread::FRenderThread(unsigned int InFramesInFlight)
+	: NextFrameNumber(0)
+	, bStopping(false)
+{
+	assert(InFramesInFlight >= 2);
+	for (unsigned int k = 0; k < InFramesInFlight; k++)
+	{
+		Frames.push_back(std::unique_ptr<FRenderFrame>(new FRenderFrame()));
+		FreeFrames.push_back(Frames.back().get());
+	} // end for k
+}
+
+FRenderThread::~FRenderThread()
+{
+	Stop();
+}
+
+void FRenderThread::Start(const FCallback &InBeginThread, const FCallback &InPresent, const FCallback &InEndThread)
+{
+	assert(!IsRunning());
+
+	BeginThread = InBeginThread;
+	Present = InPresent;
+	EndThread = InEndThread;
+	bStopping = false;
+	Thread = std::thread(&FRenderThread::Run, this);
+}
+
+void FRenderThread::Stop()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bStopping = true;
+	}
+	FrameQueued.notify_one();
+	Thread.join();
+
+	// the context is current on the caller again
+	FOpenGLDrv::SharedInstance().SetRenderThread();
+}
+
+FRenderFrame* FRenderThread::BeginFrame()
+{
+	std::unique_lock<std::mutex> Lock(Mutex);
+	if (FreeFrames.empty())
+	{
+		std::chrono::steady_clock::time_point WaitStart = std::chrono::steady_clock::now();
+		FrameFreed.wait(Lock, [this]() { return !FreeFrames.empty(); });
+		Stats.GameWaitSeconds += SecondsSince(WaitStart);
+	}
+
+	FRenderFrame *Frame = FreeFrames.front();
+	FreeFrames.pop_front();
+	Frame->FrameNumber = NextFrameNumber++;
+
+	return Frame;
+}
+
+void FRenderThread::EndFrame(FRenderFrame *InFrame)
+{
+	assert(InFrame && IsRunning());
+	InFrame->Seal();
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		QueuedFrames.push_back(InFrame);
+	}
+	FrameQueued.notify_one();
+}
+
+FRenderThreadStats FRenderThread::GetStats()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	return Stats;
+}
+
+void FRenderThread::Run()
+{
+	if (BeginThread)
+	{
+		BeginThread();
+	}
+	FOpenGLDrv::SharedInstance().SetRenderThread();
+
+	for (;;)
+	{
+		FRenderFrame *Frame = nullptr;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			std::chrono::steady_clock::time_point WaitStart = std::chrono::steady_clock::now();
+			FrameQueued.wait(Lock, [this]() { return bStopping || !QueuedFrames.empty(); });
+			Stats.RenderWaitSeconds += SecondsSince(WaitStart);
+
+			if (QueuedFrames.empty())
+			{
+				break;
+			}
+			Frame = QueuedFrames.front();
+			QueuedFrames.pop_front();
+		}
+
+		RenderFrame(*Frame);
+		// the last references of gl resources may be held by proxies, drop them here where the context is current
+		Frame->Reset();
+
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			FreeFrames.push_back(Frame);
+			Stats.FramesRendered++;
+		}
+		FrameFreed.notify_one();
+	} // end for
+
+	if (EndThread)
+	{
+		EndThread();
+	}
+}
+
+void FRenderThread::RenderFrame(FRenderFrame &InFrame)
+{
+	assert(InFrame.IsSealed());
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+
+	GLDriver.SetClearColor(InFrame.ClearColor.r, InFrame.ClearColor.g, InFrame.ClearColor.b, InFrame.ClearColor.a);
+	GLDriver.ClearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	for (size_t Index = 0; Index < InFrame.Meshes.size(); Index++)
+	{
+		const FMeshRenderProxy &Proxy = InFrame.Meshes[Index];
+		Proxy.Mesh->DrawProxy(InFrame.View, InFrame.Policy, Proxy);
+	} // end for
+
+	GLDriver.EndFrame();
+	// the resources created by loader thread are drawn from next frame
+	FLoaderThread &Loader = FLoaderThread::SharedInstance();
+	if (Loader.IsRunning())
+	{
+		Loader.Tick();
+	}
+
+	if (Present)
+	{
+		Present();
+	}
+
+	// the levels are uploaded while the gpu draws the frame
+	FTextureStreamer &Streamer = FTextureStreamer::SharedInstance();
+	if (Streamer.IsEnabled())
+	{
+		Streamer.AddFrame(InFrame);
+		Streamer.Tick(kTextureStreamingMs);
+	}
+}
@@ -0,0 +1,87 @@
+// \brief
+//		dedicated render thread, draws the frames snapshotted by game thread
+//
+
+#ifndef __JETX_SCENE_RENDER_THREAD_H__
+#define __JETX_SCENE_RENDER_THREAD_H__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RenderProxy.h"
+
+
+// statistics of render thread
+struct FRenderThreadStats
+{
+	FRenderThreadStats()
+		: FramesRendered(0)
+		, GameWaitSeconds(0.0)
+		, RenderWaitSeconds(0.0)
+	{}
+
+	unsigned int	FramesRendered;
+	double			GameWaitSeconds;	// game thread blocked in BeginFrame(), the render thread is behind
+	double			RenderWaitSeconds;	// render thread idle, the game thread is behind
+};
+
+// \brief
+//	the game thread fills frame N+1 while the render thread draws frame N.
+//	the frames are pooled, BeginFrame() blocks when all of them are queued or drawing,
+//	so the game thread is at most (InFramesInFlight - 1) frames ahead.
+//	the gl context must be current on the render thread only, InBeginThread/InEndThread make it current/release it,
+//	InPresent swaps the buffers. no gl call or Draw() on game thread between Start() and Stop().
+//	the render thread is the one of FOpenGLDrv state cache while running, the resources released on game thread are deleted by it.
+class FRenderThread
+{
+public:
+	typedef std::function<void()>	FCallback;
+
+	explicit FRenderThread(unsigned int InFramesInFlight = 2);
+	~FRenderThread();
+
+	void Start(const FCallback &InBeginThread, const FCallback &InPresent, const FCallback &InEndThread);
+	// draw the queued frames and join the thread
+	void Stop();
+
+	bool IsRunning() const { return Thread.joinable(); }
+
+	// game thread: get a free frame to fill, waits for render thread if none
+	FRenderFrame* BeginFrame();
+	// game thread: seal the frame and queue it to render thread
+	void EndFrame(FRenderFrame *InFrame);
+
+	// copy of statistics, safe on any thread
+	FRenderThreadStats GetStats();
+
+private:
+	FRenderThread(const FRenderThread&) = delete;
+	FRenderThread& operator=(const FRenderThread&) = delete;
+
+	void Run();
+	void RenderFrame(FRenderFrame &InFrame);
+
+	std::vector<std::unique_ptr<FRenderFrame>>	Frames;
+	std::deque<FRenderFrame*>	FreeFrames;
+	std::deque<FRenderFrame*>	QueuedFrames;
+	unsigned int				NextFrameNumber;
+
+	std::mutex					Mutex;
+	std::condition_variable		FrameFreed;
+	std::condition_variable		FrameQueued;
+	bool						bStopping;
+
+	std::thread					Thread;
+	FCallback					BeginThread;
+	FCallback					Present;
+	FCallback					EndThread;
+
+	FRenderThreadStats			Stats;
+};
+
+#endif // __JETX_SCENE_RENDER_THREAD_H__
@@ -0,0 +1,224 @@
+// \brief
+//		implementation of shader permutations
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+#include <Common/UtilityHelper.h>
+#include <OpenGL/OpenGLDrv.h>
+
+#include "AssetRegistry.h"
+#include "ShaderPermutation.h"
+
+
+std::string FShaderDefines::GetSource() const
+{
+	std::string Source;
+	for (std::map<std::string, std::string>::const_iterator itr = Values.begin(); itr != Values.end(); ++itr)
+	{
+		Source += "#define " + itr->first + " " + itr->second + "\n";
+	} // end for
+
+	return Source;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FShaderSourceCache& FShaderSourceCache::SharedInstance()
+{
+	static FShaderSourceCache Cache;
+
+	return Cache;
+}
+
+const FShaderSourceCache::FSourceFile* FShaderSourceCache::ReadFile(const std::string &InFilename)
+{
+	std::map<std::string, FSourceFile>::iterator itr = Files.find(InFilename);
+	if (itr != Files.end())
+	{
+		Stats.FileHits++;
+		return &itr->second;
+	}
+
+	FSourceFile File;
+	File.Index = (int)Files.size();
+	File.Text = FUtilityHelper::ReadTextFile(InFilename.c_str());
+	if (File.Text.empty())
+	{
+		return nullptr;
+	}
+	Stats.FilesRead++;
+
+	return &(Files[InFilename] = File);
+}
+
+bool FShaderSourceCache::ExpandFile(const std::string &InFilename, std::vector<std::string> &InOutIncluded, std::string &OutSource)
+{
+	if (std::find(InOutIncluded.begin(), InOutIncluded.end(), InFilename) != InOutIncluded.end())
+	{
+		return true;
+	}
+	InOutIncluded.push_back(InFilename);
+
+	const FSourceFile *File = ReadFile(InFilename);
+	if (!File)
+	{
+		return false;
+	}
+
+	// an include starts at line 1 of its source string, "#line N" of glsl 330 numbers the next line N
+	if (InOutIncluded.size() > 1)
+	{
+		OutSource += "#line 1 " + std::to_string(File->Index) + "\n";
+	}
+
+	const size_t kSlash = InFilename.rfind('/');
+	const std::string kDirectory = kSlash == std::string::npos ? std::string() : InFilename.substr(0, kSlash + 1);
+
+	std::istringstream Stream(File->Text);
+	std::string Line;
+	int LineNumber = 0;
+	while (std::getline(Stream, Line))
+	{
+		LineNumber++;
+		const size_t kFirst = Line.find_first_not_of(" \t");
+		if (kFirst == std::string::npos || Line.compare(kFirst, 8, "#include") != 0)
+		{
+			OutSource += Line + "\n";
+			continue;
+		}
+
+		const size_t kOpen = Line.find('"', kFirst + 8);
+		const size_t kClose = kOpen == std::string::npos ? std::string::npos : Line.find('"', kOpen + 1);
+		if (kClose == std::string::npos)
+		{
+			std::cout << "Error: Bad Include: " << InFilename << "(" << LineNumber << "): " << Line << std::endl;
+			return false;
+		}
+
+		const std::string kInclude = FAssetRegistry::CanonicalizePath(kDirectory + Line.substr(kOpen + 1, kClose - kOpen - 1));
+		if (!ExpandFile(kInclude, InOutIncluded, OutSource))
+		{
+			std::cout << "Error: Include Failed: " << InFilename << "(" << LineNumber << "): " << kInclude << std::endl;
+			return false;
+		}
+		OutSource += "#line " + std::to_string(LineNumber + 1) + " " + std::to_string(File->Index) + "\n";
+	} // end while
+
+	return true;
+}
+
+std::string FShaderSourceCache::GetSource(const std::string &InFilename, const FShaderDefines &InDefines)
+{
+	std::string Source;
+	std::vector<std::string> Included;
+	const std::string kFilename = FAssetRegistry::CanonicalizePath(InFilename);
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	if (!ExpandFile(kFilename, Included, Source))
+	{
+		return std::string();
+	}
+
+	if (!InDefines.IsEmpty())
+	{
+		// the #version line must be the first
+		size_t Insert = 0;
+		int VersionLine = 0;
+		const size_t kVersion = Source.find("#version");
+		if (kVersion != std::string::npos && Source.find_first_not_of(" \t\r\n", 0) == kVersion)
+		{
+			Insert = Source.find('\n', kVersion);
+			Insert = Insert == std::string::npos ? Source.size() : Insert + 1;
+			VersionLine = (int)std::count(Source.begin(), Source.begin() + Insert, '\n');
+		}
+		Source.insert(Insert, InDefines.GetSource() + "#line " + std::to_string(VersionLine + 1) + " " + std::to_string(Files[kFilename].Index) + "\n");
+	}
+
+	return Source;
+}
+
+void FShaderSourceCache::Empty()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Files.clear();
+}
+
+FShaderSourceCacheStats FShaderSourceCache::GetStats()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	return Stats;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// FNV-1a of 64 bits
+static uint64_t HashSource(uint64_t InHash, const std::string &InSource)
+{
+	// the terminator separates the sources
+	for (size_t Index = 0; Index <= InSource.size(); Index++)
+	{
+		InHash ^= (unsigned char)InSource.c_str()[Index];
+		InHash *= 1099511628211ull;
+	} // end for
+
+	return InHash;
+}
+
+FShaderProgram::~FShaderProgram()
+{
+	FAssetRegistry::SharedInstance().Unregister(this);
+}
+
+FShaderProgramRef FShaderProgram::Create(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines)
+{
+	FShaderSourceCache &SourceCache = FShaderSourceCache::SharedInstance();
+	const std::string kVsSource = SourceCache.GetSource(InVsFile, InDefines);
+	const std::string kPsSource = SourceCache.GetSource(InPsFile, InDefines);
+	if (kVsSource.empty() || kPsSource.empty())
+	{
+		std::cout << "Error: Load Shader Failed: " << InVsFile << ", " << InPsFile << std::endl;
+		return nullptr;
+	}
+
+	// the variants of the same expanded sources are one program, whichever files they come from
+	char Hash[32];
+	snprintf(Hash, sizeof(Hash), "%016llx", (unsigned long long)HashSource(HashSource(14695981039346656037ull, kVsSource), kPsSource));
+
+	FAssetRegistry &Registry = FAssetRegistry::SharedInstance();
+	FShaderProgramRef NewProgram;
+	// the probe is the option of key, a hash collision moves on to the next one
+	for (unsigned int Probe = 0; ; Probe++)
+	{
+		const std::string kKey = FAssetRegistry::MakeKey("ShaderProgram", Hash, Probe);
+		FShaderProgramRef ShaderProgram = (FShaderProgram*)Registry.Find(kKey).DeRef();
+		if (IsValidRef(ShaderProgram))
+		{
+			if (ShaderProgram->HasSources(kVsSource, kPsSource))
+			{
+				return ShaderProgram;
+			}
+			continue;
+		}
+
+		if (!IsValidRef(NewProgram))
+		{
+			NewProgram = new FShaderProgram();
+			NewProgram->VsSource = kVsSource;
+			NewProgram->PsSource = kPsSource;
+			NewProgram->Program = FOpenGLDrv::SharedInstance().CreateProgram(kVsSource.c_str(), kPsSource.c_str(), &NewProgram->VertexShader, &NewProgram->PixelShader);
+		}
+
+		// the same sources may be created by two threads at a time, the first one is kept
+		ShaderProgram = (FShaderProgram*)Registry.Register(kKey, NewProgram).DeRef();
+		if (ShaderProgram->HasSources(kVsSource, kPsSource))
+		{
+			Registry.SetResident(ShaderProgram, true);
+			return ShaderProgram;
+		}
+	} // end for
+}
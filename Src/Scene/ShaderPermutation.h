@@ -0,0 +1,180 @@
+// \brief
+//		shader permutations: defines, #include resolved by a source cache, and the programs deduplicated by source
+//
+
+#ifndef __JETX_SCENE_SHADER_PERMUTATION_H__
+#define __JETX_SCENE_SHADER_PERMUTATION_H__
+
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Common/RefCounting.h>
+#include <OpenGL/GLShader.h>
+
+
+// the compile-time switches of a shader, "#define NAME VALUE" after the #version line
+class FShaderDefines
+{
+public:
+	void Set(const std::string &InName, const std::string &InValue) { Values[InName] = InValue; }
+	void Set(const std::string &InName, int InValue) { Values[InName] = std::to_string(InValue); }
+
+	bool IsEmpty() const { return Values.empty(); }
+	const std::map<std::string, std::string>& GetValues() const { return Values; }
+
+	// the lines in the order of names, the equal sets are the equal text
+	std::string GetSource() const;
+
+private:
+	std::map<std::string, std::string>	Values;
+};
+
+// statistics of shader source cache
+struct FShaderSourceCacheStats
+{
+	FShaderSourceCacheStats()
+		: FilesRead(0)
+		, FileHits(0)
+	{}
+
+	unsigned int	FilesRead;
+	unsigned int	FileHits;		// a file or an include read before
+};
+
+// \brief
+//	the files are read once, '#include "file"' is resolved relative to the including file and expanded recursively,
+//	an include reached again in the same file is skipped, so a file can be included by several others.
+//	"#line" keeps the line numbers of compile logs, the source string number is the order of the file in the cache.
+//	thread safe
+class FShaderSourceCache
+{
+public:
+	static FShaderSourceCache& SharedInstance();
+
+	// the expanded source of InFilename with InDefines, empty if not readable
+	std::string GetSource(const std::string &InFilename, const FShaderDefines &InDefines);
+
+	// read the files again, e.g. after they are edited
+	void Empty();
+
+	FShaderSourceCacheStats GetStats();
+
+private:
+	FShaderSourceCache() {}
+	FShaderSourceCache(const FShaderSourceCache&) = delete;
+	FShaderSourceCache& operator=(const FShaderSourceCache&) = delete;
+
+	struct FSourceFile
+	{
+		int				Index;		// source string number of "#line"
+		std::string		Text;
+	};
+
+	// with the lock held
+	const FSourceFile* ReadFile(const std::string &InFilename);
+	bool ExpandFile(const std::string &InFilename, std::vector<std::string> &InOutIncluded, std::string &OutSource);
+
+	std::mutex		Mutex;
+	std::map<std::string, FSourceFile>	Files;
+
+	FShaderSourceCacheStats	Stats;
+};
+
+class FShaderProgram;
+typedef TRefCountPtr<FShaderProgram>	FShaderProgramRef;
+
+// \brief
+//	a program and its shaders, registered in FAssetRegistry by the 64-bit hash of the expanded sources,
+//	so the shader types of the same files and defines share one program. the sources are compared on a hit,
+//	a colliding program is registered under the next probe of the key
+class FShaderProgram : public FRefCountedObject
+{
+public:
+	virtual ~FShaderProgram();
+
+	// null if a file is not readable
+	static FShaderProgramRef Create(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines);
+
+	const FOpenGLProgramRef& GetRHIProgram() const { return Program; }
+	// null if the program binary is cached
+	const FOpenGLVertexShaderRef& GetVertexShader() const { return VertexShader; }
+	const FOpenGLPixelShaderRef& GetPixelShader() const { return PixelShader; }
+
+private:
+	FShaderProgram() {}
+
+	bool HasSources(const std::string &InVsSource, const std::string &InPsSource) const { return VsSource == InVsSource && PsSource == InPsSource; }
+
+	std::string				VsSource;
+	std::string				PsSource;
+	FOpenGLVertexShaderRef	VertexShader;
+	FOpenGLPixelShaderRef	PixelShader;
+	FOpenGLProgramRef		Program;
+};
+
+// \brief
+//	the variants of a shader type over the declared switches, bit k of a mask is switch k.
+//	a variant is compiled on first Get() with each switch defined as 0 or 1, use "#if SWITCH" in the shaders.
+//	TShaderType has the constructor (InVsFile, InPsFile, InDefines)
+template<typename TShaderType>
+class TShaderPermutation
+{
+public:
+	TShaderPermutation(const std::string &InVsFile, const std::string &InPsFile, const std::vector<std::string> &InSwitches,
+		const FShaderDefines &InDefines = FShaderDefines())
+		: VsFile(InVsFile)
+		, PsFile(InPsFile)
+		, Switches(InSwitches)
+		, Defines(InDefines)
+	{
+		assert(Switches.size() <= 32);
+	}
+
+	// the bit of a declared switch, 0 if not declared
+	uint32_t GetSwitchBit(const std::string &InSwitch) const
+	{
+		for (size_t Index = 0; Index < Switches.size(); Index++)
+		{
+			if (Switches[Index] == InSwitch)
+			{
+				return 1u << Index;
+			}
+		} // end for
+
+		return 0;
+	}
+
+	TRefCountPtr<TShaderType> Get(uint32_t InMask)
+	{
+		typename std::map<uint32_t, TRefCountPtr<TShaderType>>::iterator itr = Variants.find(InMask);
+		if (itr != Variants.end())
+		{
+			return itr->second;
+		}
+
+		FShaderDefines VariantDefines = Defines;
+		for (size_t Index = 0; Index < Switches.size(); Index++)
+		{
+			VariantDefines.Set(Switches[Index], (InMask >> Index) & 1 ? 1 : 0);
+		} // end for
+
+		TRefCountPtr<TShaderType> Variant = new TShaderType(VsFile, PsFile, VariantDefines);
+		Variants[InMask] = Variant;
+		return Variant;
+	}
+
+	size_t GetVariantCount() const { return Variants.size(); }
+
+private:
+	std::string					VsFile;
+	std::string					PsFile;
+	std::vector<std::string>	Switches;
+	FShaderDefines				Defines;
+	std::map<uint32_t, TRefCountPtr<TShaderType>>	Variants;
+};
+
+#endif // __JETX_SCENE_SHADER_PERMUTATION_H__
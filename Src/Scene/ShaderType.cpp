@@ -2,6 +2,7 @@
 //		implementation of Shader-Type
 //
 
+#include <cassert>
 #include <iostream>
 #include <Common/UtilityHelper.h>
 #include <OpenGL/OpenGLDrv.h>
@@ -10,51 +11,87 @@
 #include "Scene.h"
 #include "Mesh.h"
 #include "SkinMesh.h"
+#include "RenderProxy.h"
 #include "ShaderType.h"
 
 
 
-FShaderType::FShaderType(const std::string &InVsFile, const std::string &InPsFile)
+FShaderType::FShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines)
+	: VsFile(InVsFile)
+	, PsFile(InPsFile)
+	, bResolved(false)
+	, bViewBlock(false)
 {
 	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
 
-	// Load Shader
-	std::string  vShaderCode = FUtilityHelper::ReadTextFile(InVsFile.c_str());
-	std::string  pShaderCode = FUtilityHelper::ReadTextFile(InPsFile.c_str());
+	// Load Shader, the shaders are not compiled if the program binary is cached
+	ShaderProgram = FShaderProgram::Create(InVsFile, InPsFile, InDefines);
+	assert(IsValidRef(ShaderProgram));
+	ProgramRef = ShaderProgram->GetRHIProgram();
 
-	VertexShaderRef = GLDriver.CreateVertexShader(vShaderCode.c_str());
-	PixelShaderRef = GLDriver.CreatePixelShader(pShaderCode.c_str());
-	ProgramRef = GLDriver.CreateProgram(VertexShaderRef, PixelShaderRef);
+	// the other programs are submitted before this one is waited for
+	if (!GLDriver.IsShaderStatusDeferred())
+	{
+		Resolve();
+	}
+}
 
-	std::cout << "======== Load Shader: " << InVsFile << ", " << InPsFile << std::endl;
-	VertexShaderRef->DumpDebugInfo();
-	PixelShaderRef->DumpDebugInfo();
+void FShaderType::Resolve()
+{
+	if (bResolved)
+	{
+		return;
+	}
+	bResolved = true;
+
+	ProgramRef->Resolve();
+	bViewBlock = ProgramRef->HasUniformBlock(FViewUniformBuffer::GetBlockName());
+
+	const FOpenGLVertexShaderRef &VertexShaderRef = ShaderProgram->GetVertexShader();
+	std::cout << "======== Load Shader: " << VsFile << ", " << PsFile << (IsValidRef(VertexShaderRef) ? "" : " (Cached)") << std::endl;
+	if (IsValidRef(VertexShaderRef))
+	{
+		VertexShaderRef->DumpDebugInfo();
+		ShaderProgram->GetPixelShader()->DumpDebugInfo();
+	}
 	ProgramRef->DumpDebugInfo();
 }
 
-FMeshShaderType::FMeshShaderType(const std::string &InVsFile, const std::string &InPsFile)
-	: FShaderType(InVsFile, InPsFile)
+FMeshShaderType::FMeshShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines)
+	: FShaderType(InVsFile, InPsFile, InDefines)
 {
 
 }
 
 void FMeshShaderType::Prepare(const FViewContext &InView, const FMesh &InMesh)
 {
+	PrepareMaterial(InView, *InMesh.Material);
+}
+
+void FMeshShaderType::PrepareMaterial(const FViewContext &InView, const FMaterial &InMaterial)
+{
+	Resolve();
 	ProgramParams.clear();
 
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("model", InView.model));
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("view", InView.view));
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("projection", InView.projection));
-	ProgramParams.push_back(new FShaderParameter_Integer1v("diffuseTex", 0));
-	ProgramParams.push_back(new FShaderParameter_Integer1v("specularTex", 1));
-	ProgramParams.push_back(new FShaderParameter_Integer1v("normalTex", 2));
+	ProgramParams.push_back((new FShaderParameter_Matrix4fv("model", InView.model))->BindSlot(ModelSlot));
+	if (bViewBlock)
+	{
+		FViewUniformBuffer::SharedInstance().SetUp(InView);
+	}
+	else
+	{
+		ProgramParams.push_back((new FShaderParameter_Matrix4fv("view", InView.view))->BindSlot(ViewSlot));
+		ProgramParams.push_back((new FShaderParameter_Matrix4fv("projection", InView.projection))->BindSlot(ProjectionSlot));
+	}
+	ProgramParams.push_back((new FShaderParameter_Integer1v("diffuseTex", 0))->BindSlot(DiffuseTexSlot));
+	ProgramParams.push_back((new FShaderParameter_Integer1v("specularTex", 1))->BindSlot(SpecularTexSlot));
+	ProgramParams.push_back((new FShaderParameter_Integer1v("normalTex", 2))->BindSlot(NormalTexSlot));
 
 	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
 
-	FMaterialRef Material = InMesh.Material;
-	GLDriver.SetTexture2D(0, IsValidRef(Material->TexDiffuse) ? Material->TexDiffuse->GetRHITexture() : nullptr);
-	GLDriver.SetTexture2D(1, IsValidRef(Material->TexSpecular) ? Material->TexSpecular->GetRHITexture() : nullptr);
-	GLDriver.SetTexture2D(2, IsValidRef(Material->TexNormal) ? Material->TexNormal->GetRHITexture() : nullptr);
+	GLDriver.SetTexture2D(0, IsValidRef(InMaterial.TexDiffuse) ? InMaterial.TexDiffuse->GetRHITexture() : nullptr);
+	GLDriver.SetTexture2D(1, IsValidRef(InMaterial.TexSpecular) ? InMaterial.TexSpecular->GetRHITexture() : nullptr);
+	GLDriver.SetTexture2D(2, IsValidRef(InMaterial.TexNormal) ? InMaterial.TexNormal->GetRHITexture() : nullptr);
 }
 
 void FMeshShaderType::SetUp(const FViewContext &InView, const FMesh &InMesh)
@@ -66,10 +103,50 @@ void FMeshShaderType::SetUp(const FViewContext &InView, const FMesh &InMesh)
 	GLDriver.SetShaderProgramParameters(&ProgramParams);
 }
 
+void FMeshShaderType::Prepare(const FViewContext &InView, const FMeshRenderProxy &InProxy)
+{
+	PrepareMaterial(InView, *InProxy.Material);
+}
+
+void FMeshShaderType::SetUp(const FViewContext &InView, const FMeshRenderProxy &InProxy)
+{
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	Prepare(InView, InProxy);
+
+	GLDriver.SetShaderProgram(ProgramRef);
+	GLDriver.SetShaderProgramParameters(&ProgramParams);
+}
+
+void FMeshShaderType::Record(FOpenGLCommandList &InCommandList, const FViewContext &InView, const FMesh &InMesh) const
+{
+	// the reflection can't be queried off the gl thread
+	if (!bResolved)
+	{
+		std::cout << "Error: Record with unresolved shader: " << VsFile << ", " << PsFile << std::endl;
+		return;
+	}
+	InCommandList.SetShaderProgram(ProgramRef);
+
+	InCommandList.SetShaderParameter("model", InView.model);
+	if (!bViewBlock)
+	{
+		InCommandList.SetShaderParameter("view", InView.view);
+		InCommandList.SetShaderParameter("projection", InView.projection);
+	}
+	InCommandList.SetShaderParameter("diffuseTex", 0);
+	InCommandList.SetShaderParameter("specularTex", 1);
+	InCommandList.SetShaderParameter("normalTex", 2);
+
+	FMaterialRef Material = InMesh.Material;
+	InCommandList.SetTexture2D(0, IsValidRef(Material->TexDiffuse) ? Material->TexDiffuse->GetRHITexture() : nullptr);
+	InCommandList.SetTexture2D(1, IsValidRef(Material->TexSpecular) ? Material->TexSpecular->GetRHITexture() : nullptr);
+	InCommandList.SetTexture2D(2, IsValidRef(Material->TexNormal) ? Material->TexNormal->GetRHITexture() : nullptr);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
-FSkinningMeshShaderType::FSkinningMeshShaderType(const std::string &InVsFile, const std::string &InPsFile)
-	: FMeshShaderType(InVsFile, InPsFile)
+FSkinningMeshShaderType::FSkinningMeshShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines)
+	: FMeshShaderType(InVsFile, InPsFile, InDefines)
 {
 
 }
@@ -79,7 +156,7 @@ void FSkinningMeshShaderType::Prepare(const FViewContext &InView, const FSkinMes
 	Super::Prepare(InView, InMesh);
 
 	// Set Bone Matrix Uniform
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("gBones[0]", (float*)(InMesh.FinalMats.data()), InMesh.FinalMats.size()));
+	ProgramParams.push_back((new FShaderParameter_Matrix4fv("gBones[0]", (float*)(InMesh.FinalMats.data()), InMesh.FinalMats.size()))->BindSlot(BonesSlot));
 }
 
 void FSkinningMeshShaderType::SetUp(const FViewContext &InView, const FSkinMesh &InMesh)
@@ -91,21 +168,49 @@ void FSkinningMeshShaderType::SetUp(const FViewContext &InView, const FSkinMesh
 	GLDriver.SetShaderProgramParameters(&ProgramParams);
 }
 
+void FSkinningMeshShaderType::Prepare(const FViewContext &InView, const FMeshRenderProxy &InProxy)
+{
+	Super::Prepare(InView, InProxy);
+
+	// Set Bone Matrix Uniform, the palette lives in the frame until it is drawn
+	ProgramParams.push_back((new FShaderParameter_Matrix4fv("gBones[0]", (float*)(InProxy.Bones), InProxy.BoneCount))->BindSlot(BonesSlot));
+}
+
+void FSkinningMeshShaderType::Record(FOpenGLCommandList &InCommandList, const FViewContext &InView, const FMesh &InMesh) const
+{
+	Super::Record(InCommandList, InView, InMesh);
+
+	// Set Bone Matrix Uniform
+	if (bResolved && InMesh.IsSkinned())
+	{
+		const FSkinMesh &SkinMesh = static_cast<const FSkinMesh&>(InMesh);
+		InCommandList.SetShaderParameter("gBones[0]", GL_FLOAT_MAT4, SkinMesh.FinalMats.data(), (GLsizei)SkinMesh.FinalMats.size());
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 
-FLinesShaderType::FLinesShaderType(const std::string &InVsFile, const std::string &InPsFile)
-	: FShaderType(InVsFile, InPsFile)
+FLinesShaderType::FLinesShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines)
+	: FShaderType(InVsFile, InPsFile, InDefines)
 {
 
 }
 
 void FLinesShaderType::Prepare(const FViewContext &InView, const FLinesPatch &InLines)
 {
+	Resolve();
 	ProgramParams.clear();
 
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("model", InView.model));
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("view", InView.view));
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("projection", InView.projection));
+	ProgramParams.push_back((new FShaderParameter_Matrix4fv("model", InView.model))->BindSlot(ModelSlot));
+	if (bViewBlock)
+	{
+		FViewUniformBuffer::SharedInstance().SetUp(InView);
+	}
+	else
+	{
+		ProgramParams.push_back((new FShaderParameter_Matrix4fv("view", InView.view))->BindSlot(ViewSlot));
+		ProgramParams.push_back((new FShaderParameter_Matrix4fv("projection", InView.projection))->BindSlot(ProjectionSlot));
+	}
 }
 
 void FLinesShaderType::SetUp(const FViewContext &InView, const FLinesPatch &InLines)
@@ -119,19 +224,20 @@ void FLinesShaderType::SetUp(const FViewContext &InView, const FLinesPatch &InLi
 
 //////////////////////////////////////////////////////////////////////////
 
-FGlobalShaderType::FGlobalShaderType(const std::string &InVsFile, const std::string &InPsFile)
-	: FShaderType(InVsFile, InPsFile)
+FGlobalShaderType::FGlobalShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines)
+	: FShaderType(InVsFile, InPsFile, InDefines)
 {
 
 }
 
 void FGlobalShaderType::Prepare()
 {
+	Resolve();
 	ProgramParams.clear();
 
 	glm::mat4 MVP = glm::ortho(0.f, 1.f, 0.f, 1.f, -1.f, 1.f);
-	ProgramParams.push_back(new FShaderParameter_Matrix4fv("mvp", MVP));
-	ProgramParams.push_back(new FShaderParameter_Integer1v("quadTex", 0));
+	ProgramParams.push_back((new FShaderParameter_Matrix4fv("mvp", MVP))->BindSlot(MvpSlot));
+	ProgramParams.push_back((new FShaderParameter_Integer1v("quadTex", 0))->BindSlot(QuadTexSlot));
 }
 
 void FGlobalShaderType::SetUp()
@@ -11,25 +11,47 @@
 #include <OpenGL/GLShader.h>
 #include <OpenGL/GLShaderParameter.h>
 
+#include "ShaderPermutation.h"
+
 
 struct FViewContext;
 class FMesh;
 class FSkinMesh;
+class FMaterial;
 class FLinesPatch;
+class FOpenGLCommandList;
+struct FMeshRenderProxy;
 
 
 // shader type
 class FShaderType : public FRefCountedObject
 {
 public:
-	FShaderType(const std::string &InVsFile, const std::string &InPsFile);
+	FShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines = FShaderDefines());
+
+	// no waiting: the program is compiled and linked, poll it when the shader status is deferred
+	bool IsReady() const { return ProgramRef->IsReady(); }
+	// gl thread: query the program and dump the logs. done by the constructor, or on first use if the shader status is deferred
+	void Resolve();
+	bool IsResolved() const { return bResolved; }
 
 protected:
+	std::string VsFile;
+	std::string PsFile;
+	bool bResolved;
+
+	// the program reads view and projection from the shared "ViewBlock"
+	bool bViewBlock;
+
 	// Set Shader Parameters
 	FProgramParameters ProgramParams;
+	// the slots of the parameters set up every draw
+	FShaderParameterSlot ModelSlot;
+	FShaderParameterSlot ViewSlot;
+	FShaderParameterSlot ProjectionSlot;
 
-	FOpenGLVertexShaderRef VertexShaderRef;
-	FOpenGLPixelShaderRef PixelShaderRef;
+	// shared by the shader types of the same sources and defines
+	FShaderProgramRef ShaderProgram;
 	FOpenGLProgramRef ProgramRef;
 };
 
@@ -37,11 +59,28 @@ protected:
 class FMeshShaderType : public FShaderType
 {
 public:
-	FMeshShaderType(const std::string &InVsFile, const std::string &InPsFile);
+	FMeshShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines = FShaderDefines());
 
 	virtual void Prepare(const FViewContext &InView, const FMesh &InMesh);
 
 	void SetUp(const FViewContext &InView, const FMesh &InMesh);
+
+	// the material and bone palette of proxy, on render thread
+	virtual void Prepare(const FViewContext &InView, const FMeshRenderProxy &InProxy);
+
+	void SetUp(const FViewContext &InView, const FMeshRenderProxy &InProxy);
+
+	// record the program, parameters and textures of Prepare() without gl call, it is safe on worker threads.
+	// the "ViewBlock" is not recorded, set it up on the gl thread before the list is executed.
+	// requires Resolve() on the gl thread before recording, e.g. by FRenderPolicy::Resolve(), records nothing otherwise
+	virtual void Record(FOpenGLCommandList &InCommandList, const FViewContext &InView, const FMesh &InMesh) const;
+
+protected:
+	void PrepareMaterial(const FViewContext &InView, const FMaterial &InMaterial);
+
+	FShaderParameterSlot DiffuseTexSlot;
+	FShaderParameterSlot SpecularTexSlot;
+	FShaderParameterSlot NormalTexSlot;
 };
 
 // skinning mesh shader type
@@ -50,18 +89,27 @@ class FSkinningMeshShaderType : public FMeshShaderType
 public:
 	typedef FMeshShaderType Super;
 
-	FSkinningMeshShaderType(const std::string &InVsFile, const std::string &InPsFile);
+	FSkinningMeshShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines = FShaderDefines());
 
 	virtual void Prepare(const FViewContext &InView, const FSkinMesh &InMesh);
 
 	void SetUp(const FViewContext &InView, const FSkinMesh &InMesh);
+	using Super::SetUp;
+
+	virtual void Prepare(const FViewContext &InView, const FMeshRenderProxy &InProxy) override;
+
+	// the bone palette is recorded if InMesh is skinned
+	virtual void Record(FOpenGLCommandList &InCommandList, const FViewContext &InView, const FMesh &InMesh) const override;
+
+protected:
+	FShaderParameterSlot BonesSlot;
 };
 
 // line shader type
 class FLinesShaderType : public FShaderType
 {
 public:
-	FLinesShaderType(const std::string &InVsFile, const std::string &InPsFile);
+	FLinesShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines = FShaderDefines());
 
 	virtual void Prepare(const FViewContext &InView, const FLinesPatch &InLines);
 
@@ -72,11 +120,15 @@ public:
 class FGlobalShaderType : public FShaderType
 {
 public:
-	FGlobalShaderType(const std::string &InVsFile, const std::string &InPsFile);
+	FGlobalShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines = FShaderDefines());
 
 	virtual void Prepare();
 
 	void SetUp();
+
+protected:
+	FShaderParameterSlot MvpSlot;
+	FShaderParameterSlot QuadTexSlot;
 };
 
 #endif // __JETX_SCENE_SHADERTYPE_H__
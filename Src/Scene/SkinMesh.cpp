@@ -7,42 +7,41 @@
 
 #include "Model.h"
 #include "SkinMesh.h"
+#include "RenderProxy.h"
 
-void FSkinMesh::InitRHI()
+void FSkinMesh::InitResources()
 {
-	Super::InitRHI();
+	Super::InitResources();
 	if (IsValidRef(VertexSkinBuffer))
 	{
 		VertexSkinBuffer->InitRHI();
 	}
 }
 
-void FSkinMesh::ReleaseRHI()
+void FSkinMesh::ReleaseResources()
 {
 	if (IsValidRef(VertexSkinBuffer))
 	{
 		VertexSkinBuffer->ReleaseRHI();
 	}
-	Super::ReleaseRHI();
+	Super::ReleaseResources();
 }
 
-void FSkinMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance)
+void FSkinMesh::InitVertexDeclaration()
 {
-	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
-
-	if (!IsValidRef(VertexDeclRef))
-	{
-		FVertexElementsList VertexElementList;
-		VertexElementList.push_back(FVertexElement(0, 0, STRUCT_VAR_OFFSET(FVertex, Position), sizeof(FVertex), VET_Float3));	// POSITION
-		VertexElementList.push_back(FVertexElement(0, 1, STRUCT_VAR_OFFSET(FVertex, Normal), sizeof(FVertex), VET_Float3));		// NORMAL
-		VertexElementList.push_back(FVertexElement(0, 2, STRUCT_VAR_OFFSET(FVertex, TexCoords), sizeof(FVertex), VET_Float2));	// TEX-COORD
-		VertexElementList.push_back(FVertexElement(0, 3, STRUCT_VAR_OFFSET(FVertex, Tangent), sizeof(FVertex), VET_Float3));	// Tangent
-		VertexElementList.push_back(FVertexElement(0, 4, STRUCT_VAR_OFFSET(FVertex, Bitangent), sizeof(FVertex), VET_Float3));	// BiTangent
-		VertexElementList.push_back(FVertexElement(1, 5, STRUCT_VAR_OFFSET(FVertexSkin, Indices), sizeof(FVertexSkin), VET_UByte4));	// Bone Indices
-		VertexElementList.push_back(FVertexElement(1, 6, STRUCT_VAR_OFFSET(FVertexSkin, Weights), sizeof(FVertexSkin), VET_Float4));	// Bone Weights
-		VertexDeclRef = GLDriver.CreateVertexDeclaration(VertexElementList);
-	}
+	FVertexElementsList VertexElementList;
+	VertexElementList.push_back(FVertexElement(0, 0, STRUCT_VAR_OFFSET(FVertex, Position), sizeof(FVertex), VET_Float3));	// POSITION
+	VertexElementList.push_back(FVertexElement(0, 1, STRUCT_VAR_OFFSET(FVertex, Normal), sizeof(FVertex), VET_Float3));		// NORMAL
+	VertexElementList.push_back(FVertexElement(0, 2, STRUCT_VAR_OFFSET(FVertex, TexCoords), sizeof(FVertex), VET_Float2));	// TEX-COORD
+	VertexElementList.push_back(FVertexElement(0, 3, STRUCT_VAR_OFFSET(FVertex, Tangent), sizeof(FVertex), VET_Float3));	// Tangent
+	VertexElementList.push_back(FVertexElement(0, 4, STRUCT_VAR_OFFSET(FVertex, Bitangent), sizeof(FVertex), VET_Float3));	// BiTangent
+	VertexElementList.push_back(FVertexElement(1, 5, STRUCT_VAR_OFFSET(FVertexSkin, Indices), sizeof(FVertexSkin), VET_UByte4));	// Bone Indices
+	VertexElementList.push_back(FVertexElement(1, 6, STRUCT_VAR_OFFSET(FVertexSkin, Weights), sizeof(FVertexSkin), VET_Float4));	// Bone Weights
+	VertexDeclRef = FOpenGLDrv::SharedInstance().GetVertexDeclaration(VertexElementList);
+}
 
+void FSkinMesh::UpdateBoneMatrices(const FModel &InModel)
+{
 	FNodeHierarchyRef NodeHierarchy = InModel.GetNodeHierarchy();
 	assert(IsValidRef(NodeHierarchy));
 
@@ -71,14 +70,27 @@ void FSkinMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy,
 
 		FinalMats[Index] = SkeletonNode.ModelMat * Bone.MeshToBone;
 	}
+}
+
+void FSkinMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance)
+{
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+
+	if (!IsValidRef(VertexDeclRef))
+	{
+		InitVertexDeclaration();
+	}
+
+	UpdateBoneMatrices(InModel);
 
 #if 0
 	// CPU SKIN
-	FVertex* pVertexs = (FVertex*) VertexBuffer->Buffer->Lock(0, VertexBuffer->Vertexes.size() * sizeof(FVertex), false, false);
-	for (unsigned int k = 0; k < VertexSkinBuffer->Vertexes.size(); k++)
+	// all vertices are rewritten, the old content is discarded without waiting for gpu
+	FVertex* pVertexs = (FVertex*) VertexBuffer->Buffer->Lock(0, VertexBuffer->GetVertexCount() * sizeof(FVertex), BLF_Write | BLF_DiscardBuffer);
+	for (unsigned int k = 0; k < VertexSkinBuffer->GetVertexCount(); k++)
 	{
-		const FVertexSkin &SkinInfo = VertexSkinBuffer->Vertexes[k];
-		const glm::vec4 localPos = glm::vec4(VertexBuffer->Vertexes[k].Position, 1.f);
+		const FVertexSkin &SkinInfo = VertexSkinBuffer->GetVertexData()[k];
+		const glm::vec4 localPos = glm::vec4(VertexBuffer->GetVertexData()[k].Position, 1.f);
 
 		glm::vec4 ObjPos;
 		ObjPos = FinalMats[SkinInfo.Indices[0]] * localPos * SkinInfo.Weights[0];
@@ -86,6 +98,7 @@ void FSkinMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy,
 		ObjPos += FinalMats[SkinInfo.Indices[2]] * localPos * SkinInfo.Weights[2];
 		ObjPos += FinalMats[SkinInfo.Indices[3]] * localPos * SkinInfo.Weights[3];
 
+		pVertexs[k] = VertexBuffer->GetVertexData()[k];
 		pVertexs[k].Position = glm::vec3(ObjPos.x, ObjPos.y, ObjPos.z);
 	}
 	VertexBuffer->Buffer->UnLock();
@@ -102,5 +115,45 @@ void FSkinMesh::Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy,
 	GLDriver.SetStreamSource(1, VertexSkinBuffer->GetRHIBuffer());
 	GLDriver.SetVertexDeclaration(VertexDeclRef);
 
-	GLDriver.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, 0, IndexBuffer->GetElementCount());
+	GLDriver.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, IndexBuffer->GetFirstIndex(), IndexBuffer->GetElementCount(), VertexBuffer->GetBaseVertex());
+}
+
+void FSkinMesh::Record(FOpenGLCommandList &InCommandList, const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance)
+{
+	assert(IsValidRef(VertexDeclRef));
+	UpdateBoneMatrices(InModel);
+
+	// record shader & parameters, the bone matrices are copied
+	InPolicy.SkinMeshShader->Record(InCommandList, InViewContext, *this);
+
+	InCommandList.SetStreamSource(0, VertexBuffer->GetRHIBuffer());
+	InCommandList.SetStreamSource(1, VertexSkinBuffer->GetRHIBuffer());
+	InCommandList.SetVertexDeclaration(VertexDeclRef);
+
+	InCommandList.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, IndexBuffer->GetFirstIndex(), IndexBuffer->GetElementCount(), VertexBuffer->GetBaseVertex());
+}
+
+void FSkinMesh::Snapshot(FRenderFrame &OutFrame, const glm::mat4 &InTransform, const FModel &InModel, const FMeshInstance &MeshInstance)
+{
+	// the bones are in model space, the node transform is not applied as Draw()
+	UpdateBoneMatrices(InModel);
+	OutFrame.AddMesh(this, Material, InTransform, FinalMats.data(), (GLuint)FinalMats.size());
+}
+
+void FSkinMesh::DrawProxy(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FMeshRenderProxy &InProxy)
+{
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	assert(IsValidRef(VertexDeclRef));
+
+	FViewContext LocalViewContext(InViewContext);
+	LocalViewContext.model = InProxy.Transform;
+
+	// GPU SKIN with the bone palette of proxy
+	InPolicy.SkinMeshShader->SetUp(LocalViewContext, InProxy);
+
+	GLDriver.SetStreamSource(0, VertexBuffer->GetRHIBuffer());
+	GLDriver.SetStreamSource(1, VertexSkinBuffer->GetRHIBuffer());
+	GLDriver.SetVertexDeclaration(VertexDeclRef);
+
+	GLDriver.DrawIndexedPrimitive(IndexBuffer->GetRHIBuffer(), PrimitiveMode, IndexBuffer->GetFirstIndex(), IndexBuffer->GetElementCount(), VertexBuffer->GetBaseVertex());
 }
@@ -49,14 +49,25 @@ public:
 	}
 
 	virtual void Draw(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance) override;
+	virtual void Record(FOpenGLCommandList &InCommandList, const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FModel &InModel, const FMeshInstance &MeshInstance) override;
+	virtual void Snapshot(FRenderFrame &OutFrame, const glm::mat4 &InTransform, const FModel &InModel, const FMeshInstance &MeshInstance) override;
+	virtual void DrawProxy(const FViewContext &InViewContext, FRenderPolicy &InPolicy, const FMeshRenderProxy &InProxy) override;
 
-	virtual void InitRHI() override;
-	virtual void ReleaseRHI() override;
+	virtual bool IsSkinned() const override { return true; }
+
+protected:
+	virtual void InitResources() override;
+	virtual void ReleaseResources() override;
+
+	virtual void InitVertexDeclaration() override;
+	// FinalMats from the pose of model
+	void UpdateBoneMatrices(const FModel &InModel);
 
 public:
 	FVertexSkinBufferRef	VertexSkinBuffer;
 
 	std::vector<FMeshBone>	MeshBones;
+	// the pose of the model last drawn, the instances sharing the mesh overwrite it in turn
 	std::vector<glm::mat4>	FinalMats;
 	bool					bBoneIdxCached;
 };
@@ -0,0 +1,287 @@
+// \brief
+//		implementation of texture streaming
+//
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <functional>
+
+#include "TextureStreamer.h"
+#include "Mesh.h"
+#include "RenderProxy.h"
+
+
+FTextureStreamer& FTextureStreamer::SharedInstance()
+{
+	static FTextureStreamer Streamer;
+
+	return Streamer;
+}
+
+int FTextureStreamer::GetMipTailFirstMip(const FTexture2D &InTexture) const
+{
+	// the first level not larger than the tail size, level k is max(1, size >> k)
+	int Size = std::max(InTexture.GetWidth(), InTexture.GetHeight());
+	int Level = 0;
+	while (Size > Config.MipTailSize && Level + 1 < InTexture.GetMipCount())
+	{
+		Size = std::max(1, Size >> 1);
+		Level++;
+	} // end while
+
+	return Level;
+}
+
+void FTextureStreamer::Register(FTexture2D *InTexture)
+{
+	FStreamingTexture Entry;
+	Entry.RequiredMip = (float)InTexture->GetResidentFirstMip();
+	Entry.LastSeenFrame = 0;
+	Entry.WantedMip = InTexture->GetResidentFirstMip();
+	Entry.bLoading = false;
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Textures[InTexture] = Entry;
+}
+
+void FTextureStreamer::Unregister(FTexture2D *InTexture)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Textures.erase(InTexture);
+}
+
+void FTextureStreamer::AddFrame(const FRenderFrame &InFrame)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	for (size_t Index = 0; Index < InFrame.Meshes.size(); Index++)
+	{
+		const FMeshRenderProxy &Proxy = InFrame.Meshes[Index];
+		AddMeshLocked(*Proxy.Mesh, Proxy.Material.DeRef(), Proxy.Transform, InFrame.View);
+	} // end for
+}
+
+void FTextureStreamer::AddMesh(const FMesh &InMesh, const FMaterial *InMaterial, const glm::mat4 &InTransform, const FViewContext &InView)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	AddMeshLocked(InMesh, InMaterial, InTransform, InView);
+}
+
+void FTextureStreamer::AddMeshLocked(const FMesh &InMesh, const FMaterial *InMaterial, const glm::mat4 &InTransform, const FViewContext &InView)
+{
+	if (!InMaterial)
+	{
+		return;
+	}
+
+	// the largest axis scale of the transform
+	const float kScale = glm::sqrt(std::max(glm::dot(glm::vec3(InTransform[0]), glm::vec3(InTransform[0])),
+		std::max(glm::dot(glm::vec3(InTransform[1]), glm::vec3(InTransform[1])), glm::dot(glm::vec3(InTransform[2]), glm::vec3(InTransform[2])))));
+
+	// the nearest point of bounding sphere decides the pixels of a world unit
+	const glm::vec4 kViewCenter = InView.view * InTransform * glm::vec4(InMesh.BoundsCenter, 1.f);
+	const float kDistance = std::max(glm::length(glm::vec3(kViewCenter)) - InMesh.BoundsRadius * kScale, 0.01f);
+	const float kPixelsPerWorldUnit = InView.projection[1][1] * 0.5f * (float)InView.viewport.w / kDistance;
+
+	const float kWorldPerUV = InMesh.TexelFactor * kScale;
+	RequireTexture(InMaterial->TexDiffuse.DeRef(), kWorldPerUV, kPixelsPerWorldUnit);
+	RequireTexture(InMaterial->TexSpecular.DeRef(), kWorldPerUV, kPixelsPerWorldUnit);
+	RequireTexture(InMaterial->TexNormal.DeRef(), kWorldPerUV, kPixelsPerWorldUnit);
+}
+
+void FTextureStreamer::RequireTexture(FTexture2D *InTexture, float InWorldPerUV, float InPixelsPerWorldUnit)
+{
+	std::map<FTexture2D*, FStreamingTexture>::iterator itr = InTexture ? Textures.find(InTexture) : Textures.end();
+	if (itr == Textures.end())
+	{
+		return;
+	}
+
+	// a texel covers a pixel at the level, the full resolution if the uv density is unknown
+	float Mip = 0.f;
+	if (InWorldPerUV > 0.f)
+	{
+		const float kTexelsPerWorldUnit = (float)std::max(InTexture->GetWidth(), InTexture->GetHeight()) / InWorldPerUV;
+		Mip = std::max(glm::log2(kTexelsPerWorldUnit / InPixelsPerWorldUnit), 0.f);
+	}
+
+	FStreamingTexture &Entry = itr->second;
+	if (Entry.LastSeenFrame != FrameNumber + 1)
+	{
+		Entry.RequiredMip = Mip;
+		Entry.LastSeenFrame = FrameNumber + 1;
+	}
+	else
+	{
+		Entry.RequiredMip = std::min(Entry.RequiredMip, Mip);
+	}
+}
+
+void FTextureStreamer::UpdateWantedMips()
+{
+	size_t FixedBytes = 0;
+	std::vector<int> RequiredMips;
+	std::vector<int> TailMips;
+	RequiredMips.reserve(Textures.size());
+	TailMips.reserve(Textures.size());
+
+	Stats.Textures = (unsigned int)Textures.size();
+	Stats.StreamedTextures = 0;
+	Stats.ResidentBytes = 0;
+	for (std::map<FTexture2D*, FStreamingTexture>::iterator itr = Textures.begin(); itr != Textures.end(); ++itr)
+	{
+		const FTexture2D &Texture = *itr->first;
+		const FStreamingTexture &Entry = itr->second;
+
+		Stats.ResidentBytes += Texture.GetMipsBytes(Texture.GetResidentFirstMip());
+		Stats.StreamedTextures += Texture.GetResidentFirstMip() > 0 ? 1 : 0;
+
+		int TailMip = 0, RequiredMip = 0;
+		if (Texture.IsStreamable())
+		{
+			TailMip = GetMipTailFirstMip(Texture);
+			// the level of the last frame seen, or the tail if not seen for a while
+			const bool bSeen = Entry.LastSeenFrame > 0 && FrameNumber - Entry.LastSeenFrame < Config.KeepUnseenFrames;
+			RequiredMip = bSeen ? std::min((int)Entry.RequiredMip, TailMip) : TailMip;
+		}
+		else
+		{
+			FixedBytes += Texture.GetMipsBytes(0);
+		}
+		RequiredMips.push_back(RequiredMip);
+		TailMips.push_back(TailMip);
+	} // end for
+
+	// the smallest bias fits the budget
+	MipBias = 0;
+	for (;; MipBias++)
+	{
+		size_t Bytes = FixedBytes;
+		size_t Index = 0;
+		for (std::map<FTexture2D*, FStreamingTexture>::iterator itr = Textures.begin(); itr != Textures.end(); ++itr, ++Index)
+		{
+			if (itr->first->IsStreamable())
+			{
+				Bytes += itr->first->GetMipsBytes(std::min(RequiredMips[Index] + MipBias, TailMips[Index]));
+			}
+		} // end for
+
+		if (MipBias == 0)
+		{
+			Stats.WantedBytes = Bytes;
+		}
+		if (Bytes <= Config.BudgetBytes || MipBias >= Config.MaxMipBias)
+		{
+			break;
+		}
+	} // end for
+
+	size_t Index = 0;
+	for (std::map<FTexture2D*, FStreamingTexture>::iterator itr = Textures.begin(); itr != Textures.end(); ++itr, ++Index)
+	{
+		itr->second.WantedMip = std::min(RequiredMips[Index] + MipBias, TailMips[Index]);
+	} // end for
+	Stats.MipBias = MipBias;
+}
+
+void FTextureStreamer::Tick(double InBudgetMs)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point TickStart = std::chrono::steady_clock::now();
+	FJobSystem &JobSystem = FJobSystem::SharedInstance();
+
+	// the references are dropped after the lock is released, a last release unregisters the texture
+	std::vector<FTexture2DRef> Retained;
+	std::vector<std::unique_ptr<FStreamingLoad>> FinishedLoads;
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	FrameNumber++;
+	UpdateWantedMips();
+
+	unsigned int Uploads = 0;
+	std::function<bool()> HasTime = [&TickStart, &Uploads, InBudgetMs]() {
+		// one upload at least
+		return Uploads == 0 || std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - TickStart).count() < InBudgetMs;
+	};
+
+	// evictions first, they free the memory for the loads
+	for (std::map<FTexture2D*, FStreamingTexture>::iterator itr = Textures.begin(); itr != Textures.end() && HasTime(); ++itr)
+	{
+		FTexture2D *Texture = itr->first;
+		FStreamingTexture &Entry = itr->second;
+		if (Entry.bLoading || Entry.WantedMip <= Texture->GetResidentFirstMip() || !Texture->TryRetain())
+		{
+			continue;
+		}
+		Retained.push_back(FTexture2DRef(Texture, false));
+
+		Stats.LevelsEvicted += Entry.WantedMip - Texture->GetResidentFirstMip();
+		Texture->StreamMips(Entry.WantedMip);
+		Uploads++;
+	} // end for
+
+	// the prefetched levels, no more than wanted now
+	for (size_t Index = 0; Index < Loads.size() && HasTime(); )
+	{
+		FStreamingLoad &Load = *Loads[Index];
+		if (JobSystem.GetNumWorkers() == 0)
+		{
+			JobSystem.Wait(Load.Counter);
+		}
+		if (!Load.Counter.IsDone())
+		{
+			Index++;
+			continue;
+		}
+
+		std::map<FTexture2D*, FStreamingTexture>::iterator itr = Textures.find(Load.Texture.DeRef());
+		if (itr != Textures.end())
+		{
+			itr->second.bLoading = false;
+			const int kFirstMip = std::max(Load.FirstMip, itr->second.WantedMip);
+			if (kFirstMip < Load.Texture->GetResidentFirstMip())
+			{
+				Stats.LevelsLoaded += Load.Texture->GetResidentFirstMip() - kFirstMip;
+				Load.Texture->StreamMips(kFirstMip);
+				Uploads++;
+			}
+		}
+
+		FinishedLoads.push_back(std::move(Loads[Index]));
+		Loads.erase(Loads.begin() + Index);
+	} // end for
+
+	// prefetch the levels wanted
+	for (std::map<FTexture2D*, FStreamingTexture>::iterator itr = Textures.begin(); itr != Textures.end(); ++itr)
+	{
+		FTexture2D *Texture = itr->first;
+		FStreamingTexture &Entry = itr->second;
+		if (Entry.bLoading || Entry.WantedMip >= Texture->GetResidentFirstMip() || !Texture->TryRetain())
+		{
+			continue;
+		}
+
+		std::unique_ptr<FStreamingLoad> Load(new FStreamingLoad());
+		Load->Texture = FTexture2DRef(Texture, false);
+		Load->FirstMip = Entry.WantedMip;
+		Entry.bLoading = true;
+
+		// the load outlives the job, it is kept until the counter is done
+		FStreamingLoad *RawLoad = Load.get();
+		const int kLastMip = Texture->GetResidentFirstMip();
+		JobSystem.Run([RawLoad, kLastMip]() { RawLoad->Texture->PrefetchMips(RawLoad->FirstMip, kLastMip); }, &RawLoad->Counter);
+		Loads.push_back(std::move(Load));
+	} // end for
+	Stats.PendingLoads = (unsigned int)Loads.size();
+}
+
+FTextureStreamerStats FTextureStreamer::GetStats()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	return Stats;
+}
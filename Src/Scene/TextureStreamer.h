@@ -0,0 +1,136 @@
+// \brief
+//		texture streaming, the resident mip levels of textures are decided by their screen size and a video memory budget
+//
+
+#ifndef __JETX_SCENE_TEXTURE_STREAMER_H__
+#define __JETX_SCENE_TEXTURE_STREAMER_H__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <Common/JobSystem.h>
+#include <Common/RefCounting.h>
+
+
+class FTexture2D;
+class FMesh;
+class FMaterial;
+class FRenderFrame;
+struct FViewContext;
+
+// settings of texture streaming
+struct FTextureStreamingConfig
+{
+	FTextureStreamingConfig()
+		: BudgetBytes(0)
+		, MipTailSize(64)
+		, KeepUnseenFrames(60)
+		, MaxMipBias(4)
+	{}
+
+	size_t			BudgetBytes;		// video memory of the textures, 0 disables the streaming
+	int				MipTailSize;		// the levels not larger than it are always resident
+	unsigned int	KeepUnseenFrames;	// a texture not drawn for the frames drops to its mip tail
+	int				MaxMipBias;			// the most levels dropped from all textures to fit the budget
+};
+
+// statistics of texture streaming
+struct FTextureStreamerStats
+{
+	FTextureStreamerStats()
+		: Textures(0)
+		, StreamedTextures(0)
+		, ResidentBytes(0)
+		, WantedBytes(0)
+		, MipBias(0)
+		, LevelsLoaded(0)
+		, LevelsEvicted(0)
+		, PendingLoads(0)
+	{}
+
+	unsigned int	Textures;			// with gl resources
+	unsigned int	StreamedTextures;	// not at full resolution
+	size_t			ResidentBytes;		// video memory of all textures
+	size_t			WantedBytes;		// video memory if the required levels of all textures were resident
+	int				MipBias;			// the levels dropped to fit the budget
+	unsigned int	LevelsLoaded;
+	unsigned int	LevelsEvicted;
+	unsigned int	PendingLoads;		// prefetching on the job system
+};
+
+// \brief
+//	AddFrame() accumulates the required level of each texture from the meshes drawn, the level of which
+//	a texel covers a pixel, by the distance to the bounding sphere and the uv density of mesh.
+//	Tick() fits the wanted levels into the budget by a bias on all textures, evicts the levels not wanted,
+//	and loads the wanted ones: the levels are prefetched from the mapped dds file by a job,
+//	then the texture is recreated on the gl thread within the time budget.
+//	only the compressed textures with a mip chain are streamed, the others count against the budget at full size.
+//	the registered textures are weak references, a texture unregisters itself when released or destroyed.
+class FTextureStreamer
+{
+public:
+	static FTextureStreamer& SharedInstance();
+
+	// set before the textures are created
+	void SetConfig(const FTextureStreamingConfig &InConfig) { Config = InConfig; }
+	const FTextureStreamingConfig& GetConfig() const { return Config; }
+	bool IsEnabled() const { return Config.BudgetBytes > 0; }
+
+	// the first level of the mip tail, which is always resident
+	int GetMipTailFirstMip(const FTexture2D &InTexture) const;
+
+	// called by FTexture2D when the gl resource is created or released
+	void Register(FTexture2D *InTexture);
+	void Unregister(FTexture2D *InTexture);
+
+	// the textures of the meshes in frame are required, call before Tick() for each frame drawn
+	void AddFrame(const FRenderFrame &InFrame);
+	// same for a mesh drawn without render frame, InTransform is the model matrix
+	void AddMesh(const FMesh &InMesh, const FMaterial *InMaterial, const glm::mat4 &InTransform, const FViewContext &InView);
+
+	// gl thread: update the residency within InBudgetMs milliseconds, an upload is not split
+	void Tick(double InBudgetMs);
+
+	FTextureStreamerStats GetStats();
+
+private:
+	FTextureStreamer() : FrameNumber(0), MipBias(0) {}
+	FTextureStreamer(const FTextureStreamer&) = delete;
+	FTextureStreamer& operator=(const FTextureStreamer&) = delete;
+
+	struct FStreamingTexture
+	{
+		float			RequiredMip;	// the finest level required in the last seen frame
+		unsigned int	LastSeenFrame;
+		int				WantedMip;		// decided by Tick()
+		bool			bLoading;
+	};
+
+	// the levels of a texture prefetched by a job, the texture is kept alive until the upload
+	struct FStreamingLoad
+	{
+		TRefCountPtr<FTexture2D>	Texture;
+		int							FirstMip;
+		FJobCounter					Counter;
+	};
+
+	// with the lock held
+	void AddMeshLocked(const FMesh &InMesh, const FMaterial *InMaterial, const glm::mat4 &InTransform, const FViewContext &InView);
+	void RequireTexture(FTexture2D *InTexture, float InWorldPerUV, float InPixelsPerWorldUnit);
+	// decide WantedMip of all textures and the bias
+	void UpdateWantedMips();
+
+	std::mutex		Mutex;
+	FTextureStreamingConfig					Config;
+	std::map<FTexture2D*, FStreamingTexture>	Textures;
+	std::vector<std::unique_ptr<FStreamingLoad>>	Loads;
+	unsigned int	FrameNumber;
+	int				MipBias;
+
+	FTextureStreamerStats	Stats;
+};
+
+#endif // __JETX_SCENE_TEXTURE_STREAMER_H__
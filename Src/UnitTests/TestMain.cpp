@@ -8,6 +8,14 @@
 //#include "test_camera.h"
 //#include "model_rendered.h"
 //#include "test_model.h"
+//#include "test_model_instanced.h"
+//#include "test_command_list.h"
+//#include "test_render_thread.h"
+//#include "test_job_system.h"
+//#include "test_model_async.h"
+//#include "test_loader_thread.h"
+//#include "test_cook_model.h"
+//#include "test_texture_streaming.h"
 //#include "test_framebuffer.h"
 //#include "geometry_shader_houses.h"
 //#include "instancing_asteroids_instanced.h"
@@ -20,4 +28,5 @@
 //#include "test_deferred_shading.h"
 //#include "ssao.h"
 //#include "test_ssao.h"
+//#include "test_shader_permutation.h"
 #include "test_model_animation.h"
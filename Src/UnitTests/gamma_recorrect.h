@@ -149,6 +149,8 @@ int main()
 		}
 
 
+        GLDriver.EndFrame();
+
         // Swap the screen buffers
         glfwSwapBuffers(window);
     }
@@ -1,8 +1,10 @@
 // Std. Includes
 #include <string>
 
+#include "Common/JobSystem.h"
 #include "Common/UtilityHelper.h"
 #include "OpenGL/OpenGLDrv.h"
+#include "Scene/AssetRegistry.h"
 #include "Scene/Camera.h"
 #include "Scene/Model.h"
 #include "Scene/Render.h"
@@ -172,7 +174,10 @@ int main()
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
 
 	glm::vec3 LightPos(2.f, 2.f, 2.f);
 	glm::vec3 LightColor(2.0f, 2.0f, 2.0f);
@@ -191,7 +196,8 @@ int main()
 
 	FDrawFullQuadHelper QuadHelper;
 
-	// Load Model
+	// Load Model, the textures are decoded by the workers
+	FJobSystem::SharedInstance().Initialize(FJobSystem::GetDefaultNumWorkers());
 	Model = FModel::CreateModel("objects/nanosuit/nanosuit.obj");
 	Model->InitRHI();
 
@@ -204,6 +210,9 @@ int main()
 	LightCube = FModel::CreateCube("textures/awesomeface.png");
 	LightCube->InitRHI();
 
+	// the floor and the cube share "wood.png"
+	FAssetRegistry::SharedInstance().DumpAssets();
+
 	// Create Frame Buffer
 	FOpenGLFrameBufferRef FrameBuffer = GLDriver.CreateFrameBuffer();
 	FOpenGLTexture2DRef SceneTexture0 = GLDriver.CreateTexture2D(GL_RGB, screenWidth, screenHeight, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
@@ -344,12 +353,15 @@ int main()
 			QuadHelper.Draw(ScreenQuadShader, QuadTex);
 		}
 
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
 
 	Model->ReleaseRHI();
 	// Properly de-allocate all resources once they've outlived their purpose
+	FJobSystem::SharedInstance().Shutdown();
 	glfwTerminate();
 	return 0;
 }
@@ -66,7 +66,10 @@ int main()
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
 
 
 	// Load Shader
@@ -213,6 +216,8 @@ int main()
 			GLDriver.DrawArrayedPrimitive(GL_TRIANGLES, 0, 36);
 		}
 
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
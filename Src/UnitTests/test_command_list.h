@@ -0,0 +1,259 @@
+// Std. Includes
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/UtilityHelper.h"
+#include "OpenGL/OpenGLDrv.h"
+#include "Scene/Camera.h"
+#include "Scene/Model.h"
+#include "Scene/Render.h"
+#include "Scene/ShaderType.h"
+
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+// GLM Mathemtics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Other Libs
+#include <SOIL.h>
+
+// Properties
+GLuint screenWidth = 800, screenHeight = 600;
+
+// Function prototypes
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void Do_Movement();
+
+// Camera
+FCamera camera(glm::vec3(0.0f, 20.0f, 150.0f));
+bool keys[1024];
+bool bRecordLists = true;	// toggled by C, record the rocks on worker threads or draw them directly
+GLfloat lastX = 400, lastY = 300;
+bool firstMouse = true;
+
+GLfloat deltaTime = 0.0f;
+GLfloat lastFrame = 0.0f;
+
+// The MAIN function, from here we start our application and run our Game loop
+int main()
+{
+	std::cout << "Starting GLFW context, OpenGL 3.3" << std::endl;
+
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	GLDriver.Initialize();
+
+	// Init GLFW
+	glfwInit();
+	// Set all the required options for GLFW
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+
+	GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "LearnOpenGL", nullptr, nullptr); // Windowed
+	glfwMakeContextCurrent(window);
+
+	// Set the required callback functions
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// Options
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	GLDriver.DeferredInitialize();
+
+	// Define the viewport dimensions
+	glViewport(0, 0, screenWidth, screenHeight);
+	// Setup some OpenGL options
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
+
+
+	// Load Shader
+	TRefCountPtr<FMeshShaderType> MeshShader = new FMeshShaderType("shaders/test_model.vs", "shaders/test_model.frag");
+
+	// Load Models
+	FModelRef Rock = FModel::CreateModel("objects/rock/rock.obj");
+	Rock->InitRHI();
+
+	// a grid of rocks, a draw call per rock
+	const GLint kGridSize = 64;
+	std::vector<glm::mat4> RockTransforms;
+	for (GLint x = 0; x < kGridSize; x++)
+	{
+		for (GLint z = 0; z < kGridSize; z++)
+		{
+			glm::mat4 model;
+			model = glm::translate(model, glm::vec3((x - kGridSize / 2) * 4.f, -2.5f, (z - kGridSize / 2) * 4.f));
+			model = glm::rotate(model, (GLfloat)(x * 7 + z * 13), glm::vec3(0.4f, 0.6f, 0.8f));
+			RockTransforms.push_back(model);
+		} // end for z
+	} // end for x
+
+	// a command list per worker thread
+	const GLuint kThreads = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+	std::vector<FOpenGLCommandListRef> CommandLists;
+	for (GLuint i = 0; i < kThreads; i++)
+	{
+		CommandLists.push_back(new FOpenGLCommandList());
+	} // end for i
+	GLuint FrameCount = 0;
+
+	glfwSetCursorPos(window, screenWidth*0.5f, screenHeight*0.5f);
+	// Game loop
+	while (!glfwWindowShouldClose(window))
+	{
+		// Set frame time
+		GLfloat currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// Check and call events
+		glfwPollEvents();
+		Do_Movement();
+
+		// Clear the colorbuffer
+		GLDriver.SetClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		GLDriver.ClearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Create camera transformation
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(camera.Zoom, (float)screenWidth / (float)screenHeight, 1.0f, 1000.0f);
+
+		FViewContext viewContext;
+		viewContext.viewport = glm::uvec4(0, 0, screenWidth, screenHeight);
+		viewContext.view = view;
+		viewContext.projection = projection;
+
+		FRenderPolicy policy;
+		policy.MeshShader = MeshShader;
+
+		if (IsValidRef(Rock) && bRecordLists)
+		{
+			// the shader types and the view block are shared by the lists, set up them on the gl thread
+			policy.Resolve();
+			FViewUniformBuffer::SharedInstance().SetUp(viewContext);
+
+			// each thread records a slice of rocks
+			std::vector<std::thread> Workers;
+			const size_t kSlice = (RockTransforms.size() + kThreads - 1) / kThreads;
+			for (GLuint i = 0; i < kThreads; i++)
+			{
+				Workers.push_back(std::thread([&, i]() {
+					FOpenGLCommandList &CommandList = *CommandLists[i];
+					CommandList.Reset();
+
+					const size_t kEnd = std::min(RockTransforms.size(), (i + 1) * kSlice);
+					for (size_t k = i * kSlice; k < kEnd; k++)
+					{
+						FViewContext rockContext(viewContext);
+						rockContext.model = RockTransforms[k];
+						Rock->Record(CommandList, rockContext, policy);
+					} // end for k
+				}));
+			} // end for i
+
+			// replay in order on the gl thread
+			for (GLuint i = 0; i < kThreads; i++)
+			{
+				Workers[i].join();
+				GLDriver.ExecuteCommandList(*CommandLists[i]);
+			} // end for i
+
+			if (++FrameCount % 300 == 0)
+			{
+				std::cout << "Command Lists: " << kThreads << ", Commands: " << CommandLists[0]->GetCommandCount() * kThreads
+					<< ", Bytes: " << CommandLists[0]->GetSize() * kThreads << std::endl;
+			}
+		}
+		else if (IsValidRef(Rock))
+		{
+			for (size_t k = 0; k < RockTransforms.size(); k++)
+			{
+				FViewContext rockContext(viewContext);
+				rockContext.model = RockTransforms[k];
+				Rock->Draw(rockContext, policy);
+			} // end for k
+		}
+
+		GLDriver.EndFrame();
+
+		// Swap the buffers
+		glfwSwapBuffers(window);
+	}
+
+	CommandLists.clear();
+	Rock->ReleaseRHI();
+	// Properly de-allocate all resources once they've outlived their purpose
+	glfwTerminate();
+	return 0;
+}
+
+// Moves/alters the camera positions based on user input
+void Do_Movement()
+{
+	// Camera controls
+	if (keys[GLFW_KEY_W])
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (keys[GLFW_KEY_S])
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (keys[GLFW_KEY_A])
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (keys[GLFW_KEY_D])
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// Is called whenever a key is pressed/released via GLFW
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+	//cout << key << endl;
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (key == GLFW_KEY_C && action == GLFW_PRESS)
+	{
+		bRecordLists = !bRecordLists;
+		std::cout << (bRecordLists ? "Record Command Lists" : "Draw Directly") << std::endl;
+	}
+
+	if (action == GLFW_PRESS)
+		keys[key] = true;
+	else if (action == GLFW_RELEASE)
+		keys[key] = false;
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	GLfloat xoffset = lastX - xpos;
+	GLfloat yoffset = ypos - lastY;  // Reversed since y-coordinates go from bottom to left
+
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
@@ -0,0 +1,58 @@
+// Std. Includes
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Scene/CookedModel.h"
+#include "Scene/Model.h"
+
+
+// The MAIN function, the offline cooker of models, then the import time of source and cooked file
+int main(int argc, char **argv)
+{
+	std::vector<std::string> Files;
+	for (int k = 1; k < argc; k++)
+	{
+		Files.push_back(argv[k]);
+	} // end for k
+	if (Files.empty())
+	{
+		Files.push_back("objects/nanosuit/nanosuit.obj");
+		Files.push_back("objects/md5/boblampclean.md5mesh");
+		Files.push_back("objects/rock/rock.obj");
+	}
+
+	for (size_t Index = 0; Index < Files.size(); Index++)
+	{
+		const std::string &Filename = Files[Index];
+		const std::string CookedFilename = FCookedModel::GetCookedFilename(Filename);
+
+		// from source, the cooked file is removed first
+		std::remove(CookedFilename.c_str());
+		std::vector<FTexture2DRef> Textures;
+		FModelRef SourceModel = FModel::ImportModel(Filename, &Textures);
+		if (!IsValidRef(SourceModel))
+		{
+			continue;
+		}
+
+		if (!FModel::CookModel(Filename))
+		{
+			continue;
+		}
+
+		Textures.clear();
+		FModelRef CookedModel = FModel::ImportModel(Filename, &Textures);
+		if (!IsValidRef(CookedModel) || !CookedModel->ImportStats.bCooked)
+		{
+			std::cout << "Error: Cooked Model Not Loaded: " << CookedFilename << std::endl;
+			continue;
+		}
+
+		std::cout << Filename << ": Meshes " << CookedModel->Meshes.size() << "/" << SourceModel->Meshes.size()
+			<< ", Assimp: " << SourceModel->ImportStats.ParseMs << "ms, Cooked: " << CookedModel->ImportStats.ParseMs << "ms" << std::endl;
+	} // end for
+
+	return 0;
+}
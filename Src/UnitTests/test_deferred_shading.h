@@ -78,8 +78,8 @@ public:
 class FDeferredLightingShaderType : public FGlobalShaderType
 {
 public:
-	FDeferredLightingShaderType(const std::string &InVsFile, const std::string &InPsFile)
-		: FGlobalShaderType(InVsFile, InPsFile)
+	FDeferredLightingShaderType(const std::string &InVsFile, const std::string &InPsFile, const FShaderDefines &InDefines)
+		: FGlobalShaderType(InVsFile, InPsFile, InDefines)
 		, draw_mode(1)
 	{
 	}
@@ -96,12 +96,20 @@ public:
 		ProgramParams.push_back(new FShaderParameter_Integer1v("gAlbedoSpec", 3));
 		ProgramParams.push_back(new FShaderParameter_Float3v("viewPos", glm::value_ptr(viewPos), 1));
 
-		// Also send light relevant uniforms
+		// lights are shared by uniform block
+		GLDriver.SetUniformBuffer("LightsBlock", LightsBuffer);
+
+		GLDriver.SetTexture2D(1, gPositionTex);
+		GLDriver.SetTexture2D(2, gNormalTex);
+		GLDriver.SetTexture2D(3, gAlbedoSpecTex);
+	}
+
+	// pack the lights in std140 layout and upload them once
+	void UpdateLights()
+	{
+		FStd140Layout Layout;
 		for (GLuint i = 0; i < lightPositions.size(); i++)
 		{
-			ProgramParams.push_back(new FShaderParameter_Float3v(("lights[" + std::to_string(i) + "].Position"), lightPositions[i].x, lightPositions[i].y, lightPositions[i].z));
-			ProgramParams.push_back(new FShaderParameter_Float3v(("lights[" + std::to_string(i) + "].Color"), lightColors[i].x, lightColors[i].y, lightColors[i].z));
-			
 			// Update attenuation parameters and calculate radius
 			const GLfloat constant = 1.0; // Note that we don't send this to the shader, we assume it is always 1.0 (in our case)
 			const GLfloat linear = 0.7;
@@ -110,15 +118,25 @@ public:
 			const GLfloat lightThreshold = 5.0; // 5 / 256
 			const GLfloat maxBrightness = std::fmaxf(std::fmaxf(lightColors[i].r, lightColors[i].g), lightColors[i].b);
 			GLfloat radius = (-linear + static_cast<float>(std::sqrt(linear * linear - 4 * quadratic * (constant - (256.0 / lightThreshold) * maxBrightness)))) / (2 * quadratic);
-			
-			ProgramParams.push_back(new FShaderParameter_Float1v(("lights[" + std::to_string(i) + "].Linear"), linear));
-			ProgramParams.push_back(new FShaderParameter_Float1v(("lights[" + std::to_string(i) + "].Quadratic"), quadratic));
-			ProgramParams.push_back(new FShaderParameter_Float1v(("lights[" + std::to_string(i) + "].Radius"), radius));
+
+			Layout.BeginStruct();
+			Layout.PushVec3(lightPositions[i]);
+			Layout.PushVec3(lightColors[i]);
+			Layout.PushFloat(linear);
+			Layout.PushFloat(quadratic);
+			Layout.PushFloat(radius);
+			Layout.EndStruct();
 		}
 
-		GLDriver.SetTexture2D(1, gPositionTex);
-		GLDriver.SetTexture2D(2, gNormalTex);
-		GLDriver.SetTexture2D(3, gAlbedoSpecTex);
+		FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+		if (!IsValidRef(LightsBuffer) || LightsBuffer->GetSize() != Layout.GetSize())
+		{
+			LightsBuffer = GLDriver.CreateUniformBuffer(Layout.GetSize(), Layout.GetData());
+		}
+		else
+		{
+			LightsBuffer->UpdateData(0, Layout.GetSize(), Layout.GetData());
+		}
 	}
 
 public:
@@ -130,6 +148,7 @@ public:
 	glm::vec3			   viewPos;
 	std::vector<glm::vec3> lightPositions;
 	std::vector<glm::vec3> lightColors;
+	FOpenGLUniformBufferRef	LightsBuffer;
 };
 
 
@@ -171,13 +190,20 @@ int main()
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
+
 
+	// Load Shader, the light count of the lighting pass is compiled in
+	const GLuint NR_LIGHTS = 32;
+	FShaderDefines LightingDefines;
+	LightingDefines.Set("NR_LIGHTS", NR_LIGHTS);
 
-	// Load Shader
 	TRefCountPtr<FDrawGeometryInfoShaderType> GeometryPass_Shader = new FDrawGeometryInfoShaderType("shaders/test_g_buffer.vs", "shaders/test_g_buffer.frag");
 	TRefCountPtr<FDrawLightBoxShaderType> DrawLightBox_Shader = new FDrawLightBoxShaderType("shaders/test_deferred_light_box.vs", "shaders/test_deferred_light_box.frag");
-	TRefCountPtr<FDeferredLightingShaderType> LightingPass_Shader = new FDeferredLightingShaderType("shaders/test_deferred_shading.vs", "shaders/test_deferred_shading.frag");
+	TRefCountPtr<FDeferredLightingShaderType> LightingPass_Shader = new FDeferredLightingShaderType("shaders/test_deferred_shading.vs", "shaders/test_deferred_shading.frag", LightingDefines);
 
 	FDrawFullQuadHelper QuadHelper;
 
@@ -227,7 +253,6 @@ int main()
 	objectPositions.push_back(glm::vec3(0.0, -3.0, 3.0));
 	objectPositions.push_back(glm::vec3(3.0, -3.0, 3.0));
 	// - Colors
-	const GLuint NR_LIGHTS = 32;
 	std::vector<glm::vec3> lightPositions;
 	std::vector<glm::vec3> lightColors;
 	srand(13);
@@ -247,6 +272,7 @@ int main()
 
 	LightingPass_Shader->lightPositions = lightPositions;
 	LightingPass_Shader->lightColors = lightColors;
+	LightingPass_Shader->UpdateLights();
 
 	// Game loop
 	while (!glfwWindowShouldClose(window))
@@ -346,6 +372,8 @@ int main()
 			}
 		}
 
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
@@ -388,6 +416,13 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 
+	if (key == GLFW_KEY_P && action == GLFW_PRESS)
+	{
+		const FFrameAllocatorStats &Stats = FFrameAllocator::SharedInstance().GetStats();
+		std::cout << "FrameAllocator: frame allocs " << Stats.LastFrameAllocs << ", frame bytes " << Stats.LastFrameBytes
+			<< ", peak bytes " << Stats.PeakBytes << ", heap allocs " << Stats.HeapAllocs << " in " << Stats.Frames << " frames" << std::endl;
+	}
+
 	if (action == GLFW_PRESS)
 		keys[key] = true;
 	else if (action == GLFW_RELEASE)
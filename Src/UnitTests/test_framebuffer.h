@@ -70,7 +70,10 @@ int main()
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
 
 
 	// Load Shader
@@ -113,6 +116,9 @@ int main()
 	FrameBuffer->SetDepthStencilAttachment(DepthStencilBuffer);
 	FrameBuffer->CheckStatus();
 
+	// the scene texture has no mipmaps
+	FOpenGLSamplerStateRef PostSampler = GLDriver.GetSamplerState(FSamplerStateInitializer(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE));
+
 	// quad
 	GLfloat quadVerts[] = {
 		0.f, 0.f, 0.f, 0.f,  // v0, t0
@@ -148,8 +154,6 @@ int main()
 		// PASS 1:
 		GLDriver.SetFrameBuffer(FrameBuffer);
 
-		SceneTexture->SetFilterMode(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-
 		// Clear the colorbuffer
 		GLDriver.SetClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		GLDriver.ClearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -185,8 +189,6 @@ int main()
 			GLDriver.SetClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 			GLDriver.ClearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-			SceneTexture->SetFilterMode(GL_LINEAR, GL_LINEAR);
-
 			// SHADER parameters
 			FProgramParameters Parameters;
 			glm::mat4 MVP = glm::ortho(0.f, 1.f, 0.f, 1.f, -1.f, 1.f);
@@ -196,11 +198,13 @@ int main()
 			GLDriver.SetShaderProgram(PostProgramRef);
 			GLDriver.SetShaderProgramParameters(&Parameters);
 
-			GLDriver.SetTexture2D(0, SceneTexture);
+			GLDriver.SetTexture2D(0, SceneTexture, PostSampler);
 			GLDriver.SetStreamSource(0, quadVertBuffer);
 			GLDriver.SetVertexDeclaration(quadVertDecl);
 			GLDriver.DrawIndexedPrimitive(quadIndexBuffer, GL_TRIANGLES, 0, 6);
 		}
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
@@ -0,0 +1,99 @@
+// Std. Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "Common/JobSystem.h"
+
+
+// independent work per item, no shared write
+static float Heavy_Work(size_t InIndex)
+{
+	float Value = (float)InIndex;
+	for (int k = 0; k < 2000; k++)
+	{
+		Value = std::sqrt(Value * 1.0001f + (float)k);
+	} // end for k
+
+	return Value;
+}
+
+static double Time_ParallelFor(FJobSystem &JobSystem, std::vector<float> &Results)
+{
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	JobSystem.ParallelFor(0, Results.size(), 256, [&Results](size_t Begin, size_t End) {
+		for (size_t k = Begin; k < End; k++)
+		{
+			Results[k] = Heavy_Work(k);
+		} // end for k
+	});
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+}
+
+// The MAIN function, a micro benchmark of job system
+int main()
+{
+	FJobSystem &JobSystem = FJobSystem::SharedInstance();
+	// this thread plays the gl thread
+	JobSystem.SetGLThread();
+
+	std::vector<float> Results(1 << 16);
+	const unsigned int kMaxWorkers = FJobSystem::GetDefaultNumWorkers();
+
+	// scaling: the calling thread plus N workers
+	double BaseTime = 0.0;
+	for (unsigned int NumWorkers = 0; NumWorkers <= kMaxWorkers; NumWorkers++)
+	{
+		JobSystem.Initialize(NumWorkers);
+		Time_ParallelFor(JobSystem, Results);	// warm up
+
+		double Best = 1e30;
+		for (int Run = 0; Run < 5; Run++)
+		{
+			Best = std::min(Best, Time_ParallelFor(JobSystem, Results));
+		} // end for Run
+		if (NumWorkers == 0)
+		{
+			BaseTime = Best;
+		}
+
+		std::cout << "Threads: " << NumWorkers + 1 << ", Time: " << Best << "ms, Speedup: " << BaseTime / Best << std::endl;
+		JobSystem.Shutdown();
+	} // end for NumWorkers
+
+	// dependencies: simulate -> record on workers -> submit on gl thread
+	JobSystem.Initialize(kMaxWorkers);
+	{
+		FJobCounter Simulated, Recorded, Submitted;
+		std::vector<float> Poses(64), Commands(64);
+
+		for (size_t k = 0; k < Poses.size(); k++)
+		{
+			JobSystem.Run([&Poses, k]() { Poses[k] = Heavy_Work(k); }, &Simulated);
+		} // end for k
+		for (size_t k = 0; k < Commands.size(); k++)
+		{
+			JobSystem.Run([&Poses, &Commands, k]() { Commands[k] = Poses[k] * 2.f; }, &Recorded, &Simulated);
+		} // end for k
+		JobSystem.RunOnGLThread([&Commands]() {
+			float Sum = 0.f;
+			for (size_t k = 0; k < Commands.size(); k++)
+			{
+				Sum += Commands[k];
+			} // end for k
+			std::cout << "Submitted on gl thread, Checksum: " << Sum << std::endl;
+		}, &Submitted, &Recorded);
+
+		// the gl job runs here, in Wait() of the gl thread
+		JobSystem.Wait(Submitted);
+	}
+
+	FJobSystemStats Stats = JobSystem.GetStats();
+	std::cout << "Jobs: " << Stats.JobsExecuted << ", Stolen: " << Stats.JobsStolen << ", GL Jobs: " << Stats.GLJobsExecuted << std::endl;
+	JobSystem.Shutdown();
+
+	return 0;
+}
@@ -71,7 +71,10 @@ int main()
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
 
 
 	// Load Shader
@@ -119,6 +122,8 @@ int main()
 			Model->Draw(viewContext, policy);
 		}
 
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
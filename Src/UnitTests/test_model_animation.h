@@ -71,11 +71,18 @@ int main()
 	glfwSetCursorPos(window, screenWidth*0.5f, screenHeight*0.5f);
 
 	GLDriver.DeferredInitialize();
+	// the linked programs are cached, a later run loads them without compiling
+	GLDriver.SetProgramCacheDirectory("shadercache");
+	// the shaders compile in parallel, a program is waited for on first draw
+	GLDriver.SetShaderStatusDeferred(true);
 
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
 
 
 	// Load Shader
@@ -144,11 +151,17 @@ int main()
 			//Draw_Debug(Model, Cube, SkeletonLines, viewContext, policy);
 		}
 
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
 
 	Model->ReleaseRHI();
+	if (IsValidRef(GLDriver.GetProgramCache()))
+	{
+		GLDriver.GetProgramCache()->GetStats().Print();
+	}
 	// Properly de-allocate all resources once they've outlived their purpose
 	glfwTerminate();
 	return 0;
@@ -0,0 +1,225 @@
+// Std. Includes
+#include <algorithm>
+#include <string>
+
+#include "Common/UtilityHelper.h"
+#include "OpenGL/OpenGLDrv.h"
+#include "Scene/Camera.h"
+#include "Scene/Model.h"
+#include "Scene/ModelLoader.h"
+#include "Scene/Render.h"
+#include "Scene/ShaderType.h"
+
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+// GLM Mathemtics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Other Libs
+#include <SOIL.h>
+
+// Properties
+GLuint screenWidth = 800, screenHeight = 600;
+
+// Function prototypes
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void Do_Movement();
+
+// Camera
+FCamera camera(glm::vec3(0.0f, 0.0f, 30.0f));
+bool keys[1024];
+GLfloat lastX = 400, lastY = 300;
+bool firstMouse = true;
+
+GLfloat deltaTime = 0.0f;
+GLfloat lastFrame = 0.0f;
+
+// The MAIN function, from here we start our application and run our Game loop
+int main()
+{
+	std::cout << "Starting GLFW context, OpenGL 3.3" << std::endl;
+
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	GLDriver.Initialize();
+
+	// Init GLFW
+	glfwInit();
+	// Set all the required options for GLFW
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+
+	GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "LearnOpenGL", nullptr, nullptr); // Windowed
+	glfwMakeContextCurrent(window);
+
+	// Set the required callback functions
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// Options
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	GLDriver.DeferredInitialize();
+
+	// Define the viewport dimensions
+	glViewport(0, 0, screenWidth, screenHeight);
+	// Setup some OpenGL options
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
+
+
+	// Load Shader
+	TRefCountPtr<FMeshShaderType> MeshShader = new FMeshShaderType("shaders/test_model.vs", "shaders/test_model.frag");
+
+	// the loading runs on workers, keep one at least
+	FJobSystem &JobSystem = FJobSystem::SharedInstance();
+	JobSystem.Initialize(std::max(1u, FJobSystem::GetDefaultNumWorkers()));
+
+	// a placeholder spins while the models are loading
+	FModelRef Cube = FModel::CreateCube("textures/container2.png");
+	Cube->InitRHI();
+
+	std::vector<FModelRef> Models;
+	const GLdouble kStartTime = glfwGetTime();
+	const char *kFiles[] = { "objects/nanosuit/nanosuit.obj", "objects/rock/rock.obj", "objects/planet/planet.obj" };
+	for (size_t k = 0; k < sizeof(kFiles) / sizeof(kFiles[0]); k++)
+	{
+		FModel::CreateModelAsync(kFiles[k],
+			[&Models, kStartTime](FModelLoadRequest &Request) {
+				std::cout << "Loaded: " << Request.GetFilename() << (Request.GetState() == MLS_Done ? " Done" : " Failed")
+					<< " in " << glfwGetTime() - kStartTime << "s" << std::endl;
+				const FOpenGLTextureUploaderStats &UploadStats = FOpenGLDrv::SharedInstance().GetTextureUploader()->GetStats();
+				std::cout << "Texture Uploads: " << UploadStats.Uploads << ", " << UploadStats.BytesUploaded / 1024 << "KB, Ring Full: " << UploadStats.RingFull << std::endl;
+				if (Request.GetState() == MLS_Done)
+				{
+					Models.push_back(Request.GetModel());
+				}
+			},
+			[](FModelLoadRequest &Request) {
+				std::cout << "Loading: " << Request.GetFilename() << " " << (int)(Request.GetProgress() * 100.f) << "%" << std::endl;
+			});
+	} // end for k
+
+	glfwSetCursorPos(window, screenWidth*0.5f, screenHeight*0.5f);
+	// Game loop
+	while (!glfwWindowShouldClose(window))
+	{
+		// Set frame time
+		GLfloat currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// Check and call events
+		glfwPollEvents();
+		Do_Movement();
+
+		// gl creation of the loaded models, 2ms per frame
+		FModelLoader::SharedInstance().Tick(2.0);
+
+		// Clear the colorbuffer
+		GLDriver.SetClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		GLDriver.ClearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Create camera transformation
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(camera.Zoom, (float)screenWidth / (float)screenHeight, 0.1f, 100.0f);
+
+		FViewContext viewContext;
+		viewContext.viewport = glm::uvec4(0, 0, screenWidth, screenHeight);
+		viewContext.view = view;
+		viewContext.projection = projection;
+
+		FRenderPolicy policy;
+		policy.MeshShader = MeshShader;
+
+		if (FModelLoader::SharedInstance().GetPendingCount() > 0)
+		{
+			viewContext.model = glm::rotate(glm::mat4(), currentFrame, glm::vec3(0.f, 1.f, 0.f));
+			Cube->Draw(viewContext, policy);
+		}
+
+		for (size_t k = 0; k < Models.size(); k++)
+		{
+			viewContext.model = glm::translate(glm::mat4(), glm::vec3(((GLfloat)k - 1.f) * 6.0f, -1.75f, -5.0f));
+			viewContext.model = glm::scale(viewContext.model, glm::vec3(0.2f, 0.2f, 0.2f));
+			Models[k]->Draw(viewContext, policy);
+		} // end for k
+
+		GLDriver.EndFrame();
+
+		// Swap the buffers
+		glfwSwapBuffers(window);
+	}
+
+	for (size_t k = 0; k < Models.size(); k++)
+	{
+		Models[k]->ReleaseRHI();
+	} // end for k
+	Cube->ReleaseRHI();
+	JobSystem.Shutdown();
+	// Properly de-allocate all resources once they've outlived their purpose
+	glfwTerminate();
+	return 0;
+}
+
+// Moves/alters the camera positions based on user input
+void Do_Movement()
+{
+	// Camera controls
+	if (keys[GLFW_KEY_W])
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (keys[GLFW_KEY_S])
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (keys[GLFW_KEY_A])
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (keys[GLFW_KEY_D])
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// Is called whenever a key is pressed/released via GLFW
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+	//cout << key << endl;
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (action == GLFW_PRESS)
+		keys[key] = true;
+	else if (action == GLFW_RELEASE)
+		keys[key] = false;
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	GLfloat xoffset = lastX - xpos;
+	GLfloat yoffset = ypos - lastY;  // Reversed since y-coordinates go from bottom to left
+
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
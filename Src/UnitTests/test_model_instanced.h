@@ -0,0 +1,272 @@
+// Std. Includes
+#include <string>
+#include <vector>
+
+#include "Common/UtilityHelper.h"
+#include "OpenGL/OpenGLDrv.h"
+#include "Scene/Camera.h"
+#include "Scene/MeshBatch.h"
+#include "Scene/Model.h"
+#include "Scene/Render.h"
+#include "Scene/ShaderType.h"
+
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+// GLM Mathemtics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Other Libs
+#include <SOIL.h>
+
+// Properties
+GLuint screenWidth = 800, screenHeight = 600;
+
+// Function prototypes
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void Do_Movement();
+
+// Camera
+FCamera camera(glm::vec3(0.0f, 0.0f, 155.0f));
+bool keys[1024];
+bool bDrawBatches = false;	// toggled by B, draw a part of rocks by mesh batch builder
+GLfloat lastX = 400, lastY = 300;
+bool firstMouse = true;
+
+GLfloat deltaTime = 0.0f;
+GLfloat lastFrame = 0.0f;
+
+// The MAIN function, from here we start our application and run our Game loop
+int main()
+{
+	std::cout << "Starting GLFW context, OpenGL 3.3" << std::endl;
+
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	GLDriver.Initialize();
+
+	// Init GLFW
+	glfwInit();
+	// Set all the required options for GLFW
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+
+	GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "LearnOpenGL", nullptr, nullptr); // Windowed
+	glfwMakeContextCurrent(window);
+
+	// Set the required callback functions
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// Options
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	GLDriver.DeferredInitialize();
+
+	// Define the viewport dimensions
+	glViewport(0, 0, screenWidth, screenHeight);
+	// Setup some OpenGL options
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
+
+
+	// Load Shader
+	TRefCountPtr<FMeshShaderType> MeshShader = new FMeshShaderType("shaders/test_model.vs", "shaders/test_model.frag");
+	TRefCountPtr<FMeshShaderType> InstancedMeshShader = new FMeshShaderType("shaders/test_model_instanced.vs", "shaders/test_model.frag");
+
+	// Load Models
+	FModelRef Planet = FModel::CreateModel("objects/planet/planet.obj");
+	FModelRef Rock = FModel::CreateModel("objects/rock/rock.obj");
+	Planet->InitRHI();
+	Rock->InitRHI();
+
+	// two cube meshes of one material in one arena page, the batch builder groups them into one batch
+	FModelRef Crates = FModel::CreateCube("textures/container2.png");
+	FModelRef OtherCrate = FModel::CreateCube("textures/container2.png");
+	OtherCrate->Meshes[0]->Material = Crates->Meshes[0]->Material;
+	Crates->Meshes.push_back(OtherCrate->Meshes[0]);
+	Crates->MeshInstances.push_back(FMeshInstance(NODE_INDEX_NONE, 1));
+	OtherCrate.SafeRelease();
+	Crates->InitRHI();
+
+	// Generate a large list of semi-random transformation matrices in a ring
+	const GLuint kAmount = 100000;
+	std::vector<glm::mat4> RockTransforms(kAmount);
+	srand((unsigned int)glfwGetTime());
+	const GLfloat kRadius = 150.0f;
+	const GLfloat kOffset = 25.0f;
+	for (GLuint i = 0; i < kAmount; i++)
+	{
+		glm::mat4 model;
+		// 1. Translation: displace along circle with radius in range [-offset, offset]
+		GLfloat angle = (GLfloat)i / (GLfloat)kAmount * 360.0f;
+		GLfloat displacement = (rand() % (GLint)(2 * kOffset * 100)) / 100.0f - kOffset;
+		GLfloat x = sin(angle) * kRadius + displacement;
+		displacement = (rand() % (GLint)(2 * kOffset * 100)) / 100.0f - kOffset;
+		GLfloat y = -2.5f + displacement * 0.4f;
+		displacement = (rand() % (GLint)(2 * kOffset * 100)) / 100.0f - kOffset;
+		GLfloat z = cos(angle) * kRadius + displacement;
+		model = glm::translate(model, glm::vec3(x, y, z));
+
+		// 2. Scale: between 0.05 and 0.25f
+		GLfloat scale = (rand() % 20) / 100.0f + 0.05f;
+		model = glm::scale(model, glm::vec3(scale));
+
+		// 3. Rotation: around a (semi)randomly picked rotation axis vector
+		GLfloat rotAngle = (GLfloat)(rand() % 360);
+		model = glm::rotate(model, rotAngle, glm::vec3(0.4f, 0.6f, 0.8f));
+
+		RockTransforms[i] = model;
+	} // end for i
+
+	const GLuint kBatchedAmount = 2000;
+	const GLuint kCratesAmount = 100;
+	FMeshBatchBuilder BatchBuilder;
+	GLuint FrameCount = 0;
+
+	glfwSetCursorPos(window, screenWidth*0.5f, screenHeight*0.5f);
+	// Game loop
+	while (!glfwWindowShouldClose(window))
+	{
+		// Set frame time
+		GLfloat currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// Check and call events
+		glfwPollEvents();
+		Do_Movement();
+
+		// Clear the colorbuffer
+		GLDriver.SetClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		GLDriver.ClearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Create camera transformation
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(camera.Zoom, (float)screenWidth / (float)screenHeight, 1.0f, 10000.0f);
+
+		FViewContext viewContext;
+		viewContext.viewport = glm::uvec4(0, 0, screenWidth, screenHeight);
+		viewContext.view = view;
+		viewContext.projection = projection;
+
+		FRenderPolicy policy;
+		policy.MeshShader = MeshShader;
+		policy.InstancedMeshShader = InstancedMeshShader;
+
+		// Draw Planet
+		FViewContext planetContext(viewContext);
+		planetContext.model = glm::translate(planetContext.model, glm::vec3(0.0f, -5.0f, 0.0f));
+		planetContext.model = glm::scale(planetContext.model, glm::vec3(4.0f, 4.0f, 4.0f));
+		if (IsValidRef(Planet))
+		{
+			Planet->Draw(planetContext, policy);
+		}
+
+		// Draw Rocks, one draw call per mesh
+		if (IsValidRef(Rock) && !bDrawBatches)
+		{
+			Rock->DrawInstanced(viewContext, policy, RockTransforms);
+		}
+		else if (IsValidRef(Rock))
+		{
+			for (GLuint i = 0; i < kBatchedAmount; i++)
+			{
+				BatchBuilder.AddModel(*Rock, RockTransforms[i]);
+			} // end for i
+			for (GLuint i = 0; i < kCratesAmount; i++)
+			{
+				BatchBuilder.AddModel(*Crates, RockTransforms[kBatchedAmount + i]);
+			} // end for i
+			BatchBuilder.Flush(viewContext, policy);
+
+			// the crates alternate their meshes, so the commands are more than the batches
+			if (++FrameCount % 300 == 0)
+			{
+				const FMeshBatchStats &BatchStats = BatchBuilder.GetStats();
+				std::cout << "Mesh Batches: " << BatchStats.Instances << " instances, " << BatchStats.Batches << " batches, "
+					<< BatchStats.Meshes << " meshes, " << BatchStats.Commands << " commands, " << BatchStats.DrawCalls << " draw calls" << std::endl;
+			}
+		}
+
+		GLDriver.EndFrame();
+
+		// Swap the buffers
+		glfwSwapBuffers(window);
+	}
+
+	Planet->ReleaseRHI();
+	Rock->ReleaseRHI();
+	Crates->ReleaseRHI();
+	BatchBuilder.ReleaseRHI();
+	// Properly de-allocate all resources once they've outlived their purpose
+	glfwTerminate();
+	return 0;
+}
+
+// Moves/alters the camera positions based on user input
+void Do_Movement()
+{
+	// Camera controls
+	if (keys[GLFW_KEY_W])
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (keys[GLFW_KEY_S])
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (keys[GLFW_KEY_A])
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (keys[GLFW_KEY_D])
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// Is called whenever a key is pressed/released via GLFW
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+	//cout << key << endl;
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (key == GLFW_KEY_B && action == GLFW_PRESS)
+	{
+		bDrawBatches = !bDrawBatches;
+		std::cout << (bDrawBatches ? "Draw Batches" : "Draw Instanced") << std::endl;
+	}
+
+	if (action == GLFW_PRESS)
+		keys[key] = true;
+	else if (action == GLFW_RELEASE)
+		keys[key] = false;
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	GLfloat xoffset = lastX - xpos;
+	GLfloat yoffset = ypos - lastY;  // Reversed since y-coordinates go from bottom to left
+
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
@@ -0,0 +1,203 @@
+// Std. Includes
+#include <string>
+
+#include "Common/UtilityHelper.h"
+#include "OpenGL/OpenGLDrv.h"
+#include "Scene/Camera.h"
+#include "Scene/Model.h"
+#include "Scene/Render.h"
+#include "Scene/ShaderPermutation.h"
+#include "Scene/ShaderType.h"
+
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+// GLM Mathemtics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Other Libs
+#include <SOIL.h>
+
+// Properties
+GLuint screenWidth = 800, screenHeight = 600;
+
+// Function prototypes
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void Do_Movement();
+
+// Camera
+FCamera camera(glm::vec3(0.0f, 0.0f, 30.0f));
+bool keys[1024];
+GLfloat lastX = 400, lastY = 300;
+bool firstMouse = true;
+
+GLfloat deltaTime = 0.0f;
+GLfloat lastFrame = 0.0f;
+
+// the switches on while keys N and G are held
+uint32_t permutationMask = 0;
+
+// The MAIN function, from here we start our application and run our Game loop
+int main()
+{
+	std::cout << "Starting GLFW context, OpenGL 3.3" << std::endl;
+
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	GLDriver.Initialize();
+
+	// Init GLFW
+	glfwInit();
+	// Set all the required options for GLFW
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+
+	GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "LearnOpenGL", nullptr, nullptr); // Windowed
+	glfwMakeContextCurrent(window);
+
+	// Set the required callback functions
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// Options
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	GLDriver.DeferredInitialize();
+
+	// Define the viewport dimensions
+	glViewport(0, 0, screenWidth, screenHeight);
+	// Setup some OpenGL options
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
+
+
+	// the variants of shader, compiled on first use
+	std::vector<std::string> Switches;
+	Switches.push_back("SHOW_NORMAL");
+	Switches.push_back("GRAYSCALE");
+	TShaderPermutation<FMeshShaderType> MeshShaders("shaders/test_permutation.vs", "shaders/test_permutation.frag", Switches);
+	const uint32_t kShowNormal = MeshShaders.GetSwitchBit("SHOW_NORMAL");
+	const uint32_t kGrayscale = MeshShaders.GetSwitchBit("GRAYSCALE");
+
+	// Load Model
+	FModelRef Model = FModel::CreateModel("objects/MD5/Bob.md5mesh");
+	Model->InitRHI();
+
+	glfwSetCursorPos(window, screenWidth*0.5f, screenHeight*0.5f);
+	// Game loop
+	while (!glfwWindowShouldClose(window))
+	{
+		// Set frame time
+		GLfloat currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// Check and call events
+		glfwPollEvents();
+		Do_Movement();
+
+		// Clear the colorbuffer
+		GLDriver.SetClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		GLDriver.ClearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Create camera transformation
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(camera.Zoom, (float)screenWidth / (float)screenHeight, 0.1f, 100.0f);
+
+		FViewContext viewContext;
+		viewContext.viewport = glm::uvec4(0, 0, screenWidth, screenHeight);
+		viewContext.view = view;
+		viewContext.projection = projection;
+
+		viewContext.model = glm::translate(viewContext.model, glm::vec3(0.0f, -1.75f, 0.0f)); // Translate it down a bit so it's at the center of the scene
+		viewContext.model = glm::scale(viewContext.model, glm::vec3(0.2f, 0.2f, 0.2f));
+		viewContext.model = glm::rotate(viewContext.model, -glm::half_pi<float>(), glm::vec3(1.f, 0.f, 0.f));
+
+		// the variant of the held keys, compiled on first Get()
+		FRenderPolicy policy;
+		const uint32_t kMask = (keys[GLFW_KEY_N] ? kShowNormal : 0) | (keys[GLFW_KEY_G] ? kGrayscale : 0);
+		policy.MeshShader = MeshShaders.Get(kMask);
+		if (kMask != permutationMask)
+		{
+			permutationMask = kMask;
+			std::cout << "Shader Permutation: " << (kMask & kShowNormal ? "SHOW_NORMAL " : "") << (kMask & kGrayscale ? "GRAYSCALE " : "")
+				<< "(" << MeshShaders.GetVariantCount() << " variants compiled)" << std::endl;
+		}
+
+		if (IsValidRef(Model))
+		{
+			Model->Draw(viewContext, policy);
+		}
+
+		GLDriver.EndFrame();
+
+		// Swap the buffers
+		glfwSwapBuffers(window);
+	}
+
+	Model->ReleaseRHI();
+	// Properly de-allocate all resources once they've outlived their purpose
+	glfwTerminate();
+	return 0;
+}
+
+// Moves/alters the camera positions based on user input
+void Do_Movement()
+{
+	// Camera controls
+	if (keys[GLFW_KEY_W])
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (keys[GLFW_KEY_S])
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (keys[GLFW_KEY_A])
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (keys[GLFW_KEY_D])
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// Is called whenever a key is pressed/released via GLFW
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+	//cout << key << endl;
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (action == GLFW_PRESS)
+		keys[key] = true;
+	else if (action == GLFW_RELEASE)
+		keys[key] = false;
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	GLfloat xoffset = lastX - xpos;
+	GLfloat yoffset = ypos - lastY;  // Reversed since y-coordinates go from bottom to left
+
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
@@ -69,7 +69,7 @@ public:
 		ProgramParams.push_back(new FShaderParameter_Integer1v("shadowMapTex", 3));
 
 		FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
-		GLDriver.SetTexture2D(3, ShadowMapTex);
+		GLDriver.SetTexture2D(3, ShadowMapTex, ShadowMapSampler);
 	}
 
 public:
@@ -78,6 +78,7 @@ public:
 	glm::mat4		ShadowVP;
 
 	FOpenGLTexture2DRef	ShadowMapTex;
+	FOpenGLSamplerStateRef	ShadowMapSampler;
 };
 
 class FShowDepthShaderType : public FGlobalShaderType
@@ -132,7 +133,10 @@ int main()
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
 
 	glm::vec3 LightPos(0.f, 5.f, 0.f);
 
@@ -162,9 +166,12 @@ int main()
 	// Create Frame Buffer;
 	FOpenGLFrameBufferRef FrameBuffer = GLDriver.CreateFrameBuffer();
 	FOpenGLTexture2DRef DepthTexture = GLDriver.CreateTexture2D(GL_DEPTH_COMPONENT, depthWidth, depthHeight, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-	DepthTexture->SetWrapMode(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
 	DepthTexture->SetFilterMode(GL_LINEAR, GL_LINEAR);
-	DepthTexture->SetBorderColor(1.f, 1.f, 1.f, 1.f);
+
+	// outside of the light frustum is lit
+	FSamplerStateInitializer ShadowSamplerInitializer(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
+	ShadowSamplerInitializer.SetBorderColor(1.f, 1.f, 1.f, 1.f);
+	LightingShader->ShadowMapSampler = GLDriver.GetSamplerState(ShadowSamplerInitializer);
 
 
 	FrameBuffer->SetDepthAttachment(DepthTexture);
@@ -265,6 +272,8 @@ int main()
 			QuadHelper.Draw(DisplayDepthShader, DepthTexture);
 		}
 
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
@@ -231,7 +231,12 @@ int main()
 	// Define the viewport dimensions
 	glViewport(0, 0, screenWidth, screenHeight);
 	// Setup some OpenGL options
-	glEnable(GL_DEPTH_TEST);
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(false);
+	FOpenGLPipelineStateRef NoDepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
 
 
 	// Load Shader
@@ -357,7 +362,7 @@ int main()
 		glfwPollEvents();
 		Do_Movement();
 
-		glEnable(GL_DEPTH_TEST);
+		GLDriver.SetPipelineState(DepthTestState);
 		// PASS 1: Geometry Pass
 		{
 			GLDriver.SetFrameBuffer(GFrameBuffer);
@@ -395,7 +400,7 @@ int main()
 			}
 		}
 
-		glDisable(GL_DEPTH_TEST);
+		GLDriver.SetPipelineState(NoDepthTestState);
 		// PASS 2: Calculate Ambient Occlusion Factors
 		if(1)
 		{
@@ -438,7 +443,7 @@ int main()
 		// DEBUG: Draw Lights Cube
 		if (1)
 		{
-			glEnable(GL_DEPTH_TEST);
+			GLDriver.SetPipelineState(DepthTestState);
 
 			// 2.5. Copy content of geometry's depth buffer to default framebuffer's depth buffer
 			GLDriver.BlitFramebuffer(GFrameBuffer, FOpenGLFrameBufferRef(), screenWidth, screenHeight, GL_DEPTH_BUFFER_BIT);
@@ -478,6 +483,8 @@ int main()
 			GLDriver.CheckError(__FILE__, __LINE__);
 		}
 
+		GLDriver.EndFrame();
+
 		// Swap the buffers
 		glfwSwapBuffers(window);
 	}
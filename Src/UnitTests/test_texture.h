@@ -167,13 +167,7 @@ int main()
 	}
 #endif
 
-	// Set Shader Parameters
 	FProgramParameters ProgramParams;
-	{
-		ProgramParams.push_back(new FShaderParameter_Integer1v("ourTexture1", 0));
-		ProgramParams.push_back(new FShaderParameter_Integer1v("ourTexture2", 1));
-		GLDriver.SetShaderProgramParameters(&ProgramParams);
-	}
 
 	// Game loop
 	while (!glfwWindowShouldClose(window))
@@ -186,8 +180,16 @@ int main()
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
+		// Set Shader Parameters, they are released at the end of frame
+		ProgramParams.clear();
+		ProgramParams.push_back(new FShaderParameter_Integer1v("ourTexture1", 0));
+		ProgramParams.push_back(new FShaderParameter_Integer1v("ourTexture2", 1));
+		GLDriver.SetShaderProgramParameters(&ProgramParams);
+
 		GLDriver.DrawIndexedPrimitive(IndexBufferRef, GL_TRIANGLES, 0, 6);
 
+		GLDriver.EndFrame();
+
 		// Swap the screen buffers
 		glfwSwapBuffers(window);
 	}
@@ -0,0 +1,216 @@
+// Std. Includes
+#include <algorithm>
+#include <string>
+
+#include "Common/UtilityHelper.h"
+#include "OpenGL/OpenGLDrv.h"
+#include "Scene/Camera.h"
+#include "Scene/Model.h"
+#include "Scene/Render.h"
+#include "Scene/ShaderType.h"
+#include "Scene/RenderThread.h"
+#include "Scene/TextureStreamer.h"
+#include "Common/JobSystem.h"
+
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+// GLM Mathemtics
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Other Libs
+#include <SOIL.h>
+
+// Properties
+GLuint screenWidth = 800, screenHeight = 600;
+
+// Function prototypes
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void Do_Movement();
+
+
+// Camera
+FCamera camera(glm::vec3(0.0f, 0.0f, 10.0f));
+bool keys[1024];
+GLfloat lastX = 400, lastY = 300;
+bool firstMouse = true;
+
+GLfloat deltaTime = 0.0f;
+GLfloat lastFrame = 0.0f;
+
+// The MAIN function, from here we start our application and run our Game loop
+int main()
+{
+	std::cout << "Starting GLFW context, OpenGL 3.3" << std::endl;
+
+	FOpenGLDrv &GLDriver = FOpenGLDrv::SharedInstance();
+	GLDriver.Initialize();
+
+	// Init GLFW
+	glfwInit();
+	// Set all the required options for GLFW
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+
+	GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "LearnOpenGL", nullptr, nullptr); // Windowed
+	glfwMakeContextCurrent(window);
+
+	// Set the required callback functions
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// Options
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	glfwSetCursorPos(window, screenWidth*0.5f, screenHeight*0.5f);
+
+	GLDriver.DeferredInitialize();
+
+	// Define the viewport dimensions
+	glViewport(0, 0, screenWidth, screenHeight);
+	// Setup some OpenGL options
+	FPipelineStateInitializer PipelineInitializer;
+	PipelineInitializer.DepthStencilState = FDepthStencilStateInitializer(true);
+	FOpenGLPipelineStateRef DepthTestState = GLDriver.GetPipelineState(PipelineInitializer);
+	GLDriver.SetPipelineState(DepthTestState);
+
+
+	// Load Shader
+	TRefCountPtr<FMeshShaderType> MeshShader = new FMeshShaderType("shaders/test_model.vs", "shaders/test_model.frag");
+
+	// the prefetching runs on workers, the textures are compressed offline to be streamed
+	FJobSystem::SharedInstance().Initialize(std::max(1u, FJobSystem::GetDefaultNumWorkers()));
+	FModel::CookModel("objects/nanosuit/nanosuit.obj");
+
+	// a budget smaller than the full resolution of all textures
+	FTextureStreamingConfig StreamingConfig;
+	StreamingConfig.BudgetBytes = 8 * 1024 * 1024;
+	FTextureStreamer::SharedInstance().SetConfig(StreamingConfig);
+
+	// Load Model
+	FModelRef Model = FModel::CreateModel("objects/nanosuit/nanosuit.obj");
+	assert(IsValidRef(Model));
+	Model->InitRHI();
+
+	// the context is moved to render thread, no gl call on this thread until it stops
+	glfwMakeContextCurrent(nullptr);
+	FRenderThread RenderThread(2);
+	RenderThread.Start(
+		[window]() { glfwMakeContextCurrent(window); },
+		[window]() { glfwSwapBuffers(window); },
+		[]() { glfwMakeContextCurrent(nullptr); });
+
+	// Game loop
+	while (!glfwWindowShouldClose(window))
+	{
+		// Set frame time
+		GLfloat currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// Check and call events
+		glfwPollEvents();
+		Do_Movement();
+
+		// waits here if the render thread is a frame behind
+		FRenderFrame *Frame = RenderThread.BeginFrame();
+		const unsigned int FrameNumber = Frame->FrameNumber;
+
+		// Create camera transformation
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(camera.Zoom, (float)screenWidth / (float)screenHeight, 0.1f, 100.0f);
+
+		Frame->ClearColor = glm::vec4(0.2f, 0.3f, 0.3f, 1.0f);
+		Frame->View.viewport = glm::uvec4(0, 0, screenWidth, screenHeight);
+		Frame->View.view = view;
+		Frame->View.projection = projection;
+		Frame->Policy.MeshShader = MeshShader;
+
+		// a row into the distance, the far ones need the small levels only
+		for (GLint k = 0; k < 8; k++)
+		{
+			glm::mat4 model;
+			model = glm::translate(model, glm::vec3(0.0f, -1.75f, -k * 10.0f));
+			model = glm::scale(model, glm::vec3(0.2f, 0.2f, 0.2f));
+			Model->Snapshot(*Frame, model);
+		} // end for k
+
+		RenderThread.EndFrame(Frame);
+
+		if (FrameNumber % 300 == 299)
+		{
+			FTextureStreamerStats Stats = FTextureStreamer::SharedInstance().GetStats();
+			std::cout << "Textures: " << Stats.StreamedTextures << "/" << Stats.Textures << " streamed, Resident: " << Stats.ResidentBytes / 1024
+				<< "KB, Wanted: " << Stats.WantedBytes / 1024 << "KB, Bias: " << Stats.MipBias << ", Loaded: " << Stats.LevelsLoaded
+				<< ", Evicted: " << Stats.LevelsEvicted << std::endl;
+		}
+	}
+
+	RenderThread.Stop();
+	glfwMakeContextCurrent(window);
+
+	Model->ReleaseRHI();
+	FJobSystem::SharedInstance().Shutdown();
+	// Properly de-allocate all resources once they've outlived their purpose
+	glfwTerminate();
+	return 0;
+}
+
+// Moves/alters the camera positions based on user input
+void Do_Movement()
+{
+	// Camera controls
+	if (keys[GLFW_KEY_W])
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (keys[GLFW_KEY_S])
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (keys[GLFW_KEY_A])
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (keys[GLFW_KEY_D])
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// Is called whenever a key is pressed/released via GLFW
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+	//cout << key << endl;
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (action == GLFW_PRESS)
+		keys[key] = true;
+	else if (action == GLFW_RELEASE)
+		keys[key] = false;
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	GLfloat xoffset = lastX - xpos;
+	GLfloat yoffset = ypos - lastY;  // Reversed since y-coordinates go from bottom to left
+
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}